@@ -34,6 +34,7 @@ Or: '|';
 Star: '*';
 Slash: '/';
 Arrow : '->';
+Minus: '-';
 
 /// Boolean Literals
 
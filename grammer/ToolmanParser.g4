@@ -79,7 +79,7 @@ httpMethod:
 	| Trace
 	| Connect;
 
-path: (Slash? pathParam? pathString pathParam?)+;
+path: (Slash | pathParam | pathString)+;
 
 pathParam: OpenBrace structField CloseBrace;
 
@@ -112,7 +112,18 @@ fieldType: type_;
 
 structFieldList: structField (Comma structField)*;
 
-structField: DocumentComment* InlineComment? identifierName Colon fieldType QuestionMark? InlineComment?;
+structField: DocumentComment* InlineComment? identifierName Colon fieldType QuestionMark? fieldNumber? fieldConstraints? InlineComment?;
+
+// = 3, the number identifying the field in the binary wire format
+fieldNumber: Assign intgerLiteral;
+
+// [min: 0, max: 100], checked by the generated validators
+fieldConstraints:
+	OpenBracket fieldConstraint (Comma fieldConstraint)* CloseBracket;
+
+fieldConstraint: identifierName Colon constraintValue;
+
+constraintValue: Minus? numericLiteral | StringLiteral;
 
 enumFieldList: enumField (Comma enumField)*;
 
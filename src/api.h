@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -63,6 +64,22 @@ class Api {
     returns_.push_back(std::move(api_return));
   }
 
+  [[nodiscard]] HttpMethod get_http_method() const { return http_method_; }
+
+  [[nodiscard]] const std::string& get_path() const { return path_; }
+
+  [[nodiscard]] const std::vector<PathParam>& get_path_params() const {
+    return path_params_;
+  }
+
+  [[nodiscard]] const std::shared_ptr<Type>& get_body_param() const {
+    return body_param_;
+  }
+
+  [[nodiscard]] const std::vector<ApiReturn>& get_returns() const {
+    return returns_;
+  }
+
  private:
   HttpMethod http_method_;
   std::string path_;
@@ -72,6 +89,31 @@ class Api {
   std::vector<ApiReturn> returns_;
 };
 
+// The name of the method as it appears in HTTP requests.
+inline const char* http_method_to_string(Api::HttpMethod http_method) {
+  switch (http_method) {
+    case Api::HttpMethod::GET:
+      return "GET";
+    case Api::HttpMethod::POST:
+      return "POST";
+    case Api::HttpMethod::DELETE:
+      return "DELETE";
+    case Api::HttpMethod::PUT:
+      return "PUT";
+    case Api::HttpMethod::PATCH:
+      return "PATCH";
+    case Api::HttpMethod::HEAD:
+      return "HEAD";
+    case Api::HttpMethod::OPTIONS:
+      return "OPTIONS";
+    case Api::HttpMethod::TRACE:
+      return "TRACE";
+    case Api::HttpMethod::CONNECT:
+      return "CONNECT";
+  }
+  return "";
+}
+
 class ApiGroup {
  public:
   explicit ApiGroup(std::string group_name)
@@ -79,6 +121,12 @@ class ApiGroup {
 
   void add_api(Api api) { apis_.push_back(std::move(api)); }
 
+  [[nodiscard]] const std::string& get_group_name() const {
+    return group_name_;
+  }
+
+  [[nodiscard]] const std::vector<Api>& get_apis() const { return apis_; }
+
  private:
   std::string group_name_;
   std::string api_prefix_;
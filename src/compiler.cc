@@ -4,7 +4,7 @@
 
 #include "compiler.h"
 
-#define DEF_PHASE_WALK(source, compiler)                     \
+#define DEF_PHASE_PARSE(source, compiler)                    \
   auto ifs = std::ifstream(*(source), std::ios_base::in);    \
   if (!ifs.is_open()) {                                      \
     throw FileNotFoundError(source);                         \
@@ -15,25 +15,52 @@
   tokens.fill();                                             \
   ToolmanParser parser(&tokens);                             \
   antlr4::tree::ParseTree* tree = parser.document();         \
-  auto def_phase_walker = DeclPhaseWalker(source, compiler); \
-  walker_.walk(&def_phase_walker, tree);
+  auto def_phase_walker = DeclPhaseWalker(source, compiler);
 
 namespace toolman {
+std::optional<std::pair<std::filesystem::path, FileId>>
+Compiler::resolve_import(const std::filesystem::path& src_path) {
+  auto source = src_path.lexically_normal();
+  if (source.is_absolute()) {
+    if (auto id = file_cache_.stat(source); id.has_value()) {
+      return std::make_pair(source, id.value());
+    }
+    return std::nullopt;
+  }
+  if (auto id = file_cache_.stat(base_path_ / source); id.has_value()) {
+    return std::make_pair(base_path_ / source, id.value());
+  }
+  for (const auto& import_path : import_paths_) {
+    if (auto id = file_cache_.stat(import_path / source); id.has_value()) {
+      return std::make_pair(import_path / source, id.value());
+    }
+  }
+  return std::nullopt;
+}
+
 std::shared_ptr<Module> Compiler::compile_module(const std::string& src_path) {
-  auto source = std::filesystem::path(src_path).lexically_normal();
-  if (source.is_relative()) {
-    source = base_path_ / source;
+  auto resolved = resolve_import(src_path);
+  if (!resolved.has_value()) {
+    throw FileNotFoundError(std::make_shared<std::filesystem::path>(src_path));
   }
-  if (auto it = modules_.find(source); it != modules_.end()) {
+  auto& [source, file_id] = resolved.value();
+  if (auto it = modules_.find(file_id); it != modules_.end()) {
     return it->second;
   }
-  auto source_ptr = std::make_shared<std::filesystem::path>(source);
-  DEF_PHASE_WALK(source_ptr, this);
+  auto source_ptr =
+      std::make_shared<std::filesystem::path>(file_cache_.canonical(source));
+  DEF_PHASE_PARSE(source_ptr, this);
+  // Registered before the walk like the root, so that modules importing
+  // each other get the scopes being filled instead of recursing forever.
+  modules_.emplace(file_id, std::make_shared<Module>(
+                                def_phase_walker.type_scope(),
+                                def_phase_walker.option_scope(), source_ptr,
+                                std::vector<Error>{}));
   walker_.walk(&def_phase_walker, tree);
   auto module = std::make_shared<Module>(
       def_phase_walker.type_scope(), def_phase_walker.option_scope(),
       source_ptr, def_phase_walker.get_errors());
-  modules_.emplace(source, module);
+  modules_[file_id] = module;
   return module;
 }
 
@@ -41,7 +68,18 @@ CompileResult Compiler::compile(const std::string& src_path) {
   auto source_ptr = std::make_shared<std::filesystem::path>(
       std::filesystem::absolute(src_path).lexically_normal());
   base_path_ = source_ptr->parent_path();
-  DEF_PHASE_WALK(source_ptr, this);
+  DEF_PHASE_PARSE(source_ptr, this);
+  // Registered before the walk, so a module that imports the root through
+  // a symlink or a `..` path gets the root's scopes instead of parsing and
+  // walking it a second time.
+  if (auto file_id = file_cache_.stat(*source_ptr); file_id.has_value()) {
+    modules_.emplace(
+        file_id.value(),
+        std::make_shared<Module>(def_phase_walker.type_scope(),
+                                 def_phase_walker.option_scope(), source_ptr,
+                                 std::vector<Error>{}));
+  }
+  walker_.walk(&def_phase_walker, tree);
 
   auto ref_phase_walker =
       RefPhaseWalker(def_phase_walker.type_scope(),
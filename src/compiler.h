@@ -9,6 +9,7 @@
 #include <fstream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -17,6 +18,7 @@
 #include "ToolmanLexer.h"
 #include "ToolmanParser.h"
 #include "src/error.h"
+#include "src/file_cache.h"
 #include "src/walker.h"
 
 namespace toolman {
@@ -66,10 +68,26 @@ class Compiler {
 
   CompileResult compile(const std::string& src_path);
 
+  // Adds a directory that relative imports are resolved against when they
+  // are not found next to the root file. Directories are tried in the
+  // order they were added.
+  void add_import_path(std::filesystem::path import_path) {
+    import_paths_.push_back(std::move(import_path));
+  }
+
  private:
+  // Returns the first existing candidate for `src_path` together with its
+  // identity, or std::nullopt if no search directory contains it.
+  std::optional<std::pair<std::filesystem::path, FileId>> resolve_import(
+      const std::filesystem::path& src_path);
+
   antlr4::tree::ParseTreeWalker walker_;
-  std::map<std::filesystem::path, std::shared_ptr<Module>> modules_;
+  // Modules are keyed by file identity, so a file reached through a symlink
+  // or a different relative spelling is compiled only once.
+  std::map<FileId, std::shared_ptr<Module>> modules_;
   std::filesystem::path base_path_;
+  std::vector<std::filesystem::path> import_paths_;
+  FileCache file_cache_;
 };
 }  // namespace toolman
 
@@ -0,0 +1,493 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_CPP_GENERATOR_H_
+#define TOOLMAN_CPP_GENERATOR_H_
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "src/cpp_runtime.h"
+#include "src/field.h"
+#include "src/generator.h"
+#include "src/list_type.h"
+#include "src/map_type.h"
+#include "src/primitive_type.h"
+#include "src/scope.h"
+
+namespace toolman::generator {
+// Generates a C++17 header: a struct per struct type, with std::optional
+// for optional fields and a std::variant of one struct per alternative for
+// oneofs, and an enum class per enum type. Every type also specializes
+// toolman::Descriptor, whose constexpr tables let generic code reach the
+// fields through member pointers without any lookup at run time.
+class CppGenerator : public Generator {
+ protected:
+  void before_generate_document(std::ostream& ostream,
+                                const Document* document) override {
+    namespace_ = cpp_namespace(document->get_source()->stem());
+    for (const auto& opt : document->get_options()) {
+      if (opt->get_name() == buildin::option_cpp_namespace.get_name()) {
+        namespace_ = std::dynamic_pointer_cast<decltype(
+                         buildin::option_cpp_namespace)>(opt)
+                         ->get_value();
+      } else if (opt->get_name() == buildin::option_cpp_arena.get_name()) {
+        arena_ =
+            std::dynamic_pointer_cast<decltype(buildin::option_cpp_arena)>(opt)
+                ->get_value();
+      }
+    }
+    guard_ = "TOOLMAN_GENERATED_";
+    for (char c : namespace_ + "_" + document->get_source()->stem().string()) {
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        guard_.push_back(static_cast<char>(std::toupper(c)));
+      } else if (guard_.back() != '_') {
+        // Identifiers containing `__` are reserved.
+        guard_.push_back('_');
+      }
+    }
+    guard_ += "_H_";
+
+    ostream << "#ifndef " << guard_ << NL << "#define " << guard_ << NL2
+            << cpp_runtime::kIncludes << cpp_runtime::kDescriptors;
+    if (arena_) {
+      ostream << cpp_runtime::kArena;
+    }
+    ostream << NL << "namespace " << namespace_ << " {" << NL2;
+    // Enums have a fixed underlying type, so they can be used before they
+    // are defined.
+    for (const auto& enum_type : document->get_enum_types()) {
+      ostream << "enum class " << enum_type->get_name() << " : std::int32_t;"
+              << NL;
+    }
+    for (const auto& struct_type : document->get_struct_types()) {
+      ostream << "struct " << struct_type->get_name() << ";" << NL;
+    }
+    ostream << NL;
+  }
+
+  void after_generate_document(std::ostream& ostream,
+                               const Document* document) override {
+    ostream << "}  // namespace " << namespace_ << NL2 << "namespace toolman {"
+            << NL2;
+    for (const auto* struct_type : ordered_structs_) {
+      generate_struct_descriptor(ostream, struct_type);
+    }
+    for (const auto& enum_type : document->get_enum_types()) {
+      generate_enum_descriptor(ostream, enum_type.get());
+    }
+    ostream << "}  // namespace toolman" << NL2;
+    // The special members of arena messages walk the descriptors, so they
+    // are defined once those are.
+    if (arena_) {
+      ostream << "namespace " << namespace_ << " {" << NL2;
+      for (const auto& name : messages_) {
+        generate_arena_members(ostream, name);
+      }
+      ostream << "}  // namespace " << namespace_ << NL2;
+    }
+    ostream << "#endif  // " << guard_ << NL;
+  }
+
+  // Structs are written once all are known, each after the structs that it
+  // holds, which must be complete types where it is defined.
+  void after_generate_struct(std::ostream& ostream,
+                             const Document* document) override {
+    std::set<const StructType*> visited;
+    for (const auto& struct_type : document->get_struct_types()) {
+      order_structs(struct_type.get(), &visited);
+    }
+    for (const auto* struct_type : ordered_structs_) {
+      generate_struct_definition(ostream, struct_type);
+    }
+  }
+
+  [[nodiscard]] std::string single_line_comment(
+      std::string code) const override {
+    return "// " + code;
+  }
+
+  // Structs are defined in dependency order by generate_struct_definition.
+  void generate_struct(
+      std::ostream& /*ostream*/,
+      const std::shared_ptr<StructType>& /*struct_type*/) override {}
+
+  void generate_enum(std::ostream& ostream,
+                     const std::shared_ptr<EnumType>& enum_type) override {
+    ostream << "enum class " << enum_type->get_name() << " : std::int32_t {"
+            << NL;
+    for (const auto& field : enum_type->get_fields()) {
+      generate_comments(ostream, field.get_comments(), INDENT_1);
+      ostream << INDENT_1 << identifier(field.get_name()) << " = "
+              << field.get_value() << "," << NL;
+    }
+    ostream << "};" << NL2;
+  }
+
+ private:
+  void order_structs(const StructType* struct_type,
+                     std::set<const StructType*>* visited) {
+    if (!visited->insert(struct_type).second) {
+      return;
+    }
+    for (const auto& field : struct_type->get_fields()) {
+      std::vector<const StructType*> held;
+      collect_structs(field.get_type().get(), &held);
+      for (const auto* held_type : held) {
+        order_structs(held_type, visited);
+      }
+    }
+    ordered_structs_.push_back(struct_type);
+  }
+
+  static void collect_structs(const Type* type,
+                              std::vector<const StructType*>* held) {
+    if (type->is_struct()) {
+      held->push_back(dynamic_cast<const StructType*>(type));
+    } else if (type->is_list()) {
+      collect_structs(
+          dynamic_cast<const ListType*>(type)->get_elem_type().get(), held);
+    } else if (type->is_map()) {
+      collect_structs(
+          dynamic_cast<const MapType*>(type)->get_value_type().get(), held);
+    } else if (type->is_oneof()) {
+      for (const auto& oneof_field :
+           dynamic_cast<const OneofType*>(type)->get_fields()) {
+        collect_structs(oneof_field.get_type().get(), held);
+      }
+    }
+  }
+
+  void generate_struct_definition(std::ostream& ostream,
+                                  const StructType* struct_type) {
+    for (const auto& field : struct_type->get_fields()) {
+      if (!field.get_type()->is_oneof()) {
+        continue;
+      }
+      // One struct per alternative tells them apart in the variant even
+      // when they hold the same type; std::monostate is none set.
+      auto oneof = dynamic_cast<const OneofType*>(field.get_type().get());
+      std::string alternatives = "std::monostate";
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_name = alternative_name(struct_type, oneof_field);
+        generate_message(ostream, struct_type, alt_name, {oneof_field});
+        alternatives += ", " + alt_name;
+      }
+      ostream << "using " << oneof_name(struct_type, field)
+              << " = std::variant<" << alternatives << ">;" << NL2;
+    }
+    generate_message(ostream, struct_type, struct_type->get_name(),
+                     struct_type->get_fields());
+  }
+
+  void generate_message(std::ostream& ostream, const StructType* struct_type,
+                        const std::string& name,
+                        const std::vector<Field>& fields) {
+    if (arena_ && std::any_of(fields.begin(), fields.end(),
+                              [](const Field& field) {
+                                return field.get_type()->is_oneof() ||
+                                       (field.is_optional() &&
+                                        allocates(field.get_type().get()));
+                              })) {
+      ostream << "// Optional and oneof fields do not pass get_allocator() on: "
+                 "values put"
+              << NL
+              << "// into them with std::optional::emplace or a variant "
+                 "assignment use the"
+              << NL
+              << "// default resource. toolman::emplace and toolman::assign "
+                 "allocate from"
+              << NL << "// the allocator they are given." << NL;
+    }
+    ostream << "struct " << name << " {" << NL;
+    if (arena_) {
+      messages_.push_back(name);
+      // Allocator-aware in the way of the std::pmr containers, so lists and
+      // maps of messages pass their allocator on to their elements.
+      ostream << INDENT_1 << "using allocator_type = toolman::Allocator;" << NL2
+              << INDENT_1 << name << "() : " << name << "(allocator_type()) {}"
+              << NL << INDENT_1 << "explicit " << name
+              << "(const allocator_type& alloc)" << NL << INDENT_2 << ": ";
+      for (const auto& field : fields) {
+        if (!field.is_optional() && allocates(field.get_type().get())) {
+          ostream << identifier(field.get_name()) << "(alloc)," << NL
+                  << INDENT_2 << "  ";
+        }
+      }
+      ostream << "allocator_(alloc) {}" << NL << INDENT_1 << name << "(const "
+              << name << "& other) : " << name
+              << "(other, allocator_type()) {}" << NL << INDENT_1 << name
+              << "(const " << name << "& other, const allocator_type& alloc);"
+              << NL << INDENT_1 << name << "(" << name
+              << "&& other) = default;" << NL << INDENT_1 << name << "("
+              << name << "&& other, const allocator_type& alloc);" << NL
+              << INDENT_1 << "~" << name << "() = default;" << NL << INDENT_1
+              << name << "& operator=(const " << name << "& other);" << NL
+              << INDENT_1 << name << "& operator=(" << name << "&& other);"
+              << NL2 << INDENT_1
+              << "allocator_type get_allocator() const { return allocator_; }"
+              << NL2;
+    }
+    for (const auto& field : fields) {
+      generate_member(ostream, struct_type, field);
+    }
+    if (arena_) {
+      ostream << NL << "private:" << NL << INDENT_1
+              << "allocator_type allocator_;" << NL;
+    }
+    ostream << "};" << NL2;
+  }
+
+  // Copies and moves keep the allocator of the message assigned to, like
+  // the std::pmr containers.
+  static void generate_arena_members(std::ostream& ostream,
+                                     const std::string& name) {
+    ostream << "inline " << name << "::" << name << "(const " << name
+            << "& other, const allocator_type& alloc)" << NL << INDENT_1
+            << ": " << name << "(alloc) {" << NL << INDENT_1
+            << "toolman::assign_fields(*this, other);" << NL << "}" << NL2
+            << "inline " << name << "::" << name << "(" << name
+            << "&& other, const allocator_type& alloc)" << NL << INDENT_1
+            << ": " << name << "(alloc) {" << NL << INDENT_1
+            << "toolman::assign_fields(*this, std::move(other));" << NL << "}"
+            << NL2 << "inline " << name << "& " << name << "::operator=(const "
+            << name << "& other) {" << NL << INDENT_1
+            << "if (this != &other) {" << NL << INDENT_2
+            << "toolman::assign_fields(*this, other);" << NL << INDENT_1 << "}"
+            << NL << INDENT_1 << "return *this;" << NL << "}" << NL2
+            << "inline " << name << "& " << name << "::operator=(" << name
+            << "&& other) {" << NL << INDENT_1 << "if (this != &other) {" << NL
+            << INDENT_2 << "toolman::assign_fields(*this, std::move(other));"
+            << NL << INDENT_1 << "}" << NL << INDENT_1 << "return *this;" << NL
+            << "}" << NL2;
+  }
+
+  // Whether a value of type holds memory of its own.
+  static bool allocates(const Type* type) {
+    return type->is_struct() || type->is_list() || type->is_map() ||
+           (type->is_primitive() &&
+            (dynamic_cast<const PrimitiveType*>(type)->is_string() ||
+             dynamic_cast<const PrimitiveType*>(type)->is_any()));
+  }
+
+  void generate_member(std::ostream& ostream, const StructType* struct_type,
+                       const Field& field) {
+    generate_comments(ostream, field.get_comments(), INDENT_1);
+    auto type = field.get_type().get();
+    ostream << INDENT_1 << member_type(struct_type, field) << " "
+            << identifier(field.get_name());
+    // Scalars and enums start out as zero, like in the other targets.
+    if (!field.is_optional() &&
+        (type->is_enum() ||
+         (type->is_primitive() &&
+          (dynamic_cast<const PrimitiveType*>(type)->is_numeric() ||
+           dynamic_cast<const PrimitiveType*>(type)->is_bool())))) {
+      ostream << "{}";
+    }
+    ostream << ";" << NL;
+  }
+
+  void generate_struct_descriptor(std::ostream& ostream,
+                                  const StructType* struct_type) {
+    for (const auto& field : struct_type->get_fields()) {
+      if (field.get_type()->is_oneof()) {
+        for (const auto& oneof_field :
+             dynamic_cast<const OneofType*>(field.get_type().get())
+                 ->get_fields()) {
+          generate_descriptor(ostream,
+                              alternative_name(struct_type, oneof_field),
+                              {oneof_field});
+        }
+      }
+    }
+    generate_descriptor(ostream, struct_type->get_name(),
+                        struct_type->get_fields());
+  }
+
+  void generate_descriptor(std::ostream& ostream, const std::string& name,
+                           const std::vector<Field>& fields) {
+    auto qualified = "::" + namespace_ + "::" + name;
+    ostream << "template <>" << NL << "struct Descriptor<" << qualified
+            << "> {" << NL << INDENT_1
+            << "static constexpr std::string_view name = \"" << name << "\";"
+            << NL << INDENT_1
+            << "static constexpr auto fields = std::make_tuple(";
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto& field = fields[i];
+      ostream << (i == 0 ? "" : ",") << NL << INDENT_2 << "field(\""
+              << field.get_name() << "\", " << field.get_number() << ", "
+              << "FieldKind::" << field_kind(field.get_type().get()) << ", "
+              << (field.is_optional() ? "true" : "false") << ", &"
+              << qualified << "::" << identifier(field.get_name()) << ")";
+    }
+    ostream << ");" << NL << "};" << NL2;
+  }
+
+  void generate_enum_descriptor(std::ostream& ostream,
+                                const EnumType* enum_type) {
+    auto qualified = "::" + namespace_ + "::" + enum_type->get_name();
+    auto fields = enum_type->get_fields();
+    ostream << "template <>" << NL << "struct Descriptor<" << qualified
+            << "> {" << NL << INDENT_1
+            << "static constexpr std::string_view name = \""
+            << enum_type->get_name() << "\";" << NL << INDENT_1
+            << "static constexpr std::array<EnumValue<" << qualified << ">, "
+            << fields.size() << "> values = {{";
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      ostream << (i == 0 ? "" : ",") << NL << INDENT_2 << "{\""
+              << fields[i].get_name() << "\", " << qualified
+              << "::" << identifier(fields[i].get_name()) << "}";
+    }
+    ostream << "}};" << NL << "};" << NL2;
+  }
+
+  std::string member_type(const StructType* struct_type,
+                          const Field& field) const {
+    auto type = field.get_type().get();
+    auto cpp = type->is_oneof() ? oneof_name(struct_type, field)
+                                : type_to_cpp_type(type);
+    return field.is_optional() && !type->is_oneof()
+               ? "std::optional<" + cpp + ">"
+               : cpp;
+  }
+
+  std::string type_to_cpp_type(const Type* type) const {
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      if (primitive->is_bool()) {
+        return "bool";
+      } else if (primitive->is_i32()) {
+        return "std::int32_t";
+      } else if (primitive->is_u32()) {
+        return "std::uint32_t";
+      } else if (primitive->is_i64()) {
+        return "std::int64_t";
+      } else if (primitive->is_u64()) {
+        return "std::uint64_t";
+      } else if (primitive->is_float()) {
+        return "double";
+      }
+      // `any` values are JSON text, as in the binary format.
+      return container("string");
+    } else if (type->is_struct() || type->is_enum()) {
+      return type->get_name();
+    } else if (type->is_list()) {
+      return container("vector") + "<" +
+             type_to_cpp_type(
+                 dynamic_cast<const ListType*>(type)->get_elem_type().get()) +
+             ">";
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      return container("map") + "<" +
+             type_to_cpp_type(map->get_key_type().get()) + ", " +
+             type_to_cpp_type(map->get_value_type().get()) + ">";
+    }
+    return "";
+  }
+
+  // The standard library type name, from std::pmr for arena messages.
+  std::string container(const std::string& name) const {
+    return (arena_ ? "std::pmr::" : "std::") + name;
+  }
+
+  static std::string field_kind(const Type* type) {
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      if (primitive->is_bool()) {
+        return "kBool";
+      } else if (primitive->is_i32()) {
+        return "kI32";
+      } else if (primitive->is_u32()) {
+        return "kU32";
+      } else if (primitive->is_i64()) {
+        return "kI64";
+      } else if (primitive->is_u64()) {
+        return "kU64";
+      } else if (primitive->is_float()) {
+        return "kFloat";
+      } else if (primitive->is_any()) {
+        return "kAny";
+      }
+      return "kString";
+    } else if (type->is_enum()) {
+      return "kEnum";
+    } else if (type->is_struct()) {
+      return "kStruct";
+    } else if (type->is_list()) {
+      return "kList";
+    } else if (type->is_map()) {
+      return "kMap";
+    }
+    return "kOneof";
+  }
+
+  static std::string alternative_name(const StructType* struct_type,
+                                      const Field& oneof_field) {
+    return capitalize(camelcase(struct_type->get_name())) +
+           capitalize(camelcase(oneof_field.get_name()));
+  }
+
+  static std::string oneof_name(const StructType* struct_type,
+                                const Field& field) {
+    return capitalize(camelcase(struct_type->get_name())) +
+           capitalize(camelcase(field.get_name()));
+  }
+
+  // Names that are C++ keywords get an underscore appended.
+  static std::string identifier(const std::string& name) {
+    static const std::set<std::string> kKeywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor",
+        "bool", "break", "case", "catch", "char", "class", "compl", "const",
+        "constexpr", "const_cast", "continue", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export",
+        "extern", "false", "float", "for", "friend", "goto", "if", "inline",
+        "int", "long", "mutable", "namespace", "new", "noexcept", "not",
+        "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected",
+        "public", "register", "reinterpret_cast", "return", "short", "signed",
+        "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+        "template", "this", "thread_local", "throw", "true", "try", "typedef",
+        "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+        "volatile", "wchar_t", "while", "xor", "xor_eq"};
+    return kKeywords.count(name) ? name + "_" : name;
+  }
+
+  static void generate_comments(std::ostream& ostream,
+                                const std::vector<std::string>& comments,
+                                const std::string& indent) {
+    for (const auto& comment : comments) {
+      ostream << indent << "// " << comment << NL;
+    }
+  }
+
+  // The namespace of the generated code when the `cpp_namespace` option is
+  // not given, an identifier derived from the source file name.
+  static std::string cpp_namespace(const std::filesystem::path& stem) {
+    std::string name;
+    for (char c : stem.string()) {
+      name.push_back(std::isalnum(static_cast<unsigned char>(c))
+                         ? static_cast<char>(std::tolower(c))
+                         : '_');
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+      name.insert(0, "_");
+    }
+    return identifier(name);
+  }
+
+  std::string namespace_;
+  std::string guard_;
+  bool arena_ = false;
+  // The arena messages, structs and oneof alternatives, in definition order.
+  std::vector<std::string> messages_;
+  // The structs in the order they are defined in.
+  std::vector<const StructType*> ordered_structs_;
+};
+}  // namespace toolman::generator
+
+#endif  // TOOLMAN_CPP_GENERATOR_H_
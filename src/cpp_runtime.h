@@ -0,0 +1,214 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_CPP_RUNTIME_H_
+#define TOOLMAN_CPP_RUNTIME_H_
+
+namespace toolman::generator::cpp_runtime {
+
+// The standard headers every generated C++ header includes.
+constexpr char kIncludes[] = R"(#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+)";
+
+// Support code emitted into every generated C++ header, guarded so that
+// headers generated from several files can be included together. The
+// generated types specialize toolman::Descriptor; generic code walks the
+// fields of a struct with toolman::for_each_field, which expands to one
+// call per field at compile time.
+constexpr char kDescriptors[] = R"(
+#ifndef TOOLMAN_CPP_DESCRIPTORS_
+#define TOOLMAN_CPP_DESCRIPTORS_
+namespace toolman {
+
+// What a field holds. kAny fields hold JSON text in a std::string.
+enum class FieldKind : std::uint8_t {
+    kBool,
+    kI32,
+    kU32,
+    kI64,
+    kU64,
+    kFloat,
+    kString,
+    kAny,
+    kEnum,
+    kStruct,
+    kList,
+    kMap,
+    kOneof,
+};
+
+// Describes the field `member` of T, of type M. Optional fields are held
+// in a std::optional<V>, kind describes V.
+template <typename T, typename M>
+struct FieldDescriptor {
+    using Struct = T;
+    using Member = M;
+
+    std::string_view name;
+    std::uint32_t number;
+    FieldKind kind;
+    bool optional;
+    M T::*member;
+};
+
+template <typename T, typename M>
+constexpr FieldDescriptor<T, M> field(std::string_view name, std::uint32_t number, FieldKind kind, bool optional, M T::*member) {
+    return {name, number, kind, optional, member};
+}
+
+template <typename E>
+struct EnumValue {
+    std::string_view name;
+    E value;
+};
+
+// Specialized for every generated struct, with its `name` and a tuple of
+// FieldDescriptors in declaration order as `fields`, and for every
+// generated enum, with its `name` and an array of EnumValues as `values`.
+template <typename T>
+struct Descriptor;
+
+// Calls f with the descriptor of every field of T, in declaration order.
+template <typename T, typename F>
+constexpr void for_each_field(F&& f) {
+    std::apply([&f](const auto&... fields) { (f(fields), ...); }, Descriptor<T>::fields);
+}
+
+// The declared name of value, empty if it has none.
+template <typename E>
+constexpr std::string_view enum_name(E value) {
+    for (const auto& v : Descriptor<E>::values) {
+        if (v.value == value) {
+            return v.name;
+        }
+    }
+    return {};
+}
+
+// The value declared as name.
+template <typename E>
+constexpr std::optional<E> parse_enum(std::string_view name) {
+    for (const auto& v : Descriptor<E>::values) {
+        if (v.name == name) {
+            return v.value;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace toolman
+#endif  // TOOLMAN_CPP_DESCRIPTORS_
+)";
+
+// Support code for messages generated with the cpp_arena option.
+constexpr char kArena[] = R"(
+#ifndef TOOLMAN_CPP_ARENA_
+#define TOOLMAN_CPP_ARENA_
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+namespace toolman {
+
+// The allocator of arena messages. A message allocates its strings, lists,
+// maps and nested messages from the memory resource it was created with,
+// and keeps that resource when assigned to, so a tree built on a
+// std::pmr::monotonic_buffer_resource lives entirely in it.
+using Allocator = std::pmr::polymorphic_allocator<std::byte>;
+
+// Creates a T in arena that is never destroyed: arena.release() frees it
+// and everything it holds at once, without walking the tree.
+template <typename T, typename... Args>
+T* arena_new(std::pmr::monotonic_buffer_resource& arena, Args&&... args) {
+    void* storage = arena.allocate(sizeof(T), alignof(T));
+    return ::new (storage) T(std::forward<Args>(args)..., Allocator(&arena));
+}
+
+// Sets the optional field target to a value made from args, allocating
+// from alloc.
+template <typename T, typename... Args>
+T& emplace(std::optional<T>& target, const Allocator& alloc, Args&&... args) {
+    if constexpr (std::uses_allocator_v<T, Allocator>) {
+        return target.emplace(std::forward<Args>(args)..., alloc);
+    } else {
+        return target.emplace(std::forward<Args>(args)...);
+    }
+}
+
+// Sets the oneof target to the alternative A made from args, allocating
+// from alloc.
+template <typename A, typename... V, typename... Args>
+A& emplace(std::variant<V...>& target, const Allocator& alloc, Args&&... args) {
+    return target.template emplace<A>(std::forward<Args>(args)..., alloc);
+}
+
+namespace internal {
+
+template <typename T>
+struct IsOptional : std::false_type {};
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+template <typename T>
+struct IsVariant : std::false_type {};
+template <typename... V>
+struct IsVariant<std::variant<V...>> : std::true_type {};
+
+}  // namespace internal
+
+// Assigns source to the field target, allocating whatever target did not
+// hold yet from alloc. std::optional and std::variant do not pass their
+// allocator on by themselves.
+template <typename T, typename S>
+void assign(T& target, S&& source, const Allocator& alloc) {
+    if constexpr (internal::IsOptional<T>::value) {
+        if (!source) {
+            target.reset();
+        } else if (target) {
+            assign(*target, *std::forward<S>(source), alloc);
+        } else {
+            emplace(target, alloc, *std::forward<S>(source));
+        }
+    } else if constexpr (internal::IsVariant<T>::value) {
+        std::visit(
+            [&target, &alloc](auto&& alternative) {
+                using A = std::decay_t<decltype(alternative)>;
+                if constexpr (std::is_same_v<A, std::monostate>) {
+                    target = std::monostate{};
+                } else if (auto* held = std::get_if<A>(&target)) {
+                    *held = std::forward<decltype(alternative)>(alternative);
+                } else {
+                    target.template emplace<A>(std::forward<decltype(alternative)>(alternative), alloc);
+                }
+            },
+            std::forward<S>(source));
+    } else {
+        target = std::forward<S>(source);
+    }
+}
+
+// Assigns every field of source to the message target, which keeps its
+// allocator.
+template <typename T, typename S>
+void assign_fields(T& target, S&& source) {
+    for_each_field<T>([&target, &source](const auto& field) {
+        assign(target.*(field.member), std::forward<S>(source).*(field.member), target.get_allocator());
+    });
+}
+
+}  // namespace toolman
+#endif  // TOOLMAN_CPP_ARENA_
+)";
+
+}  // namespace toolman::generator::cpp_runtime
+
+#endif  // TOOLMAN_CPP_RUNTIME_H_
@@ -5,6 +5,9 @@
 #ifndef TOOLMAN_CUSTOM_TYPE_H_
 #define TOOLMAN_CUSTOM_TYPE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
 #include <utility>
@@ -23,7 +26,7 @@ class CustomType : public Type {
   CustomType(S&& name, SI&& stmt_info)
       : Type(std::forward<S>(name), std::forward<SI>(stmt_info)) {}
 
-  void append_field(F f) { fields_.push_back(std::move(f)); }
+  virtual void append_field(F f) { fields_.push_back(std::move(f)); }
 
   [[nodiscard]] std::vector<F> get_fields() const { return fields_; }
 
@@ -66,6 +69,47 @@ class EnumType final : public CustomType<EnumField> {
  public:
   using CustomType::CustomType;
   [[nodiscard]] bool is_enum() const override { return true; }
+
+  void append_field(EnumField f) override {
+    value_index_.emplace(f.get_value(), f);
+    CustomType::append_field(std::move(f));
+  }
+
+  // Returns the first field declared with `value`.
+  [[nodiscard]] std::optional<EnumField> get_field_by_value(int value) const {
+    if (auto got = value_index_.find(value); got != value_index_.end()) {
+      return std::make_optional(got->second);
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] int get_min_value() const {
+    return value_index_.empty() ? 0 : value_index_.begin()->first;
+  }
+
+  [[nodiscard]] int get_max_value() const {
+    return value_index_.empty() ? 0 : value_index_.rbegin()->first;
+  }
+
+  // The number of slots in an array indexed by value - get_min_value().
+  [[nodiscard]] std::int64_t get_value_span() const {
+    return value_index_.empty() ? 0
+                                : static_cast<std::int64_t>(get_max_value()) -
+                                      get_min_value() + 1;
+  }
+
+  // Whether every value between the smallest and the largest is declared,
+  // so that a range check alone tells the valid values.
+  [[nodiscard]] bool is_contiguous() const {
+    return get_value_span() == static_cast<std::int64_t>(value_index_.size());
+  }
+
+  // Whether an array indexed by value - get_min_value() would be at least
+  // half full, which makes it the cheapest lookup by value.
+  [[nodiscard]] bool is_dense() const {
+    auto count = static_cast<std::int64_t>(value_index_.size());
+    return count > 0 && get_value_span() <= 2 * count;
+  }
   [[nodiscard]] std::string to_string() const override {
     return "enum " + name_ + " {...}";
   }
@@ -75,6 +119,9 @@ class EnumType final : public CustomType<EnumField> {
     }
     return CustomType::operator==(rhs);
   }
+
+ private:
+  std::map<int, EnumField> value_index_;
 };
 
 class OneofType final : public CustomType<Field> {
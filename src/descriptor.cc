@@ -0,0 +1,363 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "src/descriptor.h"
+
+#include <cstring>
+#include <set>
+
+#include "src/list_type.h"
+#include "src/map_type.h"
+#include "src/primitive_type.h"
+
+namespace toolman::descriptor {
+
+namespace {
+
+class Writer {
+ public:
+  void write_byte(std::uint8_t byte) {
+    out_.push_back(static_cast<char>(byte));
+  }
+
+  void write_varint(std::uint64_t value) {
+    while (value >= 0x80) {
+      write_byte(static_cast<std::uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    write_byte(static_cast<std::uint8_t>(value));
+  }
+
+  void write_zigzag(std::int64_t value) {
+    write_varint((static_cast<std::uint64_t>(value) << 1) ^
+                 static_cast<std::uint64_t>(value >> 63));
+  }
+
+  void write_double(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+      write_byte(static_cast<std::uint8_t>(bits >> (8 * i)));
+    }
+  }
+
+  void write_string(const std::string& str) {
+    write_varint(str.size());
+    out_.append(str);
+  }
+
+  void write_strings(const std::vector<std::string>& strs) {
+    write_varint(strs.size());
+    for (const auto& str : strs) {
+      write_string(str);
+    }
+  }
+
+  void write_raw(const char* data, std::size_t size) {
+    out_.append(data, size);
+  }
+
+  std::string take() { return std::move(out_); }
+
+ private:
+  std::string out_;
+};
+
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : data_(data) {}
+
+  [[nodiscard]] bool eof() const { return pos_ == data_.size(); }
+
+  std::uint8_t read_byte() {
+    if (eof()) {
+      throw DecodeError("unexpected end of plugin response");
+    }
+    return static_cast<std::uint8_t>(data_[pos_++]);
+  }
+
+  std::uint64_t read_varint() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto byte = read_byte();
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw DecodeError("malformed varint in plugin response");
+  }
+
+  std::string read_string() {
+    auto size = read_varint();
+    if (size > data_.size() - pos_) {
+      throw DecodeError("string length exceeds plugin response size");
+    }
+    auto str = data_.substr(pos_, size);
+    pos_ += size;
+    return str;
+  }
+
+ private:
+  const std::string& data_;
+  std::string::size_type pos_ = 0;
+};
+
+void write_field(Writer* writer, const Field& field);
+
+void write_type(Writer* writer, const Type* type) {
+  if (type == nullptr) {
+    writer->write_byte(static_cast<std::uint8_t>(TypeKind::Unresolved));
+  } else if (type->is_primitive()) {
+    auto primitive = dynamic_cast<const PrimitiveType*>(type);
+    TypeKind kind = TypeKind::Any;
+    if (primitive->is_bool()) {
+      kind = TypeKind::Bool;
+    } else if (primitive->is_i32()) {
+      kind = TypeKind::I32;
+    } else if (primitive->is_u32()) {
+      kind = TypeKind::U32;
+    } else if (primitive->is_i64()) {
+      kind = TypeKind::I64;
+    } else if (primitive->is_u64()) {
+      kind = TypeKind::U64;
+    } else if (primitive->is_float()) {
+      kind = TypeKind::Float;
+    } else if (primitive->is_string()) {
+      kind = TypeKind::String;
+    }
+    writer->write_byte(static_cast<std::uint8_t>(kind));
+  } else if (type->is_struct() || type->is_enum()) {
+    writer->write_byte(static_cast<std::uint8_t>(
+        type->is_struct() ? TypeKind::Struct : TypeKind::Enum));
+    writer->write_string(type->get_name());
+  } else if (type->is_list()) {
+    writer->write_byte(static_cast<std::uint8_t>(TypeKind::List));
+    write_type(writer,
+               dynamic_cast<const ListType*>(type)->get_elem_type().get());
+  } else if (type->is_map()) {
+    auto map = dynamic_cast<const MapType*>(type);
+    writer->write_byte(static_cast<std::uint8_t>(TypeKind::Map));
+    write_type(writer, map->get_key_type().get());
+    write_type(writer, map->get_value_type().get());
+  } else if (type->is_oneof()) {
+    auto oneof = dynamic_cast<const OneofType*>(type);
+    writer->write_byte(static_cast<std::uint8_t>(TypeKind::Oneof));
+    auto fields = oneof->get_fields();
+    writer->write_varint(fields.size());
+    for (const auto& field : fields) {
+      write_field(writer, field);
+    }
+  } else {
+    writer->write_byte(static_cast<std::uint8_t>(TypeKind::Unresolved));
+  }
+}
+
+void write_field(Writer* writer, const Field& field) {
+  writer->write_string(field.get_name());
+  writer->write_byte(field.is_optional() ? 1 : 0);
+  writer->write_strings(field.get_comments());
+  write_type(writer, field.get_type().get());
+  writer->write_varint(field.get_number());
+}
+
+void write_enum(Writer* writer, const EnumType& enum_type) {
+  writer->write_string(enum_type.get_name());
+  auto fields = enum_type.get_fields();
+  writer->write_varint(fields.size());
+  for (const auto& field : fields) {
+    writer->write_string(field.get_name());
+    writer->write_zigzag(field.get_value());
+    writer->write_strings(field.get_comments());
+  }
+}
+
+void write_struct(Writer* writer, const StructType& struct_type) {
+  writer->write_string(struct_type.get_name());
+  auto fields = struct_type.get_fields();
+  writer->write_varint(fields.size());
+  for (const auto& field : fields) {
+    write_field(writer, field);
+  }
+}
+
+// The struct and enum types declared in other files that a document refers
+// to, directly or through one another, in the order they are first reached.
+class ImportedTypes {
+ public:
+  explicit ImportedTypes(const Document& document) {
+    for (const auto& struct_type : document.get_struct_types()) {
+      seen_.insert(struct_type.get());
+    }
+    for (const auto& enum_type : document.get_enum_types()) {
+      seen_.insert(enum_type.get());
+    }
+    for (const auto& struct_type : document.get_struct_types()) {
+      visit_fields(struct_type->get_fields());
+    }
+    for (const auto& api_group : document.get_api_groups()) {
+      for (const auto& api : api_group.get_apis()) {
+        visit(api.get_body_param().get());
+        for (const auto& path_param : api.get_path_params()) {
+          visit(path_param.field.get_type().get());
+        }
+        for (const auto& api_return : api.get_returns()) {
+          visit(api_return.resp_.get());
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] const std::vector<const EnumType*>& enums() const {
+    return enums_;
+  }
+  [[nodiscard]] const std::vector<const StructType*>& structs() const {
+    return structs_;
+  }
+
+ private:
+  void visit(const Type* type) {
+    if (type == nullptr) {
+      return;
+    }
+    if (type->is_struct() || type->is_enum()) {
+      if (!seen_.insert(type).second) {
+        return;
+      }
+      if (type->is_enum()) {
+        enums_.push_back(dynamic_cast<const EnumType*>(type));
+      } else {
+        auto struct_type = dynamic_cast<const StructType*>(type);
+        structs_.push_back(struct_type);
+        visit_fields(struct_type->get_fields());
+      }
+    } else if (type->is_list()) {
+      visit(dynamic_cast<const ListType*>(type)->get_elem_type().get());
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      visit(map->get_key_type().get());
+      visit(map->get_value_type().get());
+    } else if (type->is_oneof()) {
+      visit_fields(dynamic_cast<const OneofType*>(type)->get_fields());
+    }
+  }
+
+  void visit_fields(const std::vector<Field>& fields) {
+    for (const auto& field : fields) {
+      visit(field.get_type().get());
+    }
+  }
+
+  std::set<const Type*> seen_;
+  std::vector<const EnumType*> enums_;
+  std::vector<const StructType*> structs_;
+};
+
+void write_option(Writer* writer, const Option& option) {
+  writer->write_string(option.get_name());
+  if (option.is_bool()) {
+    writer->write_byte(0);
+    writer->write_varint(
+        dynamic_cast<const BoolOption&>(option).get_value() ? 1 : 0);
+  } else if (option.is_numeric()) {
+    writer->write_byte(1);
+    writer->write_double(
+        dynamic_cast<const NumericOption&>(option).get_value());
+  } else {
+    writer->write_byte(2);
+    writer->write_string(
+        dynamic_cast<const StringOption&>(option).get_value());
+  }
+}
+
+void write_api(Writer* writer, const Api& api) {
+  writer->write_byte(static_cast<std::uint8_t>(api.get_http_method()));
+  writer->write_string(api.get_path());
+  write_type(writer, api.get_body_param().get());
+  writer->write_varint(api.get_path_params().size());
+  for (const auto& path_param : api.get_path_params()) {
+    write_field(writer, path_param.field);
+    writer->write_varint(path_param.pos_in_path);
+  }
+  writer->write_varint(api.get_returns().size());
+  for (const auto& api_return : api.get_returns()) {
+    writer->write_varint(api_return.http_status_code_);
+    write_type(writer, api_return.resp_.get());
+  }
+}
+
+}  // namespace
+
+std::string serialize(const Document& document) {
+  Writer writer;
+  writer.write_raw(kRequestMagic, sizeof(kRequestMagic));
+  writer.write_string(
+      document.get_source() ? document.get_source()->string() : "");
+
+  writer.write_varint(document.get_options().size());
+  for (const auto& option : document.get_options()) {
+    write_option(&writer, *option);
+  }
+
+  writer.write_varint(document.get_enum_types().size());
+  for (const auto& enum_type : document.get_enum_types()) {
+    write_enum(&writer, *enum_type);
+  }
+
+  writer.write_varint(document.get_struct_types().size());
+  for (const auto& struct_type : document.get_struct_types()) {
+    write_struct(&writer, *struct_type);
+  }
+
+  writer.write_varint(document.get_api_groups().size());
+  for (const auto& api_group : document.get_api_groups()) {
+    writer.write_string(api_group.get_group_name());
+    writer.write_varint(api_group.get_apis().size());
+    for (const auto& api : api_group.get_apis()) {
+      write_api(&writer, api);
+    }
+  }
+
+  ImportedTypes imported(document);
+  writer.write_varint(imported.enums().size());
+  for (const auto* enum_type : imported.enums()) {
+    write_enum(&writer, *enum_type);
+  }
+  writer.write_varint(imported.structs().size());
+  for (const auto* struct_type : imported.structs()) {
+    write_struct(&writer, *struct_type);
+  }
+  return writer.take();
+}
+
+Response parse_response(const std::string& data) {
+  if (data.compare(0, sizeof(kResponseMagic),
+                   std::string(kResponseMagic, sizeof(kResponseMagic))) != 0) {
+    throw DecodeError("plugin response does not start with the magic bytes");
+  }
+  Response response;
+  Reader reader(data);
+  for (std::size_t i = 0; i < sizeof(kResponseMagic); ++i) {
+    reader.read_byte();
+  }
+  while (!reader.eof()) {
+    switch (static_cast<RecordKind>(reader.read_byte())) {
+      case RecordKind::File: {
+        auto name = reader.read_string();
+        auto content = reader.read_string();
+        response.files.push_back(
+            GeneratedFile{std::move(name), std::move(content)});
+        break;
+      }
+      case RecordKind::Error:
+        response.errors.push_back(reader.read_string());
+        break;
+      default:
+        throw DecodeError("unknown record kind in plugin response");
+    }
+  }
+  return response;
+}
+
+}  // namespace toolman::descriptor
@@ -0,0 +1,111 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_DESCRIPTOR_H_
+#define TOOLMAN_DESCRIPTOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/document.h"
+
+namespace toolman::descriptor {
+
+// The descriptor is the compact binary form of a compiled `Document` that
+// toolman streams to generator plugins over stdin.
+//
+// Every integer is an unsigned LEB128 varint unless noted otherwise, signed
+// integers are zigzag encoded before being written as varints, a `string` is
+// a varint byte length followed by the raw bytes and a `list<T>` is a varint
+// element count followed by the elements.
+//
+//   Request   := "TMD" 0x03 Document
+//   Document  := source:string options:list<Option> enums:list<Enum>
+//                structs:list<Struct> api_groups:list<ApiGroup>
+//                imported_enums:list<Enum> imported_structs:list<Struct>
+//                (the types declared in imported files that the document
+//                 refers to, directly or through one another, so that every
+//                 struct and enum TypeRef resolves by name)
+//   Option    := name:string kind:u8 value
+//                (kind 0 bool: varint 0/1, kind 1 numeric: 8 byte little
+//                 endian IEEE 754 double, kind 2 string: string)
+//   Enum      := name:string fields:list<EnumField>
+//   EnumField := name:string value:zigzag comments:list<string>
+//   Struct    := name:string fields:list<Field>
+//   Field     := name:string optional:u8 comments:list<string> type:TypeRef
+//                number:varint
+//                (the wire format field number, see src/wire_format.h, 0
+//                 for path params)
+//   TypeRef   := kind:u8 payload
+//                (kinds 0-7 are the primitives bool, i32, u32, i64, u64,
+//                 float, string and any and carry no payload, 8 struct and
+//                 9 enum carry the type name as a string, 10 list carries the
+//                 element TypeRef, 11 map carries the key and value TypeRef,
+//                 12 oneof carries its alternatives as list<Field> and 255
+//                 marks an unresolved type)
+//   ApiGroup  := name:string apis:list<Api>
+//   Api       := method:u8 path:string body:TypeRef
+//                path_params:list<PathParam> returns:list<ApiReturn>
+//   PathParam := field:Field pos_in_path:varint
+//   ApiReturn := http_status_code:varint resp:TypeRef
+//
+// A plugin answers on stdout with a sequence of records, terminated by EOF:
+//
+//   Response  := "TMR" 0x01 Record*
+//   Record    := 0x01 name:string content:string   (a generated file)
+//              | 0x02 message:string               (a generation error)
+//
+// The encoding uses only length prefixed data, so a reader never needs to
+// look ahead and a writer never needs to seek.
+
+constexpr char kRequestMagic[] = {'T', 'M', 'D', 0x03};
+constexpr char kResponseMagic[] = {'T', 'M', 'R', 0x01};
+
+enum class TypeKind : std::uint8_t {
+  Bool = 0,
+  I32 = 1,
+  U32 = 2,
+  I64 = 3,
+  U64 = 4,
+  Float = 5,
+  String = 6,
+  Any = 7,
+  Struct = 8,
+  Enum = 9,
+  List = 10,
+  Map = 11,
+  Oneof = 12,
+  Unresolved = 255,
+};
+
+enum class RecordKind : std::uint8_t { File = 1, Error = 2 };
+
+// Serializes `document` into a request that can be handed to a plugin.
+std::string serialize(const Document& document);
+
+class DecodeError final : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+struct GeneratedFile {
+  std::string name;
+  std::string content;
+};
+
+struct Response {
+  std::vector<GeneratedFile> files;
+  std::vector<std::string> errors;
+};
+
+// Parses the bytes a plugin wrote to stdout.
+// Throws `DecodeError` if the bytes are not a well formed response.
+Response parse_response(const std::string& data);
+
+}  // namespace toolman::descriptor
+
+#endif  // TOOLMAN_DESCRIPTOR_H_
@@ -5,6 +5,8 @@
 #ifndef TOOLMAN_DOC_H_
 #define TOOLMAN_DOC_H_
 
+#include <filesystem>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -52,6 +54,10 @@ class Document final {
     source_ = std::move(source);
   }
 
+  [[nodiscard]] const std::vector<ApiGroup>& get_api_groups() const {
+    return api_groups_;
+  }
+
   void insert_api_group(ApiGroup api_group) {
     api_groups_.emplace_back(std::move(api_group));
   }
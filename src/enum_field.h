@@ -7,7 +7,6 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -36,25 +35,12 @@ class EnumField final : public HasStmtInfo {
 
   [[nodiscard]] int get_value() const { return value_; }
 
-  // set value to enum field, return false when value already exists.
-  bool set_value(int value) {
-    value_ = value;
-    return value_mapping_.emplace(value, *this).second;
-  }
-
-  static std::optional<EnumField> get_by_value(int value) {
-    if (auto got = value_mapping_.find(value); got != value_mapping_.end()) {
-      return std::make_optional(got->second);
-    } else {
-      return std::nullopt;
-    }
-  }
+  void set_value(int value) { value_ = value; }
 
  private:
   std::string name_;
-  int value_;
+  int value_ = 0;
   std::vector<std::string> comments_;
-  inline static std::unordered_map<int, EnumField> value_mapping_;
 };
 }  // namespace toolman
 
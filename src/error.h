@@ -17,6 +17,7 @@
 #include "src/option.h"
 #include "src/stmt_info.h"
 #include "src/type.h"
+#include "src/wire_format.h"
 
 namespace toolman {
 
@@ -100,6 +101,16 @@ class CustomTypeNotFoundError final : public Error {
               "cannot find type `" + type_name + "`") {}
 };
 
+class AmbiguousTypeError final : public Error {
+ public:
+  template <typename SI>
+  AmbiguousTypeError(const std::string& type_name, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "type `" + type_name +
+                  "` is ambiguous, it is imported by more than one `import "
+                  "*`") {}
+};
+
 class DuplicateFieldDeclError final : public Error {
  public:
   template <typename FIELD, typename SI>
@@ -120,6 +131,27 @@ class DuplicateEnumFieldValueError final : public Error {
                   "` already exists") {}
 };
 
+class DuplicateFieldNumberError final : public Error {
+ public:
+  template <typename FIELD, typename SI>
+  DuplicateFieldNumberError(FIELD first_decl_field, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "field number `" +
+                  std::to_string(first_decl_field.get_number()) +
+                  "` is already used by field `" +
+                  first_decl_field.get_name() + "`") {}
+};
+
+class FieldNumberOutOfRangeError final : public Error {
+ public:
+  template <typename SI>
+  FieldNumberOutOfRangeError(const std::string& number, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "field number `" + number + "` is out of range, it must be "
+                  "between 1 and " +
+                  std::to_string(wire_format::kMaxFieldNumber)) {}
+};
+
 class DuplicatePathParamDeclError final : public Error {
  public:
   template <typename FIELD, typename SI>
@@ -129,6 +161,43 @@ class DuplicatePathParamDeclError final : public Error {
                   "` is already declared") {}
 };
 
+class PathParamTypeError final : public Error {
+ public:
+  template <typename FIELD, typename SI>
+  PathParamTypeError(FIELD field, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "path param `" + field.get_name() +
+                  "` must be of a primitive type other than any, or an "
+                  "enum") {}
+};
+
+class PathParamSegmentError final : public Error {
+ public:
+  template <typename FIELD, typename SI>
+  PathParamSegmentError(FIELD field, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "path param `" + field.get_name() +
+                  "` must make up a whole path segment") {}
+};
+
+class DuplicateRouteError final : public Error {
+ public:
+  template <typename SI>
+  DuplicateRouteError(const std::string& path, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "an api with the same method and path as `" + path +
+                  "` is already declared") {}
+};
+
+class FieldConstraintError final : public Error {
+ public:
+  template <typename SI>
+  FieldConstraintError(const std::string& constraint,
+                       const std::string& problem, SI&& stmt_info)
+      : Error(Error::ErrorType::Semantic, Error::Level::Fatal,
+              "constraint `" + constraint + "` " + problem) {}
+};
+
 class RecursiveOneofTypeError final : public Error {
  public:
   template <typename SI>
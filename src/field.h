@@ -5,7 +5,9 @@
 #ifndef TOOLMAN_FIELD_H_
 #define TOOLMAN_FIELD_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,6 +17,29 @@
 
 namespace toolman {
 
+// Constraints on the value of a field, declared after it as
+// `[min: 0, max: 100]` and checked by the generated validators. Bounds are
+// kept as decimal literals, so 64-bit values stay exact.
+struct FieldConstraints {
+  // Numbers.
+  std::optional<std::string> min;
+  std::optional<std::string> max;
+  // Strings, counted in Unicode code points. `len` sets both.
+  std::optional<std::uint64_t> min_len;
+  std::optional<std::uint64_t> max_len;
+  // A regular expression strings must contain a match of, written in the
+  // syntax shared by RE2, java.util.regex and JavaScript.
+  std::optional<std::string> pattern;
+  // Lists and maps.
+  std::optional<std::uint64_t> min_items;
+  std::optional<std::uint64_t> max_items;
+
+  [[nodiscard]] bool empty() const {
+    return !min && !max && !min_len && !max_len && !pattern && !min_items &&
+           !max_items;
+  }
+};
+
 class Field final : public HasStmtInfo {
  public:
   template <typename S, typename SI>
@@ -53,6 +78,20 @@ class Field final : public HasStmtInfo {
 
   void set_type(std::shared_ptr<Type> type) { type_ = std::move(type); }
 
+  // The number that identifies the field in the binary wire format, 0 until
+  // one is declared or assigned.
+  [[nodiscard]] std::uint32_t get_number() const { return number_; }
+
+  void set_number(std::uint32_t number) { number_ = number; }
+
+  [[nodiscard]] const FieldConstraints& get_constraints() const {
+    return constraints_;
+  }
+
+  void set_constraints(FieldConstraints constraints) {
+    constraints_ = std::move(constraints);
+  }
+
   std::shared_ptr<Type> get_type() { return type_; }
 
  private:
@@ -60,6 +99,8 @@ class Field final : public HasStmtInfo {
   std::string name_;
   std::vector<std::string> comments_;
   bool optional_;
+  std::uint32_t number_ = 0;
+  FieldConstraints constraints_;
 };
 
 }  // namespace toolman
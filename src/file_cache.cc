@@ -0,0 +1,37 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "src/file_cache.h"
+
+#include <sys/stat.h>
+
+namespace toolman {
+
+std::optional<FileId> FileCache::stat(const std::filesystem::path& path) {
+  if (auto it = stats_.find(path.native()); it != stats_.end()) {
+    return it->second;
+  }
+  std::optional<FileId> id;
+  struct stat st {};
+  if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+    id = FileId{st.st_dev, st.st_ino};
+  }
+  stats_.emplace(path.native(), id);
+  return id;
+}
+
+const std::filesystem::path& FileCache::canonical(
+    const std::filesystem::path& path) {
+  if (auto it = canonicals_.find(path.native()); it != canonicals_.end()) {
+    return it->second;
+  }
+  std::error_code ec;
+  auto resolved = std::filesystem::canonical(path, ec);
+  if (ec) {
+    resolved = path.lexically_normal();
+  }
+  return canonicals_.emplace(path.native(), std::move(resolved)).first->second;
+}
+
+}  // namespace toolman
@@ -0,0 +1,55 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_FILE_CACHE_H_
+#define TOOLMAN_FILE_CACHE_H_
+
+#include <sys/types.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace toolman {
+
+// Identity of a file on disk. Two paths that reach the same file through
+// symlinks, `..` segments or different mount-relative spellings compare
+// equal.
+struct FileId {
+  dev_t device;
+  ino_t inode;
+
+  bool operator<(const FileId& rhs) const {
+    return std::tie(device, inode) < std::tie(rhs.device, rhs.inode);
+  }
+
+  bool operator==(const FileId& rhs) const {
+    return device == rhs.device && inode == rhs.inode;
+  }
+};
+
+// Memoizes filesystem lookups for the lifetime of the cache. Misses are
+// cached as well, so probing the same import path against every search
+// directory hits the filesystem once per candidate per compilation.
+// Not thread-safe.
+class FileCache {
+ public:
+  // Returns the identity of the regular file at `path`, or std::nullopt if
+  // there is none.
+  std::optional<FileId> stat(const std::filesystem::path& path);
+
+  // Returns the canonical form of `path` (symlinks and `..` resolved), or
+  // the lexically normal form if the path does not exist.
+  const std::filesystem::path& canonical(const std::filesystem::path& path);
+
+ private:
+  std::unordered_map<std::string, std::optional<FileId>> stats_;
+  std::unordered_map<std::string, std::filesystem::path> canonicals_;
+};
+
+}  // namespace toolman
+
+#endif  // TOOLMAN_FILE_CACHE_H_
@@ -4,6 +4,7 @@
 
 #include "src/generator.h"
 
+#include "src/cpp_generator.h"
 #include "src/document.h"
 #include "src/golang_generator.h"
 #include "src/java_generator.h"
@@ -20,6 +21,8 @@ TargetLanguage target_language_from_string(std::string target) {
     return TargetLanguage::GOLANG;
   } else if (target == "ts" || target == "typescript") {
     return TargetLanguage::TYPESCRIPT;
+  } else if (target == "cpp" || target == "c++") {
+    return TargetLanguage::CPP;
   }
   return TargetLanguage::JAVA;
 }
@@ -61,6 +64,9 @@ void generate(std::unique_ptr<Document> document, TargetLanguage targetLanguage,
     case TargetLanguage::JAVA:
       generator = std::make_unique<JavaGenerator>();
       break;
+    case TargetLanguage::CPP:
+      generator = std::make_unique<CppGenerator>();
+      break;
   }
   generator->generate(ostream, document);
 }
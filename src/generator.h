@@ -25,7 +25,7 @@
 
 namespace toolman::generator {
 
-enum class TargetLanguage : char { GOLANG, TYPESCRIPT, JAVA };
+enum class TargetLanguage : char { GOLANG, TYPESCRIPT, JAVA, CPP };
 
 TargetLanguage target_language_from_string(std::string target);
 
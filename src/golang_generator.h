@@ -5,33 +5,196 @@
 #ifndef TOOLMAN_GOLANG_GENERATOR_H_
 #define TOOLMAN_GOLANG_GENERATOR_H_
 
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/generator.h"
+#include "src/golang_runtime.h"
 #include "src/list_type.h"
 #include "src/map_type.h"
+#include "src/perfect_hash.h"
 #include "src/primitive_type.h"
+#include "src/route_tree.h"
+#include "src/scope.h"
+#include "src/validation.h"
+#include "src/wire_format.h"
 
 namespace toolman::generator {
 class GolangGenerator : public Generator {
  protected:
+  void before_generate_document(std::ostream& ostream,
+                                const Document* document) override {
+    // process option
+    auto package_name = go_package_name(document->get_source()->stem());
+    for (const auto& opt : document->get_options()) {
+      if (opt->get_name() == buildin::option_go_package.get_name()) {
+        package_name = std::dynamic_pointer_cast<decltype(
+            buildin::option_go_package)>(opt)
+                           ->get_value();
+      } else if (opt->get_name() == buildin::option_go_json_codec.get_name()) {
+        use_json_codec_ = std::dynamic_pointer_cast<decltype(
+                              buildin::option_go_json_codec)>(opt)
+                              ->get_value();
+      } else if (opt->get_name() == buildin::option_binary_codec.get_name()) {
+        use_binary_codec_ = std::dynamic_pointer_cast<decltype(
+                                buildin::option_binary_codec)>(opt)
+                                ->get_value();
+      } else if (opt->get_name() == buildin::option_binary_views.get_name()) {
+        use_binary_views_ = std::dynamic_pointer_cast<decltype(
+                                buildin::option_binary_views)>(opt)
+                                ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_presence_bits.get_name()) {
+        use_presence_bits_ = std::dynamic_pointer_cast<decltype(
+                                 buildin::option_go_presence_bits)>(opt)
+                                 ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_packed_layout.get_name()) {
+        use_packed_layout_ = std::dynamic_pointer_cast<decltype(
+                                 buildin::option_go_packed_layout)>(opt)
+                                 ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_object_pool.get_name()) {
+        use_object_pool_ = std::dynamic_pointer_cast<decltype(
+                               buildin::option_go_object_pool)>(opt)
+                               ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_inline_oneof.get_name()) {
+        use_inline_oneof_ = std::dynamic_pointer_cast<decltype(
+                                buildin::option_go_inline_oneof)>(opt)
+                                ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_http_server.get_name()) {
+        use_http_server_ = std::dynamic_pointer_cast<decltype(
+                               buildin::option_go_http_server)>(opt)
+                               ->get_value();
+      } else if (opt->get_name() == buildin::option_http_client.get_name()) {
+        use_http_client_ = std::dynamic_pointer_cast<decltype(
+                               buildin::option_http_client)>(opt)
+                               ->get_value();
+      } else if (opt->get_name() == buildin::option_deep_copy.get_name()) {
+        use_deep_copy_ = std::dynamic_pointer_cast<decltype(
+                             buildin::option_deep_copy)>(opt)
+                             ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_go_field_masks.get_name()) {
+        use_field_masks_ = std::dynamic_pointer_cast<decltype(
+                               buildin::option_go_field_masks)>(opt)
+                               ->get_value();
+      } else if (opt->get_name() == buildin::option_json_streams.get_name()) {
+        use_json_streams_ = std::dynamic_pointer_cast<decltype(
+                                buildin::option_json_streams)>(opt)
+                                ->get_value();
+      }
+    }
+    use_http_server_ =
+        use_http_server_ && !document->get_api_groups().empty();
+    use_http_client_ =
+        use_http_client_ && !document->get_api_groups().empty();
+    // encoding/json cannot see the presence bits, so fields that are not
+    // set would be written as zero; the generated JSON codec honours them.
+    // It also writes fields in declaration order, whatever the layout, and
+    // cannot see the unexported storage of inline oneofs. The HTTP servers
+    // and clients decode and encode bodies with it, field masks select what
+    // it writes and streaming decoders decode values with it.
+    use_json_codec_ = use_json_codec_ || use_presence_bits_ ||
+                      use_packed_layout_ || use_inline_oneof_ ||
+                      use_http_server_ || use_http_client_ ||
+                      use_field_masks_ || use_json_streams_;
+
+    ostream << "package " << package_name << NL2;
+    // `any` values are JSON text in the binary format too.
+    if (use_json_codec_ || use_binary_runtime()) {
+      ostream << "import (" << NL << golang_runtime::kJsonImports << ")"
+              << NL2;
+    } else if (!document->get_enum_types().empty()) {
+      // For the String methods of enums.
+      ostream << "import \"strconv\"" << NL2;
+    }
+    if (use_object_pool_ || use_http_server_ || use_http_client_) {
+      ostream << "import \"sync\"" << NL2;
+    }
+    generate_validation_imports(ostream, document);
+    if (use_http_server_ || use_http_client_) {
+      ostream << "import (" << NL << golang_runtime::kHttpImports
+              << (use_http_server_ ? golang_runtime::kHttpServerImports : "")
+              << (use_http_client_ ? golang_runtime::kHttpClientImports : "")
+              << ")" << NL2;
+    } else if (use_json_streams_) {
+      ostream << "import \"io\"" << NL2;
+    }
+  }
+
+  void after_generate_document(std::ostream& ostream,
+                               const Document* document) override {
+    for (const auto& api_group : document->get_api_groups()) {
+      if (use_http_server_ || use_http_client_) {
+        generate_http_responses(ostream, api_group);
+      }
+      if (use_http_server_) {
+        generate_http_server(ostream, api_group);
+      }
+      if (use_http_client_) {
+        generate_http_client(ostream, api_group);
+      }
+    }
+    if (use_http_server_ || use_http_client_) {
+      ostream << golang_runtime::kHttp;
+    }
+    if (use_http_server_) {
+      ostream << golang_runtime::kHttpServer;
+    }
+    if (use_http_client_) {
+      ostream << golang_runtime::kHttpClient;
+    }
+    if (use_json_codec_ || use_binary_runtime()) {
+      ostream << golang_runtime::kJson;
+    }
+    if (use_binary_runtime()) {
+      ostream << golang_runtime::kBinary;
+    }
+    if (use_json_streams_) {
+      ostream << golang_runtime::kStream;
+    }
+    if (use_field_masks_) {
+      ostream << golang_runtime::kMask;
+    }
+    if (use_validation_) {
+      ostream << golang_runtime::kValidation;
+    }
+    if (use_deep_copy_) {
+      ostream << golang_runtime::kCopy;
+    }
+  }
+
   void before_generate_struct(std::ostream& ostream,
                               const Document* document) override {
     for (const auto& struct_type : document->get_struct_types()) {
       auto capitalized_struct_name = capitalize(struct_type->get_name());
       for (const auto& field : struct_type->get_fields()) {
-        if (field.get_type()->is_oneof()) {
+        if (field.get_type()->is_oneof() && use_inline_oneof_) {
+          generate_inline_oneof(ostream, struct_type.get(), field);
+        } else if (field.get_type()->is_oneof()) {
           auto oneof_name =
               gen_oneof_name(struct_type->get_name(), field.get_name());
           ostream << "type " << oneof_name << " interface {" << NL << INDENT_1
-                  << oneof_name << "()" << NL << "}" << NL;
+                  << oneof_name << "()" << NL << "}" << NL2;
           auto oneof = std::dynamic_pointer_cast<OneofType>(field.get_type());
           for (const auto& oneof_field : oneof->get_fields()) {
             auto capitalized_field_name = capitalize(oneof_field.get_name());
             auto struct_name = capitalized_struct_name + capitalized_field_name;
-            ostream << struct_name << " struct {" << NL << INDENT_1
+            ostream << "type " << struct_name << " struct {" << NL << INDENT_1
                     << capitalized_field_name << " "
                     << type_to_go_type(oneof_field.get_type().get()) << NL
                     << "}" << NL2 << "func (*" << struct_name << ") "
@@ -46,6 +209,57 @@ class GolangGenerator : public Generator {
   void after_generate_struct(std::ostream& ostream,
                              const Document* document) override {
     ostream << ")" << NL2;
+    // Only the decoders and the object pools reuse messages.
+    if (use_json_codec_ || use_binary_codec_ || use_object_pool_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_reset(ostream, struct_type.get());
+      }
+    }
+    if (use_object_pool_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_object_pool(ostream, struct_type.get());
+      }
+    }
+    if (use_presence_bits_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_presence_accessors(ostream, struct_type.get());
+      }
+    }
+    for (const auto& struct_type : document->get_struct_types()) {
+      if (needs_validation(struct_type.get())) {
+        generate_validate(ostream, struct_type.get());
+      }
+    }
+    if (use_deep_copy_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_deep_copy(ostream, struct_type.get());
+      }
+    }
+    if (use_json_codec_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_json_codec(ostream, struct_type.get());
+      }
+    }
+    if (use_json_streams_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_json_stream(ostream, struct_type.get());
+      }
+    }
+    if (use_field_masks_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_field_mask(ostream, struct_type.get());
+      }
+    }
+    if (use_binary_codec_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_binary_codec(ostream, struct_type.get());
+      }
+    }
+    if (use_binary_views_) {
+      for (const auto& struct_type : document->get_struct_types()) {
+        generate_binary_view(ostream, struct_type.get());
+      }
+    }
   }
 
   void after_generate_enum(std::ostream& ostream,
@@ -62,37 +276,40 @@ class GolangGenerator : public Generator {
       std::ostream& ostream,
       const std::shared_ptr<StructType>& struct_type) override {
     auto capitalized_struct_name = capitalize(struct_type->get_name());
-    for (const auto& field : struct_type->get_fields()) {
-      if (field.get_type()->is_oneof()) {
-        auto oneof_name =
-            gen_oneof_name(struct_type->get_name(), field.get_name());
-        ostream << oneof_name + " interface {" << NL << INDENT_1 << oneof_name
-                << "()" << NL << "}" << NL;
-        auto oneof = std::dynamic_pointer_cast<OneofType>(field.get_type());
-        for (const auto& oneof_field : oneof->get_fields()) {
-          auto capitalized_field_name = capitalize(oneof_field.get_name());
-          ostream << capitalized_struct_name << "_" << capitalized_field_name
-                  << " struct {" << NL << INDENT_1 << capitalized_field_name
-                  << " " << type_to_go_type(oneof_field.get_type().get()) << NL
-                  << "}" << NL;
-        }
+    auto fields = struct_type->get_fields();
+    auto order = declaration_order(struct_type.get());
+    if (use_packed_layout_) {
+      auto packed = packed_order(struct_type.get());
+      auto declared = go_layout(struct_type.get(), order).size;
+      auto size = go_layout(struct_type.get(), packed).size;
+      if (size < declared) {
+        order = packed;
+        ostream << single_line_comment(
+                       "Fields ordered by alignment: " + std::to_string(size) +
+                       " bytes, " + std::to_string(declared) +
+                       " in declaration order.")
+                << NL;
+      } else {
+        ostream << single_line_comment("Fields in declaration order: " +
+                                       std::to_string(size) + " bytes.")
+                << NL;
       }
     }
-
     ostream << capitalized_struct_name << " struct {" << NL;
-    for (const auto& field : struct_type->get_fields()) {
+    for (auto i : order) {
+      if (i == fields.size()) {
+        generate_presence_field(ostream, struct_type.get());
+        continue;
+      }
+      const auto& field = fields[i];
       for (const auto& comment : field.get_comments()) {
         ostream << INDENT_1 << single_line_comment(comment) << NL;
       }
 
       ostream << INDENT_1 << capitalize(field.get_name()) << " "
-              << (field.is_optional() && !field.get_type()->is_map() &&
-                          !field.get_type()->is_list()
-                      ? "*"
-                      : "")
+              << (is_pointer_field(field) ? "*" : "")
               << (field.get_type()->is_oneof()
-                      ? gen_oneof_name(struct_type->get_name(),
-                                       field.get_name())
+                      ? oneof_type_name(struct_type.get(), field)
                       : type_to_go_type(field.get_type().get()))
               << " `json:\"" + field.get_name() + "\"`" << NL;
     }
@@ -111,7 +328,8 @@ class GolangGenerator : public Generator {
       ostream << capitalized_name << "_" << field.get_name() << " "
               << capitalized_name << " = " << field.get_value() << NL;
     }
-    ostream << ")" << NL;
+    ostream << ")" << NL2;
+    generate_enum_lookups(ostream, enum_type.get());
   }
 
  private:
@@ -120,9 +338,2364 @@ class GolangGenerator : public Generator {
     return "is" + capitalize(struct_name) + "_" + capitalize(field_name);
   }
 
-  [[nodiscard]] static std::string type_to_go_type(Type* type) {
+  std::string oneof_type_name(const StructType* struct_type,
+                              const Field& field) const {
+    if (use_inline_oneof_) {
+      return capitalize(struct_type->get_name()) + "_" +
+             capitalize(field.get_name());
+    }
+    return gen_oneof_name(struct_type->get_name(), field.get_name());
+  }
+
+  // With go_inline_oneof, a oneof is a struct that stores every alternative
+  // inline next to a discriminant, rather than an interface holding a
+  // pointer to a wrapper struct, so setting one does not allocate. It is
+  // as large as all its alternatives together; the accessors keep at most
+  // one of them non-zero.
+  void generate_inline_oneof(std::ostream& ostream,
+                             const StructType* struct_type,
+                             const Field& field) {
+    auto name = oneof_type_name(struct_type, field);
+    auto kind = name + "Kind";
+    auto oneof = dynamic_cast<const OneofType*>(field.get_type().get());
+    inline_oneof_names_[oneof] = name;
+    ostream << "// " << kind << " tells which alternative of a " << name
+            << " is set." << NL << "type " << kind << " uint8" << NL2
+            << "const (" << NL << INDENT_1 << name << "_None " << kind
+            << " = iota" << NL;
+    for (const auto& oneof_field : oneof->get_fields()) {
+      ostream << INDENT_1 << name << "_" << capitalize(oneof_field.get_name())
+              << NL;
+    }
+    ostream << ")" << NL2 << "type " << name << " struct {" << NL << INDENT_1
+            << "kind " << kind << NL;
+    for (const auto& oneof_field : oneof->get_fields()) {
+      ostream << INDENT_1 << "v" << capitalize(oneof_field.get_name()) << " "
+              << type_to_go_type(oneof_field.get_type().get()) << NL;
+    }
+    ostream << "}" << NL2 << "// Kind returns which alternative is set, "
+            << name << "_None if none is." << NL << "func (o *" << name
+            << ") Kind() " << kind << " {" << NL << INDENT_1
+            << "return o.kind" << NL << "}" << NL2 << "// Clear unsets o." << NL
+            << "func (o *" << name << ") Clear() {" << NL << INDENT_1 << "*o = "
+            << name << "{}" << NL << "}" << NL2;
+    for (const auto& oneof_field : oneof->get_fields()) {
+      auto alt = capitalize(oneof_field.get_name());
+      auto alt_type = type_to_go_type(oneof_field.get_type().get());
+      ostream << "// " << alt << " returns the " << oneof_field.get_name()
+              << " alternative, zero unless it is the one set." << NL
+              << "func (o *" << name << ") " << alt << "() " << alt_type
+              << " {" << NL << INDENT_1 << "return o.v" << alt << NL << "}"
+              << NL2 << "// Set" << alt << " makes " << oneof_field.get_name()
+              << " the alternative that is set." << NL << "func (o *" << name
+              << ") Set" << alt << "(v " << alt_type << ") {" << NL << INDENT_1
+              << "*o = " << name << "{kind: " << name << "_" << alt << ", v"
+              << alt << ": v}" << NL << "}" << NL2;
+    }
+  }
+
+  // Optional fields are pointers, except lists and maps whose nil value
+  // already means absent, scalars that have a presence bit and inline
+  // oneofs, which have a discriminant.
+  bool is_pointer_field(const Field& field) const {
+    auto type = field.get_type();
+    return field.is_optional() && !type->is_map() && !type->is_list() &&
+           !has_presence_bit(field) &&
+           !(type->is_oneof() && use_inline_oneof_);
+  }
+
+  // With go_presence_bits, optional scalars are plain values and whether
+  // they are set is kept in the unexported `presence` bitmask, so setting
+  // one does not allocate.
+  bool has_presence_bit(const Field& field) const {
+    auto type = field.get_type();
+    if (!use_presence_bits_ || !field.is_optional()) {
+      return false;
+    }
+    return type->is_enum() ||
+           (type->is_primitive() &&
+            !std::dynamic_pointer_cast<PrimitiveType>(type)->is_any());
+  }
+
+  std::size_t presence_bit_count(const StructType* struct_type) const {
+    std::size_t count = 0;
+    for (const auto& field : struct_type->get_fields()) {
+      count += has_presence_bit(field) ? 1 : 0;
+    }
+    return count;
+  }
+
+  // Returns the word of `m` holding the presence bit of `field` and its
+  // mask. Up to 32 bits fit a uint32, more take an array of uint64.
+  std::pair<std::string, std::string> presence_bit(
+      const StructType* struct_type, const Field& field) const {
+    std::size_t bit = 0;
+    for (const auto& other : struct_type->get_fields()) {
+      if (other.get_name() == field.get_name()) {
+        break;
+      }
+      bit += has_presence_bit(other) ? 1 : 0;
+    }
+    char mask[32];
+    std::snprintf(mask, sizeof(mask), "0x%llx", 1ULL << (bit % 64));
+    if (presence_bit_count(struct_type) > 32) {
+      return {"m.presence[" + std::to_string(bit / 64) + "]", mask};
+    }
+    return {"m.presence", mask};
+  }
+
+  void generate_presence_field(std::ostream& ostream,
+                               const StructType* struct_type) const {
+    auto bits = presence_bit_count(struct_type);
+    if (bits > 32) {
+      ostream << INDENT_1 << "presence [" << (bits + 63) / 64 << "]uint64"
+              << NL;
+    } else if (bits > 0) {
+      ostream << INDENT_1 << "presence uint32" << NL;
+    }
+  }
+
+  // Size and alignment of a Go value on 64-bit platforms.
+  struct GoLayout {
+    std::size_t size;
+    std::size_t align;
+  };
+
+  GoLayout go_layout(const Type* type) const {
+    if (type->is_enum()) {
+      return {4, 4};
+    } else if (type->is_struct()) {
+      auto struct_type = dynamic_cast<const StructType*>(type);
+      return go_layout(struct_type, packed_order(struct_type));
+    } else if (type->is_list()) {
+      return {24, 8};
+    } else if (type->is_map()) {
+      return {8, 8};
+    } else if (type->is_oneof() && use_inline_oneof_) {
+      std::vector<GoLayout> layouts{{1, 1}};
+      for (const auto& oneof_field :
+           dynamic_cast<const OneofType*>(type)->get_fields()) {
+        layouts.push_back(go_layout(oneof_field.get_type().get()));
+      }
+      return go_layout(layouts);
+    } else if (type->is_oneof()) {
+      return {16, 8};
+    }
+    auto primitive = dynamic_cast<const PrimitiveType*>(type);
+    if (primitive->is_bool()) {
+      return {1, 1};
+    } else if (primitive->is_i32() || primitive->is_u32()) {
+      return {4, 4};
+    } else if (primitive->is_string() || primitive->is_any()) {
+      return {16, 8};
+    }
+    return {8, 8};
+  }
+
+  // Index fields.size() stands for the presence bitmask, if there is one.
+  GoLayout go_layout(const StructType* struct_type, std::size_t index) const {
+    auto fields = struct_type->get_fields();
+    if (index == fields.size()) {
+      auto bits = presence_bit_count(struct_type);
+      return bits > 32 ? GoLayout{(bits + 63) / 64 * 8, 8} : GoLayout{4, 4};
+    }
+    if (is_pointer_field(fields[index])) {
+      return {8, 8};
+    }
+    return go_layout(fields[index].get_type().get());
+  }
+
+  // Lays the fields out in `order` the way the Go compiler does.
+  GoLayout go_layout(const StructType* struct_type,
+                     const std::vector<std::size_t>& order) const {
+    std::vector<GoLayout> layouts;
+    for (auto i : order) {
+      layouts.push_back(go_layout(struct_type, i));
+    }
+    return go_layout(layouts);
+  }
+
+  // Lays out a struct whose fields have `layouts`, in that order.
+  static GoLayout go_layout(const std::vector<GoLayout>& layouts) {
+    std::size_t offset = 0;
+    std::size_t align = 1;
+    std::size_t last = 0;
+    for (const auto& layout : layouts) {
+      offset = (offset + layout.align - 1) / layout.align * layout.align +
+               layout.size;
+      align = std::max(align, layout.align);
+      last = layout.size;
+    }
+    // A trailing zero-size field is padded so that its address stays
+    // inside the struct.
+    if (!layouts.empty() && last == 0) {
+      offset++;
+    }
+    return {(offset + align - 1) / align * align, align};
+  }
+
+  // Returns the indices of the fields, then the presence bitmask if any.
+  std::vector<std::size_t> declaration_order(
+      const StructType* struct_type) const {
+    std::vector<std::size_t> order;
+    auto count = struct_type->get_fields().size();
+    for (std::size_t i = 0; i < count; ++i) {
+      order.push_back(i);
+    }
+    if (presence_bit_count(struct_type) > 0) {
+      order.push_back(count);
+    }
+    return order;
+  }
+
+  // Returns the declaration order sorted by decreasing alignment. Sizes
+  // are multiples of alignments, so this leaves padding only at the end.
+  std::vector<std::size_t> packed_order(const StructType* struct_type) const {
+    auto order = declaration_order(struct_type);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t lhs, std::size_t rhs) {
+                       return go_layout(struct_type, lhs).align >
+                              go_layout(struct_type, rhs).align;
+                     });
+    return order;
+  }
+
+  // Lists and maps that are not optional keep their storage, nested structs
+  // are reset in place; optional ones become nil since nil means absent,
+  // which the comment of Reset says.
+  void generate_reset(std::ostream& ostream, const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    std::string kept;
+    auto drops_storage = false;
+    for (const auto& field : struct_type->get_fields()) {
+      auto type = field.get_type();
+      drops_storage = drops_storage ||
+                      (field.is_optional() && (type->is_list() ||
+                                               type->is_map() ||
+                                               type->is_struct()));
+    }
+    ostream << "// Reset clears m, keeping the storage of its lists, maps and "
+               "nested structs"
+            << NL << "// so that decoding into m again allocates less."
+            << (drops_storage ? " Optional ones become nil," NL
+                                "// which is how they are absent, and do not "
+                                "keep their storage." NL
+                              : NL)
+            << "func (m *" << struct_name << ") Reset() {" << NL;
+    for (const auto& field : struct_type->get_fields()) {
+      auto type = field.get_type().get();
+      auto name = capitalize(field.get_name());
+      if (field.is_optional()) {
+        continue;
+      }
+      if (type->is_map()) {
+        ostream << INDENT_1 << "for k := range m." << name << " {" << NL
+                << INDENT_2 << "delete(m." << name << ", k)" << NL << INDENT_1
+                << "}" << NL;
+        kept += ", " + name + ": m." + name;
+      } else if (type->is_list()) {
+        kept += ", " + name + ": m." + name + "[:0]";
+      } else if (type->is_struct()) {
+        ostream << INDENT_1 << "m." << name << ".Reset()" << NL;
+        kept += ", " + name + ": m." + name;
+      }
+    }
+    ostream << INDENT_1 << "*m = " << struct_name << "{"
+            << (kept.empty() ? "" : kept.substr(2)) << "}" << NL << "}"
+            << NL2;
+  }
+
+  // Validators need strconv for the paths of elements, regexp and
+  // unicode/utf8 for some constraints; those the codecs or enums do not
+  // import already get an import of their own.
+  void generate_validation_imports(std::ostream& ostream,
+                                   const Document* document) {
+    auto has_pattern = false;
+    auto has_len = false;
+    for (const auto& struct_type : document->get_struct_types()) {
+      use_validation_ =
+          use_validation_ || needs_validation(struct_type.get());
+      for (const auto& field : struct_type->get_fields()) {
+        const auto& constraints = field.get_constraints();
+        has_pattern = has_pattern || constraints.pattern;
+        has_len = has_len || constraints.min_len || constraints.max_len;
+      }
+    }
+    if (!use_validation_) {
+      return;
+    }
+    auto json_imports = use_json_codec_ || use_binary_runtime();
+    std::string imports;
+    if (has_pattern) {
+      imports += "    \"regexp\"\n";
+    }
+    if (!json_imports && document->get_enum_types().empty()) {
+      imports += "    \"strconv\"\n";
+    }
+    if (!json_imports && has_len) {
+      imports += "    \"unicode/utf8\"\n";
+    }
+    if (!imports.empty()) {
+      ostream << "import (" << NL << imports << ")" << NL2;
+    }
+  }
+
+  // Validate checks the constraints of the fields in declaration order with
+  // straight-line code, then the structs the fields hold, and returns the
+  // first failure. Patterns are compiled once, into package variables.
+  void generate_validate(std::ostream& ostream,
+                         const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    for (const auto& field : struct_type->get_fields()) {
+      if (const auto& pattern = field.get_constraints().pattern; pattern) {
+        ostream << "var " << pattern_name(struct_type, field)
+                << " = regexp.MustCompile(" << quote_literal(*pattern) << ")"
+                << NL2;
+      }
+    }
+    ostream << "// Validate checks m against the constraints declared on its "
+               "fields, and on"
+            << NL
+            << "// the fields of the structs it holds, stopping at the first "
+               "one it breaks."
+            << NL << "func (m *" << struct_name << ") Validate() error {"
+            << NL;
+    for (const auto& field : struct_type->get_fields()) {
+      auto type = field.get_type().get();
+      if (field.get_constraints().empty() && !needs_validation(type)) {
+        continue;
+      }
+      auto expr = "m." + capitalize(field.get_name());
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        ostream << INDENT_1 << "if " << word << "&" << mask << " != 0 {"
+                << NL;
+      } else if (field.is_optional()) {
+        ostream << INDENT_1 << "if " << expr << " != nil {" << NL;
+        expr = is_pointer_field(field) ? "(*" + expr + ")" : expr;
+      }
+      auto indent = field.is_optional() ? INDENT_2 : INDENT_1;
+      generate_field_validation(ostream, struct_type, field, expr, indent);
+      if (field.is_optional()) {
+        ostream << INDENT_1 << "}" << NL;
+      }
+    }
+    ostream << INDENT_1 << "return nil" << NL << "}" << NL2;
+  }
+
+  void generate_field_validation(std::ostream& ostream,
+                                 const StructType* struct_type,
+                                 const Field& field, const std::string& expr,
+                                 const std::string& indent) {
+    const auto& constraints = field.get_constraints();
+    auto path = "\"" + field.get_name() + "\"";
+    auto fail = [&](const std::string& reason) {
+      ostream << indent << INDENT_1 << "return tmInvalid(" << path << ", "
+              << quote_literal(reason) << ")" << NL << indent << "}" << NL;
+    };
+    auto type = field.get_type().get();
+    if (constraints.min || constraints.max) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      // An unsigned value is never below 0.
+      auto min = (primitive->is_u32() || primitive->is_u64()) &&
+                         constraints.min == "0"
+                     ? std::nullopt
+                     : constraints.min;
+      const auto& max = constraints.max;
+      if (min || max) {
+        std::string check;
+        if (primitive->is_float()) {
+          // Written so that NaN fails.
+          check = "!(" + (min ? expr + " >= " + *min : "") +
+                  (min && max ? " && " : "") +
+                  (max ? expr + " <= " + *max : "") + ")";
+        } else {
+          check = (min ? expr + " < " + *min : "") +
+                  (min && max ? " || " : "") +
+                  (max ? expr + " > " + *max : "");
+        }
+        ostream << indent << "if " << check << " {" << NL;
+        fail(bounds_reason("", constraints.min, max));
+      }
+    }
+    if (auto check =
+            count_check("n", constraints.min_len, constraints.max_len);
+        !check.empty()) {
+      ostream << indent << "if n := utf8.RuneCountInString(" << expr << "); "
+              << check << " {" << NL;
+      fail(bounds_reason("length", constraints.min_len, constraints.max_len));
+    }
+    if (constraints.pattern) {
+      ostream << indent << "if !" << pattern_name(struct_type, field)
+              << ".MatchString(" << expr << ") {" << NL;
+      fail("must match " + *constraints.pattern);
+    }
+    if (auto check =
+            count_check("n", constraints.min_items, constraints.max_items);
+        !check.empty()) {
+      ostream << indent << "if n := len(" << expr << "); " << check << " {"
+              << NL;
+      fail(bounds_reason("size", constraints.min_items,
+                         constraints.max_items));
+    }
+    if (needs_validation(type)) {
+      generate_value_validation(ostream, type, expr, path, indent, 1);
+    }
+  }
+
+  // Emits checks of the structs in `expr`, `path` is a Go expression
+  // spelling where `expr` is.
+  static void generate_value_validation(std::ostream& ostream,
+                                        const Type* type,
+                                        const std::string& expr,
+                                        const std::string& path,
+                                        const std::string& indent,
+                                        int depth) {
+    auto d = std::to_string(depth);
+    if (type->is_struct()) {
+      ostream << indent << "if err := " << expr
+              << ".Validate(); err != nil {" << NL << indent << INDENT_1
+              << "return tmInvalidIn(err, " << path << ")" << NL << indent
+              << "}" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      ostream << indent << "for i" << d << " := range " << expr << " {"
+              << NL;
+      generate_value_validation(ostream, list->get_elem_type().get(),
+                                expr + "[i" + d + "]",
+                                "tmIndex(" + path + ", i" + d + ")",
+                                indent + INDENT_1, depth + 1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      auto key = map->get_key_type().get();
+      auto k = "k" + d;
+      std::string key_text = k;
+      if (key->is_bool()) {
+        key_text = "strconv.FormatBool(" + k + ")";
+      } else if (key->is_i32() || key->is_i64()) {
+        key_text = "strconv.FormatInt(int64(" + k + "), 10)";
+      } else if (key->is_u32() || key->is_u64()) {
+        key_text = "strconv.FormatUint(uint64(" + k + "), 10)";
+      } else if (key->is_float()) {
+        key_text = "strconv.FormatFloat(" + k + ", 'g', -1, 64)";
+      }
+      ostream << indent << "for " << k << ", v" << d << " := range " << expr
+              << " {" << NL;
+      generate_value_validation(ostream, map->get_value_type().get(),
+                                "v" + d,
+                                "tmKey(" + path + ", " + key_text + ")",
+                                indent + INDENT_1, depth + 1);
+      ostream << indent << "}" << NL;
+    }
+  }
+
+  static std::string pattern_name(const StructType* struct_type,
+                                  const Field& field) {
+    return "tm" + capitalize(struct_type->get_name()) +
+           capitalize(camelcase(field.get_name())) + "Pattern";
+  }
+
+  // DeepCopyInto starts from a shallow copy, which is all that scalars,
+  // strings and enums need, then replaces whatever still shares storage
+  // with m: pointers, lists, maps, oneofs and `any` values.
+  void generate_deep_copy(std::ostream& ostream,
+                          const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    ostream << "// DeepCopyInto copies m into out, sharing no storage with m. "
+               "Lists and maps"
+            << NL << "// are allocated at exactly their length." << NL
+            << "func (m *" << struct_name << ") DeepCopyInto(out *"
+            << struct_name << ") {" << NL << INDENT_1 << "*out = *m" << NL;
+    for (const auto& field : struct_type->get_fields()) {
+      auto type = field.get_type().get();
+      auto name = capitalize(field.get_name());
+      if (is_pointer_field(field) && type->is_struct()) {
+        ostream << INDENT_1 << "out." << name << " = m." << name
+                << ".DeepCopy()" << NL;
+      } else if (is_pointer_field(field) && type->is_primitive()) {
+        auto value = "*m." + name;
+        if (dynamic_cast<const PrimitiveType*>(type)->is_any()) {
+          value = "tmCopyAny(" + value + ")";
+        }
+        ostream << INDENT_1 << "if m." << name << " != nil {" << NL << INDENT_2
+                << "c := " << value << NL << INDENT_2 << "out." << name
+                << " = &c" << NL << INDENT_1 << "}" << NL;
+      } else if (is_pointer_field(field)) {
+        ostream << INDENT_1 << "if m." << name << " != nil {" << NL << INDENT_2
+                << "c := *m." << name << NL;
+        if (needs_deep_copy(type)) {
+          generate_copy(ostream, struct_type, type, "(*m." + name + ")", "c",
+                        INDENT_2, 1);
+        }
+        ostream << INDENT_2 << "out." << name << " = &c" << NL << INDENT_1
+                << "}" << NL;
+      } else if (needs_deep_copy(type)) {
+        generate_copy(ostream, struct_type, type, "m." + name, "out." + name,
+                      INDENT_1, 1);
+      }
+    }
+    ostream << "}" << NL2 << "// DeepCopy returns a copy of m that shares no "
+            << "storage with it, nil if m is nil." << NL << "func (m *"
+            << struct_name << ") DeepCopy() *" << struct_name << " {" << NL
+            << INDENT_1 << "if m == nil {" << NL << INDENT_2 << "return nil"
+            << NL << INDENT_1 << "}" << NL << INDENT_1 << "out := new("
+            << struct_name << ")" << NL << INDENT_1 << "m.DeepCopyInto(out)"
+            << NL << INDENT_1 << "return out" << NL << "}" << NL2;
+  }
+
+  // Whether a shallow copy of a `type` shares storage with the original.
+  bool needs_deep_copy(const Type* type) const {
+    std::set<const Type*> seen;
+    return needs_deep_copy(type, &seen);
+  }
+
+  bool needs_deep_copy(const Type* type, std::set<const Type*>* seen) const {
+    if (type->is_list() || type->is_map()) {
+      return true;
+    } else if (type->is_primitive()) {
+      return dynamic_cast<const PrimitiveType*>(type)->is_any();
+    } else if (type->is_oneof() && !use_inline_oneof_) {
+      return true;
+    } else if (type->is_oneof()) {
+      for (const auto& oneof_field :
+           dynamic_cast<const OneofType*>(type)->get_fields()) {
+        if (needs_deep_copy(oneof_field.get_type().get(), seen)) {
+          return true;
+        }
+      }
+      return false;
+    } else if (!type->is_struct() || !seen->insert(type).second) {
+      return false;
+    }
+    for (const auto& field :
+         dynamic_cast<const StructType*>(type)->get_fields()) {
+      if (is_pointer_field(field) ||
+          needs_deep_copy(field.get_type().get(), seen)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Emits statements that turn `dst`, which holds either a shallow copy of
+  // `src` or the zero value, into a deep copy of `src`.
+  void generate_copy(std::ostream& ostream, const StructType* struct_type,
+                     const Type* type, const std::string& src,
+                     const std::string& dst, const std::string& indent,
+                     int depth) {
+    auto d = std::to_string(depth);
+    if (type->is_primitive()) {
+      ostream << indent << dst << " = tmCopyAny(" << src << ")" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << src << ".DeepCopyInto(&" << dst << ")" << NL;
+    } else if (type->is_list()) {
+      auto elem = dynamic_cast<const ListType*>(type)->get_elem_type().get();
+      ostream << indent << "if " << src << " != nil {" << NL << indent
+              << INDENT_1 << dst << " = make(" << type_to_go_type(type)
+              << ", len(" << src << "))" << NL;
+      if (needs_deep_copy(elem)) {
+        ostream << indent << INDENT_1 << "for i" << d << " := range " << src
+                << " {" << NL;
+        generate_copy(ostream, struct_type, elem, src + "[i" + d + "]",
+                      dst + "[i" + d + "]", indent + INDENT_2, depth + 1);
+        ostream << indent << INDENT_1 << "}" << NL;
+      } else {
+        ostream << indent << INDENT_1 << "copy(" << dst << ", " << src << ")"
+                << NL;
+      }
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto value = dynamic_cast<const MapType*>(type)->get_value_type().get();
+      ostream << indent << "if " << src << " != nil {" << NL << indent
+              << INDENT_1 << dst << " = make(" << type_to_go_type(type)
+              << ", len(" << src << "))" << NL << indent << INDENT_1 << "for k"
+              << d << ", v" << d << " := range " << src << " {" << NL;
+      if (needs_deep_copy(value)) {
+        ostream << indent << INDENT_2 << "c" << d << " := v" << d << NL;
+        generate_copy(ostream, struct_type, value, "v" + d, "c" + d,
+                      indent + INDENT_2, depth + 1);
+        ostream << indent << INDENT_2 << dst << "[k" << d << "] = c" << d
+                << NL;
+      } else {
+        ostream << indent << INDENT_2 << dst << "[k" << d << "] = v" << d
+                << NL;
+      }
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_oneof() && use_inline_oneof_) {
+      // Only the alternative that is set can hold anything.
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      auto name = inline_oneof_names_.at(oneof);
+      ostream << indent << "switch " << src << ".kind {" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt = oneof_field.get_type().get();
+        if (!needs_deep_copy(alt)) {
+          continue;
+        }
+        auto v = ".v" + capitalize(oneof_field.get_name());
+        ostream << indent << "case " << name << "_"
+                << capitalize(oneof_field.get_name()) << ":" << NL;
+        generate_copy(ostream, struct_type, alt, src + v, dst + v,
+                      indent + INDENT_1, depth + 1);
+      }
+      ostream << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      // Every alternative is a pointer to a wrapper struct, copied anew.
+      ostream << indent << "switch v" << d << " := " << src << ".(type) {"
+              << NL;
+      for (const auto& oneof_field :
+           dynamic_cast<const OneofType*>(type)->get_fields()) {
+        auto alt = oneof_field.get_type().get();
+        auto wrapper = capitalize(struct_type->get_name()) +
+                       capitalize(oneof_field.get_name());
+        ostream << indent << "case *" << wrapper << ":" << NL << indent
+                << INDENT_1 << "c" << d << " := *v" << d << NL;
+        if (needs_deep_copy(alt)) {
+          auto member = "." + capitalize(oneof_field.get_name());
+          generate_copy(ostream, struct_type, alt, "v" + d + member,
+                        "c" + d + member, indent + INDENT_1, depth + 1);
+        }
+        ostream << indent << INDENT_1 << dst << " = &c" << d << NL;
+      }
+      ostream << indent << "}" << NL;
+    }
+  }
+
+  // A pool per struct type; ReleaseX resets the value before pooling it,
+  // so AcquireX always hands out a zero value, with storage to reuse.
+  void generate_object_pool(std::ostream& ostream,
+                            const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    auto pool = "tm" + struct_name + "Pool";
+    ostream << "var " << pool
+            << " = sync.Pool{New: func() interface{} { return new("
+            << struct_name << ") }}" << NL2 << "// Acquire" << struct_name
+            << " returns a reset " << struct_name << ", from the pool if it "
+            << "has one." << NL << "func Acquire" << struct_name << "() *"
+            << struct_name << " {" << NL << INDENT_1 << "return " << pool
+            << ".Get().(*" << struct_name << ")" << NL << "}" << NL2
+            << "// Release" << struct_name
+            << " resets m and puts it back in the pool. m must not be used "
+               "after."
+            << NL << "func Release" << struct_name << "(m *" << struct_name
+            << ") {" << NL << INDENT_1 << "m.Reset()" << NL << INDENT_1 << pool
+            << ".Put(m)" << NL << "}" << NL2;
+  }
+
+  // Setting a field directly does not mark it present, SetX does.
+  void generate_presence_accessors(std::ostream& ostream,
+                                   const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    for (const auto& field : struct_type->get_fields()) {
+      if (!has_presence_bit(field)) {
+        continue;
+      }
+      auto name = capitalize(field.get_name());
+      auto type = field.get_type().get();
+      auto [word, mask] = presence_bit(struct_type, field);
+      std::string zero = "0";
+      if (type->is_primitive()) {
+        auto primitive = dynamic_cast<const PrimitiveType*>(type);
+        zero = primitive->is_bool()     ? "false"
+               : primitive->is_string() ? "\"\""
+                                        : "0";
+      }
+      ostream << "// Has" << name << " reports whether " << name
+              << " is set." << NL << "func (m *" << struct_name << ") Has"
+              << name << "() bool {" << NL << INDENT_1 << "return " << word
+              << "&" << mask << " != 0" << NL << "}" << NL2 << "// Set" << name
+              << " sets " << name << " and marks it present." << NL
+              << "func (m *" << struct_name << ") Set" << name << "(v "
+              << type_to_go_type(type) << ") {" << NL << INDENT_1 << "m."
+              << name << " = v" << NL << INDENT_1 << word << " |= " << mask
+              << NL << "}" << NL2 << "// Clear" << name
+              << " zeroes " << name << " and marks it absent." << NL
+              << "func (m *" << struct_name << ") Clear" << name << "() {"
+              << NL << INDENT_1 << "m." << name << " = " << zero << NL
+              << INDENT_1 << word << " &^= " << mask << NL << "}" << NL2;
+    }
+  }
+
+  // String indexes an array when the values are dense and a perfect hash
+  // table otherwise; ParseX looks up the declared names through a perfect
+  // hash of their FNV-1a hash. Both fall back to a switch when no perfect
+  // hash is found.
+  void generate_enum_lookups(std::ostream& ostream,
+                             const EnumType* enum_type) {
+    auto name = capitalize(enum_type->get_name());
+    auto fields = enum_type->get_fields();
+    auto constant = [&](std::size_t i) {
+      return name + "_" + fields[i].get_name();
+    };
+    auto entry = [&](int i) {
+      return i < 0 ? std::string("{}")
+                   : "{\"" + fields[i].get_name() + "\", " + constant(i) + "}";
+    };
+    auto entry_type = std::string("struct {") + NL + INDENT_1 +
+                      "name  string" + NL + INDENT_1 + "value " + name + NL +
+                      "}";
+
+    std::vector<std::uint32_t> values;
+    std::vector<std::uint32_t> names;
+    for (const auto& field : fields) {
+      values.push_back(static_cast<std::uint32_t>(field.get_value()));
+      names.push_back(fnv1a(field.get_name()));
+    }
+    auto value_hash = enum_type->is_dense() ? std::nullopt
+                                            : find_perfect_hash(values);
+    auto name_hash = find_perfect_hash(names);
+
+    ostream << "// String returns the declared name of e, or its number if it "
+               "has none."
+            << NL;
+    if (enum_type->is_dense()) {
+      std::vector<std::string> slots(enum_type->get_value_span(), "\"\"");
+      for (std::size_t i = fields.size(); i-- > 0;) {
+        slots[fields[i].get_value() - enum_type->get_min_value()] =
+            "\"" + fields[i].get_name() + "\"";
+      }
+      auto min = static_cast<std::int64_t>(enum_type->get_min_value());
+      ostream << "func (e " << name << ") String() string {" << NL << INDENT_1
+              << "if e >= " << min << " && e <= " << enum_type->get_max_value()
+              << " {" << NL << INDENT_2 << "if s := tm" << name
+              << "Names[int(e)"
+              << (min < 0 ? "+" + std::to_string(-min)
+                          : "-" + std::to_string(min))
+              << "]; s != \"\" {" << NL << INDENT_3 << "return s" << NL
+              << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL << INDENT_1
+              << "return strconv.Itoa(int(e))" << NL << "}" << NL2 << "var tm"
+              << name << "Names = [...]string{" << go_list(slots) << "}" << NL2;
+    } else if (value_hash.has_value()) {
+      std::vector<std::string> slots;
+      for (auto i : value_hash->slots) {
+        slots.push_back(entry(i));
+      }
+      ostream << "func (e " << name << ") String() string {" << NL << INDENT_1
+              << "s := &tm" << name << "ByNumber[(uint32(e)*"
+              << hex(value_hash->multiplier) << ")>>" << value_hash->shift()
+              << "]" << NL << INDENT_1 << "if s.name != \"\" && s.value == e {"
+              << NL << INDENT_2 << "return s.name" << NL << INDENT_1 << "}"
+              << NL << INDENT_1 << "return strconv.Itoa(int(e))" << NL << "}"
+              << NL2 << "var tm" << name << "ByNumber = ["
+              << value_hash->slots.size() << "]" << entry_type << "{"
+              << go_list(slots) << "}" << NL2;
+    } else {
+      ostream << "func (e " << name << ") String() string {" << NL << INDENT_1
+              << "switch e {" << NL;
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        ostream << INDENT_1 << "case " << constant(i) << ":" << NL << INDENT_2
+                << "return \"" << fields[i].get_name() << "\"" << NL;
+      }
+      ostream << INDENT_1 << "}" << NL << INDENT_1
+              << "return strconv.Itoa(int(e))" << NL << "}" << NL2;
+    }
+
+    ostream << "// Parse" << name << " returns the " << name
+            << " declared as name." << NL << "func Parse" << name
+            << "(name string) (" << name << ", bool) {" << NL;
+    if (name_hash.has_value()) {
+      std::vector<std::string> slots;
+      for (auto i : name_hash->slots) {
+        slots.push_back(entry(i));
+      }
+      ostream << INDENT_1 << "h := uint32(2166136261)" << NL << INDENT_1
+              << "for i := 0; i < len(name); i++ {" << NL << INDENT_2
+              << "h = (h ^ uint32(name[i])) * 16777619" << NL << INDENT_1 << "}"
+              << NL << INDENT_1 << "s := &tm" << name << "ByName[(h*"
+              << hex(name_hash->multiplier) << ")>>" << name_hash->shift()
+              << "]" << NL << INDENT_1
+              << "if name != \"\" && s.name == name {" << NL << INDENT_2
+              << "return s.value, true" << NL << INDENT_1 << "}" << NL
+              << INDENT_1 << "return 0, false" << NL << "}" << NL2 << "var tm"
+              << name << "ByName = [" << name_hash->slots.size() << "]"
+              << entry_type << "{" << go_list(slots) << "}" << NL;
+    } else {
+      ostream << INDENT_1 << "switch name {" << NL;
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        ostream << INDENT_1 << "case \"" << fields[i].get_name() << "\":" << NL
+                << INDENT_2 << "return " << constant(i) << ", true" << NL;
+      }
+      ostream << INDENT_1 << "}" << NL << INDENT_1 << "return 0, false" << NL
+              << "}" << NL;
+    }
+  }
+
+  static std::string go_list(const std::vector<std::string>& elements) {
+    std::string list;
+    for (const auto& element : elements) {
+      list += (list.empty() ? "" : ", ") + element;
+    }
+    return list;
+  }
+
+  static std::string hex(std::uint32_t value) {
+    char hex[16];
+    std::snprintf(hex, sizeof(hex), "0x%08x", value);
+    return hex;
+  }
+
+  // 32-bit FNV-1a, as computed by the generated ParseX functions.
+  static std::uint32_t fnv1a(const std::string& str) {
+    std::uint32_t hash = 2166136261u;
+    for (unsigned char c : str) {
+      hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+  }
+
+  // Go package names are lower case identifiers, derive one from the source
+  // file name when the `go_package` option is not given.
+  static std::string go_package_name(const std::filesystem::path& stem) {
+    std::string name;
+    for (char c : stem.string()) {
+      name.push_back(std::isalnum(static_cast<unsigned char>(c))
+                         ? static_cast<char>(std::tolower(c))
+                         : '_');
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+      name.insert(0, "_");
+    }
+    return name;
+  }
+
+  // The JSON codec appends into a caller supplied buffer on encode and
+  // dispatches on the field name with a switch on decode, so neither
+  // direction goes through reflection. Keys are escaped at code generation
+  // time and written as constants.
+  void generate_json_codec(std::ostream& ostream,
+                           const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    auto fields = struct_type->get_fields();
+
+    // encode
+    ostream << "// AppendJSON appends the JSON encoding of m to b." << NL
+            << "func (m *" << struct_name << ") AppendJSON(b []byte) []byte {"
+            << NL;
+    if (fields.empty()) {
+      ostream << INDENT_1 << "return append(b, \"{}\"...)" << NL << "}" << NL2;
+    } else {
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        const auto& field = fields[i];
+        ostream << INDENT_1 << "b = append(b, `" << (i == 0 ? "{" : ",")
+                << "\"" << field.get_name() << "\":`...)" << NL;
+        generate_json_encode_field(ostream, struct_type, field, INDENT_1, "");
+      }
+      ostream << INDENT_1 << "return append(b, '}')" << NL << "}" << NL2;
+    }
+
+    ostream << "func (m " << struct_name << ") MarshalJSON() ([]byte, error) {"
+            << NL << INDENT_1
+            << "return m.AppendJSON(make([]byte, 0, 128)), nil" << NL << "}"
+            << NL2;
+
+    // decode
+    ostream << "func (m *" << struct_name
+            << ") UnmarshalJSON(data []byte) error {" << NL << INDENT_1
+            << "d := tmJSONDecoder{data: data}" << NL << INDENT_1
+            << "m.decodeJSON(&d)" << NL;
+    generate_decoded_return(ostream, struct_type, "d.end()");
+    ostream << "}" << NL2;
+
+    ostream << "// DecodeJSON resets m and decodes data into it, reusing its "
+               "storage. Lists"
+            << NL
+            << "// and maps that are not optional and absent from data are "
+               "left empty, not nil."
+            << NL << "func (m *" << struct_name
+            << ") DecodeJSON(data []byte) error {" << NL << INDENT_1
+            << "m.Reset()" << NL << INDENT_1 << "return m.UnmarshalJSON(data)"
+            << NL << "}" << NL2;
+
+    ostream << "func (m *" << struct_name << ") decodeJSON(d *tmJSONDecoder) {"
+            << NL << INDENT_1 << "if d.null() || !d.begin('{') {" << NL
+            << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "for i := 0; d.more('}', i); i++ {" << NL << INDENT_2
+            << "switch string(d.key()) {" << NL;
+    for (const auto& field : fields) {
+      ostream << INDENT_2 << "case \"" << field.get_name() << "\":" << NL;
+      generate_json_decode_field(ostream, struct_type, field, INDENT_3);
+    }
+    ostream << INDENT_2 << "default:" << NL << INDENT_3 << "d.skip()" << NL
+            << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL << "}" << NL2;
+  }
+
+  // A streaming decoder reads the object from an io.Reader a value at a
+  // time. The elements of each list with a handler are decoded into a
+  // single variable and passed on instead of being stored, so the memory
+  // it needs is bounded by the largest element rather than by the object.
+  void generate_json_stream(std::ostream& ostream,
+                            const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    auto stream_name = struct_name + "Stream";
+    std::vector<Field> lists;
+    for (const auto& field : struct_type->get_fields()) {
+      if (field.get_type()->is_list()) {
+        lists.push_back(field);
+      }
+    }
+    ostream << "// " << stream_name << " holds the handlers that "
+            << struct_name << ".DecodeJSONStream passes list" << NL
+            << "// elements to, with their index. Structs and lists are "
+               "passed in a variable"
+            << NL << "// that is reused for the next element." << NL << "type "
+            << stream_name << " struct {" << NL;
+    for (const auto& field : lists) {
+      auto elem_type = dynamic_cast<const ListType*>(field.get_type().get())
+                           ->get_elem_type()
+                           .get();
+      ostream << INDENT_1 << capitalize(field.get_name()) << " func(i int, v "
+              << (elem_type->is_struct() ? "*" : "")
+              << type_to_go_type(elem_type) << ") error" << NL;
+    }
+    ostream << "}" << NL2;
+
+    ostream << "// DecodeJSONStream resets m and decodes the JSON object read "
+               "from r into it,"
+            << NL
+            << "// except that the elements of each list with a handler in h "
+               "are passed to"
+            << NL
+            << "// the handler as they are read, leaving the list empty. A "
+               "handler error"
+            << NL << "// stops the decoding and is returned. Elements are "
+                     "validated, m is not."
+            << NL << "func (m *" << struct_name
+            << ") DecodeJSONStream(r io.Reader, h *" << stream_name
+            << ") error {" << NL << INDENT_1 << "m.Reset()" << NL << INDENT_1
+            << "s := tmJSONStream{r: r}" << NL << INDENT_1
+            << "if s.null() || !s.begin('{') {" << NL << INDENT_2
+            << "return s.end()" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "for i := 0; s.more('}', i); i++ {" << NL << INDENT_2
+            << "switch string(s.key()) {" << NL;
+    for (const auto& field : struct_type->get_fields()) {
+      ostream << INDENT_2 << "case \"" << field.get_name() << "\":" << NL;
+      if (!field.get_type()->is_list()) {
+        ostream << INDENT_3 << "d := s.value()" << NL;
+        generate_json_decode_field(ostream, struct_type, field, INDENT_3);
+        ostream << INDENT_3 << "s.done(d)" << NL;
+        continue;
+      }
+      auto handler = "h." + capitalize(field.get_name());
+      auto elem_type = dynamic_cast<const ListType*>(field.get_type().get())
+                           ->get_elem_type()
+                           .get();
+      ostream << INDENT_3 << "if " << handler << " == nil {" << NL << INDENT_4
+              << "d := s.value()" << NL;
+      generate_json_decode_field(ostream, struct_type, field, INDENT_4);
+      ostream << INDENT_4 << "s.done(d)" << NL << INDENT_3
+              << "} else if !s.null() && s.begin('[') {" << NL << INDENT_4
+              << "var v " << type_to_go_type(elem_type) << NL << INDENT_4
+              << "for j := 0; s.more(']', j); j++ {" << NL << INDENT_4
+              << INDENT_1 << "d := s.value()" << NL;
+      if (elem_type->is_struct()) {
+        ostream << INDENT_4 << INDENT_1 << "v.Reset()" << NL;
+      }
+      generate_json_decode(ostream, struct_type, elem_type, "v",
+                           INDENT_4 INDENT_1, 1);
+      ostream << INDENT_4 << INDENT_1 << "if !s.done(d) {" << NL << INDENT_4
+              << INDENT_2 << "break" << NL << INDENT_4 << INDENT_1 << "}"
+              << NL;
+      if (needs_validation(elem_type)) {
+        ostream << INDENT_4 << INDENT_1
+                << "if err := v.Validate(); err != nil {" << NL << INDENT_4
+                << INDENT_2 << "s.halt(tmInvalidIn(err, tmIndex(\""
+                << field.get_name() << "\", j)))" << NL << INDENT_4
+                << INDENT_2 << "break" << NL << INDENT_4 << INDENT_1 << "}"
+                << NL;
+      }
+      ostream << INDENT_4 << INDENT_1 << "if err := " << handler << "(j, "
+              << (elem_type->is_struct() ? "&v" : "v") << "); err != nil {"
+              << NL << INDENT_4 << INDENT_2 << "s.halt(err)" << NL << INDENT_4
+              << INDENT_1 << "}" << NL << INDENT_4 << "}" << NL << INDENT_3
+              << "}" << NL;
+    }
+    ostream << INDENT_2 << "default:" << NL << INDENT_3 << "s.skip()" << NL
+            << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "return s.end()" << NL << "}" << NL2;
+  }
+
+  // A mask has a bit per field, set when the field is selected, and a
+  // mask of its own per field that holds structs, in lists and maps too,
+  // nil when the field is selected whole. Paths are parsed once, with a
+  // switch per struct, so encoding with a mask only tests bits.
+  void generate_field_mask(std::ostream& ostream,
+                           const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    auto mask_type = struct_name + "Mask";
+    auto fields = struct_type->get_fields();
+    ostream << "// " << mask_type << " selects the fields of a " << struct_name
+            << " that AppendJSONMask writes." << NL
+            << "// It is immutable once parsed, so it can be shared by "
+               "goroutines."
+            << NL << "type " << mask_type << " struct {" << NL << INDENT_1
+            << "fields ";
+    if (fields.size() > 64) {
+      ostream << "[" << (fields.size() + 63) / 64 << "]";
+    }
+    ostream << "uint64" << NL;
+    for (const auto& field : fields) {
+      if (auto held = masked_struct(field.get_type().get()); held) {
+        ostream << INDENT_1 << field_mask_name(field) << " *"
+                << capitalize(held->get_name()) << "Mask" << NL;
+      }
+    }
+    ostream << "}" << NL2 << "// Parse" << mask_type
+            << " parses comma separated field paths, such as \"id,a.b\". A "
+               "path"
+            << NL
+            << "// through a list or a map selects the fields of every "
+               "element."
+            << NL << "func Parse" << mask_type << "(paths string) (*"
+            << mask_type << ", error) {" << NL << INDENT_1 << "k := new("
+            << mask_type << ")" << NL << INDENT_1 << "if paths == \"\" {"
+            << NL << INDENT_2 << "return k, nil" << NL << INDENT_1 << "}" << NL
+            << INDENT_1 << "for more := true; more; {" << NL << INDENT_2
+            << "var path string" << NL << INDENT_2
+            << "path, paths, more = tmCut(paths, ',')" << NL << INDENT_2
+            << "if !k.add(path) {" << NL << INDENT_3
+            << "return nil, &ToolmanMaskError{Path: path}" << NL << INDENT_2
+            << "}" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "return k, nil" << NL << "}" << NL2;
+
+    auto nested_used = false;
+    for (const auto& field : fields) {
+      nested_used = nested_used || masked_struct(field.get_type().get());
+    }
+    ostream << "func (k *" << mask_type << ") add(path string) bool {" << NL
+            << INDENT_1 << "name, "
+            << (nested_used ? "rest" : "_") << ", nested := tmCut(path, '.')"
+            << NL << INDENT_1 << "switch name {" << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto& field = fields[i];
+      auto [word, bit] = field_mask_bit(struct_type, i);
+      ostream << INDENT_1 << "case \"" << field.get_name() << "\":" << NL;
+      auto held = masked_struct(field.get_type().get());
+      if (!held) {
+        ostream << INDENT_2 << word << " |= " << bit << NL << INDENT_2
+                << "return !nested" << NL;
+        continue;
+      }
+      auto sub = "k." + field_mask_name(field);
+      auto sub_type = capitalize(held->get_name()) + "Mask";
+      ostream << INDENT_2 << "if !nested {" << NL << INDENT_3 << word
+              << " |= " << bit << NL << INDENT_3 << sub << " = nil" << NL
+              << INDENT_3 << "return true" << NL << INDENT_2 << "}" << NL
+              << INDENT_2 << "if " << word << "&" << bit << " != 0 && " << sub
+              << " == nil {" << NL << INDENT_3
+              << "// Selected whole already, the path only has to be valid."
+              << NL << INDENT_3 << "return new(" << sub_type << ").add(rest)"
+              << NL << INDENT_2 << "}" << NL << INDENT_2 << "if " << sub
+              << " == nil {" << NL << INDENT_3 << sub << " = new(" << sub_type
+              << ")" << NL << INDENT_2 << "}" << NL << INDENT_2 << word
+              << " |= " << bit << NL << INDENT_2 << "return " << sub
+              << ".add(rest)" << NL;
+    }
+    ostream << INDENT_1 << "default:" << NL << INDENT_2 << "return false" << NL
+            << INDENT_1 << "}" << NL << "}" << NL2;
+
+    ostream << "// AppendJSONMask appends the JSON encoding of the fields of m "
+               "that k selects"
+            << NL << "// to b, of all of them if k is nil." << NL << "func (m *"
+            << struct_name << ") AppendJSONMask(b []byte, k *" << mask_type
+            << ") []byte {" << NL << INDENT_1 << "if k == nil {" << NL
+            << INDENT_2 << "return m.AppendJSON(b)" << NL << INDENT_1 << "}"
+            << NL << INDENT_1 << "c := byte('{')" << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto& field = fields[i];
+      auto [word, bit] = field_mask_bit(struct_type, i);
+      ostream << INDENT_1 << "if " << word << "&" << bit << " != 0 {" << NL
+              << INDENT_2 << "b = append(b, c)" << NL << INDENT_2
+              << "b = append(b, `\"" << field.get_name() << "\":`...)" << NL
+              << INDENT_2 << "c = ','" << NL;
+      generate_json_encode_field(
+          ostream, struct_type, field, INDENT_2,
+          masked_struct(field.get_type().get())
+              ? "k." + field_mask_name(field)
+              : "");
+      ostream << INDENT_1 << "}" << NL;
+    }
+    ostream << INDENT_1 << "if c == '{' {" << NL << INDENT_2
+            << "b = append(b, c)" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "return append(b, '}')" << NL << "}" << NL2;
+  }
+
+  // The struct whose fields a mask path goes on into, through lists and
+  // map values; oneofs are only selected whole.
+  static const StructType* masked_struct(const Type* type) {
+    if (type->is_list()) {
+      return masked_struct(
+          dynamic_cast<const ListType*>(type)->get_elem_type().get());
+    } else if (type->is_map()) {
+      return masked_struct(
+          dynamic_cast<const MapType*>(type)->get_value_type().get());
+    }
+    return type->is_struct() ? dynamic_cast<const StructType*>(type)
+                             : nullptr;
+  }
+
+  static std::string field_mask_name(const Field& field) {
+    return camelcase(field.get_name()) + "Mask";
+  }
+
+  // Returns the word of `k` holding the bit of the field at `index`, and
+  // its mask.
+  static std::pair<std::string, std::string> field_mask_bit(
+      const StructType* struct_type, std::size_t index) {
+    char bit[32];
+    std::snprintf(bit, sizeof(bit), "0x%llx", 1ULL << (index % 64));
+    if (struct_type->get_fields().size() > 64) {
+      return {"k.fields[" + std::to_string(index / 64) + "]", bit};
+    }
+    return {"k.fields", bit};
+  }
+
+  // Emits statements that append the JSON value of `field` of `m` to `b`.
+  // `mask`, if any, is passed on to the structs in it.
+  void generate_json_encode_field(std::ostream& ostream,
+                                  const StructType* struct_type,
+                                  const Field& field,
+                                  const std::string& indent,
+                                  const std::string& mask) {
+    auto expr = "m." + capitalize(field.get_name());
+    auto type = field.get_type().get();
+    if (has_presence_bit(field)) {
+      auto [word, bit] = presence_bit(struct_type, field);
+      ostream << indent << "if " << word << "&" << bit << " == 0 {" << NL
+              << indent << INDENT_1 << "b = append(b, \"null\"...)" << NL
+              << indent << "} else {" << NL;
+      generate_json_encode(ostream, struct_type, type, expr, indent + INDENT_1,
+                           1, mask);
+      ostream << indent << "}" << NL;
+    } else if (is_pointer_field(field)) {
+      ostream << indent << "if " << expr << " == nil {" << NL << indent
+              << INDENT_1 << "b = append(b, \"null\"...)" << NL << indent
+              << "} else {" << NL;
+      generate_json_encode(ostream, struct_type, type, "(*" + expr + ")",
+                           indent + INDENT_1, 1, mask);
+      ostream << indent << "}" << NL;
+    } else {
+      generate_json_encode(ostream, struct_type, type, expr, indent, 1, mask);
+    }
+  }
+
+  // Emits statements that decode the next JSON value from `d` into `field`
+  // of `m`.
+  void generate_json_decode_field(std::ostream& ostream,
+                                  const StructType* struct_type,
+                                  const Field& field,
+                                  const std::string& indent) {
+    auto target = "m." + capitalize(field.get_name());
+    auto type = field.get_type().get();
+    if (has_presence_bit(field)) {
+      auto [word, mask] = presence_bit(struct_type, field);
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << "m.Clear" << capitalize(field.get_name()) << "()" << NL
+              << indent << "} else {" << NL;
+      generate_json_decode(ostream, struct_type, type, target,
+                           indent + INDENT_1, 1);
+      ostream << indent << INDENT_1 << word << " |= " << mask << NL << indent
+              << "}" << NL;
+    } else if (is_pointer_field(field)) {
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << target << " = nil" << NL << indent << "} else {" << NL
+              << indent << INDENT_1 << "if " << target << " == nil {" << NL
+              << indent << INDENT_2 << target << " = new("
+              << (type->is_oneof() ? gen_oneof_name(struct_type->get_name(),
+                                                    field.get_name())
+                                   : type_to_go_type(type))
+              << ")" << NL << indent << INDENT_1 << "}" << NL;
+      generate_json_decode(ostream, struct_type, type, "(*" + target + ")",
+                           indent + INDENT_1, 1);
+      ostream << indent << "}" << NL;
+    } else {
+      generate_json_decode(ostream, struct_type, type, target, indent, 1);
+    }
+  }
+
+  // Returns the error of a decoder, then the first constraint the decoded
+  // value breaks.
+  static void generate_decoded_return(std::ostream& ostream,
+                                      const StructType* struct_type,
+                                      const std::string& err) {
+    if (!needs_validation(struct_type)) {
+      ostream << INDENT_1 << "return " << err << NL;
+      return;
+    }
+    ostream << INDENT_1 << "if err := " << err << "; err != nil {" << NL
+            << INDENT_2 << "return err" << NL << INDENT_1 << "}" << NL
+            << INDENT_1 << "return m.Validate()" << NL;
+  }
+
+  // Emits statements that append the JSON encoding of `expr` to `b`.
+  // `depth` keeps the names of nested loop variables unique. Structs in
+  // `expr` are encoded with `mask`, if there is one.
+  void generate_json_encode(std::ostream& ostream,
+                            const StructType* struct_type, const Type* type,
+                            const std::string& expr,
+                            const std::string& indent, int depth,
+                            const std::string& mask = "") {
+    auto d = std::to_string(depth);
     if (type->is_primitive()) {
-      auto primitive = dynamic_cast<PrimitiveType*>(type);
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      ostream << indent << "b = ";
+      if (primitive->is_bool()) {
+        ostream << "strconv.AppendBool(b, " << expr << ")";
+      } else if (primitive->is_i32() || primitive->is_i64()) {
+        ostream << "strconv.AppendInt(b, int64(" << expr << "), 10)";
+      } else if (primitive->is_u32() || primitive->is_u64()) {
+        ostream << "strconv.AppendUint(b, uint64(" << expr << "), 10)";
+      } else if (primitive->is_float()) {
+        ostream << "tmAppendFloat(b, " << expr << ")";
+      } else if (primitive->is_string()) {
+        ostream << "tmAppendString(b, " << expr << ")";
+      } else {
+        ostream << "tmAppendAny(b, " << expr << ")";
+      }
+      ostream << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << "b = strconv.AppendInt(b, int64(" << expr
+              << "), 10)" << NL;
+    } else if (type->is_struct() && !mask.empty()) {
+      ostream << indent << "b = " << expr << ".AppendJSONMask(b, " << mask
+              << ")" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << "b = " << expr << ".AppendJSON(b)" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      ostream << indent << "if " << expr << " == nil {" << NL << indent
+              << INDENT_1 << "b = append(b, \"null\"...)" << NL << indent
+              << "} else {" << NL << indent << INDENT_1 << "b = append(b, '[')"
+              << NL << indent << INDENT_1 << "for i" << d << " := range "
+              << expr << " {" << NL << indent << INDENT_2 << "if i" << d
+              << " > 0 {" << NL << indent << INDENT_3 << "b = append(b, ',')"
+              << NL << indent << INDENT_2 << "}" << NL;
+      generate_json_encode(ostream, struct_type,
+                           list->get_elem_type().get(),
+                           expr + "[i" + d + "]", indent + INDENT_2,
+                           depth + 1, mask);
+      ostream << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "b = append(b, ']')" << NL << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      auto key = map->get_key_type();
+      // Keys are written in the order encoding/json writes them, sorted by
+      // their JSON text, so that the output is deterministic. They are
+      // collected at the width the runtime sorts them at.
+      auto sort = json_key_sort(key.get());
+      auto key_type = type_to_go_type(key.get());
+      auto widened = sort.first != key_type;
+      ostream << indent << "if " << expr << " == nil {" << NL << indent
+              << INDENT_1 << "b = append(b, \"null\"...)" << NL << indent
+              << "} else {" << NL << indent << INDENT_1 << "b = append(b, '{')"
+              << NL << indent << INDENT_1 << "keys" << d << " := make([]"
+              << sort.first << ", 0, len(" << expr << "))" << NL << indent
+              << INDENT_1 << "for k := range " << expr << " {" << NL << indent
+              << INDENT_2 << "keys" << d << " = append(keys" << d << ", "
+              << (widened ? sort.first + "(k)" : "k") << ")" << NL << indent
+              << INDENT_1 << "}" << NL << indent << INDENT_1 << sort.second
+              << "(keys" << d << ")" << NL << indent << INDENT_1 << "for i"
+              << d << ", k" << d << " := range keys" << d << " {" << NL
+              << indent << INDENT_2 << "if i" << d << " > 0 {" << NL << indent
+              << INDENT_3 << "b = append(b, ',')" << NL << indent << INDENT_2
+              << "}" << NL << indent << INDENT_2 << "v" << d << " := " << expr
+              << "[" << (widened ? key_type + "(k" + d + ")" : "k" + d)
+              << "]" << NL;
+      // JSON object keys are always strings.
+      if (key->is_string()) {
+        ostream << indent << INDENT_2 << "b = tmAppendString(b, k" << d << ")"
+                << NL;
+      } else {
+        ostream << indent << INDENT_2 << "b = append(b, '\"')" << NL;
+        generate_json_encode(ostream, struct_type, key.get(), "k" + d,
+                             indent + INDENT_2, depth + 1);
+        ostream << indent << INDENT_2 << "b = append(b, '\"')" << NL;
+      }
+      ostream << indent << INDENT_2 << "b = append(b, ':')" << NL;
+      generate_json_encode(ostream, struct_type,
+                           map->get_value_type().get(), "v" + d,
+                           indent + INDENT_2, depth + 1, mask);
+      ostream << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "b = append(b, '}')" << NL << indent << "}" << NL;
+    } else if (type->is_oneof() && use_inline_oneof_) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      auto name = inline_oneof_names_.at(oneof);
+      ostream << indent << "switch " << expr << ".kind {" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_name = capitalize(oneof_field.get_name());
+        ostream << indent << "case " << name << "_" << alt_name << ":" << NL
+                << indent << INDENT_1 << "b = append(b, `{\""
+                << oneof_field.get_name() << "\":`...)" << NL;
+        generate_json_encode(ostream, struct_type,
+                             oneof_field.get_type().get(),
+                             expr + ".v" + alt_name, indent + INDENT_1,
+                             depth + 1);
+        ostream << indent << INDENT_1 << "b = append(b, '}')" << NL;
+      }
+      ostream << indent << "default:" << NL << indent << INDENT_1
+              << "b = append(b, \"null\"...)" << NL << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      // A oneof is encoded as an object holding only the alternative that
+      // is set, e.g. {"radius":1.5}.
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      ostream << indent << "switch v" << d << " := " << expr << ".(type) {"
+              << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_name = capitalize(oneof_field.get_name());
+        ostream << indent << "case *" << capitalize(struct_type->get_name())
+                << alt_name << ":" << NL << indent << INDENT_1
+                << "b = append(b, `{\"" << oneof_field.get_name() << "\":`...)"
+                << NL;
+        generate_json_encode(ostream, struct_type,
+                             oneof_field.get_type().get(),
+                             "v" + d + "." + alt_name, indent + INDENT_1,
+                             depth + 1);
+        ostream << indent << INDENT_1 << "b = append(b, '}')" << NL;
+      }
+      ostream << indent << "default:" << NL << indent << INDENT_1
+              << "b = append(b, \"null\"...)" << NL << indent << "}" << NL;
+    }
+  }
+
+  // Emits statements that decode the next JSON value into `target`, which
+  // must be addressable.
+  void generate_json_decode(std::ostream& ostream,
+                            const StructType* struct_type, const Type* type,
+                            const std::string& target,
+                            const std::string& indent, int depth) {
+    auto d = std::to_string(depth);
+    if (type->is_primitive()) {
+      ostream << indent << target << " = "
+              << json_read_primitive(dynamic_cast<const PrimitiveType*>(type))
+              << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << target << " = " << capitalize(type->get_name())
+              << "(d.int(32))" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << target << ".decodeJSON(d)" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      auto elem_type = type_to_go_type(list->get_elem_type().get());
+      // Reuse the capacity of a slice that is decoded into again.
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << target << " = nil" << NL << indent
+              << "} else if d.begin('[') {" << NL << indent << INDENT_1
+              << "if " << target << " == nil {" << NL << indent << INDENT_2
+              << target << " = make([]" << elem_type << ", 0)" << NL << indent
+              << INDENT_1 << "} else {" << NL << indent << INDENT_2 << target
+              << " = " << target << "[:0]" << NL << indent << INDENT_1 << "}"
+              << NL << indent << INDENT_1 << "for i" << d
+              << " := 0; d.more(']', i" << d << "); i" << d << "++ {" << NL;
+      if (list->get_elem_type()->is_struct()) {
+        // Decode structs in place, into the old elements while they last.
+        ostream << indent << INDENT_2 << "if len(" << target << ") < cap("
+                << target << ") {" << NL << indent << INDENT_3 << target
+                << " = " << target << "[:len(" << target << ")+1]" << NL
+                << indent << INDENT_3 << target << "[i" << d << "].Reset()"
+                << NL << indent << INDENT_2 << "} else {" << NL << indent
+                << INDENT_3 << target << " = append(" << target << ", "
+                << elem_type << "{})" << NL << indent << INDENT_2 << "}"
+                << NL;
+        generate_json_decode(ostream, struct_type,
+                             list->get_elem_type().get(),
+                             target + "[i" + d + "]", indent + INDENT_2,
+                             depth + 1);
+      } else {
+        ostream << indent << INDENT_2 << "var v" << d << " " << elem_type
+                << NL;
+        generate_json_decode(ostream, struct_type,
+                             list->get_elem_type().get(), "v" + d,
+                             indent + INDENT_2, depth + 1);
+        ostream << indent << INDENT_2 << target << " = append(" << target
+                << ", v" << d << ")" << NL;
+      }
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      auto key = map->get_key_type();
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << target << " = nil" << NL << indent
+              << "} else if d.begin('{') {" << NL << indent << INDENT_1
+              << "if " << target << " == nil {" << NL << indent << INDENT_2
+              << target << " = make(" << type_to_go_type(type) << ")" << NL
+              << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "for i" << d << " := 0; d.more('}', i" << d << "); i" << d
+              << "++ {" << NL << indent << INDENT_2 << "k" << d << " := "
+              << json_read_key(key.get()) << NL << indent << INDENT_2 << "var v"
+              << d << " " << type_to_go_type(map->get_value_type().get())
+              << NL;
+      generate_json_decode(ostream, struct_type,
+                           map->get_value_type().get(), "v" + d,
+                           indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_2 << target << "[k" << d << "] = v" << d
+              << NL << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_oneof() && use_inline_oneof_) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      auto name = inline_oneof_names_.at(oneof);
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << target << ".Clear()" << NL << indent
+              << "} else if d.begin('{') {" << NL << indent << INDENT_1
+              << "for i" << d << " := 0; d.more('}', i" << d << "); i" << d
+              << "++ {" << NL << indent << INDENT_2
+              << "switch string(d.key()) {" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_name = capitalize(oneof_field.get_name());
+        ostream << indent << INDENT_2 << "case \"" << oneof_field.get_name()
+                << "\":" << NL << indent << INDENT_3 << target << " = "
+                << name << "{kind: " << name << "_" << alt_name << "}" << NL;
+        generate_json_decode(ostream, struct_type,
+                             oneof_field.get_type().get(),
+                             target + ".v" + alt_name, indent + INDENT_3,
+                             depth + 1);
+      }
+      ostream << indent << INDENT_2 << "default:" << NL << indent << INDENT_3
+              << "d.skip()" << NL << indent << INDENT_2 << "}" << NL << indent
+              << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      ostream << indent << "if d.null() {" << NL << indent << INDENT_1
+              << target << " = nil" << NL << indent
+              << "} else if d.begin('{') {" << NL << indent << INDENT_1
+              << "for i" << d << " := 0; d.more('}', i" << d << "); i" << d
+              << "++ {" << NL << indent << INDENT_2
+              << "switch string(d.key()) {" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        ostream << indent << INDENT_2 << "case \"" << oneof_field.get_name()
+                << "\":" << NL << indent << INDENT_3 << "v" << d << " := &"
+                << capitalize(struct_type->get_name())
+                << capitalize(oneof_field.get_name()) << "{}" << NL;
+        generate_json_decode(
+            ostream, struct_type, oneof_field.get_type().get(),
+            "v" + d + "." + capitalize(oneof_field.get_name()),
+            indent + INDENT_3, depth + 1);
+        ostream << indent << INDENT_3 << target << " = v" << d << NL;
+      }
+      ostream << indent << INDENT_2 << "default:" << NL << indent << INDENT_3
+              << "d.skip()" << NL << indent << INDENT_2 << "}" << NL << indent
+              << INDENT_1 << "}" << NL << indent << "}" << NL;
+    }
+  }
+
+  static std::string json_read_primitive(const PrimitiveType* primitive) {
+    if (primitive->is_bool()) {
+      return "d.bool()";
+    } else if (primitive->is_i32()) {
+      return "int32(d.int(32))";
+    } else if (primitive->is_i64()) {
+      return "d.int(64)";
+    } else if (primitive->is_u32()) {
+      return "uint32(d.uint(32))";
+    } else if (primitive->is_u64()) {
+      return "d.uint(64)";
+    } else if (primitive->is_float()) {
+      return "d.float()";
+    } else if (primitive->is_string()) {
+      return "d.str()";
+    }
+    return "d.any()";
+  }
+
+  // Map keys arrive as JSON strings, numeric keys are parsed out of them.
+  static std::string json_read_key(const PrimitiveType* key) {
+    if (key->is_bool()) {
+      return "d.keyBool(d.key())";
+    } else if (key->is_i32()) {
+      return "int32(d.parseInt(d.key(), 32))";
+    } else if (key->is_i64()) {
+      return "d.parseInt(d.key(), 64)";
+    } else if (key->is_u32()) {
+      return "uint32(d.parseUint(d.key(), 32))";
+    } else if (key->is_u64()) {
+      return "d.parseUint(d.key(), 64)";
+    } else if (key->is_float()) {
+      return "d.parseFloat(d.key())";
+    }
+    return "string(d.key())";
+  }
+
+  // The binary codec follows src/wire_format.h. Keys are known at code
+  // generation time and appended as byte constants; lengths are written
+  // after the value, see tmEndLen.
+  void generate_binary_codec(std::ostream& ostream,
+                             const StructType* struct_type) {
+    auto struct_name = capitalize(struct_type->get_name());
+    auto fields = struct_type->get_fields();
+
+    // encode
+    ostream << "// AppendBinary appends the binary encoding of m to b." << NL
+            << "func (m *" << struct_name
+            << ") AppendBinary(b []byte) []byte {" << NL;
+    for (const auto& field : fields) {
+      auto type = field.get_type().get();
+      auto expr = "m." + capitalize(field.get_name());
+      auto key = "b = append(b, " + binary_key(field) + ")";
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        ostream << INDENT_1 << "if " << word << "&" << mask << " != 0 {" << NL
+                << INDENT_2 << key << NL;
+        generate_binary_encode(ostream, struct_type, type, expr, INDENT_2, 1);
+        ostream << INDENT_1 << "}" << NL;
+      } else if (type->is_oneof() && use_inline_oneof_) {
+        ostream << INDENT_1 << "if " << expr << ".kind != "
+                << inline_oneof_names_.at(type) << "_None {" << NL << INDENT_2
+                << key << NL;
+        generate_binary_encode(ostream, struct_type, type, expr, INDENT_2, 1);
+        ostream << INDENT_1 << "}" << NL;
+      } else if (is_pointer_field(field) || type->is_list() || type->is_map() ||
+          type->is_oneof()) {
+        ostream << INDENT_1 << "if " << expr << " != nil {" << NL << INDENT_2
+                << key << NL;
+        generate_binary_encode(
+            ostream, struct_type, type,
+            is_pointer_field(field) ? "(*" + expr + ")" : expr, INDENT_2, 1);
+        ostream << INDENT_1 << "}" << NL;
+      } else {
+        ostream << INDENT_1 << key << NL;
+        generate_binary_encode(ostream, struct_type, type, expr, INDENT_1, 1);
+      }
+    }
+    ostream << INDENT_1 << "return b" << NL << "}" << NL2;
+
+    ostream << "func (m " << struct_name
+            << ") MarshalBinary() ([]byte, error) {" << NL << INDENT_1
+            << "return m.AppendBinary(make([]byte, 0, 64)), nil" << NL << "}"
+            << NL2;
+
+    // decode
+    ostream << "func (m *" << struct_name
+            << ") UnmarshalBinary(data []byte) error {" << NL << INDENT_1
+            << "*m = " << struct_name << "{}" << NL << INDENT_1
+            << "d := tmBinaryDecoder{data: data}" << NL << INDENT_1
+            << "m.decodeBinary(&d, len(data))" << NL;
+    generate_decoded_return(ostream, struct_type, "d.err");
+    ostream << "}" << NL2;
+
+    ostream << "// DecodeBinary resets m and decodes data into it, reusing "
+               "its storage. Lists"
+            << NL
+            << "// and maps that are not optional and absent from data are "
+               "left empty, not nil."
+            << NL << "func (m *" << struct_name
+            << ") DecodeBinary(data []byte) error {" << NL << INDENT_1
+            << "m.Reset()" << NL << INDENT_1
+            << "d := tmBinaryDecoder{data: data}" << NL << INDENT_1
+            << "m.decodeBinary(&d, len(data))" << NL;
+    generate_decoded_return(ostream, struct_type, "d.err");
+    ostream << "}" << NL2;
+
+    ostream << "func (m *" << struct_name
+            << ") decodeBinary(d *tmBinaryDecoder, end int) {" << NL
+            << INDENT_1 << "for d.pos < end {" << NL << INDENT_2
+            << "num, wt := d.key()" << NL << INDENT_2 << "switch num {" << NL;
+    for (const auto& field : fields) {
+      auto type = field.get_type().get();
+      auto target = "m." + capitalize(field.get_name());
+      ostream << INDENT_2 << "case " << field.get_number() << ":" << NL
+              << INDENT_3 << "if d.expect(wt, "
+              << static_cast<int>(wire_format::wire_type_of(type)) << ") {"
+              << NL;
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        generate_binary_decode(ostream, struct_type, type, target, INDENT_4,
+                               1);
+        ostream << INDENT_4 << word << " |= " << mask << NL;
+      } else if (is_pointer_field(field)) {
+        ostream << INDENT_4 << "if " << target << " == nil {" << NL << INDENT_4
+                << INDENT_1 << target << " = new("
+                << (type->is_oneof() ? gen_oneof_name(struct_type->get_name(),
+                                                      field.get_name())
+                                     : type_to_go_type(type))
+                << ")" << NL << INDENT_4 << "}" << NL;
+        generate_binary_decode(ostream, struct_type, type,
+                               "(*" + target + ")", INDENT_4, 1);
+      } else {
+        generate_binary_decode(ostream, struct_type, type, target, INDENT_4,
+                               1);
+      }
+      ostream << INDENT_3 << "}" << NL;
+    }
+    ostream << INDENT_2 << "default:" << NL << INDENT_3 << "d.skip(wt)" << NL
+            << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "d.done(end)" << NL << "}" << NL2;
+  }
+
+  // Emits statements that append the untagged binary encoding of `expr`.
+  void generate_binary_encode(std::ostream& ostream,
+                              const StructType* struct_type, const Type* type,
+                              const std::string& expr,
+                              const std::string& indent, int depth) {
+    auto d = std::to_string(depth);
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      ostream << indent << "b = ";
+      if (primitive->is_bool()) {
+        ostream << "tmAppendBool(b, " << expr << ")";
+      } else if (primitive->is_i32() || primitive->is_i64()) {
+        ostream << "tmAppendZigzag(b, int64(" << expr << "))";
+      } else if (primitive->is_u32() || primitive->is_u64()) {
+        ostream << "tmAppendVarint(b, uint64(" << expr << "))";
+      } else if (primitive->is_float()) {
+        ostream << "tmAppendFixed64(b, " << expr << ")";
+      } else if (primitive->is_string()) {
+        ostream << "tmAppendBytes(b, " << expr << ")";
+      } else {
+        // b is only reassigned once the call returns, so len(b)+1 is
+        // where the value starts whichever operand is evaluated first.
+        ostream << "tmEndLen(tmAppendAny(append(b, 0), " << expr
+                << "), len(b)+1)";
+      }
+      ostream << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << "b = tmAppendZigzag(b, int64(" << expr << "))"
+              << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << "b = tmEndLen(" << expr
+              << ".AppendBinary(append(b, 0)), len(b)+1)" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      ostream << indent << "b = append(b, 0)" << NL << indent << "s" << d
+              << " := len(b)" << NL << indent
+              << "b = tmAppendVarint(b, uint64(len(" << expr << ")))" << NL
+              << indent << "for i" << d << " := range " << expr << " {" << NL;
+      generate_binary_encode(ostream, struct_type,
+                             list->get_elem_type().get(),
+                             expr + "[i" + d + "]", indent + INDENT_1,
+                             depth + 1);
+      ostream << indent << "}" << NL << indent << "b = tmEndLen(b, s" << d
+              << ")" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      ostream << indent << "b = append(b, 0)" << NL << indent << "s" << d
+              << " := len(b)" << NL << indent
+              << "b = tmAppendVarint(b, uint64(len(" << expr << ")))" << NL
+              << indent << "for k" << d << ", v" << d << " := range " << expr
+              << " {" << NL;
+      generate_binary_encode(ostream, struct_type,
+                             map->get_key_type().get(), "k" + d,
+                             indent + INDENT_1, depth + 1);
+      generate_binary_encode(ostream, struct_type,
+                             map->get_value_type().get(), "v" + d,
+                             indent + INDENT_1, depth + 1);
+      ostream << indent << "}" << NL << indent << "b = tmEndLen(b, s" << d
+              << ")" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      ostream << indent << "b = append(b, 0)" << NL << indent << "s" << d
+              << " := len(b)" << NL << indent << "switch ";
+      if (use_inline_oneof_) {
+        ostream << expr << ".kind {" << NL;
+      } else {
+        ostream << "v" << d << " := " << expr << ".(type) {" << NL;
+      }
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_name = capitalize(oneof_field.get_name());
+        if (use_inline_oneof_) {
+          ostream << indent << "case " << inline_oneof_names_.at(oneof) << "_"
+                  << alt_name << ":" << NL;
+        } else {
+          ostream << indent << "case *" << capitalize(struct_type->get_name())
+                  << alt_name << ":" << NL;
+        }
+        ostream << indent << INDENT_1 << "b = append(b, "
+                << binary_key(oneof_field) << ")" << NL;
+        generate_binary_encode(
+            ostream, struct_type, oneof_field.get_type().get(),
+            (use_inline_oneof_ ? expr + ".v" : "v" + d + ".") + alt_name,
+            indent + INDENT_1, depth + 1);
+      }
+      ostream << indent << "}" << NL << indent << "b = tmEndLen(b, s" << d
+              << ")" << NL;
+    }
+  }
+
+  // Emits statements that decode the next untagged binary value into
+  // `target`, which must be addressable.
+  void generate_binary_decode(std::ostream& ostream,
+                              const StructType* struct_type, const Type* type,
+                              const std::string& target,
+                              const std::string& indent, int depth) {
+    auto d = std::to_string(depth);
+    if (type->is_primitive()) {
+      ostream << indent << target << " = "
+              << binary_read_primitive(dynamic_cast<const PrimitiveType*>(type))
+              << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << target << " = " << capitalize(type->get_name())
+              << "(d.zigzag())" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << target << ".decodeBinary(d, d.limit())" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      // Reuse the capacity of a slice that is decoded into again; struct
+      // elements left over from before are reset first. A nil slice is
+      // still replaced, so that an empty list does not decode as nil.
+      ostream << indent << "end" << d << " := d.limit()" << NL << indent
+              << "n" << d << " := d.count(end" << d << ")" << NL << indent
+              << "if " << target << " != nil && cap(" << target << ") >= n"
+              << d << " {" << NL << indent
+              << INDENT_1 << target << " = " << target << "[:n" << d << "]"
+              << NL << indent << "} else {" << NL << indent << INDENT_1
+              << target << " = make(" << type_to_go_type(type) << ", n" << d
+              << ")" << NL << indent << "}" << NL << indent << "for i" << d
+              << " := range " << target << " {" << NL;
+      if (list->get_elem_type()->is_struct()) {
+        ostream << indent << INDENT_1 << target << "[i" << d << "].Reset()"
+                << NL;
+      }
+      generate_binary_decode(ostream, struct_type,
+                             list->get_elem_type().get(),
+                             target + "[i" + d + "]", indent + INDENT_1,
+                             depth + 1);
+      ostream << indent << "}" << NL << indent << "d.done(end" << d << ")"
+              << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      ostream << indent << "end" << d << " := d.limit()" << NL << indent
+              << "n" << d << " := d.count(end" << d << ")" << NL << indent
+              << "if " << target << " == nil {" << NL << indent << INDENT_1
+              << target << " = make(" << type_to_go_type(type) << ", n" << d
+              << ")" << NL << indent << "} else {" << NL << indent << INDENT_1
+              << "for k := range " << target << " {" << NL << indent
+              << INDENT_2 << "delete(" << target << ", k)" << NL << indent
+              << INDENT_1 << "}" << NL << indent << "}" << NL << indent
+              << "for i" << d << " := 0; i" << d
+              << " < n" << d << "; i" << d << "++ {" << NL << indent
+              << INDENT_1 << "var k" << d << " "
+              << type_to_go_type(map->get_key_type().get()) << NL << indent
+              << INDENT_1 << "var v" << d << " "
+              << type_to_go_type(map->get_value_type().get()) << NL;
+      generate_binary_decode(ostream, struct_type,
+                             map->get_key_type().get(), "k" + d,
+                             indent + INDENT_1, depth + 1);
+      generate_binary_decode(ostream, struct_type,
+                             map->get_value_type().get(), "v" + d,
+                             indent + INDENT_1, depth + 1);
+      ostream << indent << INDENT_1 << target << "[k" << d << "] = v" << d
+              << NL << indent << "}" << NL << indent << "d.done(end" << d
+              << ")" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      ostream << indent << "end" << d << " := d.limit()" << NL << indent
+              << "for d.pos < end" << d << " {" << NL << indent << INDENT_1
+              << "num" << d << ", wt" << d << " := d.key()" << NL << indent
+              << INDENT_1 << "switch num" << d << " {" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt_type = oneof_field.get_type().get();
+        auto alt_name = capitalize(oneof_field.get_name());
+        ostream << indent << INDENT_1 << "case " << oneof_field.get_number()
+                << ":" << NL << indent << INDENT_2 << "if d.expect(wt" << d
+                << ", " << static_cast<int>(wire_format::wire_type_of(alt_type))
+                << ") {" << NL;
+        if (use_inline_oneof_) {
+          auto name = inline_oneof_names_.at(oneof);
+          ostream << indent << INDENT_3 << target << " = " << name
+                  << "{kind: " << name << "_" << alt_name << "}" << NL;
+          generate_binary_decode(ostream, struct_type, alt_type,
+                                 target + ".v" + alt_name, indent + INDENT_3,
+                                 depth + 1);
+        } else {
+          ostream << indent << INDENT_3 << "v" << d << " := &"
+                  << capitalize(struct_type->get_name()) << alt_name << "{}"
+                  << NL;
+          generate_binary_decode(ostream, struct_type, alt_type,
+                                 "v" + d + "." + alt_name, indent + INDENT_3,
+                                 depth + 1);
+          ostream << indent << INDENT_3 << target << " = v" << d << NL;
+        }
+        ostream << indent << INDENT_2 << "}" << NL;
+      }
+      ostream << indent << INDENT_1 << "default:" << NL << indent << INDENT_2
+              << "d.skip(wt" << d << ")" << NL << indent << INDENT_1 << "}"
+              << NL << indent << "}" << NL << indent << "d.done(end" << d
+              << ")" << NL;
+    }
+  }
+
+  // A view checks the top level of a binary message once, recording where
+  // the value of each field it knows starts, and decodes a field only when
+  // it is read. Strings come back as slices of the message and structs as
+  // views of their bytes, so reading does not allocate. Lists, maps, oneofs
+  // and `any` values come back as their encoded bytes.
+  void generate_binary_view(std::ostream& ostream,
+                            const StructType* struct_type) {
+    auto view_name = capitalize(struct_type->get_name()) + "View";
+    auto fields = struct_type->get_fields();
+
+    ostream << "// " << view_name << " reads the fields of a binary encoded "
+            << capitalize(struct_type->get_name()) << " in place." << NL
+            << "type " << view_name << " struct {" << NL << INDENT_1
+            << "data []byte" << NL << INDENT_1
+            << "// Offset of each field's value plus one, 0 if it is absent."
+            << NL << INDENT_1 << "off  [" << fields.size() << "]uint32" << NL
+            << "}" << NL2;
+
+    ostream << "func New" << view_name << "(data []byte) (" << view_name
+            << ", error) {" << NL << INDENT_1 << "v := " << view_name
+            << "{data: data}" << NL << INDENT_1
+            << "d := tmBinaryDecoder{data: data}" << NL << INDENT_1
+            << "for d.pos < len(data) {" << NL << INDENT_2
+            << "num, wt := d.key()" << NL << INDENT_2 << "start := d.pos" << NL
+            << INDENT_2 << "switch num {" << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      ostream << INDENT_2 << "case " << fields[i].get_number() << ":" << NL
+              << INDENT_3 << "if d.expect(wt, "
+              << static_cast<int>(
+                     wire_format::wire_type_of(fields[i].get_type().get()))
+              << ") {" << NL << INDENT_4 << "v.off[" << i
+              << "] = uint32(start) + 1" << NL << INDENT_3 << "}" << NL;
+    }
+    ostream << INDENT_2 << "}" << NL << INDENT_2 << "d.skip(wt)" << NL
+            << INDENT_1 << "}" << NL << INDENT_1 << "return v, d.err" << NL
+            << "}" << NL2;
+
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto& field = fields[i];
+      auto type = field.get_type().get();
+      auto method = capitalize(field.get_name());
+      auto slot = "v.off[" + std::to_string(i) + "]";
+      ostream << "func (v " << view_name << ") Has" << method
+              << "() bool {" << NL << INDENT_1 << "return " << slot
+              << " != 0" << NL << "}" << NL2;
+
+      std::string result;
+      std::string zero;
+      std::string read;
+      if (type->is_enum()) {
+        result = capitalize(type->get_name());
+        zero = "0";
+        read = result + "(d.zigzag())";
+      } else if (type->is_struct()) {
+        result = capitalize(type->get_name()) + "View";
+        zero = result + "{}";
+      } else if (type->is_primitive() &&
+                 !dynamic_cast<const PrimitiveType*>(type)->is_any()) {
+        auto primitive = dynamic_cast<const PrimitiveType*>(type);
+        if (primitive->is_string()) {
+          result = "[]byte";
+          zero = "nil";
+          read = "d.bytes()";
+        } else {
+          result = type_to_go_type(type);
+          zero = primitive->is_bool() ? "false" : "0";
+          read = binary_read_primitive(primitive);
+        }
+      } else {
+        method += "Bytes";
+        result = "[]byte";
+        zero = "nil";
+        read = "d.bytes()";
+      }
+      ostream << "func (v " << view_name << ") " << method << "() " << result
+              << " {" << NL << INDENT_1 << "if " << slot << " == 0 {" << NL
+              << INDENT_2 << "return " << zero << NL << INDENT_1 << "}" << NL
+              << INDENT_1 << "d := tmBinaryDecoder{data: v.data, pos: int("
+              << slot << ") - 1}" << NL;
+      if (type->is_struct()) {
+        // The top level of the message was checked, not what is nested in
+        // it; a malformed nested message reads as far as it is well formed.
+        ostream << INDENT_1 << "w, _ := New" << result << "(d.bytes())" << NL
+                << INDENT_1 << "return w" << NL;
+      } else {
+        ostream << INDENT_1 << "return " << read << NL;
+      }
+      ostream << "}" << NL2;
+    }
+  }
+
+  static std::string binary_read_primitive(const PrimitiveType* primitive) {
+    if (primitive->is_bool()) {
+      return "d.varint() != 0";
+    } else if (primitive->is_i32()) {
+      return "int32(d.zigzag())";
+    } else if (primitive->is_i64()) {
+      return "d.zigzag()";
+    } else if (primitive->is_u32()) {
+      return "uint32(d.varint())";
+    } else if (primitive->is_u64()) {
+      return "d.varint()";
+    } else if (primitive->is_float()) {
+      return "d.fixed64()";
+    } else if (primitive->is_string()) {
+      return "string(d.bytes())";
+    }
+    return "d.any()";
+  }
+
+  // Each api group gets a handler interface with a method per api, and a
+  // server that routes requests to it. The router is a radix tree of the
+  // paths unrolled into nested ifs: it slices params out of the path
+  // without allocating and parses them into typed values only once a
+  // route has matched.
+  void generate_http_server(std::ostream& ostream,
+                            const ApiGroup& api_group) {
+    auto group = capitalize(api_group.get_group_name());
+    auto handler = group + "Handler";
+    auto server = group + "Server";
+    const auto& apis = api_group.get_apis();
+    auto names = api_method_names(api_group);
+    std::size_t max_params = 0;
+    for (const auto& api : apis) {
+      max_params = std::max(max_params, api.get_path_params().size());
+    }
+    auto params_type = "[" + std::to_string(max_params) + "]string";
+
+    ostream << "// " << handler << " implements the apis of " << group << "."
+            << NL << "type " << handler << " interface {" << NL;
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      ostream << INDENT_1 << names[i] << "(r *http.Request";
+      for (const auto& param : apis[i].get_path_params()) {
+        ostream << ", " << http_param_name(param.field) << " "
+                << type_to_go_type(param.field.get_type().get());
+      }
+      ostream << ", body *" << type_to_go_type(apis[i].get_body_param().get())
+              << ") (" << group << names[i] << "Response, error)" << NL;
+    }
+    ostream << "}" << NL2;
+
+    ostream << "// " << server << " routes requests to a " << handler << "."
+            << NL << "type " << server << " struct {" << NL << INDENT_1
+            << "h " << handler << NL << "}" << NL2 << "func New" << server
+            << "(h " << handler << ") *" << server << " {" << NL << INDENT_1
+            << "return &" << server << "{h: h}" << NL << "}" << NL2
+            << "func (s *" << server
+            << ") ServeHTTP(w http.ResponseWriter, r *http.Request) {" << NL
+            << INDENT_1 << "path := r.URL.EscapedPath()" << NL << INDENT_1
+            << "var params " << params_type << NL;
+    generate_route_node(ostream, api_group, names, build_route_tree(api_group),
+                        "0", 0, 0, INDENT_1);
+    ostream << INDENT_1 << "http.NotFound(w, r)" << NL << "}" << NL2;
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      generate_http_serve(ostream, server, group + names[i], names[i],
+                          params_type, apis[i]);
+    }
+  }
+
+  // A response is only made through the function of one of the statuses
+  // the api declares, which takes the body of that status if it has one,
+  // and read through accessors.
+  void generate_http_responses(std::ostream& ostream,
+                               const ApiGroup& api_group) {
+    auto group = capitalize(api_group.get_group_name());
+    auto names = api_method_names(api_group);
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      generate_http_response(ostream, group + names[i],
+                             api_group.get_apis()[i]);
+    }
+  }
+
+  void generate_http_response(std::ostream& ostream, const std::string& name,
+                              const Api& api) {
+    auto type = name + "Response";
+    ostream << "// " << type << " is made by one of the " << name
+            << "<Status> functions." << NL << "type " << type << " struct {"
+            << NL << INDENT_1 << "status int" << NL;
+    for (const auto& api_return : api.get_returns()) {
+      if (api_return.resp_ != nullptr) {
+        ostream << INDENT_1 << "s" << api_return.http_status_code_ << " "
+                << (api_return.resp_->is_struct() ? "*" : "")
+                << type_to_go_type(api_return.resp_.get()) << NL;
+      }
+    }
+    ostream << "}" << NL2;
+    for (const auto& api_return : api.get_returns()) {
+      auto status = std::to_string(api_return.http_status_code_);
+      ostream << "func " << name << status << "(";
+      if (api_return.resp_ != nullptr) {
+        ostream << "body " << (api_return.resp_->is_struct() ? "*" : "")
+                << type_to_go_type(api_return.resp_.get());
+      }
+      ostream << ") " << type << " {" << NL << INDENT_1 << "return " << type
+              << "{status: " << status
+              << (api_return.resp_ != nullptr ? ", s" + status + ": body" : "")
+              << "}" << NL << "}" << NL2;
+    }
+    ostream << "func (r *" << type << ") Status() int {" << NL << INDENT_1
+            << "return r.status" << NL << "}" << NL2;
+    for (const auto& api_return : api.get_returns()) {
+      if (api_return.resp_ == nullptr) {
+        continue;
+      }
+      auto status = std::to_string(api_return.http_status_code_);
+      ostream << "// Body" << status << " returns the body of a " << status
+              << " response, zero for other statuses." << NL << "func (r *"
+              << type << ") Body" << status << "() "
+              << (api_return.resp_->is_struct() ? "*" : "")
+              << type_to_go_type(api_return.resp_.get()) << " {" << NL
+              << INDENT_1 << "return r.s" << status << NL << "}" << NL2;
+    }
+  }
+
+  // Emits the matching of what is left of the path from `pos` on against
+  // `node`. Static children are tried before the param child, and code
+  // that does not match falls through to the next alternative.
+  void generate_route_node(std::ostream& ostream, const ApiGroup& api_group,
+                           const std::vector<std::string>& names,
+                           const RouteNode& node, const std::string& pos,
+                           int depth, std::size_t param,
+                           const std::string& indent) {
+    if (!node.routes.empty()) {
+      std::string allow;
+      ostream << indent << "if " << pos << " == len(path) {" << NL << indent
+              << INDENT_1 << "switch r.Method {" << NL;
+      for (auto route : node.routes) {
+        const auto& api = api_group.get_apis()[route];
+        std::string method = http_method_to_string(api.get_http_method());
+        allow += (allow.empty() ? "" : ", ") + method;
+        ostream << indent << INDENT_1 << "case \"" << method << "\":" << NL
+                << indent << INDENT_2 << "s.serve" << names[route]
+                << "(w, r, &params)" << NL;
+      }
+      ostream << indent << INDENT_1 << "default:" << NL << indent << INDENT_2
+              << "tmHTTPMethodNotAllowed(w, \"" << allow << "\")" << NL
+              << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "return" << NL << indent << "}" << NL;
+    }
+    auto next = "i" + std::to_string(depth + 1);
+    auto rest = [&](const std::string& offset) {
+      return pos == "0" ? "path[" + offset + ":]"
+                        : "path[" + pos + "+" + offset + ":]";
+    };
+    auto advance = [&](std::size_t n) {
+      return pos == "0" ? std::to_string(n)
+                        : pos + " + " + std::to_string(n);
+    };
+    if (node.children.size() == 1) {
+      const auto& child = node.children[0];
+      if (child.prefix.size() == 1) {
+        ostream << indent << "if " << pos << " < len(path) && path[" << pos
+                << "] == '" << child.prefix << "' {" << NL;
+      } else {
+        ostream << indent << "if strings.HasPrefix("
+                << (pos == "0" ? "path" : "path[" + pos + ":]") << ", \""
+                << child.prefix << "\") {" << NL;
+      }
+      ostream << indent << INDENT_1 << next << " := "
+              << advance(child.prefix.size()) << NL;
+      generate_route_node(ostream, api_group, names, child, next, depth + 1,
+                          param, indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (!node.children.empty()) {
+      ostream << indent << "if " << pos << " < len(path) {" << NL << indent
+              << INDENT_1 << "switch path[" << pos << "] {" << NL;
+      for (const auto& child : node.children) {
+        auto child_indent = indent + INDENT_2;
+        ostream << indent << INDENT_1 << "case '" << child.prefix[0] << "':"
+                << NL;
+        if (child.prefix.size() > 1) {
+          ostream << child_indent << "if strings.HasPrefix(" << rest("1")
+                  << ", \"" << child.prefix.substr(1) << "\") {" << NL;
+          child_indent += INDENT_1;
+        }
+        ostream << child_indent << next << " := "
+                << advance(child.prefix.size()) << NL;
+        generate_route_node(ostream, api_group, names, child, next,
+                            depth + 1, param, child_indent);
+        if (child.prefix.size() > 1) {
+          ostream << indent << INDENT_2 << "}" << NL;
+        }
+      }
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    }
+    if (node.param) {
+      ostream << indent << "if " << pos << " < len(path) && path[" << pos
+              << "] != '/' {" << NL << indent << INDENT_1 << next
+              << " := len(path)" << NL << indent << INDENT_1
+              << "if j := strings.IndexByte(path[" << pos
+              << ":], '/'); j >= 0 {" << NL << indent << INDENT_2 << next
+              << " = " << pos << " + j" << NL << indent << INDENT_1 << "}"
+              << NL << indent << INDENT_1 << "params[" << param << "] = path["
+              << pos << ":" << next << "]" << NL;
+      generate_route_node(ostream, api_group, names, *node.param, next,
+                          depth + 1, param + 1, indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    }
+  }
+
+  // Parses the params of a matched route, decodes the body, calls the
+  // handler and writes its response. The body and the response share one
+  // pooled buffer.
+  void generate_http_serve(std::ostream& ostream, const std::string& server,
+                           const std::string& name,
+                           const std::string& handler_method,
+                           const std::string& params_type, const Api& api) {
+    ostream << "func (s *" << server << ") serve" << handler_method
+            << "(w http.ResponseWriter, r *http.Request, params *"
+            << params_type << ") {" << NL;
+    const auto& params = api.get_path_params();
+    std::string args;
+    for (std::size_t i = 0; i < params.size(); ++i) {
+      auto p = "p" + std::to_string(i);
+      auto raw = "params[" + std::to_string(i) + "]";
+      auto type = params[i].field.get_type().get();
+      auto arg = p;
+      if (type->is_enum()) {
+        ostream << INDENT_1 << p << ", ok := Parse"
+                << capitalize(type->get_name()) << "(" << raw << ")" << NL
+                << INDENT_1 << "if !ok {" << NL;
+      } else {
+        auto primitive = dynamic_cast<const PrimitiveType*>(type);
+        std::string parse;
+        if (primitive->is_string()) {
+          // The router matches the escaped path, so that an escaped slash
+          // stays inside its segment.
+          parse = "url.PathUnescape(" + raw + ")";
+        } else if (primitive->is_bool()) {
+          parse = "strconv.ParseBool(" + raw + ")";
+        } else if (primitive->is_i32() || primitive->is_i64()) {
+          parse = "strconv.ParseInt(" + raw + ", 10, " +
+                  (primitive->is_i32() ? "32" : "64") + ")";
+        } else if (primitive->is_u32() || primitive->is_u64()) {
+          parse = "strconv.ParseUint(" + raw + ", 10, " +
+                  (primitive->is_u32() ? "32" : "64") + ")";
+        } else {
+          parse = "strconv.ParseFloat(" + raw + ", 64)";
+        }
+        if (primitive->is_i32() || primitive->is_u32()) {
+          arg = type_to_go_type(type) + "(" + p + ")";
+        }
+        ostream << INDENT_1 << p << ", err := " << parse << NL << INDENT_1
+                << "if err != nil {" << NL;
+      }
+      ostream << INDENT_2 << "http.Error(w, \"malformed path param "
+              << params[i].field.get_name() << "\", http.StatusBadRequest)"
+              << NL << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL;
+      args += ", " + arg;
+    }
+    auto body_type = api.get_body_param().get();
+    ostream << INDENT_1 << "buf := tmHTTPBuffers.Get().(*[]byte)" << NL
+            << INDENT_1 << "defer tmHTTPBuffers.Put(buf)" << NL << INDENT_1
+            << "if err := tmHTTPRead(r.Body, buf); err != nil {" << NL
+            << INDENT_2
+            << "http.Error(w, err.Error(), http.StatusBadRequest)" << NL
+            << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "var body " << type_to_go_type(body_type) << NL << INDENT_1
+            << "if len(*buf) != 0 {" << NL << INDENT_2
+            << "d := &tmJSONDecoder{data: *buf}" << NL;
+    generate_json_decode(ostream, nullptr, body_type, "body", INDENT_2, 1);
+    ostream << INDENT_2 << "if err := d.end(); err != nil {" << NL << INDENT_3
+            << "http.Error(w, err.Error(), http.StatusBadRequest)" << NL
+            << INDENT_3 << "return" << NL << INDENT_2 << "}" << NL << INDENT_1
+            << "}" << NL;
+    // Constraints hold on what handlers get, an empty body included.
+    if (body_type->is_struct() && needs_validation(body_type)) {
+      ostream << INDENT_1 << "if err := body.Validate(); err != nil {" << NL
+              << INDENT_2
+              << "http.Error(w, err.Error(), http.StatusBadRequest)" << NL
+              << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL;
+    }
+    ostream << INDENT_1 << "resp, err := s.h." << handler_method
+            << "(r" << args << ", &body)" << NL << INDENT_1
+            << "if err != nil {" << NL << INDENT_2
+            << "http.Error(w, err.Error(), http.StatusInternalServerError)"
+            << NL << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL
+            << INDENT_1 << "b := (*buf)[:0]" << NL << INDENT_1
+            << "switch resp.status {" << NL;
+    for (const auto& api_return : api.get_returns()) {
+      auto status = std::to_string(api_return.http_status_code_);
+      ostream << INDENT_1 << "case " << status << ":" << NL;
+      if (api_return.resp_ == nullptr) {
+        continue;
+      }
+      auto expr = "resp.s" + status;
+      if (api_return.resp_->is_struct()) {
+        ostream << INDENT_2 << "if " << expr << " == nil {" << NL << INDENT_3
+                << "b = append(b, \"null\"...)" << NL << INDENT_2
+                << "} else {" << NL;
+        generate_json_encode(ostream, nullptr, api_return.resp_.get(), expr,
+                             INDENT_3, 1);
+        ostream << INDENT_2 << "}" << NL;
+      } else {
+        generate_json_encode(ostream, nullptr, api_return.resp_.get(), expr,
+                             INDENT_2, 1);
+      }
+    }
+    ostream << INDENT_1 << "default:" << NL << INDENT_2
+            << "http.Error(w, \"" << handler_method
+            << " returned no response\", http.StatusInternalServerError)"
+            << NL << INDENT_2 << "return" << NL << INDENT_1 << "}" << NL
+            << INDENT_1 << "tmHTTPWrite(w, resp.status, b)" << NL << INDENT_1
+            << "*buf = b" << NL << "}" << NL2;
+  }
+
+  // Parameter names of generated handler and client methods, renamed where
+  // they would clash with the names the generated code uses.
+  static std::string http_param_name(const Field& field) {
+    static const std::vector<std::string> taken = {
+        "b", "body", "buf", "c", "ctx", "d", "err", "r", "resp", "status", "u"};
+    auto name = field.get_name();
+    if (std::find(taken.begin(), taken.end(), name) != taken.end()) {
+      name += "_";
+    }
+    return name;
+  }
+
+  // A client builds the URL of a call in one buffer, presized from the
+  // static text of the path and an estimate for each param, by appending
+  // the parts of the path as split at code generation time.
+  void generate_http_client(std::ostream& ostream,
+                            const ApiGroup& api_group) {
+    auto group = capitalize(api_group.get_group_name());
+    auto client = group + "Client";
+    const auto& apis = api_group.get_apis();
+    auto names = api_method_names(api_group);
+
+    ostream << "// " << client << " calls the apis of " << group
+            << " on a server." << NL << "type " << client << " struct {" << NL
+            << INDENT_1 << "base string" << NL << INDENT_1
+            << "c    *http.Client" << NL << "}" << NL2 << "// New" << client
+            << " returns a client of the server at base, such as" << NL
+            << "// \"http://localhost:8080\". A nil c means http.DefaultClient."
+            << NL << "func New" << client << "(base string, c *http.Client) *"
+            << client << " {" << NL << INDENT_1 << "if c == nil {" << NL
+            << INDENT_2 << "c = http.DefaultClient" << NL << INDENT_1 << "}"
+            << NL << INDENT_1 << "return &" << client
+            << "{base: strings.TrimSuffix(base, \"/\"), c: c}" << NL << "}"
+            << NL2;
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      const auto& api = apis[i];
+      auto response = group + names[i] + "Response";
+      const auto& params = api.get_path_params();
+      auto parts = route_parts(api);
+      auto body_type = api.get_body_param().get();
+
+      ostream << "func (c *" << client << ") " << names[i]
+              << "(ctx context.Context";
+      for (const auto& param : params) {
+        ostream << ", " << http_param_name(param.field) << " "
+                << type_to_go_type(param.field.get_type().get());
+      }
+      ostream << ", body *" << type_to_go_type(body_type) << ") (" << response
+              << ", error) {" << NL;
+
+      std::size_t size = 0;
+      std::string dynamic_size;
+      for (const auto& part : parts) {
+        size += part.size();
+      }
+      for (const auto& param : params) {
+        auto type = param.field.get_type().get();
+        size += path_param_size(type);
+        if (type->is_primitive() &&
+            dynamic_cast<const PrimitiveType*>(type)->is_string()) {
+          dynamic_size += "+len(" + http_param_name(param.field) + ")";
+        }
+      }
+      ostream << INDENT_1 << "var resp " << response << NL << INDENT_1
+              << "u := make([]byte, 0, len(c.base)+" << size << dynamic_size
+              << ")" << NL << INDENT_1 << "u = append(u, c.base...)" << NL;
+      for (std::size_t j = 0; j < parts.size(); ++j) {
+        if (!parts[j].empty()) {
+          ostream << INDENT_1 << "u = append(u, \"" << parts[j] << "\"...)"
+                  << NL;
+        }
+        if (j == params.size()) {
+          break;
+        }
+        auto name = http_param_name(params[j].field);
+        auto type = params[j].field.get_type().get();
+        ostream << INDENT_1 << "u = ";
+        if (type->is_enum()) {
+          ostream << "append(u, " << name << ".String()...)";
+        } else {
+          auto primitive = dynamic_cast<const PrimitiveType*>(type);
+          if (primitive->is_string()) {
+            ostream << "tmAppendPathSegment(u, " << name << ")";
+          } else if (primitive->is_bool()) {
+            ostream << "strconv.AppendBool(u, " << name << ")";
+          } else if (primitive->is_i32() || primitive->is_i64()) {
+            ostream << "strconv.AppendInt(u, int64(" << name << "), 10)";
+          } else if (primitive->is_u32() || primitive->is_u64()) {
+            ostream << "strconv.AppendUint(u, uint64(" << name << "), 10)";
+          } else {
+            ostream << "strconv.AppendFloat(u, " << name << ", 'g', -1, 64)";
+          }
+        }
+        ostream << NL;
+      }
+      ostream << INDENT_1 << "var b []byte" << NL << INDENT_1
+              << "if body != nil {" << NL << INDENT_2
+              << "b = make([]byte, 0, 128)" << NL;
+      generate_json_encode(ostream, nullptr, body_type, "(*body)", INDENT_2,
+                           1);
+      ostream << INDENT_1 << "}" << NL << INDENT_1
+              << "status, buf, err := tmHTTPDo(ctx, c.c, \""
+              << http_method_to_string(api.get_http_method())
+              << "\", u, b)" << NL << INDENT_1 << "if err != nil {" << NL
+              << INDENT_2 << "return resp, err" << NL << INDENT_1 << "}" << NL
+              << INDENT_1 << "defer tmHTTPBuffers.Put(buf)" << NL;
+      auto typed = std::any_of(
+          api.get_returns().begin(), api.get_returns().end(),
+          [](const auto& api_return) { return api_return.resp_ != nullptr; });
+      if (typed) {
+        ostream << INDENT_1 << "d := &tmJSONDecoder{data: *buf}" << NL;
+      }
+      ostream << INDENT_1 << "switch status {" << NL;
+      for (const auto& api_return : api.get_returns()) {
+        auto status = std::to_string(api_return.http_status_code_);
+        ostream << INDENT_1 << "case " << status << ":" << NL;
+        if (api_return.resp_ == nullptr) {
+          continue;
+        }
+        auto target = "resp.s" + status;
+        if (api_return.resp_->is_struct()) {
+          ostream << INDENT_2 << target << " = new("
+                  << type_to_go_type(api_return.resp_.get()) << ")" << NL;
+        }
+        generate_json_decode(ostream, nullptr, api_return.resp_.get(), target,
+                             INDENT_2, 1);
+      }
+      ostream << INDENT_1 << "default:" << NL << INDENT_2
+              << "return resp, &ToolmanHTTPError{Status: status, "
+                 "Body: append([]byte(nil), *buf...)}"
+              << NL << INDENT_1 << "}" << NL;
+      if (typed) {
+        ostream << INDENT_1 << "if err := d.end(); err != nil {" << NL
+                << INDENT_2 << "return resp, err" << NL << INDENT_1 << "}"
+                << NL;
+      }
+      ostream << INDENT_1 << "resp.status = status" << NL << INDENT_1
+              << "return resp, nil" << NL << "}" << NL2;
+    }
+  }
+
+  bool use_binary_runtime() const {
+    return use_binary_codec_ || use_binary_views_;
+  }
+
+  // Returns the key of `field` as a list of Go byte literals.
+  static std::string binary_key(const Field& field) {
+    std::string bytes;
+    for (unsigned char c :
+         wire_format::encode_key(field.get_number(), field.get_type().get())) {
+      char hex[8];
+      std::snprintf(hex, sizeof(hex), "0x%02x", c);
+      bytes += (bytes.empty() ? "" : ", ") + std::string(hex);
+    }
+    return bytes;
+  }
+
+  // The Go type the keys of a map with `key` are sorted as, and the runtime
+  // function that sorts them in the order encoding/json writes them.
+  static std::pair<std::string, std::string> json_key_sort(
+      const PrimitiveType* key) {
+    if (key->is_bool()) {
+      return {"bool", "tmSortBoolKeys"};
+    } else if (key->is_i32() || key->is_i64()) {
+      return {"int64", "tmSortIntKeys"};
+    } else if (key->is_u32() || key->is_u64()) {
+      return {"uint64", "tmSortUintKeys"};
+    } else if (key->is_float()) {
+      return {"float64", "tmSortFloatKeys"};
+    } else if (key->is_string()) {
+      return {"string", "tmSortStringKeys"};
+    }
+    return {"interface{}", "tmSortAnyKeys"};
+  }
+
+  [[nodiscard]] static std::string type_to_go_type(const Type* type) {
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
       if (primitive->is_bool()) {
         return "bool";
       } else if (primitive->is_i32()) {
@@ -143,15 +2716,31 @@ class GolangGenerator : public Generator {
     } else if (type->is_struct() || type->is_enum()) {
       return capitalize(type->get_name());
     } else if (type->is_list()) {
-      auto list = dynamic_cast<ListType*>(type);
+      auto list = dynamic_cast<const ListType*>(type);
       return "[]" + type_to_go_type(list->get_elem_type().get());
     } else if (type->is_map()) {
-      auto map = dynamic_cast<MapType*>(type);
+      auto map = dynamic_cast<const MapType*>(type);
       return "map[" + type_to_go_type(map->get_key_type().get()) + "]" +
              type_to_go_type(map->get_value_type().get());
     }
     return "";
   }
+
+  bool use_json_codec_ = false;
+  bool use_binary_codec_ = false;
+  bool use_binary_views_ = false;
+  bool use_presence_bits_ = false;
+  bool use_packed_layout_ = false;
+  bool use_object_pool_ = false;
+  bool use_inline_oneof_ = false;
+  bool use_http_server_ = false;
+  bool use_http_client_ = false;
+  bool use_validation_ = false;
+  bool use_deep_copy_ = false;
+  bool use_field_masks_ = false;
+  bool use_json_streams_ = false;
+  // The Go type of each oneof with go_inline_oneof.
+  std::map<const Type*, std::string> inline_oneof_names_;
 };
 }  // namespace toolman::generator
 
@@ -0,0 +1,1198 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_GOLANG_RUNTIME_H_
+#define TOOLMAN_GOLANG_RUNTIME_H_
+
+namespace toolman::generator::golang_runtime {
+
+// Support code emitted once into every Go file that uses the generated JSON
+// codec. It needs the imports listed in `kJsonImports`.
+constexpr char kJsonImports[] =
+    R"(    "encoding/json"
+    "math"
+    "sort"
+    "strconv"
+    "unicode/utf8"
+)";
+
+constexpr char kJson[] = R"(// tmJSONError reports malformed input to a generated JSON decoder.
+type tmJSONError struct {
+    msg    string
+    offset int
+}
+
+func (e *tmJSONError) Error() string {
+    return "toolman: " + e.msg + " at offset " + strconv.Itoa(e.offset)
+}
+
+const tmJSONHex = "0123456789abcdef"
+
+// tmJSONSafe marks the ASCII bytes that are written verbatim inside JSON
+// strings, matching the escaping of encoding/json.
+var tmJSONSafe = func() (safe [utf8.RuneSelf]bool) {
+    for c := 0x20; c < utf8.RuneSelf; c++ {
+        safe[c] = c != '"' && c != '\\' && c != '<' && c != '>' && c != '&'
+    }
+    return
+}()
+
+func tmAppendString(b []byte, s string) []byte {
+    b = append(b, '"')
+    start := 0
+    for i := 0; i < len(s); {
+        if c := s[i]; c < utf8.RuneSelf {
+            if tmJSONSafe[c] {
+                i++
+                continue
+            }
+            b = append(b, s[start:i]...)
+            switch c {
+            case '"', '\\':
+                b = append(b, '\\', c)
+            case '\n':
+                b = append(b, '\\', 'n')
+            case '\r':
+                b = append(b, '\\', 'r')
+            case '\t':
+                b = append(b, '\\', 't')
+            default:
+                b = append(b, '\\', 'u', '0', '0', tmJSONHex[c>>4], tmJSONHex[c&0xf])
+            }
+            i++
+            start = i
+            continue
+        }
+        r, size := utf8.DecodeRuneInString(s[i:])
+        if r == utf8.RuneError && size == 1 {
+            b = append(b, s[start:i]...)
+            b = append(b, "\ufffd"...)
+            i += size
+            start = i
+            continue
+        }
+        if r == '\u2028' || r == '\u2029' {
+            b = append(b, s[start:i]...)
+            b = append(b, '\\', 'u', '2', '0', '2', tmJSONHex[r&0xf])
+            i += size
+            start = i
+            continue
+        }
+        i += size
+    }
+    b = append(b, s[start:]...)
+    return append(b, '"')
+}
+
+func tmAppendFloat(b []byte, f float64) []byte {
+    if math.IsInf(f, 0) || math.IsNaN(f) {
+        return append(b, "null"...)
+    }
+    format := byte('f')
+    if abs := math.Abs(f); abs != 0 && (abs < 1e-6 || abs >= 1e21) {
+        format = 'e'
+    }
+    b = strconv.AppendFloat(b, f, format, -1, 64)
+    if format == 'e' {
+        // Turn e-09 into e-9 like encoding/json does.
+        if n := len(b); n >= 4 && b[n-4] == 'e' && b[n-3] == '-' && b[n-2] == '0' {
+            b[n-2] = b[n-1]
+            b = b[:n-1]
+        }
+    }
+    return b
+}
+
+func tmAppendAny(b []byte, v interface{}) []byte {
+    raw, err := json.Marshal(v)
+    if err != nil {
+        return append(b, "null"...)
+    }
+    return append(b, raw...)
+}
+
+// Generated encoders write the keys of a map sorted by their JSON text, the
+// order encoding/json writes them in, so 10 comes before 9. The few keys
+// most maps have are sorted by insertion, which does not allocate.
+const tmSortKeysByInsertion = 12
+
+func tmSortStringKeys(keys []string) {
+    if len(keys) > tmSortKeysByInsertion {
+        sort.Strings(keys)
+        return
+    }
+    for i := 1; i < len(keys); i++ {
+        for j := i; j > 0 && keys[j] < keys[j-1]; j-- {
+            keys[j], keys[j-1] = keys[j-1], keys[j]
+        }
+    }
+}
+
+func tmSortBoolKeys(keys []bool) {
+    if len(keys) == 2 && keys[0] {
+        keys[0], keys[1] = false, true
+    }
+}
+
+func tmLessIntKey(a, b int64) bool {
+    var x, y [20]byte
+    return string(strconv.AppendInt(x[:0], a, 10)) < string(strconv.AppendInt(y[:0], b, 10))
+}
+
+func tmSortIntKeys(keys []int64) {
+    if len(keys) > tmSortKeysByInsertion {
+        sort.Slice(keys, func(i, j int) bool { return tmLessIntKey(keys[i], keys[j]) })
+        return
+    }
+    for i := 1; i < len(keys); i++ {
+        for j := i; j > 0 && tmLessIntKey(keys[j], keys[j-1]); j-- {
+            keys[j], keys[j-1] = keys[j-1], keys[j]
+        }
+    }
+}
+
+func tmLessUintKey(a, b uint64) bool {
+    var x, y [20]byte
+    return string(strconv.AppendUint(x[:0], a, 10)) < string(strconv.AppendUint(y[:0], b, 10))
+}
+
+func tmSortUintKeys(keys []uint64) {
+    if len(keys) > tmSortKeysByInsertion {
+        sort.Slice(keys, func(i, j int) bool { return tmLessUintKey(keys[i], keys[j]) })
+        return
+    }
+    for i := 1; i < len(keys); i++ {
+        for j := i; j > 0 && tmLessUintKey(keys[j], keys[j-1]); j-- {
+            keys[j], keys[j-1] = keys[j-1], keys[j]
+        }
+    }
+}
+
+func tmLessFloatKey(a, b float64) bool {
+    var x, y [32]byte
+    return string(tmAppendFloat(x[:0], a)) < string(tmAppendFloat(y[:0], b))
+}
+
+func tmSortFloatKeys(keys []float64) {
+    if len(keys) > tmSortKeysByInsertion {
+        sort.Slice(keys, func(i, j int) bool { return tmLessFloatKey(keys[i], keys[j]) })
+        return
+    }
+    for i := 1; i < len(keys); i++ {
+        for j := i; j > 0 && tmLessFloatKey(keys[j], keys[j-1]); j-- {
+            keys[j], keys[j-1] = keys[j-1], keys[j]
+        }
+    }
+}
+
+func tmSortAnyKeys(keys []interface{}) {
+    sort.Slice(keys, func(i, j int) bool {
+        return string(tmAppendAny(nil, keys[i])) < string(tmAppendAny(nil, keys[j]))
+    })
+}
+
+// tmJSONDecoder is a forward-only JSON reader. The first error is sticky:
+// after it every read returns a zero value and every loop ends, so generated
+// decoders are straight-line code that checks the error once at the end.
+type tmJSONDecoder struct {
+    data    []byte
+    pos     int
+    err     error
+    scratch []byte
+}
+
+func (d *tmJSONDecoder) fail(msg string) {
+    if d.err == nil {
+        d.err = &tmJSONError{msg: msg, offset: d.pos}
+    }
+    d.pos = len(d.data)
+}
+
+func (d *tmJSONDecoder) ws() {
+    for d.pos < len(d.data) {
+        switch d.data[d.pos] {
+        case ' ', '\t', '\n', '\r':
+            d.pos++
+        default:
+            return
+        }
+    }
+}
+
+func (d *tmJSONDecoder) end() error {
+    d.ws()
+    if d.err == nil && d.pos != len(d.data) {
+        d.fail("unexpected data after top-level value")
+    }
+    return d.err
+}
+
+// null consumes a JSON null if it is the next value.
+func (d *tmJSONDecoder) null() bool {
+    d.ws()
+    if d.pos+4 <= len(d.data) && string(d.data[d.pos:d.pos+4]) == "null" {
+        d.pos += 4
+        return true
+    }
+    return false
+}
+
+// begin consumes the opening bracket c of an object or array.
+func (d *tmJSONDecoder) begin(c byte) bool {
+    d.ws()
+    if d.pos < len(d.data) && d.data[d.pos] == c {
+        d.pos++
+        return true
+    }
+    d.fail("expected " + string(c))
+    return false
+}
+
+// more reports whether the i-th member of the object or array that closes
+// with c follows, consuming the separating comma or the closing bracket.
+func (d *tmJSONDecoder) more(c byte, i int) bool {
+    d.ws()
+    if d.pos >= len(d.data) {
+        d.fail("unexpected end of JSON input")
+        return false
+    }
+    switch d.data[d.pos] {
+    case c:
+        d.pos++
+        return false
+    case ',':
+        if i > 0 {
+            d.pos++
+            return true
+        }
+    default:
+        if i == 0 {
+            return true
+        }
+    }
+    d.fail("expected , or " + string(c))
+    return false
+}
+
+// key reads an object key and the colon after it. The returned bytes are
+// only valid until the next read.
+func (d *tmJSONDecoder) key() []byte {
+    k := d.rawString()
+    d.ws()
+    if d.pos < len(d.data) && d.data[d.pos] == ':' {
+        d.pos++
+    } else {
+        d.fail("expected :")
+    }
+    return k
+}
+
+// rawString reads a JSON string. Strings without escapes are returned as a
+// slice of the input, others are unescaped into the scratch buffer.
+func (d *tmJSONDecoder) rawString() []byte {
+    d.ws()
+    if d.pos >= len(d.data) || d.data[d.pos] != '"' {
+        d.fail("expected string")
+        return nil
+    }
+    d.pos++
+    start := d.pos
+    for d.pos < len(d.data) {
+        switch c := d.data[d.pos]; {
+        case c == '"':
+            d.pos++
+            return d.data[start : d.pos-1]
+        case c == '\\':
+            return d.unescape(start)
+        case c < 0x20:
+            d.fail("invalid character in string")
+            return nil
+        }
+        d.pos++
+    }
+    d.fail("unexpected end of JSON input")
+    return nil
+}
+
+func (d *tmJSONDecoder) unescape(start int) []byte {
+    out := append(d.scratch[:0], d.data[start:d.pos]...)
+    for d.pos < len(d.data) {
+        c := d.data[d.pos]
+        switch {
+        case c == '"':
+            d.pos++
+            d.scratch = out
+            return out
+        case c < 0x20:
+            d.fail("invalid character in string")
+            return nil
+        case c != '\\':
+            out = append(out, c)
+            d.pos++
+            continue
+        }
+        if d.pos+1 >= len(d.data) {
+            break
+        }
+        d.pos += 2
+        switch e := d.data[d.pos-1]; e {
+        case '"', '\\', '/':
+            out = append(out, e)
+        case 'b':
+            out = append(out, '\b')
+        case 'f':
+            out = append(out, '\f')
+        case 'n':
+            out = append(out, '\n')
+        case 'r':
+            out = append(out, '\r')
+        case 't':
+            out = append(out, '\t')
+        case 'u':
+            r := d.hex4()
+            if r >= 0xd800 && r < 0xdc00 {
+                // A high surrogate must be followed by \u and a low one.
+                if d.pos+1 < len(d.data) && d.data[d.pos] == '\\' && d.data[d.pos+1] == 'u' {
+                    d.pos += 2
+                    if r2 := d.hex4(); r2 >= 0xdc00 && r2 < 0xe000 {
+                        r = (r-0xd800)<<10 | (r2 - 0xdc00) + 0x10000
+                    } else {
+                        r = utf8.RuneError
+                    }
+                } else {
+                    r = utf8.RuneError
+                }
+            }
+            out = utf8.AppendRune(out, r)
+        default:
+            d.fail("invalid escape in string")
+            return nil
+        }
+    }
+    d.fail("unexpected end of JSON input")
+    return nil
+}
+
+func (d *tmJSONDecoder) hex4() rune {
+    if d.pos+4 > len(d.data) {
+        d.fail("invalid unicode escape")
+        return 0
+    }
+    var r rune
+    for _, c := range d.data[d.pos : d.pos+4] {
+        switch {
+        case '0' <= c && c <= '9':
+            c -= '0'
+        case 'a' <= c && c <= 'f':
+            c -= 'a' - 10
+        case 'A' <= c && c <= 'F':
+            c -= 'A' - 10
+        default:
+            d.fail("invalid unicode escape")
+            return 0
+        }
+        r = r<<4 | rune(c)
+    }
+    d.pos += 4
+    return r
+}
+
+func (d *tmJSONDecoder) str() string {
+    return string(d.rawString())
+}
+
+func (d *tmJSONDecoder) bool() bool {
+    d.ws()
+    if d.pos+4 <= len(d.data) && string(d.data[d.pos:d.pos+4]) == "true" {
+        d.pos += 4
+        return true
+    }
+    if d.pos+5 <= len(d.data) && string(d.data[d.pos:d.pos+5]) == "false" {
+        d.pos += 5
+        return false
+    }
+    d.fail("expected boolean")
+    return false
+}
+
+// number returns the bytes of the next JSON number.
+func (d *tmJSONDecoder) number() []byte {
+    d.ws()
+    start := d.pos
+    for d.pos < len(d.data) {
+        switch c := d.data[d.pos]; {
+        case '0' <= c && c <= '9', c == '-', c == '+', c == '.', c == 'e', c == 'E':
+            d.pos++
+            continue
+        }
+        break
+    }
+    if start == d.pos {
+        d.fail("expected number")
+    }
+    return d.data[start:d.pos]
+}
+
+func (d *tmJSONDecoder) int(bits uint) int64 {
+    return d.parseInt(d.number(), bits)
+}
+
+func (d *tmJSONDecoder) uint(bits uint) uint64 {
+    return d.parseUint(d.number(), bits)
+}
+
+func (d *tmJSONDecoder) parseInt(num []byte, bits uint) int64 {
+    neg := len(num) > 0 && num[0] == '-'
+    if neg {
+        num = num[1:]
+    }
+    u := d.parseUint(num, 64)
+    limit := uint64(1) << (bits - 1)
+    if !neg && u >= limit || neg && u > limit {
+        d.fail("integer overflow")
+        return 0
+    }
+    if neg {
+        return -int64(u)
+    }
+    return int64(u)
+}
+
+func (d *tmJSONDecoder) parseUint(num []byte, bits uint) uint64 {
+    if len(num) == 0 || len(num) > 1 && num[0] == '0' {
+        d.fail("invalid integer")
+        return 0
+    }
+    var u uint64
+    for _, c := range num {
+        if c < '0' || c > '9' {
+            d.fail("invalid integer")
+            return 0
+        }
+        if u > math.MaxUint64/10 || u*10 > math.MaxUint64-uint64(c-'0') {
+            d.fail("integer overflow")
+            return 0
+        }
+        u = u*10 + uint64(c-'0')
+    }
+    if bits < 64 && u >= uint64(1)<<bits {
+        d.fail("integer overflow")
+        return 0
+    }
+    return u
+}
+
+var tmPow10 = [...]float64{1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22}
+
+func (d *tmJSONDecoder) float() float64 {
+    return d.parseFloat(d.number())
+}
+
+func (d *tmJSONDecoder) parseFloat(num []byte) float64 {
+    // Exact fast path for numbers with at most 15 significant digits and a
+    // small exponent, everything else goes through strconv.
+    i, neg := 0, false
+    if i < len(num) && num[i] == '-' {
+        neg = true
+        i++
+    }
+    var mant uint64
+    digits, exp := 0, 0
+    for ; i < len(num) && '0' <= num[i] && num[i] <= '9'; i++ {
+        mant = mant*10 + uint64(num[i]-'0')
+        digits++
+    }
+    if i < len(num) && num[i] == '.' {
+        for i++; i < len(num) && '0' <= num[i] && num[i] <= '9'; i++ {
+            mant = mant*10 + uint64(num[i]-'0')
+            digits++
+            exp--
+        }
+    }
+    if i == len(num) && digits > 0 && digits <= 15 && exp >= -22 {
+        f := float64(mant)
+        if exp < 0 {
+            f /= tmPow10[-exp]
+        }
+        if neg {
+            f = -f
+        }
+        return f
+    }
+    f, err := strconv.ParseFloat(string(num), 64)
+    if err != nil {
+        d.fail("invalid number")
+    }
+    return f
+}
+
+// skip consumes the next value whatever its type.
+func (d *tmJSONDecoder) skip() {
+    d.ws()
+    if d.pos >= len(d.data) {
+        d.fail("unexpected end of JSON input")
+        return
+    }
+    switch d.data[d.pos] {
+    case '{':
+        d.pos++
+        for i := 0; d.more('}', i); i++ {
+            d.key()
+            d.skip()
+        }
+    case '[':
+        d.pos++
+        for i := 0; d.more(']', i); i++ {
+            d.skip()
+        }
+    case '"':
+        d.rawString()
+    case 't', 'f':
+        d.bool()
+    case 'n':
+        if !d.null() {
+            d.fail("invalid literal")
+        }
+    default:
+        d.parseFloat(d.number())
+    }
+}
+
+func (d *tmJSONDecoder) any() interface{} {
+    d.ws()
+    start := d.pos
+    d.skip()
+    var v interface{}
+    if d.err == nil {
+        if err := json.Unmarshal(d.data[start:d.pos], &v); err != nil {
+            d.fail(err.Error())
+        }
+    }
+    return v
+}
+
+func (d *tmJSONDecoder) keyBool(key []byte) bool {
+    switch string(key) {
+    case "true":
+        return true
+    case "false":
+        return false
+    }
+    d.fail("invalid boolean key")
+    return false
+}
+)";
+
+// Support code for the generated binary codec, see src/wire_format.h. It is
+// emitted after `kJson`, whose tmAppendAny encodes `any` values.
+constexpr char kBinary[] = R"(
+// tmBinaryError reports malformed input to a generated binary decoder.
+type tmBinaryError struct {
+    msg    string
+    offset int
+}
+
+func (e *tmBinaryError) Error() string {
+    return "toolman: " + e.msg + " at offset " + strconv.Itoa(e.offset)
+}
+
+func tmAppendVarint(b []byte, v uint64) []byte {
+    for v >= 0x80 {
+        b = append(b, byte(v)|0x80)
+        v >>= 7
+    }
+    return append(b, byte(v))
+}
+
+func tmAppendZigzag(b []byte, v int64) []byte {
+    return tmAppendVarint(b, uint64(v<<1)^uint64(v>>63))
+}
+
+func tmAppendBool(b []byte, v bool) []byte {
+    if v {
+        return append(b, 1)
+    }
+    return append(b, 0)
+}
+
+func tmAppendFixed64(b []byte, v float64) []byte {
+    u := math.Float64bits(v)
+    return append(b, byte(u), byte(u>>8), byte(u>>16), byte(u>>24),
+        byte(u>>32), byte(u>>40), byte(u>>48), byte(u>>56))
+}
+
+func tmAppendBytes(b []byte, s string) []byte {
+    b = tmAppendVarint(b, uint64(len(s)))
+    return append(b, s...)
+}
+
+// tmEndLen fills in the one byte length prefix reserved in front of
+// b[start:], moving the value up when its length needs a longer varint.
+func tmEndLen(b []byte, start int) []byte {
+    n := len(b) - start
+    if n < 0x80 {
+        b[start-1] = byte(n)
+        return b
+    }
+    var prefix [10]byte
+    l := len(tmAppendVarint(prefix[:0], uint64(n)))
+    b = append(b, prefix[:l-1]...)
+    copy(b[start+l-1:], b[start:start+n])
+    copy(b[start-1:], prefix[:l])
+    return b
+}
+
+// tmBinaryDecoder reads the binary wire format. The first error sticks and
+// moves the position to the end, which ends every decoding loop.
+type tmBinaryDecoder struct {
+    data []byte
+    pos  int
+    err  error
+}
+
+func (d *tmBinaryDecoder) fail(msg string) {
+    if d.err == nil {
+        d.err = &tmBinaryError{msg, d.pos}
+    }
+    d.pos = len(d.data)
+}
+
+func (d *tmBinaryDecoder) varint() uint64 {
+    var v uint64
+    for shift := uint(0); shift < 64; shift += 7 {
+        if d.pos >= len(d.data) {
+            d.fail("unexpected end of input")
+            return 0
+        }
+        c := d.data[d.pos]
+        d.pos++
+        v |= uint64(c&0x7f) << shift
+        if c < 0x80 {
+            return v
+        }
+    }
+    d.fail("malformed varint")
+    return 0
+}
+
+func (d *tmBinaryDecoder) zigzag() int64 {
+    v := d.varint()
+    return int64(v>>1) ^ -int64(v&1)
+}
+
+func (d *tmBinaryDecoder) fixed64() float64 {
+    if len(d.data)-d.pos < 8 {
+        d.fail("unexpected end of input")
+        return 0
+    }
+    b := d.data[d.pos : d.pos+8]
+    d.pos += 8
+    return math.Float64frombits(uint64(b[0]) | uint64(b[1])<<8 |
+        uint64(b[2])<<16 | uint64(b[3])<<24 | uint64(b[4])<<32 |
+        uint64(b[5])<<40 | uint64(b[6])<<48 | uint64(b[7])<<56)
+}
+
+// limit reads a length prefix and returns the offset the value ends at.
+func (d *tmBinaryDecoder) limit() int {
+    n := d.varint()
+    if n > uint64(len(d.data)-d.pos) {
+        d.fail("length exceeds input")
+        return d.pos
+    }
+    return d.pos + int(n)
+}
+
+// count reads an element count. Every element takes at least one byte, so
+// a count larger than what is left before end is malformed.
+func (d *tmBinaryDecoder) count(end int) int {
+    n := d.varint()
+    if n > uint64(end-d.pos) {
+        d.fail("count exceeds input")
+        return 0
+    }
+    return int(n)
+}
+
+// done checks that a length-delimited value ended where its prefix said.
+func (d *tmBinaryDecoder) done(end int) {
+    if d.pos != end {
+        d.fail("length mismatch")
+    }
+}
+
+func (d *tmBinaryDecoder) bytes() []byte {
+    end := d.limit()
+    b := d.data[d.pos:end]
+    d.pos = end
+    return b
+}
+
+func (d *tmBinaryDecoder) key() (uint64, int) {
+    k := d.varint()
+    return k >> 3, int(k & 7)
+}
+
+func (d *tmBinaryDecoder) expect(wireType, want int) bool {
+    if wireType != want {
+        d.fail("wrong wire type")
+        return false
+    }
+    return true
+}
+
+func (d *tmBinaryDecoder) skip(wireType int) {
+    switch wireType {
+    case 0:
+        d.varint()
+    case 1:
+        if len(d.data)-d.pos < 8 {
+            d.fail("unexpected end of input")
+        } else {
+            d.pos += 8
+        }
+    case 2:
+        d.pos = d.limit()
+    default:
+        d.fail("unknown wire type")
+    }
+}
+
+func (d *tmBinaryDecoder) any() interface{} {
+    var v interface{}
+    if b := d.bytes(); d.err == nil {
+        if err := json.Unmarshal(b, &v); err != nil {
+            d.fail(err.Error())
+        }
+    }
+    return v
+}
+)";
+
+// Support code for the generated HTTP servers and clients, which also use
+// the JSON runtime and `import "sync"`. Bodies are read into and written
+// from pooled buffers.
+constexpr char kHttpImports[] =
+    R"(    "io"
+    "net/http"
+    "strings"
+)";
+
+constexpr char kHttp[] = R"(
+var tmHTTPBuffers = sync.Pool{New: func() interface{} { return new([]byte) }}
+
+var tmHTTPJSON = []string{"application/json"}
+
+// tmHTTPRead reads r into *buf, reusing its capacity.
+func tmHTTPRead(r io.Reader, buf *[]byte) error {
+    b := (*buf)[:0]
+    for {
+        if len(b) == cap(b) {
+            b = append(b, 0)[:len(b)]
+        }
+        n, err := r.Read(b[len(b):cap(b)])
+        b = b[:len(b)+n]
+        if err == io.EOF {
+            break
+        }
+        if err != nil {
+            *buf = b
+            return err
+        }
+    }
+    *buf = b
+    return nil
+}
+)";
+
+constexpr char kHttpServerImports[] =
+    R"(    "net/url"
+)";
+
+constexpr char kHttpServer[] = R"(
+// tmHTTPWrite responds with b as the JSON body, or with no body if b is
+// empty.
+func tmHTTPWrite(w http.ResponseWriter, status int, b []byte) {
+    if len(b) != 0 {
+        w.Header()["Content-Type"] = tmHTTPJSON
+    }
+    w.WriteHeader(status)
+    w.Write(b)
+}
+
+func tmHTTPMethodNotAllowed(w http.ResponseWriter, allow string) {
+    w.Header().Set("Allow", allow)
+    http.Error(w, http.StatusText(http.StatusMethodNotAllowed),
+        http.StatusMethodNotAllowed)
+}
+)";
+
+constexpr char kHttpClientImports[] =
+    R"(    "bytes"
+    "context"
+)";
+
+constexpr char kHttpClient[] = R"(
+// ToolmanHTTPError reports a response whose status the api does not
+// declare.
+type ToolmanHTTPError struct {
+    Status int
+    Body   []byte
+}
+
+func (e *ToolmanHTTPError) Error() string {
+    return "toolman: unexpected HTTP status " + strconv.Itoa(e.Status)
+}
+
+// tmAppendPathSegment appends s to b, escaped to make up one path segment.
+func tmAppendPathSegment(b []byte, s string) []byte {
+    const hex = "0123456789ABCDEF"
+    for i := 0; i < len(s); i++ {
+        c := s[i]
+        if 'a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' ||
+            '0' <= c && c <= '9' || c == '-' || c == '.' || c == '_' ||
+            c == '~' {
+            b = append(b, c)
+        } else {
+            b = append(b, '%', hex[c>>4], hex[c&15])
+        }
+    }
+    return b
+}
+
+// tmHTTPDo sends a request with body, unless it is nil, as its JSON body.
+// It returns the status and the body of the response, in a pooled buffer
+// that the caller puts back.
+func tmHTTPDo(ctx context.Context, c *http.Client, method string, u []byte,
+    body []byte) (int, *[]byte, error) {
+    var r io.Reader
+    if body != nil {
+        r = bytes.NewReader(body)
+    }
+    req, err := http.NewRequestWithContext(ctx, method, string(u), r)
+    if err != nil {
+        return 0, nil, err
+    }
+    if body != nil {
+        req.Header["Content-Type"] = tmHTTPJSON
+    }
+    res, err := c.Do(req)
+    if err != nil {
+        return 0, nil, err
+    }
+    defer res.Body.Close()
+    buf := tmHTTPBuffers.Get().(*[]byte)
+    if err := tmHTTPRead(res.Body, buf); err != nil {
+        tmHTTPBuffers.Put(buf)
+        return 0, nil, err
+    }
+    return res.StatusCode, buf, nil
+}
+)";
+
+// Support code for the generated Validate methods. A failure allocates its
+// error, and its path is built on the way back up from the bad value.
+constexpr char kValidation[] = R"(
+// ToolmanValidationError reports a value that breaks a constraint declared
+// on the field at Path.
+type ToolmanValidationError struct {
+    Path   string
+    Reason string
+}
+
+func (e *ToolmanValidationError) Error() string {
+    return "toolman: " + e.Path + " " + e.Reason
+}
+
+func tmInvalid(path, reason string) error {
+    return &ToolmanValidationError{Path: path, Reason: reason}
+}
+
+// tmInvalidIn prefixes the path of err, reported by the Validate method of
+// a struct, with the path of the field holding it.
+func tmInvalidIn(err error, path string) error {
+    if e, ok := err.(*ToolmanValidationError); ok {
+        return &ToolmanValidationError{Path: path + "." + e.Path, Reason: e.Reason}
+    }
+    return err
+}
+
+func tmIndex(path string, i int) string {
+    return path + "[" + strconv.Itoa(i) + "]"
+}
+
+func tmKey(path, key string) string {
+    return path + "[" + key + "]"
+}
+)";
+
+// Support code for the generated DecodeJSONStream methods, emitted after
+// `kJson`. It needs the io package.
+constexpr char kStream[] = R"(
+// tmJSONStream reads a JSON document from r one value at a time, so that it
+// holds no more than the largest value it reads whole, plus what it has read
+// ahead. Each value is decoded by a tmJSONDecoder over its bytes. Errors are
+// sticky, as they are for tmJSONDecoder.
+type tmJSONStream struct {
+    r   io.Reader
+    buf []byte
+    pos int
+    // off is the offset of buf[0] in the input, base that of the value d
+    // decodes.
+    off  int
+    base int
+    eof  bool
+    err  error
+    d    tmJSONDecoder
+    k    []byte
+}
+
+// halt ends the read with err, unless it has failed already.
+func (s *tmJSONStream) halt(err error) {
+    if s.err == nil {
+        s.err = err
+    }
+    s.eof = true
+    s.buf, s.pos = s.buf[:0], 0
+}
+
+func (s *tmJSONStream) fail(msg string) {
+    s.halt(&tmJSONError{msg: msg, offset: s.off + s.pos})
+}
+
+// read drops the input before buf[pos] and appends more, growing buf only
+// when it is full of the value being read. It reports false at the end of
+// the input.
+func (s *tmJSONStream) read() bool {
+    if s.pos > 0 {
+        n := copy(s.buf, s.buf[s.pos:])
+        s.off += s.pos
+        s.buf, s.pos = s.buf[:n], 0
+    }
+    if len(s.buf) == cap(s.buf) {
+        grown := make([]byte, len(s.buf), 2*cap(s.buf)+4096)
+        copy(grown, s.buf)
+        s.buf = grown
+    }
+    for !s.eof {
+        n, err := s.r.Read(s.buf[len(s.buf):cap(s.buf)])
+        s.buf = s.buf[:len(s.buf)+n]
+        if err != nil {
+            if err != io.EOF && s.err == nil {
+                s.err = err
+            }
+            s.eof = true
+        }
+        if n > 0 {
+            return true
+        }
+    }
+    return false
+}
+
+// peek skips whitespace and returns the next byte, 0 at the end of the
+// input.
+func (s *tmJSONStream) peek() byte {
+    for {
+        for s.pos < len(s.buf) {
+            switch c := s.buf[s.pos]; c {
+            case ' ', '\t', '\n', '\r':
+                s.pos++
+            default:
+                return c
+            }
+        }
+        if !s.read() {
+            return 0
+        }
+    }
+}
+
+// value reads the next value whole and returns a decoder over it, valid
+// until the next read. Brackets are only counted here; the decoder checks
+// the value.
+func (s *tmJSONStream) value() *tmJSONDecoder {
+    if s.peek() == 0 {
+        s.fail("unexpected end of JSON input")
+    }
+    n, depth, str, esc := 0, 0, false, false
+scan:
+    for {
+        if s.pos+n == len(s.buf) && !s.read() {
+            break
+        }
+        c := s.buf[s.pos+n]
+        if str {
+            n++
+            switch {
+            case esc:
+                esc = false
+            case c == '\\':
+                esc = true
+            case c == '"':
+                str = false
+                if depth == 0 {
+                    break scan
+                }
+            }
+            continue
+        }
+        switch c {
+        case '"':
+            str = true
+        case '{', '[':
+            depth++
+        case '}', ']':
+            if depth == 0 {
+                break scan
+            }
+            if depth--; depth == 0 {
+                n++
+                break scan
+            }
+        case ',', ':', ' ', '\t', '\n', '\r':
+            if depth == 0 {
+                break scan
+            }
+        }
+        n++
+    }
+    s.d = tmJSONDecoder{data: s.buf[s.pos : s.pos+n], scratch: s.d.scratch}
+    s.base = s.off + s.pos
+    s.pos += n
+    return &s.d
+}
+
+// done checks that d, returned by value, was decoded whole, and reports
+// whether the read has not failed.
+func (s *tmJSONStream) done(d *tmJSONDecoder) bool {
+    if err := d.end(); err != nil {
+        if e, ok := err.(*tmJSONError); ok {
+            e.offset += s.base
+        }
+        s.halt(err)
+    }
+    return s.err == nil
+}
+
+func (s *tmJSONStream) null() bool {
+    if s.peek() != 'n' {
+        return false
+    }
+    d := s.value()
+    if !d.null() {
+        d.fail("invalid literal")
+    }
+    s.done(d)
+    return true
+}
+
+func (s *tmJSONStream) begin(c byte) bool {
+    if s.peek() == c {
+        s.pos++
+        return true
+    }
+    s.fail("expected " + string(c))
+    return false
+}
+
+func (s *tmJSONStream) more(c byte, i int) bool {
+    switch s.peek() {
+    case 0:
+        s.fail("unexpected end of JSON input")
+        return false
+    case c:
+        s.pos++
+        return false
+    case ',':
+        if i > 0 {
+            s.pos++
+            return true
+        }
+    default:
+        if i == 0 {
+            return true
+        }
+    }
+    s.fail("expected , or " + string(c))
+    return false
+}
+
+// key reads an object key and the colon after it. The returned bytes are
+// only valid until the next key.
+func (s *tmJSONStream) key() []byte {
+    d := s.value()
+    s.k = append(s.k[:0], d.rawString()...)
+    s.done(d)
+    if s.peek() == ':' {
+        s.pos++
+    } else {
+        s.fail("expected :")
+    }
+    return s.k
+}
+
+func (s *tmJSONStream) skip() {
+    d := s.value()
+    d.skip()
+    s.done(d)
+}
+
+func (s *tmJSONStream) end() error {
+    if s.peek() != 0 {
+        s.fail("unexpected data after top-level value")
+    }
+    return s.err
+}
+)";
+
+// Support code for the generated field masks, emitted after `kJson`, which
+// imports strconv.
+constexpr char kMask[] = R"(
+// ToolmanMaskError reports a field mask path that does not name a field.
+type ToolmanMaskError struct {
+    Path string
+}
+
+func (e *ToolmanMaskError) Error() string {
+    return "toolman: no field at " + strconv.Quote(e.Path)
+}
+
+// tmCut splits s around the first sep, if there is one.
+func tmCut(s string, sep byte) (string, string, bool) {
+    for i := 0; i < len(s); i++ {
+        if s[i] == sep {
+            return s[:i], s[i+1:], true
+        }
+    }
+    return s, "", false
+}
+)";
+
+// Support code for the generated DeepCopy methods.
+constexpr char kCopy[] = R"(
+// tmCopyAny copies an `any` value, decoded from JSON, whose maps and slices
+// are the only storage it can share.
+func tmCopyAny(v interface{}) interface{} {
+    switch v := v.(type) {
+    case map[string]interface{}:
+        c := make(map[string]interface{}, len(v))
+        for k, e := range v {
+            c[k] = tmCopyAny(e)
+        }
+        return c
+    case []interface{}:
+        c := make([]interface{}, len(v))
+        for i, e := range v {
+            c[i] = tmCopyAny(e)
+        }
+        return c
+    }
+    return v
+}
+)";
+
+}  // namespace toolman::generator::golang_runtime
+
+#endif  // TOOLMAN_GOLANG_RUNTIME_H_
@@ -16,10 +16,10 @@ namespace toolman {
 
 struct ImportName {
   bool operator<(const ImportName& rhs) const {
-    if (rhs.original_name == rhs.original_name) {
-      return rhs.local_name < rhs.local_name;
+    if (original_name == rhs.original_name) {
+      return local_name < rhs.local_name;
     }
-    return rhs.original_name < rhs.original_name;
+    return original_name < rhs.original_name;
   }
 
   bool operator==(const ImportName& rhs) const {
@@ -5,16 +5,29 @@
 #ifndef TOOLMAN_JAVA_GENERATOR_H_
 #define TOOLMAN_JAVA_GENERATOR_H_
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/field.h"
 #include "src/generator.h"
+#include "src/java_runtime.h"
 #include "src/list_type.h"
 #include "src/map_type.h"
+#include "src/perfect_hash.h"
 #include "src/primitive_type.h"
+#include "src/route_tree.h"
 #include "src/scope.h"
+#include "src/validation.h"
+#include "src/wire_format.h"
 
 namespace toolman::generator {
 class JavaGenerator : public Generator {
@@ -27,8 +40,48 @@ class JavaGenerator : public Generator {
         auto bool_opt = std::dynamic_pointer_cast<decltype(
             buildin::option_use_java8_optional)>(opt);
         use_java8_optional_ = bool_opt->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_java_json_codec.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_java_json_codec)>(opt);
+        json_codec_ = bool_opt->get_value();
+      } else if (opt->get_name() == buildin::option_binary_codec.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_binary_codec)>(opt);
+        binary_codec_ = bool_opt->get_value();
+      } else if (opt->get_name() == buildin::option_binary_views.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_binary_views)>(opt);
+        binary_views_ = bool_opt->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_java_primitive_lists.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_java_primitive_lists)>(opt);
+        primitive_lists_ = bool_opt->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_java_presence_bits.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_java_presence_bits)>(opt);
+        presence_bits_ = bool_opt->get_value();
+      } else if (opt->get_name() == buildin::option_http_client.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_http_client)>(opt);
+        http_client_ = bool_opt->get_value();
+      } else if (opt->get_name() == buildin::option_deep_copy.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_deep_copy)>(opt);
+        deep_copy_ = bool_opt->get_value();
+      } else if (opt->get_name() == buildin::option_json_streams.get_name()) {
+        auto bool_opt = std::dynamic_pointer_cast<decltype(
+            buildin::option_json_streams)>(opt);
+        streams_ = bool_opt->get_value();
       }
     }
+    http_client_ = http_client_ && !document->get_api_groups().empty();
+    json_codec_ = json_codec_ || http_client_ || streams_;
+    for (const auto &struct_type : document->get_struct_types()) {
+      validation_ = validation_ || needs_validation(struct_type.get());
+    }
 
     auto outclass =
         capitalize(camelcase(document->get_source()->stem().string()));
@@ -37,6 +90,30 @@ class JavaGenerator : public Generator {
   }
   void after_generate_document(std::ostream &ostream,
                                const Document *document) override {
+    if (http_client_) {
+      for (const auto &api_group : document->get_api_groups()) {
+        generate_http_client(ostream, api_group);
+      }
+    }
+    // `any` values are JSON text in the binary format too.
+    if (json_codec_ || binary_codec_ || binary_views_) {
+      ostream << java_runtime::kJson;
+    }
+    if (streams_) {
+      ostream << java_runtime::kStream;
+    }
+    if (binary_codec_ || binary_views_) {
+      ostream << java_runtime::kBinary;
+    }
+    if (http_client_) {
+      ostream << java_runtime::kHttpClient;
+    }
+    if (validation_) {
+      ostream << java_runtime::kValidation;
+    }
+    if (deep_copy_) {
+      ostream << java_runtime::kCopy;
+    }
     ostream << NL << "}" << NL;
   }
 
@@ -54,9 +131,11 @@ class JavaGenerator : public Generator {
           for (const auto &oneof_field : oneof->get_fields()) {
             auto field_name = camelcase(oneof_field.get_name());
             auto oneof_item_class_name = struct_name + capitalize(field_name);
-            ostream << INDENT_1 << "public class " << oneof_item_class_name
-                    << " implements " << oneof_name << " {" << NL2
-                    << generate_doc_comment(field.get_comments(), INDENT_2)
+            ostream << INDENT_1 << "public static final class "
+                    << oneof_item_class_name << " implements " << oneof_name
+                    << " {" << NL2
+                    << generate_doc_comment(oneof_field.get_comments(),
+                                            INDENT_2)
                     << INDENT_2
                     << generate_struct_field(struct_type.get(), oneof_field)
                     << NL
@@ -84,16 +163,59 @@ class JavaGenerator : public Generator {
 
     for (const auto &field : struct_type->get_fields()) {
       ostream << generate_doc_comment(field.get_comments(), INDENT_2)
-              << INDENT_2 << generate_struct_field(struct_type.get(), field)
+              << INDENT_2
+              << (has_presence_bit(field)
+                      ? "private " +
+                            type_to_java_type(field.get_type().get()) + " " +
+                            camelcase(field.get_name()) + ";"
+                      : generate_struct_field(struct_type.get(), field))
+              << NL;
+    }
+    auto bits = presence_bit_count(struct_type.get());
+    if (bits > 0) {
+      ostream << INDENT_2 << "// One bit per optional primitive field, set "
+                             "while it has a value."
               << NL;
     }
+    for (std::size_t i = 0; i * (bits > 32 ? 64 : 32) < bits; ++i) {
+      ostream << INDENT_2 << "private " << (bits > 32 ? "long" : "int")
+              << " presence" << i << ";" << NL;
+    }
     ostream << NL;
 
     for (const auto &field : struct_type->get_fields()) {
+      if (has_presence_bit(field)) {
+        ostream << generate_presence_accessors(struct_type.get(), field,
+                                               INDENT_2);
+        continue;
+      }
       ostream << generate_getter_and_setter(struct_type.get(), field, INDENT_2);
+      if (presence_bits_ && field.is_optional()) {
+        ostream << generate_has_and_clear(field, INDENT_2);
+      }
+    }
+
+    if (needs_validation(struct_type.get())) {
+      generate_validate(ostream, struct_type.get());
+    }
+    if (deep_copy_) {
+      generate_deep_copy(ostream, struct_type.get());
+    }
+    if (json_codec_) {
+      generate_json_codec(ostream, struct_type.get());
+    }
+    if (streams_) {
+      generate_streams(ostream, struct_type.get());
+    }
+    if (binary_codec_) {
+      generate_binary_codec(ostream, struct_type.get());
     }
 
     ostream << INDENT_1 << "}" << NL2;
+
+    if (binary_views_) {
+      generate_binary_view(ostream, struct_type.get());
+    }
   }
 
   void generate_enum(std::ostream &ostream,
@@ -108,28 +230,319 @@ class JavaGenerator : public Generator {
     }
     ostream << INDENT_2 << ";" << NL;
 
-    ostream << INDENT_2 << "public static "
-            << (use_java8_optional_ ? "java.util.Optional<" : "")
-            << enum_type->get_name() << (use_java8_optional_ ? ">" : "")
-            << " forNumber(int value) {" << NL << INDENT_3 << "switch (value) {"
-            << NL;
-    for (const auto &field : enum_type->get_fields()) {
-      ostream << INDENT_4 << "case " << field.get_value() << ": return "
-              << (use_java8_optional_ ? "java.util.Optional.of(" : "")
-              << camelcase(field.get_name())
-              << (use_java8_optional_ ? ");" : ";") << NL;
-    }
-    ostream << INDENT_4 << "default: return "
-            << (use_java8_optional_ ? "java.util.Optional.empty();" : "null;")
-            << NL << INDENT_3 << "}" << NL << INDENT_2 << "}" << NL;
+    generate_enum_lookups(ostream, enum_type.get());
 
     ostream << INDENT_2 << "private final int value;" << NL << INDENT_2
             << "private " + enum_type->get_name() + "(int value) {" << NL
             << INDENT_3 << "this.value = value;" << NL << INDENT_2 << "}" << NL
-            << INDENT_1 << "}";
+            << INDENT_2 << "public int getNumber() {" << NL << INDENT_3
+            << "return value;" << NL << INDENT_2 << "}" << NL << INDENT_1
+            << "}";
   }
 
  private:
+  // forNumber indexes an array when the values are dense and a perfect
+  // hash table otherwise; forName looks up the declared names through a
+  // perfect hash of their String.hashCode(). Both fall back to a switch
+  // when no perfect hash is found.
+  void generate_enum_lookups(std::ostream &ostream,
+                             const EnumType *enum_type) const {
+    auto name = enum_type->get_name();
+    auto fields = enum_type->get_fields();
+    auto result = use_java8_optional_ ? "java.util.Optional<" + name + ">"
+                                      : name;
+    auto wrap = [&](const std::string &expr) {
+      return use_java8_optional_ ? "java.util.Optional.ofNullable(" + expr +
+                                       ")"
+                                 : expr;
+    };
+
+    std::vector<std::uint32_t> values;
+    std::vector<std::uint32_t> names;
+    for (const auto &field : fields) {
+      values.push_back(static_cast<std::uint32_t>(field.get_value()));
+      names.push_back(
+          static_cast<std::uint32_t>(java_string_hash(field.get_name())));
+    }
+    auto value_hash = enum_type->is_dense() ? std::nullopt
+                                            : find_perfect_hash(values);
+    auto name_hash = find_perfect_hash(names);
+
+    if (enum_type->is_dense()) {
+      std::vector<std::string> slots(enum_type->get_value_span(), "null");
+      for (const auto &field : fields) {
+        auto &slot = slots[field.get_value() - enum_type->get_min_value()];
+        if (slot == "null") {
+          slot = camelcase(field.get_name());
+        }
+      }
+      ostream << INDENT_2 << "private static final " << name
+              << "[] BY_NUMBER = " << java_array(slots) << ";" << NL
+              << INDENT_2 << "public static " << result
+              << " forNumber(int value) {" << NL << INDENT_3 << name
+              << " c = value < " << enum_type->get_min_value()
+              << " || value > " << enum_type->get_max_value()
+              << " ? null : BY_NUMBER[value - " << enum_type->get_min_value()
+              << "];" << NL << INDENT_3 << "return " << wrap("c") << ";" << NL
+              << INDENT_2 << "}" << NL;
+    } else if (value_hash.has_value()) {
+      std::vector<std::string> slots;
+      for (auto i : value_hash->slots) {
+        slots.push_back(i < 0 ? "null" : camelcase(fields[i].get_name()));
+      }
+      ostream << INDENT_2 << "private static final " << name
+              << "[] BY_NUMBER = " << java_array(slots) << ";" << NL
+              << INDENT_2 << "public static " << result
+              << " forNumber(int value) {" << NL << INDENT_3 << name
+              << " c = BY_NUMBER[(value * " << hex(value_hash->multiplier)
+              << ") >>> " << value_hash->shift() << "];" << NL << INDENT_3
+              << "return " << wrap("c != null && c.value == value ? c : null")
+              << ";" << NL << INDENT_2 << "}" << NL;
+    } else {
+      ostream << INDENT_2 << "public static " << result
+              << " forNumber(int value) {" << NL << INDENT_3
+              << "switch (value) {" << NL;
+      for (const auto &field : fields) {
+        ostream << INDENT_4 << "case " << field.get_value() << ": return "
+                << wrap(camelcase(field.get_name())) << ";" << NL;
+      }
+      ostream << INDENT_4 << "default: return " << wrap("null") << ";" << NL
+              << INDENT_3 << "}" << NL << INDENT_2 << "}" << NL;
+    }
+
+    if (name_hash.has_value()) {
+      std::vector<std::string> slot_names;
+      std::vector<std::string> slots;
+      for (auto i : name_hash->slots) {
+        slot_names.push_back(i < 0 ? "null"
+                                   : "\"" + fields[i].get_name() + "\"");
+        slots.push_back(i < 0 ? "null" : camelcase(fields[i].get_name()));
+      }
+      ostream << INDENT_2 << "private static final String[] NAMES = "
+              << java_array(slot_names) << ";" << NL << INDENT_2
+              << "private static final " << name
+              << "[] BY_NAME = " << java_array(slots) << ";" << NL << INDENT_2
+              << "public static " << result << " forName(String name) {"
+              << NL << INDENT_3 << "int i = (name.hashCode() * "
+              << hex(name_hash->multiplier) << ") >>> " << name_hash->shift()
+              << ";" << NL << INDENT_3 << "return "
+              << wrap("name.equals(NAMES[i]) ? BY_NAME[i] : null") << ";"
+              << NL << INDENT_2 << "}" << NL;
+    } else {
+      ostream << INDENT_2 << "public static " << result
+              << " forName(String name) {" << NL << INDENT_3
+              << "switch (name) {" << NL;
+      for (const auto &field : fields) {
+        ostream << INDENT_4 << "case \"" << field.get_name() << "\": return "
+                << wrap(camelcase(field.get_name())) << ";" << NL;
+      }
+      ostream << INDENT_4 << "default: return " << wrap("null") << ";" << NL
+              << INDENT_3 << "}" << NL << INDENT_2 << "}" << NL;
+    }
+  }
+
+  // Clients build the URL of a call in a presized StringBuilder from the
+  // parts of its path as split at code generation time, and read response
+  // bodies with the generated JSON codec.
+  void generate_http_client(std::ostream &ostream,
+                            const ApiGroup &api_group) const {
+    auto group = capitalize(api_group.get_group_name());
+    auto client = group + "Client";
+    const auto &apis = api_group.get_apis();
+    auto names = api_method_names(api_group);
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      generate_http_response(ostream, group + names[i] + "Response", apis[i]);
+    }
+
+    ostream << INDENT_1 << "public static final class " << client << " {"
+            << NL;
+    // Enum params are sent by their declared names, looked up by ordinal.
+    std::vector<const Type *> enums;
+    for (const auto &api : apis) {
+      for (const auto &param : api.get_path_params()) {
+        auto type = param.field.get_type().get();
+        if (type->is_enum() &&
+            std::find(enums.begin(), enums.end(), type) == enums.end()) {
+          enums.push_back(type);
+          std::vector<std::string> slots;
+          for (const auto &field :
+               dynamic_cast<const EnumType *>(type)->get_fields()) {
+            slots.push_back("\"" + field.get_name() + "\"");
+          }
+          ostream << INDENT_2 << "private static final String[] "
+                  << enum_names_constant(type) << " = " << java_array(slots)
+                  << ";" << NL;
+        }
+      }
+    }
+    ostream << INDENT_2 << "private final java.net.http.HttpClient client;"
+            << NL << INDENT_2 << "private final String base;" << NL2
+            << INDENT_2 << "public " << client
+            << "(String base, java.net.http.HttpClient client) {" << NL
+            << INDENT_3
+            << "this.base = base.endsWith(\"/\") ? "
+               "base.substring(0, base.length() - 1) : base;"
+            << NL << INDENT_3 << "this.client = client;" << NL << INDENT_2
+            << "}" << NL2 << INDENT_2 << "public " << client
+            << "(String base) {" << NL << INDENT_3
+            << "this(base, java.net.http.HttpClient.newHttpClient());" << NL
+            << INDENT_2 << "}" << NL;
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      const auto &api = apis[i];
+      auto response = group + names[i] + "Response";
+      const auto &params = api.get_path_params();
+      auto parts = route_parts(api);
+      auto body_type = api.get_body_param().get();
+
+      ostream << NL << INDENT_2 << "public " << response << " "
+              << decapitalize(names[i]) << "(";
+      std::size_t size = 0;
+      std::string dynamic_size;
+      for (const auto &part : parts) {
+        size += part.size();
+      }
+      for (const auto &param : params) {
+        auto type = param.field.get_type().get();
+        auto name = http_param_name(param.field);
+        ostream << type_to_java_type(type) << " " << name << ", ";
+        size += path_param_size(type);
+        if (type->is_primitive() &&
+            dynamic_cast<const PrimitiveType *>(type)->is_string()) {
+          dynamic_size += " + " + name + ".length()";
+        }
+      }
+      ostream << type_to_java_type(body_type) << " body)" << NL << INDENT_4
+              << "throws java.io.IOException, InterruptedException {" << NL
+              << INDENT_3
+              << "StringBuilder u = new StringBuilder(base.length() + " << size
+              << dynamic_size << ");" << NL << INDENT_3 << "u.append(base);"
+              << NL;
+      for (std::size_t j = 0; j < parts.size(); ++j) {
+        if (!parts[j].empty()) {
+          ostream << INDENT_3 << "u.append(\"" << parts[j] << "\");" << NL;
+        }
+        if (j == params.size()) {
+          break;
+        }
+        auto name = http_param_name(params[j].field);
+        auto type = params[j].field.get_type().get();
+        ostream << INDENT_3;
+        if (type->is_enum()) {
+          ostream << "u.append(" << enum_names_constant(type) << "[" << name
+                  << ".ordinal()]);";
+        } else {
+          auto primitive = dynamic_cast<const PrimitiveType *>(type);
+          if (primitive->is_string()) {
+            ostream << "ToolmanHttp.appendSegment(u, " << name << ");";
+          } else if (primitive->is_u32()) {
+            ostream << "u.append(Integer.toUnsignedString(" << name << "));";
+          } else if (primitive->is_u64()) {
+            ostream << "u.append(Long.toUnsignedString(" << name << "));";
+          } else {
+            ostream << "u.append(" << name << ");";
+          }
+        }
+        ostream << NL;
+      }
+      ostream << INDENT_3 << "byte[] b = null;" << NL << INDENT_3
+              << "if (body != null) {" << NL << INDENT_4
+              << "ToolmanJsonWriter w = new ToolmanJsonWriter();" << NL
+              << INDENT_4
+              << (body_type->is_enum() ? "w.writeInt(body.getNumber());"
+                                       : "body.writeJson(w);")
+              << NL << INDENT_4 << "b = w.toByteArray();" << NL << INDENT_3
+              << "}" << NL << INDENT_3
+              << "java.net.http.HttpResponse<byte[]> res = "
+                 "ToolmanHttp.send(client, \""
+              << http_method_to_string(api.get_http_method()) << "\", u, b);"
+              << NL << INDENT_3 << "switch (res.statusCode()) {" << NL;
+      for (const auto &api_return : api.get_returns()) {
+        auto status = std::to_string(api_return.http_status_code_);
+        if (api_return.resp_ == nullptr) {
+          ostream << INDENT_4 << "case " << status << ":" << NL << INDENT_4
+                  << INDENT_1 << "return new " << response << "(" << status
+                  << ", null);" << NL;
+          continue;
+        }
+        ostream << INDENT_4 << "case " << status << ": {" << NL << INDENT_4
+                << INDENT_1 << "ToolmanJsonReader r = "
+                << "ToolmanHttp.reader(res.body());" << NL;
+        generate_json_decode(ostream, nullptr, "", api_return.resp_.get(), "v",
+                             false, std::string(INDENT_4) + INDENT_1, 1);
+        ostream << INDENT_4 << INDENT_1 << "r.end();" << NL << INDENT_4
+                << INDENT_1 << "return new " << response << "(" << status
+                << ", v);" << NL << INDENT_4 << "}" << NL;
+      }
+      ostream << INDENT_4 << "default:" << NL << INDENT_4 << INDENT_1
+              << "throw new ToolmanHttpException(res.statusCode(), "
+                 "res.body());"
+              << NL << INDENT_3 << "}" << NL << INDENT_2 << "}" << NL;
+    }
+    ostream << INDENT_1 << "}" << NL2;
+  }
+
+  // The result of a call: its status and the body declared for it, read
+  // through the getter for that status.
+  void generate_http_response(std::ostream &ostream,
+                              const std::string &response,
+                              const Api &api) const {
+    ostream << INDENT_1 << "public static final class " << response << " {"
+            << NL << INDENT_2 << "private final int status;" << NL << INDENT_2
+            << "private final Object body;" << NL2 << INDENT_2 << response
+            << "(int status, Object body) {" << NL << INDENT_3
+            << "this.status = status;" << NL << INDENT_3 << "this.body = body;"
+            << NL << INDENT_2 << "}" << NL2 << INDENT_2
+            << "public int getStatus() {" << NL << INDENT_3 << "return status;"
+            << NL << INDENT_2 << "}" << NL;
+    for (const auto &api_return : api.get_returns()) {
+      if (api_return.resp_ == nullptr) {
+        continue;
+      }
+      auto status = std::to_string(api_return.http_status_code_);
+      auto type = type_to_java_type(api_return.resp_.get());
+      ostream << NL << INDENT_2 << "public " << type << " getBody" << status
+              << "() {" << NL << INDENT_3 << "return status == " << status
+              << " ? (" << type << ") body : null;" << NL << INDENT_2 << "}"
+              << NL;
+    }
+    ostream << INDENT_1 << "}" << NL2;
+  }
+
+  static std::string enum_names_constant(const Type *type) {
+    auto name = underscore(type->get_name());
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    return name + "_NAMES";
+  }
+
+  // Parameter names of client methods, renamed where they would clash with
+  // the names the generated code uses.
+  static std::string http_param_name(const Field &field) {
+    static const std::vector<std::string> taken = {
+        "b", "base", "body", "client", "r", "res", "u", "v", "w"};
+    auto name = camelcase(field.get_name());
+    if (std::find(taken.begin(), taken.end(), name) != taken.end()) {
+      name += "_";
+    }
+    return name;
+  }
+
+  static std::string java_array(const std::vector<std::string> &elements) {
+    std::string array;
+    for (const auto &element : elements) {
+      array += (array.empty() ? "" : ", ") + element;
+    }
+    return "{" + array + "}";
+  }
+
+  static std::string hex(std::uint32_t value) {
+    char hex[16];
+    std::snprintf(hex, sizeof(hex), "0x%08x", value);
+    return hex;
+  }
+
   std::string generate_struct_field(StructType *struct_type,
                                     const Field &field) const {
     auto use_optional = use_java8_optional_ && field.is_optional();
@@ -138,7 +551,7 @@ class JavaGenerator : public Generator {
                 ? gen_oneof_name(struct_type->get_name(), field.get_name())
                 : type_to_java_type(field.get_type().get(),
                                     field.is_optional())) +
-           (use_optional ? "> " : " ") + field.get_name() + ";";
+           (use_optional ? "> " : " ") + camelcase(field.get_name()) + ";";
   }
 
   std::string generate_getter_and_setter(StructType *struct_type,
@@ -146,26 +559,1484 @@ class JavaGenerator : public Generator {
                                          const std::string &base_indent) const {
     auto use_optional = use_java8_optional_ && field.is_optional();
     auto field_name_camelcase = camelcase(field.get_name());
+    auto field_type =
+        field.get_type()->is_oneof()
+            ? gen_oneof_name(struct_type->get_name(), field.get_name())
+            : type_to_java_type(field.get_type().get(), field.is_optional());
     // getter
     auto getter =
         base_indent +
         (use_optional ? "public java.util.Optional<" : "public ") +
-        type_to_java_type(field.get_type().get(), field.is_optional()) +
-        (use_optional ? "> get" : " get") + capitalize(field_name_camelcase) +
+        field_type + (use_optional ? "> get" : " get") +
+        capitalize(field_name_camelcase) +
         "() {" + NL + base_indent + INDENT_1 + "return " +
         field_name_camelcase + ";" + NL + base_indent + "}" + NL;
 
     // setter
     auto setter =
         base_indent + "public void set" + capitalize(field_name_camelcase) +
-        "(" + (use_optional ? "java.util.Optional<" : "") +
-        type_to_java_type(field.get_type().get(), field.is_optional()) + " " +
-        field_name_camelcase + ") {" + NL + base_indent + INDENT_1 + "this." +
-        field_name_camelcase + " = " + field_name_camelcase + ";" + NL +
-        base_indent + "}";
+        "(" + (use_optional ? "java.util.Optional<" : "") + field_type +
+        (use_optional ? "> " : " ") + field_name_camelcase + ") {" + NL +
+        base_indent + INDENT_1 + "this." + field_name_camelcase + " = " +
+        field_name_camelcase + ";" + NL + base_indent + "}";
     return getter + setter + NL;
   }
 
+  // Accessors of a field with a presence bit. The getter returns zero when
+  // the field is not set; the Optional getter is only a convenience.
+  std::string generate_presence_accessors(
+      const StructType *struct_type, const Field &field,
+      const std::string &base_indent) const {
+    auto name = camelcase(field.get_name());
+    auto method = capitalize(name);
+    auto type = field.get_type().get();
+    auto [word, mask] = presence_bit(struct_type, field);
+    auto zero = dynamic_cast<const PrimitiveType *>(type)->is_bool()
+                    ? std::string("false")
+                    : std::string("0");
+    std::stringstream out;
+    out << base_indent << "public " << type_to_java_type(type) << " get"
+        << method << "() {" << NL << base_indent << INDENT_1 << "return "
+        << name << ";" << NL << base_indent << "}" << NL << base_indent
+        << "public void set" << method << "(" << type_to_java_type(type)
+        << " " << name << ") {" << NL << base_indent << INDENT_1 << "this."
+        << name << " = " << name << ";" << NL << base_indent << INDENT_1
+        << word << " |= " << mask << ";" << NL << base_indent << "}" << NL
+        << base_indent << "public boolean has" << method << "() {" << NL
+        << base_indent << INDENT_1 << "return (" << word << " & " << mask
+        << ") != 0;" << NL << base_indent << "}" << NL << base_indent
+        << "public void clear" << method << "() {" << NL << base_indent
+        << INDENT_1 << name << " = " << zero << ";" << NL << base_indent
+        << INDENT_1 << word << " &= ~" << mask << ";" << NL << base_indent
+        << "}" << NL;
+    if (use_java8_optional_) {
+      out << base_indent << "public java.util.Optional<"
+          << type_to_java_type(type, true) << "> get" << method
+          << "Optional() {" << NL << base_indent << INDENT_1 << "return has"
+          << method << "() ? java.util.Optional.of(" << name
+          << ") : java.util.Optional.empty();" << NL << base_indent << "}"
+          << NL;
+    }
+    return out.str();
+  }
+
+  // hasX/clearX of an optional field that is a reference anyway, so that
+  // every optional field has them under java_presence_bits.
+  std::string generate_has_and_clear(const Field &field,
+                                     const std::string &base_indent) const {
+    auto name = camelcase(field.get_name());
+    auto method = capitalize(name);
+    auto use_optional = use_java8_optional_ && !field.get_type()->is_oneof();
+    return base_indent + "public boolean has" + method + "() {" + NL +
+           base_indent + INDENT_1 + "return " + name + " != null" +
+           (use_optional ? " && " + name + ".isPresent()" : "") + ";" + NL +
+           base_indent + "}" + NL + base_indent + "public void clear" +
+           method + "() {" + NL + base_indent + INDENT_1 + name + " = null;" +
+           NL + base_indent + "}" + NL;
+  }
+
+  // With java_presence_bits, optional fields of Java primitive types are
+  // stored unboxed and whether they are set is kept in bitmask words.
+  [[nodiscard]] bool has_presence_bit(const Field &field) const {
+    if (!presence_bits_ || !field.is_optional() ||
+        !field.get_type()->is_primitive()) {
+      return false;
+    }
+    auto primitive =
+        std::dynamic_pointer_cast<PrimitiveType>(field.get_type());
+    return !primitive->is_string() && !primitive->is_any();
+  }
+
+  [[nodiscard]] std::size_t presence_bit_count(
+      const StructType *struct_type) const {
+    std::size_t count = 0;
+    for (const auto &field : struct_type->get_fields()) {
+      count += has_presence_bit(field) ? 1 : 0;
+    }
+    return count;
+  }
+
+  // Returns the word holding the presence bit of `field` and its mask.
+  // Up to 32 bits share an int, more are spread over longs.
+  std::pair<std::string, std::string> presence_bit(
+      const StructType *struct_type, const Field &field) const {
+    std::size_t bit = 0;
+    for (const auto &other : struct_type->get_fields()) {
+      if (other.get_name() == field.get_name()) {
+        break;
+      }
+      bit += has_presence_bit(other) ? 1 : 0;
+    }
+    auto wide = presence_bit_count(struct_type) > 32;
+    char mask[32];
+    std::snprintf(mask, sizeof(mask), wide ? "0x%llxL" : "0x%llx",
+                  1ULL << (bit % 64));
+    return {"presence" + std::to_string(wide ? bit / 64 : 0), mask};
+  }
+
+  // validate() checks the constraints of the fields in declaration order,
+  // then the structs the fields hold, and throws at the first failure.
+  // Strings, lists and maps that are null count as empty; structs that are
+  // null are not checked. Patterns are compiled once, into constants.
+  void generate_validate(std::ostream &ostream,
+                         const StructType *struct_type) const {
+    ostream << NL;
+    for (const auto &field : struct_type->get_fields()) {
+      if (const auto &pattern = field.get_constraints().pattern; pattern) {
+        ostream << INDENT_2 << "private static final java.util.regex.Pattern "
+                << pattern_constant(field.get_name())
+                << " = java.util.regex.Pattern.compile("
+                << quote_literal(*pattern) << ");" << NL;
+      }
+    }
+    ostream << NL << INDENT_2 << "/**" << NL << INDENT_2
+            << "* Checks the constraints declared on the fields, and on the "
+               "fields of the"
+            << NL << INDENT_2
+            << "* structs held, stopping at the first one broken." << NL
+            << INDENT_2 << "*/" << NL << INDENT_2 << "public void validate() {"
+            << NL;
+    for (const auto &field : struct_type->get_fields()) {
+      auto type = field.get_type().get();
+      if (field.get_constraints().empty() && !needs_validation(type)) {
+        continue;
+      }
+      auto expr = "this." + camelcase(field.get_name());
+      auto guarded = field.is_optional();
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        ostream << INDENT_3 << "if ((" << word << " & " << mask
+                << ") != 0) {" << NL;
+      } else if (field.is_optional() && use_java8_optional_) {
+        ostream << INDENT_3 << "if (" << expr << " != null && " << expr
+                << ".isPresent()) {" << NL;
+        expr += ".get()";
+      } else if (field.is_optional()) {
+        ostream << INDENT_3 << "if (" << expr << " != null) {" << NL;
+      }
+      auto indent = guarded ? INDENT_4 : INDENT_3;
+      generate_field_validation(ostream, field, expr, guarded, indent);
+      if (guarded) {
+        ostream << INDENT_3 << "}" << NL;
+      }
+    }
+    ostream << INDENT_2 << "}" << NL;
+  }
+
+  // `non_null` tells whether `expr` is known not to be null.
+  void generate_field_validation(std::ostream &ostream, const Field &field,
+                                 const std::string &expr, bool non_null,
+                                 const std::string &indent) const {
+    const auto &constraints = field.get_constraints();
+    auto name = field.get_name();
+    auto fail = [&](const std::string &reason) {
+      ostream << indent << INDENT_1
+              << "throw new ToolmanValidationException(\"" << name << "\", "
+              << quote_literal(reason) << ");" << NL << indent << "}" << NL;
+    };
+    auto type = field.get_type().get();
+    if (constraints.min || constraints.max) {
+      auto primitive = dynamic_cast<const PrimitiveType *>(type);
+      auto is_unsigned = primitive->is_u32() || primitive->is_u64();
+      // An unsigned value is never below 0.
+      auto min = is_unsigned && constraints.min == "0" ? std::nullopt
+                                                       : constraints.min;
+      const auto &max = constraints.max;
+      auto compare = [&](const std::string &bound, const std::string &op) {
+        return is_unsigned ? unsigned_compare(primitive, expr, bound) + op + "0"
+                           : expr + op + bound +
+                                 (primitive->is_i64() ? "L" : "");
+      };
+      std::string check;
+      if (primitive->is_float()) {
+        // Written so that NaN fails.
+        auto suffix = double_floats() ? "" : "f";
+        check = "!(" + (min ? expr + " >= " + *min + suffix : "") +
+                (min && max ? " && " : "") +
+                (max ? expr + " <= " + *max + suffix : "") + ")";
+      } else if (min || max) {
+        check = (min ? compare(*min, " < ") : "") +
+                (min && max ? " || " : "") +
+                (max ? compare(*max, " > ") : "");
+      }
+      if (!check.empty()) {
+        ostream << indent << "if (" << check << ") {" << NL;
+        fail(bounds_reason("", constraints.min, max));
+      }
+    }
+    auto length = camelcase(name) + "Length";
+    if (auto check =
+            count_check(length, constraints.min_len, constraints.max_len);
+        !check.empty()) {
+      ostream << indent << "int " << length << " = ToolmanValidation.length("
+              << expr << ");" << NL << indent << "if (" << check << ") {"
+              << NL;
+      fail(bounds_reason("length", constraints.min_len, constraints.max_len));
+    }
+    if (constraints.pattern) {
+      ostream << indent << "if (!ToolmanValidation.matches("
+              << pattern_constant(name) << ", " << expr << ")) {" << NL;
+      fail("must match " + *constraints.pattern);
+    }
+    auto size = camelcase(name) + "Size";
+    if (auto check =
+            count_check(size, constraints.min_items, constraints.max_items);
+        !check.empty()) {
+      ostream << indent << "int " << size << " = ToolmanValidation.size("
+              << expr << ");" << NL << indent << "if (" << check << ") {"
+              << NL;
+      fail(bounds_reason("size", constraints.min_items,
+                         constraints.max_items));
+    }
+    if (needs_validation(type)) {
+      generate_value_validation(ostream, type, expr, "\"" + name + "\"",
+                                non_null, indent, 1);
+    }
+  }
+
+  // Emits checks of the structs in `expr`, `path` is a Java expression
+  // spelling where `expr` is.
+  void generate_value_validation(std::ostream &ostream, const Type *type,
+                                 const std::string &expr,
+                                 const std::string &path, bool non_null,
+                                 const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    auto inner = indent;
+    if (!non_null) {
+      ostream << indent << "if (" << expr << " != null) {" << NL;
+      inner += INDENT_1;
+    }
+    if (type->is_struct()) {
+      ostream << inner << "try {" << NL << inner << INDENT_1 << expr
+              << ".validate();" << NL << inner
+              << "} catch (ToolmanValidationException e) {" << NL << inner
+              << INDENT_1 << "throw e.in(" << path << ");" << NL << inner
+              << "}" << NL;
+    } else if (type->is_list()) {
+      auto elem = dynamic_cast<const ListType *>(type)->get_elem_type().get();
+      ostream << inner << "for (int i" << d << " = 0; i" << d << " < "
+              << expr << ".size(); i" << d << "++) {" << NL << inner
+              << INDENT_1 << type_to_java_type(elem, true) << " v" << d
+              << " = " << expr << ".get(i" << d << ");" << NL;
+      generate_value_validation(ostream, elem, "v" + d,
+                                index_path(path, "i" + d), false,
+                                inner + INDENT_1, depth + 1);
+      ostream << inner << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      auto value = map->get_value_type().get();
+      auto entry = "java.util.Map.Entry<" +
+                   type_to_java_type(map->get_key_type().get(), true) + ", " +
+                   type_to_java_type(value, true) + ">";
+      ostream << inner << "for (" << entry << " e" << d << " : " << expr
+              << ".entrySet()) {" << NL;
+      generate_value_validation(ostream, value, "e" + d + ".getValue()",
+                                index_path(path, "e" + d + ".getKey()"),
+                                false, inner + INDENT_1, depth + 1);
+      ostream << inner << "}" << NL;
+    }
+    if (!non_null) {
+      ostream << indent << "}" << NL;
+    }
+  }
+
+  // The Java expression spelling `path[index]`, `path` ends in a literal.
+  static std::string index_path(const std::string &path,
+                                const std::string &index) {
+    return path.substr(0, path.size() - 1) + "[\" + " + index + " + \"]\"";
+  }
+
+  // Compares the unsigned number `expr` to the decimal literal `bound`,
+  // with the sign of a compareTo.
+  static std::string unsigned_compare(const PrimitiveType *primitive,
+                                      const std::string &expr,
+                                      const std::string &bound) {
+    if (primitive->is_u32()) {
+      return "Long.compare(Integer.toUnsignedLong(" + expr + "), " + bound +
+             "L)";
+    }
+    char hex[32];
+    std::snprintf(hex, sizeof(hex), "0x%llxL", std::stoull(bound));
+    return "Long.compareUnsigned(" + expr + ", " + hex + ")";
+  }
+
+  static std::string pattern_constant(const std::string &name) {
+    std::string constant = "PATTERN_";
+    for (auto c : name) {
+      constant +=
+          static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return constant;
+  }
+
+  // copyFrom() copies field by field: scalars, strings and enums, which
+  // are immutable, are shared; lists and maps are allocated at exactly
+  // their size, nested structs and oneofs are copied anew.
+  void generate_deep_copy(std::ostream &ostream,
+                          const StructType *struct_type) const {
+    auto name = struct_type->get_name();
+    ostream << NL << INDENT_2 << "/**" << NL << INDENT_2
+            << "* Makes this a deep copy of other, sharing no lists, maps or "
+               "nested objects"
+            << NL << INDENT_2 << "* with it." << NL << INDENT_2 << "*/" << NL
+            << INDENT_2 << "public " << name << " copyFrom(" << name
+            << " other) {" << NL;
+    for (const auto &field : struct_type->get_fields()) {
+      generate_field_copy(ostream, struct_type, field, "other", "this",
+                          INDENT_3, 1);
+    }
+    auto bits = presence_bit_count(struct_type);
+    for (std::size_t i = 0; i * (bits > 32 ? 64 : 32) < bits; ++i) {
+      ostream << INDENT_3 << "this.presence" << i << " = other.presence" << i
+              << ";" << NL;
+    }
+    ostream << INDENT_3 << "return this;" << NL << INDENT_2 << "}" << NL2
+            << INDENT_2 << "/**" << NL << INDENT_2
+            << "* Returns a deep copy of this." << NL << INDENT_2 << "*/" << NL
+            << INDENT_2 << "public " << name << " deepCopy() {" << NL
+            << INDENT_3 << "return new " << name << "().copyFrom(this);" << NL
+            << INDENT_2 << "}" << NL;
+  }
+
+  // Emits statements that set the field of `dst` to a copy of the one of
+  // `src`.
+  void generate_field_copy(std::ostream &ostream,
+                           const StructType *struct_type, const Field &field,
+                           const std::string &src, const std::string &dst,
+                           const std::string &indent, int depth) const {
+    auto name = camelcase(field.get_name());
+    auto from = src + "." + name;
+    auto to = dst + "." + name;
+    auto type = field.get_type().get();
+    if (use_java8_optional_ && field.is_optional() && !is_immutable(type)) {
+      ostream << indent << to << " = " << from << ";" << NL << indent << "if ("
+              << from << " != null && " << from << ".isPresent()) {" << NL;
+      generate_copy_into(ostream, struct_type, field.get_name(), type,
+                         from + ".get()", to + " = java.util.Optional.of(",
+                         ");", indent + INDENT_1, depth);
+      ostream << indent << "}" << NL;
+    } else {
+      generate_copy_into(ostream, struct_type, field.get_name(), type, from,
+                         to + " = ", ";", indent, depth);
+    }
+  }
+
+  // Emits a statement that hands a copy of `src` to whatever `prefix` and
+  // `suffix` surround, copying it into a variable first if need be.
+  void generate_copy_into(std::ostream &ostream, const StructType *struct_type,
+                          const std::string &field_name, const Type *type,
+                          const std::string &src, const std::string &prefix,
+                          const std::string &suffix, const std::string &indent,
+                          int depth) const {
+    if (auto copy = copy_expression(type, src); copy) {
+      ostream << indent << prefix << *copy << suffix << NL;
+      return;
+    }
+    auto var = camelcase(field_name) + std::to_string(depth);
+    generate_copy(ostream, struct_type, field_name, type, src, var, indent,
+                  depth);
+    ostream << indent << prefix << var << suffix << NL;
+  }
+
+  // Emits statements that declare `var` and set it to a copy of `src`, a
+  // list, map or oneof whose copy needs more than an expression.
+  void generate_copy(std::ostream &ostream, const StructType *struct_type,
+                     const std::string &field_name, const Type *type,
+                     const std::string &src, const std::string &var,
+                     const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    ostream << indent << java_type(struct_type, field_name, type, true) << " "
+            << var << " = null;" << NL;
+    if (type->is_list()) {
+      auto elem = dynamic_cast<const ListType *>(type)->get_elem_type().get();
+      ostream << indent << "if (" << src << " != null) {" << NL << indent
+              << INDENT_1 << var << " = new java.util.ArrayList<>(" << src
+              << ".size());" << NL << indent << INDENT_1 << "for ("
+              << type_to_java_type(elem, true) << " e" << d << " : " << src
+              << ") {" << NL;
+      generate_copy_into(ostream, struct_type, field_name, elem, "e" + d,
+                         var + ".add(", ");", indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      auto value = map->get_value_type().get();
+      ostream << indent << "if (" << src << " != null) {" << NL << indent
+              << INDENT_1 << var
+              << " = new java.util.LinkedHashMap<>(ToolmanCopy.capacity("
+              << src << ".size()));" << NL << indent << INDENT_1
+              << "for (java.util.Map.Entry<"
+              << type_to_java_type(map->get_key_type().get(), true) << ", "
+              << type_to_java_type(value, true) << "> e" << d << " : " << src
+              << ".entrySet()) {" << NL;
+      generate_copy_into(ostream, struct_type, field_name, value,
+                         "e" + d + ".getValue()",
+                         var + ".put(e" + d + ".getKey(), ", ");",
+                         indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      auto prefix = capitalize(camelcase(struct_type->get_name()));
+      auto keyword = "if (";
+      for (const auto &oneof_field :
+           dynamic_cast<const OneofType *>(type)->get_fields()) {
+        auto alt_class = prefix + capitalize(camelcase(oneof_field.get_name()));
+        ostream << indent << keyword << src << " instanceof " << alt_class
+                << ") {" << NL << indent << INDENT_1 << alt_class << " o" << d
+                << " = (" << alt_class << ") " << src << ";" << NL << indent
+                << INDENT_1 << alt_class << " a" << d << " = new " << alt_class
+                << "();" << NL;
+        generate_field_copy(ostream, struct_type, oneof_field, "o" + d,
+                            "a" + d, indent + INDENT_1, depth + 1);
+        ostream << indent << INDENT_1 << var << " = a" << d << ";" << NL;
+        keyword = "} else if (";
+      }
+      ostream << indent << "}" << NL;
+    }
+  }
+
+  // Returns an expression for a copy of `src`, if one will do.
+  std::optional<std::string> copy_expression(const Type *type,
+                                             const std::string &src) const {
+    if (is_immutable(type)) {
+      return src;
+    } else if (type->is_primitive()) {
+      return "ToolmanCopy.any(" + src + ")";
+    } else if (type->is_struct()) {
+      return src + " == null ? null : " + src + ".deepCopy()";
+    } else if (is_primitive_array(type)) {
+      return src + " == null ? null : " + src + ".clone()";
+    } else if (type->is_list()) {
+      auto elem = dynamic_cast<const ListType *>(type)->get_elem_type().get();
+      if (is_immutable(elem)) {
+        return src + " == null ? null : new java.util.ArrayList<>(" + src +
+               ")";
+      }
+    } else if (type->is_map() &&
+               is_immutable(dynamic_cast<const MapType *>(type)
+                                ->get_value_type()
+                                .get())) {
+      return src + " == null ? null : new java.util.LinkedHashMap<>(" + src +
+             ")";
+    }
+    return std::nullopt;
+  }
+
+  // Values of these types can be shared between copies.
+  static bool is_immutable(const Type *type) {
+    return type->is_enum() ||
+           (type->is_primitive() &&
+            !dynamic_cast<const PrimitiveType *>(type)->is_any());
+  }
+
+  // The JSON codec writes UTF-8 straight into a growable byte buffer, with
+  // field names escaped and encoded once per class, and reads by switching
+  // on the String.hashCode() of each key, so neither direction goes through
+  // reflection or allocates per key.
+  void generate_json_codec(std::ostream &ostream,
+                           const StructType *struct_type) const {
+    auto struct_name = struct_type->get_name();
+    auto fields = struct_type->get_fields();
+
+    ostream << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto &field = fields[i];
+      ostream << INDENT_2 << "private static final byte[] "
+              << json_key_constant(field.get_name())
+              << " = ToolmanJsonWriter.utf8(\"" << (i == 0 ? "{" : ",")
+              << "\\\"" << field.get_name() << "\\\":\");" << NL;
+      if (field.get_type()->is_oneof()) {
+        auto oneof = std::dynamic_pointer_cast<OneofType>(field.get_type());
+        for (const auto &oneof_field : oneof->get_fields()) {
+          ostream << INDENT_2 << "private static final byte[] "
+                  << json_key_constant(field.get_name() + "_" +
+                                       oneof_field.get_name())
+                  << " = ToolmanJsonWriter.utf8(\"{\\\""
+                  << oneof_field.get_name() << "\\\":\");" << NL;
+        }
+      }
+    }
+
+    // encode
+    ostream << NL << INDENT_2
+            << "public void writeTo(java.io.OutputStream out) "
+               "throws java.io.IOException {"
+            << NL << INDENT_3
+            << "ToolmanJsonWriter w = new ToolmanJsonWriter();" << NL
+            << INDENT_3 << "writeJson(w);" << NL << INDENT_3
+            << "w.writeTo(out);" << NL << INDENT_2 << "}" << NL2 << INDENT_2
+            << "public void writeTo(Appendable out) "
+               "throws java.io.IOException {"
+            << NL << INDENT_3
+            << "ToolmanJsonWriter w = new ToolmanJsonWriter();" << NL
+            << INDENT_3 << "writeJson(w);" << NL << INDENT_3
+            << "out.append(w.toString());" << NL << INDENT_2 << "}" << NL2
+            << INDENT_2 << "void writeJson(ToolmanJsonWriter w) {" << NL;
+    if (fields.empty()) {
+      ostream << INDENT_3 << "w.raw('{');" << NL;
+    }
+    for (const auto &field : fields) {
+      ostream << INDENT_3 << "w.raw(" << json_key_constant(field.get_name())
+              << ");" << NL;
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        ostream << INDENT_3 << "if ((" << word << " & " << mask
+                << ") == 0) {" << NL << INDENT_4 << "w.writeNull();" << NL
+                << INDENT_3 << "} else {" << NL;
+        generate_json_encode(ostream, struct_type, field.get_name(),
+                             field.get_type().get(),
+                             "this." + camelcase(field.get_name()), false,
+                             INDENT_4, 1);
+        ostream << INDENT_3 << "}" << NL;
+        continue;
+      }
+      generate_json_encode_field(ostream, struct_type, field, field.get_name(),
+                                 "this." + camelcase(field.get_name()),
+                                 INDENT_3, 1);
+    }
+    ostream << INDENT_3 << "w.raw('}');" << NL << INDENT_2 << "}" << NL2;
+
+    // decode
+    ostream << INDENT_2 << "public static " << struct_name
+            << " parseFrom(char[] json) {" << NL << INDENT_3
+            << "ToolmanJsonReader r = new ToolmanJsonReader(json);" << NL
+            << INDENT_3 << struct_name << " m = readJson(r);" << NL << INDENT_3
+            << "r.end();" << NL;
+    if (needs_validation(struct_type)) {
+      ostream << INDENT_3 << "if (m != null) {" << NL << INDENT_4
+              << "m.validate();" << NL << INDENT_3 << "}" << NL;
+    }
+    ostream << INDENT_3 << "return m;" << NL << INDENT_2 << "}" << NL2
+            << INDENT_2 << "public static " << struct_name
+            << " parseFrom(byte[] json) {" << NL << INDENT_3
+            << "return parseFrom(new String(json, "
+               "java.nio.charset.StandardCharsets.UTF_8).toCharArray());"
+            << NL << INDENT_2 << "}" << NL2;
+
+    ostream << INDENT_2 << "static " << struct_name
+            << " readJson(ToolmanJsonReader r) {" << NL << INDENT_3
+            << "if (r.nullValue()) {" << NL << INDENT_4 << "return null;" << NL
+            << INDENT_3 << "}" << NL << INDENT_3 << struct_name << " m = new "
+            << struct_name << "();" << NL << INDENT_3 << "r.begin('{');" << NL
+            << INDENT_3 << "for (int i0 = 0; r.more('}', i0); i0++) {" << NL;
+    generate_key_switch(
+        ostream, fields, INDENT_4,
+        [&](const Field &field, const std::string &indent) {
+          if (has_presence_bit(field)) {
+            auto method = capitalize(camelcase(field.get_name()));
+            ostream << indent << "if (r.nullValue()) {" << NL << indent
+                    << INDENT_1 << "m.clear" << method << "();" << NL << indent
+                    << "} else {" << NL;
+            generate_json_decode(ostream, struct_type, field.get_name(),
+                                 field.get_type().get(), "v1", false,
+                                 indent + INDENT_1, 1);
+            ostream << indent << INDENT_1 << "m.set" << method << "(v1);"
+                    << NL << indent << "}" << NL;
+            return;
+          }
+          generate_json_decode_field(ostream, struct_type, field,
+                                     "m." + camelcase(field.get_name()),
+                                     indent, 1);
+        });
+    ostream << INDENT_3 << "}" << NL << INDENT_3 << "return m;" << NL
+            << INDENT_2 << "}" << NL;
+  }
+
+  // Emits a switch over the hash of the key just read that decodes the
+  // member it names, skipping unknown keys. Fields whose names share a hash
+  // are told apart by comparing the key itself.
+  template <typename DecodeMember>
+  void generate_key_switch(std::ostream &ostream,
+                           const std::vector<Field> &fields,
+                           const std::string &indent,
+                           DecodeMember decode_member) const {
+    std::map<std::int32_t, std::vector<const Field *>> by_hash;
+    for (const auto &field : fields) {
+      by_hash[java_string_hash(field.get_name())].push_back(&field);
+    }
+    ostream << indent << "switch (r.key()) {" << NL;
+    for (const auto &[hash, hash_fields] : by_hash) {
+      ostream << indent << INDENT_1 << "case " << hash << ":" << NL;
+      for (const auto *field : hash_fields) {
+        ostream << indent << INDENT_2 << "if (r.keyIs(\"" << field->get_name()
+                << "\")) {" << NL;
+        decode_member(*field, indent + INDENT_3);
+        ostream << indent << INDENT_3 << "continue;" << NL << indent
+                << INDENT_2 << "}" << NL;
+      }
+      ostream << indent << INDENT_2 << "break;" << NL;
+    }
+    ostream << indent << "}" << NL << indent << "r.skip();" << NL;
+  }
+
+  // Emits statements that write `expr`, the value of `field`, as JSON.
+  void generate_json_encode_field(std::ostream &ostream,
+                                  const StructType *struct_type,
+                                  const Field &field,
+                                  const std::string &field_name,
+                                  const std::string &expr,
+                                  const std::string &indent, int depth) const {
+    if (use_java8_optional_ && field.is_optional()) {
+      ostream << indent << "if (" << expr << " == null || !" << expr
+              << ".isPresent()) {" << NL << indent << INDENT_1
+              << "w.writeNull();" << NL << indent << "} else {" << NL;
+      generate_json_encode(ostream, struct_type, field_name,
+                           field.get_type().get(), expr + ".get()", true,
+                           indent + INDENT_1, depth);
+      ostream << indent << "}" << NL;
+    } else {
+      generate_json_encode(ostream, struct_type, field_name,
+                           field.get_type().get(), expr, field.is_optional(),
+                           indent, depth);
+    }
+  }
+
+  // Emits statements that write `expr` of `type` as JSON. `boxed` tells
+  // whether a primitive `expr` is a wrapper object that may be null, and
+  // `depth` keeps the names of nested locals unique.
+  void generate_json_encode(std::ostream &ostream,
+                            const StructType *struct_type,
+                            const std::string &field_name, const Type *type,
+                            const std::string &expr, bool boxed,
+                            const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    auto null_check = [&]() {
+      ostream << indent << "if (" << expr << " == null) {" << NL << indent
+              << INDENT_1 << "w.writeNull();" << NL << indent << "} else {"
+              << NL;
+    };
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType *>(type);
+      if (primitive->is_string()) {
+        ostream << indent << "w.writeString(" << expr << ");" << NL;
+      } else if (primitive->is_any()) {
+        ostream << indent << "w.writeAny(" << expr << ");" << NL;
+      } else if (boxed) {
+        null_check();
+        ostream << indent << INDENT_1 << "w." << json_write_method(primitive)
+                << "(" << expr << ");" << NL << indent << "}" << NL;
+      } else {
+        ostream << indent << "w." << json_write_method(primitive) << "("
+                << expr << ");" << NL;
+      }
+    } else if (type->is_enum()) {
+      null_check();
+      ostream << indent << INDENT_1 << "w.writeInt(" << expr
+              << ".getNumber());" << NL << indent << "}" << NL;
+    } else if (type->is_struct()) {
+      null_check();
+      ostream << indent << INDENT_1 << expr << ".writeJson(w);" << NL << indent
+              << "}" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType *>(type);
+      auto boxed_elem = !is_primitive_array(type);
+      null_check();
+      ostream << indent << INDENT_1 << "w.raw('[');" << NL << indent << INDENT_1
+              << "int i" << d << " = 0;" << NL << indent << INDENT_1 << "for ("
+              << java_type(struct_type, field_name,
+                           list->get_elem_type().get(), boxed_elem)
+              << " v" << d << " : " << expr << ") {" << NL << indent << INDENT_2
+              << "if (i" << d << "++ > 0) {" << NL << indent << INDENT_3
+              << "w.raw(',');" << NL << indent << INDENT_2 << "}" << NL;
+      generate_json_encode(ostream, struct_type, field_name,
+                           list->get_elem_type().get(), "v" + d, boxed_elem,
+                           indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "w.raw(']');" << NL << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      auto key = map->get_key_type();
+      null_check();
+      ostream << indent << INDENT_1 << "w.raw('{');" << NL << indent << INDENT_1
+              << "int i" << d << " = 0;" << NL << indent << INDENT_1 << "for ("
+              << "java.util.Map.Entry<"
+              << java_type(struct_type, field_name, key.get(), true) << ", "
+              << java_type(struct_type, field_name,
+                           map->get_value_type().get(), true)
+              << "> e" << d << " : " << expr << ".entrySet()) {" << NL << indent
+              << INDENT_2 << "if (i" << d << "++ > 0) {" << NL << indent
+              << INDENT_3 << "w.raw(',');" << NL << indent << INDENT_2 << "}"
+              << NL;
+      // JSON object keys are always strings.
+      if (key->is_string()) {
+        ostream << indent << INDENT_2 << "w.writeString(e" << d
+                << ".getKey());" << NL;
+      } else {
+        ostream << indent << INDENT_2 << "w.raw('\"');" << NL;
+        generate_json_encode(ostream, struct_type, field_name, key.get(),
+                             "e" + d + ".getKey()", false, indent + INDENT_2,
+                             depth + 1);
+        ostream << indent << INDENT_2 << "w.raw('\"');" << NL;
+      }
+      ostream << indent << INDENT_2 << "w.raw(':');" << NL;
+      generate_json_encode(ostream, struct_type, field_name,
+                           map->get_value_type().get(), "e" + d + ".getValue()",
+                           true, indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_1 << "}" << NL << indent << INDENT_1
+              << "w.raw('}');" << NL << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      // A oneof is encoded as an object holding only the alternative that
+      // is set, e.g. {"radius":1.5}.
+      auto oneof = dynamic_cast<const OneofType *>(type);
+      auto prefix = capitalize(camelcase(struct_type->get_name()));
+      ostream << indent;
+      for (const auto &oneof_field : oneof->get_fields()) {
+        auto alt_class = prefix + capitalize(camelcase(oneof_field.get_name()));
+        ostream << "if (" << expr << " instanceof " << alt_class << ") {" << NL
+                << indent << INDENT_1 << alt_class << " a" << d << " = ("
+                << alt_class << ") " << expr << ";" << NL << indent << INDENT_1
+                << "w.raw("
+                << json_key_constant(field_name + "_" + oneof_field.get_name())
+                << ");" << NL;
+        generate_json_encode_field(
+            ostream, struct_type, oneof_field, field_name,
+            "a" + d + "." + camelcase(oneof_field.get_name()),
+            indent + INDENT_1, depth + 1);
+        ostream << indent << INDENT_1 << "w.raw('}');" << NL << indent
+                << "} else ";
+      }
+      ostream << "{" << NL << indent << INDENT_1 << "w.writeNull();" << NL
+              << indent << "}" << NL;
+    }
+  }
+
+  // Emits statements that decode the next JSON value into `target`, which
+  // holds `field`.
+  void generate_json_decode_field(std::ostream &ostream,
+                                  const StructType *struct_type,
+                                  const Field &field,
+                                  const std::string &target,
+                                  const std::string &indent, int depth) const {
+    auto var = "v" + std::to_string(depth);
+    generate_json_decode(ostream, struct_type, field.get_name(),
+                         field.get_type().get(), var, field.is_optional(),
+                         indent, depth);
+    ostream << indent << target << " = "
+            << (use_java8_optional_ && field.is_optional()
+                    ? "java.util.Optional.ofNullable(" + var + ")"
+                    : var)
+            << ";" << NL;
+  }
+
+  // Emits statements that declare `var` and decode the next JSON value of
+  // `type` into it.
+  void generate_json_decode(std::ostream &ostream,
+                            const StructType *struct_type,
+                            const std::string &field_name, const Type *type,
+                            const std::string &var, bool boxed,
+                            const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    auto declared_type = java_type(struct_type, field_name, type, boxed);
+    ostream << indent << declared_type << " " << var;
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType *>(type);
+      if (primitive->is_string()) {
+        ostream << " = r.readString();" << NL;
+      } else if (primitive->is_any()) {
+        ostream << " = r.readAny();" << NL;
+      } else if (boxed) {
+        ostream << " = r.nullValue() ? null : r."
+                << json_read_method(primitive) << "();" << NL;
+      } else {
+        ostream << " = r." << json_read_method(primitive) << "();" << NL;
+      }
+    } else if (type->is_enum()) {
+      ostream << " = r.nullValue() ? null : " << type->get_name()
+              << ".forNumber(r.readInt())"
+              << (use_java8_optional_ ? ".orElse(null)" : "") << ";" << NL;
+    } else if (type->is_struct()) {
+      ostream << " = " << type->get_name() << ".readJson(r);" << NL;
+    } else if (is_primitive_array(type)) {
+      // Grows the array by doubling and trims it once the list is read.
+      auto list = dynamic_cast<const ListType *>(type);
+      auto elem = "v" + std::to_string(depth + 1);
+      ostream << " = null;" << NL << indent << "if (!r.nullValue()) {" << NL
+              << indent << INDENT_1 << var << " = new "
+              << declared_type.substr(0, declared_type.size() - 1) << "16];"
+              << NL << indent << INDENT_1 << "r.begin('[');" << NL << indent
+              << INDENT_1 << "int i" << d << " = 0;" << NL << indent << INDENT_1
+              << "for (; r.more(']', i" << d << "); i" << d << "++) {" << NL;
+      generate_json_decode(ostream, struct_type, field_name,
+                           list->get_elem_type().get(), elem, false,
+                           indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_2 << "if (i" << d << " == " << var
+              << ".length) {" << NL << indent << INDENT_3 << var
+              << " = java.util.Arrays.copyOf(" << var << ", i" << d << " * 2);"
+              << NL << indent << INDENT_2 << "}" << NL << indent << INDENT_2
+              << var << "[i" << d << "] = " << elem << ";" << NL << indent
+              << INDENT_1 << "}" << NL << indent << INDENT_1 << "if (i" << d
+              << " != " << var << ".length) {" << NL << indent << INDENT_2
+              << var << " = java.util.Arrays.copyOf(" << var << ", i" << d
+              << ");" << NL << indent << INDENT_1 << "}" << NL << indent << "}"
+              << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType *>(type);
+      auto elem = "v" + std::to_string(depth + 1);
+      ostream << " = null;" << NL << indent << "if (!r.nullValue()) {" << NL
+              << indent << INDENT_1 << var << " = new java.util.ArrayList<>();"
+              << NL << indent << INDENT_1 << "r.begin('[');" << NL << indent
+              << INDENT_1 << "for (int i" << d << " = 0; r.more(']', i" << d
+              << "); i" << d << "++) {" << NL;
+      generate_json_decode(ostream, struct_type, field_name,
+                           list->get_elem_type().get(), elem, true,
+                           indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_2 << var << ".add(" << elem << ");" << NL
+              << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      auto value = "v" + std::to_string(depth + 1);
+      ostream << " = null;" << NL << indent << "if (!r.nullValue()) {" << NL
+              << indent << INDENT_1 << var
+              << " = new java.util.LinkedHashMap<>();" << NL << indent
+              << INDENT_1 << "r.begin('{');" << NL << indent << INDENT_1
+              << "for (int i" << d << " = 0; r.more('}', i" << d << "); i" << d
+              << "++) {" << NL << indent << INDENT_2 << "r.key();" << NL
+              << indent << INDENT_2
+              << java_type(struct_type, field_name, map->get_key_type().get(),
+                           false)
+              << " k" << d << " = r."
+              << json_read_key_method(map->get_key_type().get()) << "();"
+              << NL;
+      generate_json_decode(ostream, struct_type, field_name,
+                           map->get_value_type().get(), value, true,
+                           indent + INDENT_2, depth + 1);
+      ostream << indent << INDENT_2 << var << ".put(k" << d << ", " << value
+              << ");" << NL << indent << INDENT_1 << "}" << NL << indent << "}"
+              << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType *>(type);
+      auto prefix = capitalize(camelcase(struct_type->get_name()));
+      ostream << " = null;" << NL << indent << "if (!r.nullValue()) {" << NL
+              << indent << INDENT_1 << "r.begin('{');" << NL << indent
+              << INDENT_1 << "for (int i" << d << " = 0; r.more('}', i" << d
+              << "); i" << d << "++) {" << NL;
+      generate_key_switch(
+          ostream, oneof->get_fields(), indent + INDENT_2,
+          [&](const Field &oneof_field, const std::string &member_indent) {
+            auto alt_class =
+                prefix + capitalize(camelcase(oneof_field.get_name()));
+            ostream << member_indent << alt_class << " a" << d << " = new "
+                    << alt_class << "();" << NL;
+            generate_json_decode_field(
+                ostream, struct_type, oneof_field,
+                "a" + d + "." + camelcase(oneof_field.get_name()),
+                member_indent, depth + 1);
+            ostream << member_indent << var << " = a" << d << ";" << NL;
+          });
+      ostream << indent << INDENT_1 << "}" << NL << indent << "}" << NL;
+    }
+  }
+
+  // streamX() returns an iterator over the elements of list x that reads
+  // the struct from a java.io.Reader and parses one element at a time. The
+  // other fields are parsed once the struct has been read.
+  void generate_streams(std::ostream &ostream,
+                        const StructType *struct_type) const {
+    auto struct_name = struct_type->get_name();
+    for (const auto &field : struct_type->get_fields()) {
+      if (!field.get_type()->is_list()) {
+        continue;
+      }
+      auto elem_type = dynamic_cast<const ListType *>(field.get_type().get())
+                           ->get_elem_type()
+                           .get();
+      auto elem_class =
+          java_type(struct_type, field.get_name(), elem_type, true);
+      auto iterator = "ToolmanJsonElements<" + elem_class + ", " +
+                      struct_name + ">";
+      ostream << NL << INDENT_2 << "/**" << NL << INDENT_2
+              << "* Returns an iterator over the elements of "
+              << field.get_name() << " in the " << struct_name
+              << " read from" << NL << INDENT_2
+              << "* in, parsing and validating one at a time. Its rest() "
+                 "returns the other"
+              << NL << INDENT_2 << "* fields, without " << field.get_name()
+              << " and not validated." << NL << INDENT_2 << "*/"
+              << NL << INDENT_2 << "public static " << iterator << " stream"
+              << capitalize(camelcase(field.get_name()))
+              << "(java.io.Reader in) {" << NL << INDENT_3 << "return new "
+              << iterator << "(in, \"" << field.get_name() << "\") {" << NL
+              << INDENT_4 << "@Override" << NL << INDENT_4 << elem_class
+              << " readElement(ToolmanJsonReader r, int i) {" << NL;
+      generate_json_decode(ostream, struct_type, field.get_name(), elem_type,
+                           "v1", true, INDENT_4 INDENT_1, 1);
+      if (needs_validation(elem_type)) {
+        generate_value_validation(ostream, elem_type, "v1",
+                                  index_path("\"" + field.get_name() + "\"",
+                                             "i"),
+                                  false, INDENT_4 INDENT_1, 2);
+      }
+      ostream << INDENT_4 << INDENT_1 << "return v1;" << NL << INDENT_4 << "}"
+              << NL2 << INDENT_4 << "@Override" << NL << INDENT_4
+              << struct_name << " readRest(ToolmanJsonReader r) {" << NL
+              << INDENT_4 << INDENT_1 << "return readJson(r);" << NL
+              << INDENT_4 << "}" << NL << INDENT_3 << "};" << NL << INDENT_2
+              << "}" << NL;
+    }
+  }
+
+  // The binary codec follows src/wire_format.h. Keys are encoded once per
+  // class; fields holding null are left out.
+  void generate_binary_codec(std::ostream &ostream,
+                             const StructType *struct_type) const {
+    auto struct_name = struct_type->get_name();
+    auto fields = struct_type->get_fields();
+
+    ostream << NL;
+    for (const auto &field : fields) {
+      ostream << INDENT_2 << "private static final byte[] "
+              << binary_key_constant(field.get_name()) << " = "
+              << binary_key_bytes(field) << ";" << NL;
+      if (field.get_type()->is_oneof()) {
+        auto oneof = std::dynamic_pointer_cast<OneofType>(field.get_type());
+        for (const auto &oneof_field : oneof->get_fields()) {
+          ostream << INDENT_2 << "private static final byte[] "
+                  << binary_key_constant(field.get_name() + "_" +
+                                         oneof_field.get_name())
+                  << " = " << binary_key_bytes(oneof_field) << ";" << NL;
+        }
+      }
+    }
+
+    // encode
+    ostream << NL << INDENT_2 << "public byte[] toBinary() {" << NL << INDENT_3
+            << "ToolmanBinaryWriter w = new ToolmanBinaryWriter();" << NL
+            << INDENT_3 << "writeBinary(w);" << NL << INDENT_3
+            << "return w.toByteArray();" << NL << INDENT_2 << "}" << NL2
+            << INDENT_2
+            << "public void writeBinary(java.io.OutputStream out) "
+               "throws java.io.IOException {"
+            << NL << INDENT_3
+            << "ToolmanBinaryWriter w = new ToolmanBinaryWriter();" << NL
+            << INDENT_3 << "writeBinary(w);" << NL << INDENT_3
+            << "w.writeTo(out);" << NL << INDENT_2 << "}" << NL2 << INDENT_2
+            << "void writeBinary(ToolmanBinaryWriter w) {" << NL;
+    for (const auto &field : fields) {
+      if (has_presence_bit(field)) {
+        auto [word, mask] = presence_bit(struct_type, field);
+        ostream << INDENT_3 << "if ((" << word << " & " << mask
+                << ") != 0) {" << NL << INDENT_4 << "w.raw("
+                << binary_key_constant(field.get_name()) << ");" << NL;
+        generate_binary_encode(ostream, struct_type, field.get_name(),
+                               field.get_type().get(),
+                               "this." + camelcase(field.get_name()),
+                               INDENT_4, 1);
+        ostream << INDENT_3 << "}" << NL;
+        continue;
+      }
+      generate_binary_encode_field(ostream, struct_type, field,
+                                   field.get_name(),
+                                   "this." + camelcase(field.get_name()),
+                                   INDENT_3, 1);
+    }
+    ostream << INDENT_2 << "}" << NL2;
+
+    // decode
+    ostream << INDENT_2 << "public static " << struct_name
+            << " parseBinary(byte[] data) {" << NL << INDENT_3;
+    if (needs_validation(struct_type)) {
+      ostream << struct_name
+              << " m = readBinary(new ToolmanBinaryReader(data), data.length);"
+              << NL << INDENT_3 << "m.validate();" << NL << INDENT_3
+              << "return m;" << NL;
+    } else {
+      ostream
+          << "return readBinary(new ToolmanBinaryReader(data), data.length);"
+          << NL;
+    }
+    ostream << INDENT_2 << "}" << NL2;
+
+    ostream << INDENT_2 << "static " << struct_name
+            << " readBinary(ToolmanBinaryReader r, int end) {" << NL
+            << INDENT_3 << struct_name << " m = new " << struct_name << "();"
+            << NL << INDENT_3 << "while (r.more(end)) {" << NL;
+    generate_number_switch(
+        ostream, fields, "k0", INDENT_4,
+        [&](const Field &field, const std::string &indent) {
+          if (has_presence_bit(field)) {
+            generate_binary_decode(ostream, struct_type, field.get_name(),
+                                   field.get_type().get(), "v1", false,
+                                   indent, 1);
+            ostream << indent << "m.set"
+                    << capitalize(camelcase(field.get_name())) << "(v1);"
+                    << NL;
+            return;
+          }
+          generate_binary_decode_field(ostream, struct_type, field,
+                                       "m." + camelcase(field.get_name()),
+                                       indent, 1);
+        });
+    ostream << INDENT_3 << "}" << NL << INDENT_3 << "r.done(end);" << NL
+            << INDENT_3 << "return m;" << NL << INDENT_2 << "}" << NL;
+  }
+
+  // Emits a switch over the number of the next key that decodes the member
+  // it names, skipping unknown numbers.
+  template <typename DecodeMember>
+  void generate_number_switch(std::ostream &ostream,
+                              const std::vector<Field> &fields,
+                              const std::string &key,
+                              const std::string &indent,
+                              DecodeMember decode_member) const {
+    ostream << indent << "int " << key << " = r.key();" << NL << indent
+            << "switch (" << key << " >>> 3) {" << NL;
+    for (const auto &field : fields) {
+      ostream << indent << INDENT_1 << "case " << field.get_number() << ": {"
+              << NL << indent << INDENT_2 << "r.expect(" << key << ", "
+              << static_cast<int>(
+                     wire_format::wire_type_of(field.get_type().get()))
+              << ");" << NL;
+      decode_member(field, indent + INDENT_2);
+      ostream << indent << INDENT_2 << "break;" << NL << indent << INDENT_1
+              << "}" << NL;
+    }
+    ostream << indent << INDENT_1 << "default:" << NL << indent << INDENT_2
+            << "r.skip(" << key << ");" << NL << indent << "}" << NL;
+  }
+
+  // Emits statements that write the key and value of `field`, held in
+  // `expr`, unless it is null.
+  void generate_binary_encode_field(std::ostream &ostream,
+                                    const StructType *struct_type,
+                                    const Field &field,
+                                    const std::string &constant_name,
+                                    const std::string &expr,
+                                    const std::string &indent,
+                                    int depth) const {
+    auto type = field.get_type().get();
+    auto key = indent + INDENT_1 + "w.raw(" +
+               binary_key_constant(constant_name) + ");" + NL;
+    if (use_java8_optional_ && field.is_optional()) {
+      ostream << indent << "if (" << expr << " != null && " << expr
+              << ".isPresent()) {" << NL << key;
+      generate_binary_encode(ostream, struct_type, field.get_name(), type,
+                             expr + ".get()", indent + INDENT_1, depth);
+      ostream << indent << "}" << NL;
+    } else if (is_reference(type, field.is_optional())) {
+      ostream << indent << "if (" << expr << " != null) {" << NL << key;
+      generate_binary_encode(ostream, struct_type, field.get_name(), type,
+                             expr, indent + INDENT_1, depth);
+      ostream << indent << "}" << NL;
+    } else {
+      ostream << indent << "w.raw(" << binary_key_constant(constant_name)
+              << ");" << NL;
+      generate_binary_encode(ostream, struct_type, field.get_name(), type,
+                             expr, indent, depth);
+    }
+  }
+
+  // Emits statements that write `expr` of `type` without a key. List
+  // elements and map entries have no key to leave out, so they must not be
+  // null.
+  void generate_binary_encode(std::ostream &ostream,
+                              const StructType *struct_type,
+                              const std::string &field_name, const Type *type,
+                              const std::string &expr,
+                              const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType *>(type);
+      ostream << indent << "w.";
+      if (primitive->is_bool()) {
+        ostream << "writeBool(" << expr << ")";
+      } else if (primitive->is_i32() || primitive->is_i64()) {
+        ostream << "writeZigzag(" << expr << ")";
+      } else if (primitive->is_u32()) {
+        ostream << "writeVarint(" << expr << " & 0xffffffffL)";
+      } else if (primitive->is_u64()) {
+        ostream << "writeVarint(" << expr << ")";
+      } else if (primitive->is_float()) {
+        ostream << "writeFixed64(" << expr << ")";
+      } else if (primitive->is_string()) {
+        ostream << "writeString(" << expr << ")";
+      } else {
+        ostream << "writeAny(" << expr << ")";
+      }
+      ostream << ";" << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << "w.writeZigzag(" << expr << ".getNumber());" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << "int s" << d << " = w.begin();" << NL << indent
+              << expr << ".writeBinary(w);" << NL << indent << "w.end(s" << d
+              << ");" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType *>(type);
+      auto primitive_array = is_primitive_array(type);
+      ostream << indent << "int s" << d << " = w.begin();" << NL << indent
+              << "w.writeVarint(" << expr
+              << (primitive_array ? ".length" : ".size()") << ");" << NL
+              << indent << "for ("
+              << java_type(struct_type, field_name,
+                           list->get_elem_type().get(), !primitive_array)
+              << " v" << d << " : " << expr << ") {" << NL;
+      generate_binary_encode(ostream, struct_type, field_name,
+                             list->get_elem_type().get(), "v" + d,
+                             indent + INDENT_1, depth + 1);
+      ostream << indent << "}" << NL << indent << "w.end(s" << d << ");" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      ostream << indent << "int s" << d << " = w.begin();" << NL << indent
+              << "w.writeVarint(" << expr << ".size());" << NL << indent
+              << "for (java.util.Map.Entry<"
+              << java_type(struct_type, field_name, map->get_key_type().get(),
+                           true)
+              << ", "
+              << java_type(struct_type, field_name,
+                           map->get_value_type().get(), true)
+              << "> e" << d << " : " << expr << ".entrySet()) {" << NL;
+      generate_binary_encode(ostream, struct_type, field_name,
+                             map->get_key_type().get(), "e" + d + ".getKey()",
+                             indent + INDENT_1, depth + 1);
+      generate_binary_encode(ostream, struct_type, field_name,
+                             map->get_value_type().get(),
+                             "e" + d + ".getValue()", indent + INDENT_1,
+                             depth + 1);
+      ostream << indent << "}" << NL << indent << "w.end(s" << d << ");" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType *>(type);
+      auto prefix = capitalize(camelcase(struct_type->get_name()));
+      auto alternatives = oneof->get_fields();
+      ostream << indent << "int s" << d << " = w.begin();" << NL << indent;
+      for (std::size_t i = 0; i < alternatives.size(); ++i) {
+        const auto &oneof_field = alternatives[i];
+        auto alt_class = prefix + capitalize(camelcase(oneof_field.get_name()));
+        if (i > 0) {
+          ostream << " else ";
+        }
+        ostream << "if (" << expr << " instanceof " << alt_class << ") {" << NL
+                << indent << INDENT_1 << alt_class << " a" << d << " = ("
+                << alt_class << ") " << expr << ";" << NL;
+        generate_binary_encode_field(
+            ostream, struct_type, oneof_field,
+            field_name + "_" + oneof_field.get_name(),
+            "a" + d + "." + camelcase(oneof_field.get_name()),
+            indent + INDENT_1, depth + 1);
+        ostream << indent << "}";
+      }
+      ostream << NL << indent << "w.end(s" << d << ");" << NL;
+    }
+  }
+
+  // Emits statements that decode the next binary value into `target`,
+  // which holds `field`.
+  void generate_binary_decode_field(std::ostream &ostream,
+                                    const StructType *struct_type,
+                                    const Field &field,
+                                    const std::string &target,
+                                    const std::string &indent,
+                                    int depth) const {
+    auto var = "v" + std::to_string(depth);
+    generate_binary_decode(ostream, struct_type, field.get_name(),
+                           field.get_type().get(), var, field.is_optional(),
+                           indent, depth);
+    ostream << indent << target << " = "
+            << (use_java8_optional_ && field.is_optional()
+                    ? "java.util.Optional.ofNullable(" + var + ")"
+                    : var)
+            << ";" << NL;
+  }
+
+  // Emits statements that declare `var` and decode the next binary value of
+  // `type`, which has no key, into it.
+  void generate_binary_decode(std::ostream &ostream,
+                              const StructType *struct_type,
+                              const std::string &field_name, const Type *type,
+                              const std::string &var, bool boxed,
+                              const std::string &indent, int depth) const {
+    auto d = std::to_string(depth);
+    auto declared_type = java_type(struct_type, field_name, type, boxed);
+    if (type->is_primitive()) {
+      ostream << indent << declared_type << " " << var << " = "
+              << binary_read_primitive(
+                     dynamic_cast<const PrimitiveType *>(type))
+              << ";" << NL;
+    } else if (type->is_enum()) {
+      ostream << indent << declared_type << " " << var << " = "
+              << binary_read_enum(type) << ";" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << declared_type << " " << var << " = "
+              << type->get_name() << ".readBinary(r, r.limit());" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType *>(type);
+      auto elem = "v" + std::to_string(depth + 1);
+      auto primitive_array = is_primitive_array(type);
+      ostream << indent << "int end" << d << " = r.limit();" << NL << indent
+              << "int n" << d << " = r.count(end" << d << ");" << NL << indent
+              << declared_type << " " << var << " = new "
+              << (primitive_array
+                      ? declared_type.substr(0, declared_type.size() - 1) +
+                            "n" + d + "]"
+                      : "java.util.ArrayList<>(n" + d + ")")
+              << ";" << NL << indent << "for (int i" << d << " = 0; i" << d
+              << " < n" << d << "; i" << d << "++) {" << NL;
+      generate_binary_decode(ostream, struct_type, field_name,
+                             list->get_elem_type().get(), elem,
+                             !primitive_array, indent + INDENT_1, depth + 1);
+      ostream << indent << INDENT_1 << var
+              << (primitive_array ? "[i" + d + "] = " + elem
+                                  : ".add(" + elem + ")")
+              << ";" << NL
+              << indent << "}" << NL << indent << "r.done(end" << d << ");"
+              << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType *>(type);
+      auto value = "v" + std::to_string(depth + 1);
+      ostream << indent << "int end" << d << " = r.limit();" << NL << indent
+              << "int n" << d << " = r.count(end" << d << ");" << NL << indent
+              << declared_type << " " << var
+              << " = new java.util.LinkedHashMap<>();" << NL << indent
+              << "for (int i" << d << " = 0; i" << d << " < n" << d << "; i"
+              << d << "++) {" << NL;
+      generate_binary_decode(ostream, struct_type, field_name,
+                             map->get_key_type().get(), "k" + d, false,
+                             indent + INDENT_1, depth + 1);
+      generate_binary_decode(ostream, struct_type, field_name,
+                             map->get_value_type().get(), value, true,
+                             indent + INDENT_1, depth + 1);
+      ostream << indent << INDENT_1 << var << ".put(k" << d << ", " << value
+              << ");" << NL << indent << "}" << NL << indent << "r.done(end"
+              << d << ");" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType *>(type);
+      auto prefix = capitalize(camelcase(struct_type->get_name()));
+      ostream << indent << "int end" << d << " = r.limit();" << NL << indent
+              << declared_type << " " << var << " = null;" << NL << indent
+              << "while (r.more(end" << d << ")) {" << NL;
+      generate_number_switch(
+          ostream, oneof->get_fields(), "k" + d, indent + INDENT_1,
+          [&](const Field &oneof_field, const std::string &member_indent) {
+            auto alt_class =
+                prefix + capitalize(camelcase(oneof_field.get_name()));
+            ostream << member_indent << alt_class << " a" << d << " = new "
+                    << alt_class << "();" << NL;
+            generate_binary_decode_field(
+                ostream, struct_type, oneof_field,
+                "a" + d + "." + camelcase(oneof_field.get_name()),
+                member_indent, depth + 1);
+            ostream << member_indent << var << " = a" << d << ";" << NL;
+          });
+      ostream << indent << "}" << NL << indent << "r.done(end" << d << ");"
+              << NL;
+    }
+  }
+
+  // Returns the expression reading a `primitive` with the reader `r`.
+  static std::string binary_read_primitive(const PrimitiveType *primitive,
+                                           const std::string &r = "r") {
+    if (primitive->is_bool()) {
+      return r + ".readBool()";
+    } else if (primitive->is_i32()) {
+      return "(int) " + r + ".readZigzag()";
+    } else if (primitive->is_i64()) {
+      return r + ".readZigzag()";
+    } else if (primitive->is_u32()) {
+      return "(int) " + r + ".readVarint()";
+    } else if (primitive->is_u64()) {
+      return r + ".readVarint()";
+    } else if (primitive->is_float()) {
+      return r + ".readFixed64()";
+    } else if (primitive->is_string()) {
+      return r + ".readString()";
+    }
+    return r + ".readAny()";
+  }
+
+  std::string binary_read_enum(const Type *type,
+                               const std::string &r = "r") const {
+    return type->get_name() + ".forNumber((int) " + r + ".readZigzag())" +
+           (use_java8_optional_ ? ".orElse(null)" : "");
+  }
+
+  // A view checks the top level of a binary message once, recording where
+  // the value of each field it knows starts, and decodes a field only when
+  // it is read. Strings come back as buffers sharing the message's bytes
+  // and structs as views of them. Lists, maps, oneofs and `any` values come
+  // back as their encoded bytes. Absent fields read as zero or null.
+  void generate_binary_view(std::ostream &ostream,
+                            const StructType *struct_type) const {
+    auto view_name = struct_type->get_name() + "View";
+    auto fields = struct_type->get_fields();
+
+    ostream << INDENT_1 << "public static final class " << view_name << " {"
+            << NL << INDENT_2 << "private final java.nio.ByteBuffer buf;" << NL
+            << INDENT_2
+            << "// Offset of each field's value plus one, 0 if it is absent."
+            << NL << INDENT_2 << "private final int[] off = new int["
+            << fields.size() << "];" << NL2;
+
+    ostream << INDENT_2 << "public " << view_name
+            << "(java.nio.ByteBuffer buf) {" << NL << INDENT_3
+            << "this.buf = buf;" << NL << INDENT_3
+            << "ToolmanBinaryReader r = new ToolmanBinaryReader(buf);" << NL
+            << INDENT_3 << "while (r.more(buf.limit())) {" << NL << INDENT_4
+            << "int k = r.key();" << NL << INDENT_4
+            << "int start = r.position();" << NL << INDENT_4
+            << "switch (k >>> 3) {" << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      ostream << INDENT_4 << INDENT_1 << "case " << fields[i].get_number()
+              << ":" << NL << INDENT_4 << INDENT_2 << "r.expect(k, "
+              << static_cast<int>(
+                     wire_format::wire_type_of(fields[i].get_type().get()))
+              << ");" << NL << INDENT_4 << INDENT_2 << "off[" << i
+              << "] = start + 1;" << NL << INDENT_4 << INDENT_2 << "break;"
+              << NL;
+    }
+    ostream << INDENT_4 << INDENT_1 << "default:" << NL << INDENT_4 << INDENT_2
+            << "break;" << NL << INDENT_4 << "}" << NL << INDENT_4
+            << "r.skip(k);" << NL << INDENT_3 << "}" << NL << INDENT_2 << "}"
+            << NL2;
+
+    ostream << INDENT_2 << "private ToolmanBinaryReader at(int i) {" << NL
+            << INDENT_3
+            << "ToolmanBinaryReader r = new ToolmanBinaryReader(buf);" << NL
+            << INDENT_3 << "r.seek(off[i] - 1);" << NL << INDENT_3
+            << "return r;" << NL << INDENT_2 << "}" << NL;
+
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto &field = fields[i];
+      auto type = field.get_type().get();
+      auto method = camelcase(field.get_name());
+      auto slot = std::to_string(i);
+      ostream << NL << INDENT_2 << "public boolean has" << capitalize(method)
+              << "() {" << NL << INDENT_3 << "return off[" << slot
+              << "] != 0;" << NL << INDENT_2 << "}" << NL2;
+
+      std::string result;
+      std::string zero = "null";
+      std::string read;
+      auto reader = "at(" + slot + ")";
+      if (type->is_enum()) {
+        result = type->get_name();
+        read = binary_read_enum(type, reader);
+      } else if (type->is_struct()) {
+        result = type->get_name() + "View";
+        read = "new " + result + "(" + reader + ".readSlice())";
+      } else if (type->is_primitive() &&
+                 !dynamic_cast<const PrimitiveType *>(type)->is_any()) {
+        auto primitive = dynamic_cast<const PrimitiveType *>(type);
+        if (primitive->is_string()) {
+          result = "java.nio.ByteBuffer";
+          read = reader + ".readSlice()";
+        } else {
+          result = type_to_java_type(type);
+          zero = primitive->is_bool() ? "false" : "0";
+          read = binary_read_primitive(primitive, reader);
+        }
+      } else {
+        method += "Bytes";
+        result = "java.nio.ByteBuffer";
+        read = reader + ".readSlice()";
+      }
+      ostream << INDENT_2 << "public " << result << " " << method << "() {"
+              << NL << INDENT_3 << "return off[" << slot << "] == 0 ? " << zero
+              << " : " << read << ";" << NL << INDENT_2 << "}" << NL;
+    }
+    ostream << INDENT_1 << "}" << NL2;
+  }
+
+  // Fields of Java primitive types always have a value.
+  static bool is_reference(const Type *type, bool boxed) {
+    if (!type->is_primitive()) {
+      return true;
+    }
+    auto primitive = dynamic_cast<const PrimitiveType *>(type);
+    return boxed || primitive->is_string() || primitive->is_any();
+  }
+
+  static std::string binary_key_constant(const std::string &name) {
+    std::string constant = "BINARY_KEY_";
+    for (auto c : name) {
+      constant +=
+          static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return constant;
+  }
+
+  // Returns the key of `field` as a Java byte array initializer.
+  static std::string binary_key_bytes(const Field &field) {
+    std::string bytes;
+    for (unsigned char c :
+         wire_format::encode_key(field.get_number(), field.get_type().get())) {
+      char hex[16];
+      std::snprintf(hex, sizeof(hex), c < 0x80 ? "0x%02x" : "(byte) 0x%02x",
+                    c);
+      bytes += (bytes.empty() ? "" : ", ") + std::string(hex);
+    }
+    return "{" + bytes + "}";
+  }
+
+  static std::string json_write_method(const PrimitiveType *primitive) {
+    if (primitive->is_bool()) {
+      return "writeBool";
+    } else if (primitive->is_i32()) {
+      return "writeInt";
+    } else if (primitive->is_u32()) {
+      return "writeUnsignedInt";
+    } else if (primitive->is_i64()) {
+      return "writeLong";
+    } else if (primitive->is_u64()) {
+      return "writeUnsignedLong";
+    }
+    return "writeFloat";
+  }
+
+  static std::string json_read_method(const PrimitiveType *primitive) {
+    if (primitive->is_bool()) {
+      return "readBool";
+    } else if (primitive->is_i32()) {
+      return "readInt";
+    } else if (primitive->is_u32()) {
+      return "readUnsignedInt";
+    } else if (primitive->is_i64()) {
+      return "readLong";
+    } else if (primitive->is_u64()) {
+      return "readUnsignedLong";
+    }
+    return "readFloat";
+  }
+
+  // Map keys arrive as JSON strings, non-string keys are parsed out of them.
+  static std::string json_read_key_method(const PrimitiveType *key) {
+    if (key->is_bool()) {
+      return "keyBool";
+    } else if (key->is_i32()) {
+      return "keyInt";
+    } else if (key->is_u32()) {
+      return "keyUnsignedInt";
+    } else if (key->is_i64()) {
+      return "keyLong";
+    } else if (key->is_u64()) {
+      return "keyUnsignedLong";
+    } else if (key->is_float()) {
+      return "keyFloat";
+    }
+    return "keyString";
+  }
+
+  static std::string json_key_constant(const std::string &name) {
+    std::string constant = "JSON_KEY_";
+    for (auto c : name) {
+      constant +=
+          static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return constant;
+  }
+
+  // Mirrors java.lang.String#hashCode() for ASCII names.
+  static std::int32_t java_string_hash(const std::string &str) {
+    std::uint32_t hash = 0;
+    for (unsigned char c : str) {
+      hash = 31 * hash + c;
+    }
+    return static_cast<std::int32_t>(hash);
+  }
+
+  std::string java_type(const StructType *struct_type,
+                        const std::string &field_name, const Type *type,
+                        bool boxed) const {
+    return type->is_oneof()
+               ? gen_oneof_name(struct_type->get_name(), field_name)
+               : type_to_java_type(type, boxed);
+  }
+
   static std::string gen_oneof_name(const std::string &struct_name,
                                     const std::string &field_name) {
     return "Is" + capitalize(camelcase(struct_name)) +
@@ -186,16 +2057,35 @@ class JavaGenerator : public Generator {
     return doc_comment.str();
   }
 
-  [[nodiscard]] static std::string type_to_java_type(Type *type,
-                                                     bool boxed = false) {
+  // With java_primitive_lists, lists of numbers are stored as arrays of
+  // the unboxed type.
+  [[nodiscard]] bool is_primitive_array(const Type *type) const {
+    if (!primitive_lists_ || !type->is_list()) {
+      return false;
+    }
+    auto elem = dynamic_cast<const ListType *>(type)->get_elem_type();
+    return elem->is_primitive() &&
+           std::dynamic_pointer_cast<PrimitiveType>(elem)->is_numeric();
+  }
+
+  // Toolman floats are 64 bit in the wire format and in the other targets,
+  // so with a codec they are Java doubles, which keep every value intact.
+  [[nodiscard]] bool double_floats() const {
+    return json_codec_ || binary_codec_ || binary_views_;
+  }
+
+  [[nodiscard]] std::string type_to_java_type(const Type *type,
+                                              bool boxed = false) const {
     if (type->is_primitive()) {
-      auto primitive = dynamic_cast<PrimitiveType *>(type);
+      auto primitive = dynamic_cast<const PrimitiveType *>(type);
       if (primitive->is_bool()) {
-        return boxed ? "Boolean" : "bool";
+        return boxed ? "Boolean" : "boolean";
       } else if (primitive->is_i32() || primitive->is_u32()) {
         return boxed ? "Integer" : "int";
       } else if (primitive->is_i64() || primitive->is_u64()) {
         return boxed ? "Long" : "long";
+      } else if (primitive->is_float() && double_floats()) {
+        return boxed ? "Double" : "double";
       } else if (primitive->is_float()) {
         return boxed ? "Float" : "float";
       } else if (primitive->is_string()) {
@@ -205,12 +2095,15 @@ class JavaGenerator : public Generator {
       }
     } else if (type->is_struct() || type->is_enum()) {
       return type->get_name();
+    } else if (is_primitive_array(type)) {
+      auto list = dynamic_cast<const ListType *>(type);
+      return type_to_java_type(list->get_elem_type().get()) + "[]";
     } else if (type->is_list()) {
-      auto list = dynamic_cast<ListType *>(type);
+      auto list = dynamic_cast<const ListType *>(type);
       return "java.util.List<" +
              type_to_java_type(list->get_elem_type().get(), true) + ">";
     } else if (type->is_map()) {
-      auto map = dynamic_cast<MapType *>(type);
+      auto map = dynamic_cast<const MapType *>(type);
       return "java.util.Map<" +
              type_to_java_type(map->get_key_type().get(), true) + ", " +
              type_to_java_type(map->get_value_type().get(), true) + ">";
@@ -218,6 +2111,15 @@ class JavaGenerator : public Generator {
     return "";
   }
   bool use_java8_optional_ = false;
+  bool json_codec_ = false;
+  bool streams_ = false;
+  bool binary_codec_ = false;
+  bool binary_views_ = false;
+  bool primitive_lists_ = false;
+  bool presence_bits_ = false;
+  bool http_client_ = false;
+  bool validation_ = false;
+  bool deep_copy_ = false;
 };
 }  // namespace toolman::generator
 #endif  // TOOLMAN_GOLANG_GENERATOR_H_
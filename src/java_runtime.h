@@ -0,0 +1,1438 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_JAVA_RUNTIME_H_
+#define TOOLMAN_JAVA_RUNTIME_H_
+
+namespace toolman::generator::java_runtime {
+
+// Support classes emitted once into the outer class of every Java file that
+// uses the generated JSON codec.
+constexpr char kJson[] = R"(
+    public static final class ToolmanJsonException extends RuntimeException {
+        private static final long serialVersionUID = 0L;
+
+        ToolmanJsonException(String message, int offset) {
+            super(message + " at offset " + offset);
+        }
+    }
+
+    static final class ToolmanJsonWriter {
+        private static final byte[] NULL = {'n', 'u', 'l', 'l'};
+        private static final byte[] TRUE = {'t', 'r', 'u', 'e'};
+        private static final byte[] FALSE = {'f', 'a', 'l', 's', 'e'};
+        private static final byte[] HEX = {
+            '0', '1', '2', '3', '4', '5', '6', '7',
+            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+        private byte[] buf = new byte[256];
+        private int len;
+
+        static byte[] utf8(String s) {
+            return s.getBytes(java.nio.charset.StandardCharsets.UTF_8);
+        }
+
+        private void ensure(int n) {
+            if (len + n > buf.length) {
+                buf = java.util.Arrays.copyOf(buf, Math.max(buf.length * 2, len + n));
+            }
+        }
+
+        void raw(byte[] b) {
+            ensure(b.length);
+            System.arraycopy(b, 0, buf, len, b.length);
+            len += b.length;
+        }
+
+        void raw(char c) {
+            ensure(1);
+            buf[len++] = (byte) c;
+        }
+
+        void writeNull() {
+            raw(NULL);
+        }
+
+        void writeBool(boolean v) {
+            raw(v ? TRUE : FALSE);
+        }
+
+        void writeInt(int v) {
+            writeLong(v);
+        }
+
+        void writeUnsignedInt(int v) {
+            writeLong(v & 0xffffffffL);
+        }
+
+        void writeLong(long v) {
+            if (v == Long.MIN_VALUE) {
+                raw(utf8("-9223372036854775808"));
+                return;
+            }
+            ensure(20);
+            if (v < 0) {
+                buf[len++] = '-';
+                v = -v;
+            }
+            int start = len;
+            do {
+                buf[len++] = (byte) ('0' + v % 10);
+                v /= 10;
+            } while (v != 0);
+            for (int i = start, j = len - 1; i < j; i++, j--) {
+                byte t = buf[i];
+                buf[i] = buf[j];
+                buf[j] = t;
+            }
+        }
+
+        void writeUnsignedLong(long v) {
+            if (v >= 0) {
+                writeLong(v);
+            } else {
+                raw(utf8(Long.toUnsignedString(v)));
+            }
+        }
+
+        void writeFloat(double v) {
+            if (Double.isNaN(v) || Double.isInfinite(v)) {
+                writeNull();
+            } else if (v == (long) v && Math.abs(v) < 1e15) {
+                writeLong((long) v);
+            } else {
+                raw(utf8(Double.toString(v)));
+            }
+        }
+
+        void writeString(String s) {
+            if (s == null) {
+                writeNull();
+                return;
+            }
+            ensure(s.length() + 2);
+            buf[len++] = '"';
+            for (int i = 0; i < s.length(); i++) {
+                char c = s.charAt(i);
+                if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+                    ensure(1);
+                    buf[len++] = (byte) c;
+                } else if (c == '"' || c == '\\') {
+                    ensure(2);
+                    buf[len++] = '\\';
+                    buf[len++] = (byte) c;
+                } else if (c == '\n') {
+                    ensure(2);
+                    buf[len++] = '\\';
+                    buf[len++] = 'n';
+                } else if (c == '\r') {
+                    ensure(2);
+                    buf[len++] = '\\';
+                    buf[len++] = 'r';
+                } else if (c == '\t') {
+                    ensure(2);
+                    buf[len++] = '\\';
+                    buf[len++] = 't';
+                } else if (c < 0x20) {
+                    ensure(6);
+                    buf[len++] = '\\';
+                    buf[len++] = 'u';
+                    buf[len++] = '0';
+                    buf[len++] = '0';
+                    buf[len++] = HEX[c >> 4];
+                    buf[len++] = HEX[c & 0xf];
+                } else if (c < 0x800) {
+                    ensure(2);
+                    buf[len++] = (byte) (0xc0 | (c >> 6));
+                    buf[len++] = (byte) (0x80 | (c & 0x3f));
+                } else if (Character.isHighSurrogate(c) && i + 1 < s.length()
+                        && Character.isLowSurrogate(s.charAt(i + 1))) {
+                    int cp = Character.toCodePoint(c, s.charAt(++i));
+                    ensure(4);
+                    buf[len++] = (byte) (0xf0 | (cp >> 18));
+                    buf[len++] = (byte) (0x80 | ((cp >> 12) & 0x3f));
+                    buf[len++] = (byte) (0x80 | ((cp >> 6) & 0x3f));
+                    buf[len++] = (byte) (0x80 | (cp & 0x3f));
+                } else {
+                    if (Character.isSurrogate(c)) {
+                        c = '\uFFFD';
+                    }
+                    ensure(3);
+                    buf[len++] = (byte) (0xe0 | (c >> 12));
+                    buf[len++] = (byte) (0x80 | ((c >> 6) & 0x3f));
+                    buf[len++] = (byte) (0x80 | (c & 0x3f));
+                }
+            }
+            ensure(1);
+            buf[len++] = '"';
+        }
+
+        void writeAny(Object v) {
+            if (v == null) {
+                writeNull();
+            } else if (v instanceof String) {
+                writeString((String) v);
+            } else if (v instanceof Boolean) {
+                writeBool((Boolean) v);
+            } else if (v instanceof Float || v instanceof Double) {
+                double d = ((Number) v).doubleValue();
+                if (Double.isNaN(d) || Double.isInfinite(d)) {
+                    writeNull();
+                } else {
+                    raw(utf8(Double.toString(d)));
+                }
+            } else if (v instanceof Number) {
+                writeLong(((Number) v).longValue());
+            } else if (v instanceof java.util.Map) {
+                raw('{');
+                boolean first = true;
+                for (java.util.Map.Entry<?, ?> e : ((java.util.Map<?, ?>) v).entrySet()) {
+                    if (!first) {
+                        raw(',');
+                    }
+                    first = false;
+                    writeString(String.valueOf(e.getKey()));
+                    raw(':');
+                    writeAny(e.getValue());
+                }
+                raw('}');
+            } else if (v instanceof Iterable) {
+                raw('[');
+                boolean first = true;
+                for (Object e : (Iterable<?>) v) {
+                    if (!first) {
+                        raw(',');
+                    }
+                    first = false;
+                    writeAny(e);
+                }
+                raw(']');
+            } else {
+                writeString(v.toString());
+            }
+        }
+
+        void writeTo(java.io.OutputStream out) throws java.io.IOException {
+            out.write(buf, 0, len);
+        }
+
+        byte[] toByteArray() {
+            return java.util.Arrays.copyOf(buf, len);
+        }
+
+        @Override
+        public String toString() {
+            return new String(buf, 0, len, java.nio.charset.StandardCharsets.UTF_8);
+        }
+    }
+
+    static final class ToolmanJsonReader {
+        private static final double[] POW10 = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        private final char[] buf;
+        private int pos;
+        // The last key read, either a range of buf or unescaped into scratch.
+        private char[] keyBuf;
+        private int keyStart;
+        private int keyEnd;
+        private char[] scratch = new char[64];
+
+        ToolmanJsonReader(char[] buf) {
+            this.buf = buf;
+        }
+
+        ToolmanJsonException error(String message) {
+            return new ToolmanJsonException(message, pos);
+        }
+
+        void ws() {
+            while (pos < buf.length) {
+                char c = buf[pos];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                    return;
+                }
+                pos++;
+            }
+        }
+
+        void end() {
+            ws();
+            if (pos != buf.length) {
+                throw error("unexpected data after top-level value");
+            }
+        }
+
+        private boolean literal(String s) {
+            if (pos + s.length() > buf.length) {
+                return false;
+            }
+            for (int i = 0; i < s.length(); i++) {
+                if (buf[pos + i] != s.charAt(i)) {
+                    return false;
+                }
+            }
+            pos += s.length();
+            return true;
+        }
+
+        // Consumes a null if it is the next value.
+        boolean nullValue() {
+            ws();
+            return literal("null");
+        }
+
+        void begin(char c) {
+            ws();
+            if (pos >= buf.length || buf[pos] != c) {
+                throw error("expected " + c);
+            }
+            pos++;
+        }
+
+        // Reports whether the i-th member of the object or array that closes
+        // with c follows, consuming the separating comma or the closing bracket.
+        boolean more(char close, int i) {
+            ws();
+            if (pos >= buf.length) {
+                throw error("unexpected end of JSON input");
+            }
+            char c = buf[pos];
+            if (c == close) {
+                pos++;
+                return false;
+            }
+            if (i == 0) {
+                return true;
+            }
+            if (c != ',') {
+                throw error("expected , or " + close);
+            }
+            pos++;
+            return true;
+        }
+
+        // Reads an object key and the colon after it. Returns the key's
+        // String.hashCode() so callers can switch on it without allocating.
+        int key() {
+            readChars();
+            ws();
+            if (pos >= buf.length || buf[pos] != ':') {
+                throw error("expected :");
+            }
+            pos++;
+            int h = 0;
+            for (int i = keyStart; i < keyEnd; i++) {
+                h = 31 * h + keyBuf[i];
+            }
+            return h;
+        }
+
+        boolean keyIs(String s) {
+            if (keyEnd - keyStart != s.length()) {
+                return false;
+            }
+            for (int i = 0; i < s.length(); i++) {
+                if (keyBuf[keyStart + i] != s.charAt(i)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        String keyString() {
+            return new String(keyBuf, keyStart, keyEnd - keyStart);
+        }
+
+        // Map keys arrive as JSON strings, non-string keys are parsed out of
+        // them.
+        int keyInt() {
+            try {
+                return Integer.parseInt(keyString());
+            } catch (NumberFormatException e) {
+                throw error("invalid map key");
+            }
+        }
+
+        int keyUnsignedInt() {
+            try {
+                return Integer.parseUnsignedInt(keyString());
+            } catch (NumberFormatException e) {
+                throw error("invalid map key");
+            }
+        }
+
+        long keyLong() {
+            try {
+                return Long.parseLong(keyString());
+            } catch (NumberFormatException e) {
+                throw error("invalid map key");
+            }
+        }
+
+        long keyUnsignedLong() {
+            try {
+                return Long.parseUnsignedLong(keyString());
+            } catch (NumberFormatException e) {
+                throw error("invalid map key");
+            }
+        }
+
+        double keyFloat() {
+            try {
+                return Double.parseDouble(keyString());
+            } catch (NumberFormatException e) {
+                throw error("invalid map key");
+            }
+        }
+
+        boolean keyBool() {
+            if (keyIs("true")) {
+                return true;
+            }
+            if (keyIs("false")) {
+                return false;
+            }
+            throw error("invalid map key");
+        }
+
+        // Reads a string into keyBuf/keyStart/keyEnd. Strings without escapes
+        // stay a range of the input, others are unescaped into scratch.
+        private void readChars() {
+            ws();
+            if (pos >= buf.length || buf[pos] != '"') {
+                throw error("expected string");
+            }
+            int start = ++pos;
+            while (pos < buf.length) {
+                char c = buf[pos];
+                if (c == '"') {
+                    keyBuf = buf;
+                    keyStart = start;
+                    keyEnd = pos++;
+                    return;
+                }
+                if (c == '\\') {
+                    unescape(start);
+                    return;
+                }
+                if (c < 0x20) {
+                    throw error("invalid character in string");
+                }
+                pos++;
+            }
+            throw error("unexpected end of JSON input");
+        }
+
+        private void unescape(int start) {
+            int n = 0;
+            for (int i = start; i < pos; i++) {
+                n = put(n, buf[i]);
+            }
+            while (pos < buf.length) {
+                char c = buf[pos++];
+                if (c == '"') {
+                    keyBuf = scratch;
+                    keyStart = 0;
+                    keyEnd = n;
+                    return;
+                }
+                if (c < 0x20) {
+                    throw error("invalid character in string");
+                }
+                if (c != '\\') {
+                    n = put(n, c);
+                    continue;
+                }
+                if (pos >= buf.length) {
+                    break;
+                }
+                char e = buf[pos++];
+                switch (e) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        n = put(n, e);
+                        break;
+                    case 'b':
+                        n = put(n, '\b');
+                        break;
+                    case 'f':
+                        n = put(n, '\f');
+                        break;
+                    case 'n':
+                        n = put(n, '\n');
+                        break;
+                    case 'r':
+                        n = put(n, '\r');
+                        break;
+                    case 't':
+                        n = put(n, '\t');
+                        break;
+                    case 'u':
+                        if (pos + 4 > buf.length) {
+                            throw error("invalid unicode escape");
+                        }
+                        int cp = 0;
+                        for (int i = 0; i < 4; i++) {
+                            int digit = Character.digit(buf[pos++], 16);
+                            if (digit < 0) {
+                                throw error("invalid unicode escape");
+                            }
+                            cp = (cp << 4) | digit;
+                        }
+                        n = put(n, (char) cp);
+                        break;
+                    default:
+                        throw error("invalid escape in string");
+                }
+            }
+            throw error("unexpected end of JSON input");
+        }
+
+        private int put(int n, char c) {
+            if (n == scratch.length) {
+                scratch = java.util.Arrays.copyOf(scratch, n * 2);
+            }
+            scratch[n] = c;
+            return n + 1;
+        }
+
+        String readString() {
+            if (nullValue()) {
+                return null;
+            }
+            readChars();
+            return new String(keyBuf, keyStart, keyEnd - keyStart);
+        }
+
+        boolean readBool() {
+            ws();
+            if (literal("true")) {
+                return true;
+            }
+            if (literal("false")) {
+                return false;
+            }
+            throw error("expected boolean");
+        }
+
+        // Returns the end of the number that starts at pos.
+        private int numberEnd() {
+            ws();
+            int end = pos;
+            while (end < buf.length) {
+                char c = buf[end];
+                if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.'
+                        && c != 'e' && c != 'E') {
+                    break;
+                }
+                end++;
+            }
+            if (end == pos) {
+                throw error("expected number");
+            }
+            return end;
+        }
+
+        private long parseDigits(int start, int end, long limit) {
+            if (start == end || (end - start > 1 && buf[start] == '0')) {
+                throw error("invalid integer");
+            }
+            long v = 0;
+            for (int i = start; i < end; i++) {
+                char c = buf[i];
+                if (c < '0' || c > '9') {
+                    throw error("invalid integer");
+                }
+                if (v > (limit - (c - '0')) / 10) {
+                    throw error("integer overflow");
+                }
+                v = v * 10 + (c - '0');
+            }
+            return v;
+        }
+
+        long readLong() {
+            int end = numberEnd();
+            boolean neg = buf[pos] == '-';
+            long v;
+            if (neg) {
+                // Accumulate negatively so Long.MIN_VALUE fits.
+                if (end - pos == 20 && new String(buf, pos, end - pos).equals("-9223372036854775808")) {
+                    pos = end;
+                    return Long.MIN_VALUE;
+                }
+                v = -parseDigits(pos + 1, end, Long.MAX_VALUE);
+            } else {
+                v = parseDigits(pos, end, Long.MAX_VALUE);
+            }
+            pos = end;
+            return v;
+        }
+
+        int readInt() {
+            long v = readLong();
+            if (v < Integer.MIN_VALUE || v > Integer.MAX_VALUE) {
+                throw error("integer overflow");
+            }
+            return (int) v;
+        }
+
+        int readUnsignedInt() {
+            int end = numberEnd();
+            long v = parseDigits(pos, end, 0xffffffffL);
+            pos = end;
+            return (int) v;
+        }
+
+        long readUnsignedLong() {
+            int end = numberEnd();
+            try {
+                long v = Long.parseUnsignedLong(new String(buf, pos, end - pos));
+                pos = end;
+                return v;
+            } catch (NumberFormatException e) {
+                throw error("invalid unsigned integer");
+            }
+        }
+
+        double readFloat() {
+            int end = numberEnd();
+            // Exact fast path for short decimals: both operands of the
+            // division are exact doubles, so its result is correctly rounded.
+            // Everything else is parsed by the JDK.
+            int i = pos;
+            boolean neg = buf[i] == '-';
+            if (neg) {
+                i++;
+            }
+            long mant = 0;
+            int digits = 0;
+            int exp = 0;
+            for (; i < end && buf[i] >= '0' && buf[i] <= '9'; i++, digits++) {
+                mant = mant * 10 + (buf[i] - '0');
+            }
+            if (i < end && buf[i] == '.') {
+                for (i++; i < end && buf[i] >= '0' && buf[i] <= '9'; i++, digits++, exp--) {
+                    mant = mant * 10 + (buf[i] - '0');
+                }
+            }
+            double v;
+            if (i == end && digits > 0 && digits <= 15 && exp >= -22) {
+                v = mant / POW10[-exp];
+                if (neg) {
+                    v = -v;
+                }
+            } else {
+                try {
+                    v = Double.parseDouble(new String(buf, pos, end - pos));
+                } catch (NumberFormatException e) {
+                    throw error("invalid number");
+                }
+            }
+            pos = end;
+            return v;
+        }
+
+        Object readAny() {
+            ws();
+            if (pos >= buf.length) {
+                throw error("unexpected end of JSON input");
+            }
+            char c = buf[pos];
+            if (c == '{') {
+                pos++;
+                java.util.Map<String, Object> map = new java.util.LinkedHashMap<>();
+                for (int i = 0; more('}', i); i++) {
+                    key();
+                    String k = keyString();
+                    map.put(k, readAny());
+                }
+                return map;
+            }
+            if (c == '[') {
+                pos++;
+                java.util.List<Object> list = new java.util.ArrayList<>();
+                for (int i = 0; more(']', i); i++) {
+                    list.add(readAny());
+                }
+                return list;
+            }
+            if (c == '"') {
+                return readString();
+            }
+            if (c == 't' || c == 'f') {
+                return readBool();
+            }
+            if (nullValue()) {
+                return null;
+            }
+            int end = numberEnd();
+            try {
+                double d = Double.parseDouble(new String(buf, pos, end - pos));
+                pos = end;
+                return d;
+            } catch (NumberFormatException e) {
+                throw error("invalid number");
+            }
+        }
+
+        void skip() {
+            ws();
+            if (pos >= buf.length) {
+                throw error("unexpected end of JSON input");
+            }
+            char c = buf[pos];
+            if (c == '{') {
+                pos++;
+                for (int i = 0; more('}', i); i++) {
+                    readChars();
+                    begin(':');
+                    skip();
+                }
+            } else if (c == '[') {
+                pos++;
+                for (int i = 0; more(']', i); i++) {
+                    skip();
+                }
+            } else if (c == '"') {
+                readChars();
+            } else if (c == 't' || c == 'f') {
+                readBool();
+            } else if (!nullValue()) {
+                pos = numberEnd();
+            }
+        }
+    }
+)";
+
+// Support code for the generated streamX methods, emitted after `kJson`.
+constexpr char kStream[] = R"(
+    // Reads JSON text from a java.io.Reader one value at a time, holding no
+    // more of it than the value being read and what was read ahead. Values
+    // are copied out and parsed by a ToolmanJsonReader of their own.
+    static final class ToolmanJsonStream {
+        private final java.io.Reader in;
+        private char[] buf = new char[4096];
+        private int pos;
+        private int len;
+        // The offset of buf[0] in the input.
+        private int offset;
+        private boolean eof;
+
+        ToolmanJsonStream(java.io.Reader in) {
+            this.in = in;
+        }
+
+        ToolmanJsonException error(String message) {
+            return new ToolmanJsonException(message, offset + pos);
+        }
+
+        // Drops the input before pos and reads more, growing buf only when
+        // it is full of the value being read. Returns false at the end.
+        private boolean read() {
+            if (pos > 0) {
+                System.arraycopy(buf, pos, buf, 0, len - pos);
+                len -= pos;
+                offset += pos;
+                pos = 0;
+            }
+            if (len == buf.length) {
+                buf = java.util.Arrays.copyOf(buf, buf.length * 2);
+            }
+            while (!eof) {
+                int n;
+                try {
+                    n = in.read(buf, len, buf.length - len);
+                } catch (java.io.IOException e) {
+                    throw new java.io.UncheckedIOException(e);
+                }
+                if (n < 0) {
+                    eof = true;
+                } else if (n > 0) {
+                    len += n;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Skips whitespace and returns the next char, -1 at the end.
+        int peek() {
+            for (;;) {
+                while (pos < len) {
+                    char c = buf[pos];
+                    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                        return c;
+                    }
+                    pos++;
+                }
+                if (!read()) {
+                    return -1;
+                }
+            }
+        }
+
+        // Returns the text of the next value. Brackets are only counted
+        // here, the ToolmanJsonReader checks the value.
+        char[] value() {
+            if (peek() < 0) {
+                throw error("unexpected end of JSON input");
+            }
+            int n = 0;
+            int depth = 0;
+            boolean str = false;
+            boolean esc = false;
+            scan:
+            for (;;) {
+                if (pos + n == len && !read()) {
+                    break;
+                }
+                char c = buf[pos + n];
+                if (str) {
+                    n++;
+                    if (esc) {
+                        esc = false;
+                    } else if (c == '\\') {
+                        esc = true;
+                    } else if (c == '"') {
+                        str = false;
+                        if (depth == 0) {
+                            break;
+                        }
+                    }
+                    continue;
+                }
+                switch (c) {
+                    case '"':
+                        str = true;
+                        break;
+                    case '{':
+                    case '[':
+                        depth++;
+                        break;
+                    case '}':
+                    case ']':
+                        if (depth == 0) {
+                            break scan;
+                        }
+                        if (--depth == 0) {
+                            n++;
+                            break scan;
+                        }
+                        break;
+                    case ',':
+                    case ':':
+                    case ' ':
+                    case '\t':
+                    case '\n':
+                    case '\r':
+                        if (depth == 0) {
+                            break scan;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                n++;
+            }
+            char[] value = java.util.Arrays.copyOfRange(buf, pos, pos + n);
+            pos += n;
+            return value;
+        }
+
+        boolean nullValue() {
+            if (peek() != 'n') {
+                return false;
+            }
+            ToolmanJsonReader r = new ToolmanJsonReader(value());
+            if (!r.nullValue()) {
+                throw error("invalid literal");
+            }
+            return true;
+        }
+
+        void begin(char c) {
+            if (peek() != c) {
+                throw error("expected " + c);
+            }
+            pos++;
+        }
+
+        boolean more(char close, int i) {
+            int c = peek();
+            if (c < 0) {
+                throw error("unexpected end of JSON input");
+            }
+            if (c == close) {
+                pos++;
+                return false;
+            }
+            if (i == 0) {
+                return true;
+            }
+            if (c != ',') {
+                throw error("expected , or " + close);
+            }
+            pos++;
+            return true;
+        }
+
+        void colon() {
+            if (peek() != ':') {
+                throw error("expected :");
+            }
+            pos++;
+        }
+
+        void end() {
+            if (peek() >= 0) {
+                throw error("unexpected data after top-level value");
+            }
+        }
+    }
+
+    /**
+     * Iterates over the elements of one list of the object read from a
+     * java.io.Reader, reading and parsing one element at a time. The other
+     * members are kept as text until the object has been read, then parsed
+     * into the object returned by rest().
+     */
+    public abstract static class ToolmanJsonElements<E, T>
+            implements java.util.Iterator<E> {
+        private final ToolmanJsonStream s;
+        private final String field;
+        private final StringBuilder rest = new StringBuilder("{");
+        private int members = -1;
+        // The index of the next element, -1 outside of the list.
+        private int index = -1;
+        private boolean ready;
+        private boolean done;
+        private T result;
+
+        ToolmanJsonElements(java.io.Reader in, String field) {
+            this.s = new ToolmanJsonStream(in);
+            this.field = field;
+        }
+
+        abstract E readElement(ToolmanJsonReader r, int i);
+
+        abstract T readRest(ToolmanJsonReader r);
+
+        @Override
+        public boolean hasNext() {
+            if (ready || done) {
+                return ready;
+            }
+            if (members < 0) {
+                if (s.nullValue()) {
+                    s.end();
+                    done = true;
+                    return false;
+                }
+                s.begin('{');
+                members = 0;
+            }
+            for (;;) {
+                if (index >= 0) {
+                    if (s.more(']', index)) {
+                        ready = true;
+                        return true;
+                    }
+                    index = -1;
+                }
+                if (!s.more('}', members)) {
+                    break;
+                }
+                char[] key = s.value();
+                s.colon();
+                if (s.peek() == '[' &&
+                        field.equals(new ToolmanJsonReader(key).readString())) {
+                    s.begin('[');
+                    index = 0;
+                } else {
+                    rest.append(rest.length() == 1 ? "" : ",").append(key)
+                        .append(':').append(s.value());
+                }
+                members++;
+            }
+            s.end();
+            done = true;
+            ToolmanJsonReader r = new ToolmanJsonReader(
+                rest.append('}').toString().toCharArray());
+            result = readRest(r);
+            r.end();
+            return false;
+        }
+
+        @Override
+        public E next() {
+            if (!hasNext()) {
+                throw new java.util.NoSuchElementException();
+            }
+            ready = false;
+            ToolmanJsonReader r = new ToolmanJsonReader(s.value());
+            E e = readElement(r, index++);
+            r.end();
+            return e;
+        }
+
+        /**
+         * Reads the elements not read yet and returns the rest of the
+         * object, null if it was null.
+         */
+        public T rest() {
+            while (hasNext()) {
+                next();
+            }
+            return result;
+        }
+    }
+)";
+
+// Support classes for the generated binary codec, see src/wire_format.h.
+// Emitted after `kJson`, which encodes and decodes `any` values.
+constexpr char kBinary[] = R"(
+    public static final class ToolmanBinaryException extends RuntimeException {
+        private static final long serialVersionUID = 0L;
+
+        ToolmanBinaryException(String message, int offset) {
+            super(message + " at offset " + offset);
+        }
+    }
+
+    static final class ToolmanBinaryWriter {
+        private byte[] buf = new byte[256];
+        private int len;
+
+        private void ensure(int n) {
+            if (len + n > buf.length) {
+                buf = java.util.Arrays.copyOf(buf, Math.max(buf.length * 2, len + n));
+            }
+        }
+
+        void raw(byte[] b) {
+            ensure(b.length);
+            System.arraycopy(b, 0, buf, len, b.length);
+            len += b.length;
+        }
+
+        void writeVarint(long v) {
+            ensure(10);
+            while ((v & ~0x7fL) != 0) {
+                buf[len++] = (byte) (v | 0x80);
+                v >>>= 7;
+            }
+            buf[len++] = (byte) v;
+        }
+
+        void writeZigzag(long v) {
+            writeVarint((v << 1) ^ (v >> 63));
+        }
+
+        void writeBool(boolean v) {
+            ensure(1);
+            buf[len++] = (byte) (v ? 1 : 0);
+        }
+
+        void writeFixed64(double v) {
+            long u = Double.doubleToLongBits(v);
+            ensure(8);
+            for (int i = 0; i < 8; i++) {
+                buf[len++] = (byte) (u >>> (8 * i));
+            }
+        }
+
+        void writeString(String s) {
+            byte[] b = s.getBytes(java.nio.charset.StandardCharsets.UTF_8);
+            writeVarint(b.length);
+            raw(b);
+        }
+
+        void writeAny(Object v) {
+            ToolmanJsonWriter json = new ToolmanJsonWriter();
+            json.writeAny(v);
+            byte[] b = json.toByteArray();
+            writeVarint(b.length);
+            raw(b);
+        }
+
+        // Reserves a one byte length prefix, returns where the value starts.
+        int begin() {
+            ensure(1);
+            buf[len++] = 0;
+            return len;
+        }
+
+        // Fills in the length prefix reserved by begin(), moving the value up
+        // when its length needs a longer varint.
+        void end(int start) {
+            int n = len - start;
+            if (n < 0x80) {
+                buf[start - 1] = (byte) n;
+                return;
+            }
+            int extra = 1;
+            for (int v = n >>> 14; v != 0; v >>>= 7) {
+                extra++;
+            }
+            ensure(extra);
+            System.arraycopy(buf, start, buf, start + extra, n);
+            len += extra;
+            int p = start - 1;
+            for (int v = n; ; v >>>= 7) {
+                if (v < 0x80) {
+                    buf[p] = (byte) v;
+                    break;
+                }
+                buf[p++] = (byte) (v | 0x80);
+            }
+        }
+
+        void writeTo(java.io.OutputStream out) throws java.io.IOException {
+            out.write(buf, 0, len);
+        }
+
+        byte[] toByteArray() {
+            return java.util.Arrays.copyOf(buf, len);
+        }
+    }
+
+    // Reads a binary message from buf's position to its limit, indexing
+    // buf absolutely, so several readers can share one buffer.
+    static final class ToolmanBinaryReader {
+        private final java.nio.ByteBuffer buf;
+        private final int bufEnd;
+        private int pos;
+
+        ToolmanBinaryReader(byte[] buf) {
+            this(java.nio.ByteBuffer.wrap(buf));
+        }
+
+        ToolmanBinaryReader(java.nio.ByteBuffer buf) {
+            this.buf = buf;
+            this.pos = buf.position();
+            this.bufEnd = buf.limit();
+        }
+
+        int position() {
+            return pos;
+        }
+
+        void seek(int pos) {
+            this.pos = pos;
+        }
+
+        ToolmanBinaryException error(String message) {
+            return new ToolmanBinaryException(message, pos);
+        }
+
+        boolean more(int end) {
+            return pos < end;
+        }
+
+        long readVarint() {
+            long v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (pos >= bufEnd) {
+                    throw error("unexpected end of input");
+                }
+                byte b = buf.get(pos++);
+                v |= (long) (b & 0x7f) << shift;
+                if (b >= 0) {
+                    return v;
+                }
+            }
+            throw error("malformed varint");
+        }
+
+        long readZigzag() {
+            long v = readVarint();
+            return (v >>> 1) ^ -(v & 1);
+        }
+
+        boolean readBool() {
+            return readVarint() != 0;
+        }
+
+        double readFixed64() {
+            if (bufEnd - pos < 8) {
+                throw error("unexpected end of input");
+            }
+            long u = 0;
+            for (int i = 7; i >= 0; i--) {
+                u = (u << 8) | (buf.get(pos + i) & 0xff);
+            }
+            pos += 8;
+            return Double.longBitsToDouble(u);
+        }
+
+        // Reads a length prefix, returns the offset the value ends at.
+        int limit() {
+            long n = readVarint();
+            if (n < 0 || n > bufEnd - pos) {
+                throw error("length exceeds input");
+            }
+            return pos + (int) n;
+        }
+
+        // Reads an element count. Every element takes at least one byte, so
+        // a count larger than what is left before end is malformed.
+        int count(int end) {
+            long n = readVarint();
+            if (n < 0 || n > end - pos) {
+                throw error("count exceeds input");
+            }
+            return (int) n;
+        }
+
+        // Checks that a length-delimited value ended where its prefix said.
+        void done(int end) {
+            if (pos != end) {
+                throw error("length mismatch");
+            }
+        }
+
+        String readString() {
+            int end = limit();
+            String s;
+            if (buf.hasArray()) {
+                s = new String(buf.array(), buf.arrayOffset() + pos, end - pos,
+                    java.nio.charset.StandardCharsets.UTF_8);
+            } else {
+                byte[] b = new byte[end - pos];
+                for (int i = 0; i < b.length; i++) {
+                    b[i] = buf.get(pos + i);
+                }
+                s = new String(b, java.nio.charset.StandardCharsets.UTF_8);
+            }
+            pos = end;
+            return s;
+        }
+
+        // Returns the next length-delimited value as a buffer sharing its
+        // bytes, positioned at the value and limited to its end.
+        java.nio.ByteBuffer readSlice() {
+            int end = limit();
+            java.nio.ByteBuffer b = buf.duplicate();
+            b.limit(end);
+            b.position(pos);
+            pos = end;
+            return b;
+        }
+
+        Object readAny() {
+            ToolmanJsonReader json = new ToolmanJsonReader(readString().toCharArray());
+            Object v = json.readAny();
+            json.end();
+            return v;
+        }
+
+        // Returns the whole key, the field number is key >>> 3.
+        int key() {
+            long k = readVarint();
+            if ((k >>> 32) != 0) {
+                throw error("malformed key");
+            }
+            return (int) k;
+        }
+
+        void expect(int key, int wireType) {
+            if ((key & 7) != wireType) {
+                throw error("wrong wire type");
+            }
+        }
+
+        void skip(int key) {
+            switch (key & 7) {
+                case 0:
+                    readVarint();
+                    break;
+                case 1:
+                    if (bufEnd - pos < 8) {
+                        throw error("unexpected end of input");
+                    }
+                    pos += 8;
+                    break;
+                case 2:
+                    pos = limit();
+                    break;
+                default:
+                    throw error("unknown wire type");
+            }
+        }
+    }
+)";
+
+// Support code for the generated HTTP clients, on java.net.http (Java 11).
+constexpr char kHttpClient[] = R"(
+    public static final class ToolmanHttpException extends java.io.IOException {
+        private static final long serialVersionUID = 0L;
+
+        private final int status;
+        private final byte[] body;
+
+        ToolmanHttpException(int status, byte[] body) {
+            super("unexpected HTTP status " + status);
+            this.status = status;
+            this.body = body;
+        }
+
+        public int getStatus() {
+            return status;
+        }
+
+        public byte[] getBody() {
+            return body;
+        }
+    }
+
+    static final class ToolmanHttp {
+        private static final char[] HEX = "0123456789ABCDEF".toCharArray();
+
+        // Appends s as one path segment, percent-encoding its UTF-8 bytes
+        // except for the characters RFC 3986 leaves unreserved.
+        static void appendSegment(StringBuilder u, String s) {
+            for (int i = 0; i < s.length(); i++) {
+                char c = s.charAt(i);
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                        || (c >= '0' && c <= '9') || c == '-' || c == '.'
+                        || c == '_' || c == '~') {
+                    u.append(c);
+                    continue;
+                }
+                int cp = s.codePointAt(i);
+                i += Character.charCount(cp) - 1;
+                byte[] b = new String(Character.toChars(cp))
+                    .getBytes(java.nio.charset.StandardCharsets.UTF_8);
+                for (byte x : b) {
+                    u.append('%').append(HEX[(x >> 4) & 0xf]).append(HEX[x & 0xf]);
+                }
+            }
+        }
+
+        static java.net.http.HttpResponse<byte[]> send(java.net.http.HttpClient client,
+                String method, StringBuilder url, byte[] body)
+                throws java.io.IOException, InterruptedException {
+            java.net.http.HttpRequest.Builder b =
+                java.net.http.HttpRequest.newBuilder(java.net.URI.create(url.toString()));
+            if (body == null) {
+                b.method(method, java.net.http.HttpRequest.BodyPublishers.noBody());
+            } else {
+                b.header("Content-Type", "application/json")
+                    .method(method, java.net.http.HttpRequest.BodyPublishers.ofByteArray(body));
+            }
+            return client.send(b.build(), java.net.http.HttpResponse.BodyHandlers.ofByteArray());
+        }
+
+        static ToolmanJsonReader reader(byte[] body) {
+            return new ToolmanJsonReader(
+                new String(body, java.nio.charset.StandardCharsets.UTF_8).toCharArray());
+        }
+    }
+)";
+
+// Support code for the generated validate() methods.
+constexpr char kValidation[] = R"(
+    public static final class ToolmanValidationException
+            extends IllegalArgumentException {
+        private static final long serialVersionUID = 0L;
+
+        private final String path;
+        private final String reason;
+
+        ToolmanValidationException(String path, String reason) {
+            super(path + " " + reason);
+            this.path = path;
+            this.reason = reason;
+        }
+
+        public String getPath() {
+            return path;
+        }
+
+        public String getReason() {
+            return reason;
+        }
+
+        // The same failure, in the struct held at prefix.
+        ToolmanValidationException in(String prefix) {
+            return new ToolmanValidationException(prefix + "." + path, reason);
+        }
+    }
+
+    static final class ToolmanValidation {
+        // Lengths count code points, the way the other targets do.
+        static int length(String s) {
+            return s == null ? 0 : s.codePointCount(0, s.length());
+        }
+
+        static boolean matches(java.util.regex.Pattern p, String s) {
+            return p.matcher(s == null ? "" : s).find();
+        }
+
+        static int size(java.util.Collection<?> c) {
+            return c == null ? 0 : c.size();
+        }
+
+        static int size(java.util.Map<?, ?> m) {
+            return m == null ? 0 : m.size();
+        }
+
+        static int size(int[] a) {
+            return a == null ? 0 : a.length;
+        }
+
+        static int size(long[] a) {
+            return a == null ? 0 : a.length;
+        }
+
+        static int size(float[] a) {
+            return a == null ? 0 : a.length;
+        }
+
+        static int size(double[] a) {
+            return a == null ? 0 : a.length;
+        }
+    }
+)";
+
+// Support code for the generated copyFrom methods.
+constexpr char kCopy[] = R"(
+    static final class ToolmanCopy {
+        // The capacity of a hash map that takes n entries without growing,
+        // the way HashMap sizes the copy of a map.
+        static int capacity(int n) {
+            return n < 3 ? n + 1 : (int) (n / 0.75f + 1.0f);
+        }
+
+        // Copies an `any` value, read from JSON, whose maps and lists are
+        // the only storage it can share.
+        @SuppressWarnings("unchecked")
+        static Object any(Object v) {
+            if (v instanceof java.util.Map) {
+                java.util.Map<String, Object> map = (java.util.Map<String, Object>) v;
+                java.util.Map<String, Object> copy = new java.util.LinkedHashMap<>(capacity(map.size()));
+                for (java.util.Map.Entry<String, Object> e : map.entrySet()) {
+                    copy.put(e.getKey(), any(e.getValue()));
+                }
+                return copy;
+            } else if (v instanceof java.util.List) {
+                java.util.List<Object> list = (java.util.List<Object>) v;
+                java.util.List<Object> copy = new java.util.ArrayList<>(list.size());
+                for (Object e : list) {
+                    copy.add(any(e));
+                }
+                return copy;
+            }
+            return v;
+        }
+    }
+)";
+
+}  // namespace toolman::generator::java_runtime
+
+#endif  // TOOLMAN_JAVA_RUNTIME_H_
@@ -6,25 +6,52 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "src/compiler.h"
 #include "src/generator.h"
+#include "src/plugin.h"
 
 int main(int argc, char **argv) {
   std::string filename = "/Users/ty/Desktop/toolman_examples.tm";  // for debug
   toolman::generator::TargetLanguage target =
       toolman::generator::target_language_from_string("");
 
-  if (argc > 1) {
-    if (argc == 3) {
-      target = toolman::generator::target_language_from_string(argv[1]);
-      filename = argv[2];
+  // toolman [-I dir ...] [target] file.tm
+  // toolman [-I dir ...] --plugin=name [--plugin=other ...] [--out=dir] file.tm
+  toolman::Compiler compiler;
+  std::vector<std::string> plugins;
+  std::string out_dir = ".";
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-I") {
+      // A trailing -I would otherwise be taken for the file name.
+      if (i + 1 == argc) {
+        std::cerr << "toolman: -I needs a directory" << std::endl
+                  << "usage: toolman [-I dir ...] [target] file.tm"
+                  << std::endl;
+        return 2;
+      }
+      compiler.add_import_path(argv[++i]);
+    } else if (arg.rfind("-I", 0) == 0 && arg.size() > 2) {
+      compiler.add_import_path(arg.substr(2));
+    } else if (arg.rfind("--plugin=", 0) == 0) {
+      plugins.push_back(arg.substr(9));
+    } else if (arg.rfind("--out=", 0) == 0) {
+      out_dir = arg.substr(6);
     } else {
-      filename = argv[1];
+      positional.push_back(std::move(arg));
     }
   }
 
-  toolman::Compiler compiler;
+  if (positional.size() == 2) {
+    target = toolman::generator::target_language_from_string(positional[0]);
+    filename = positional[1];
+  } else if (positional.size() == 1) {
+    filename = positional[0];
+  }
+
   auto compile_res = compiler.compile(filename);
 
   for (const auto &error : compile_res.get_errors()) {
@@ -35,6 +62,30 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (!plugins.empty()) {
+    auto document = compile_res.get_document();
+    int ret = 0;
+    for (const auto &result :
+         toolman::plugin::run_plugins(plugins, *document)) {
+      if (!result.failure.empty()) {
+        std::cerr << result.failure << std::endl;
+        ret = 1;
+        continue;
+      }
+      for (const auto &error : result.response.errors) {
+        std::cerr << result.name << ": " << error << std::endl;
+        ret = 1;
+      }
+      if (result.ok() &&
+          !toolman::plugin::write_generated_files(result, out_dir)) {
+        std::cerr << result.name << ": cannot write generated files to `"
+                  << out_dir << "`" << std::endl;
+        ret = 1;
+      }
+    }
+    return ret;
+  }
+
   toolman::generator::generate(compile_res.get_document(), target, std::cout);
   return 0;
 }
@@ -0,0 +1,64 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_PERFECT_HASH_H_
+#define TOOLMAN_PERFECT_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace toolman::generator {
+
+// A collision free hash of a fixed set of 32-bit keys into a table of
+// 2^bits slots: slot(key) = (key * multiplier mod 2^32) >> (32 - bits).
+// Generated code evaluates it with one multiplication and one shift, then
+// compares the key stored in the slot to tell members from other keys.
+struct PerfectHash {
+  std::uint32_t multiplier;
+  unsigned bits;
+  // The index in `keys` of the key hashed into each slot, -1 if none.
+  std::vector<int> slots;
+
+  [[nodiscard]] unsigned shift() const { return 32 - bits; }
+
+  [[nodiscard]] std::uint32_t slot(std::uint32_t key) const {
+    return (key * multiplier) >> shift();
+  }
+};
+
+// Searches multipliers for tables of up to eight times as many slots as
+// keys, smallest table first. Returns nullopt when the keys are not
+// distinct or no multiplier is found, callers then fall back to a switch.
+inline std::optional<PerfectHash> find_perfect_hash(
+    const std::vector<std::uint32_t>& keys) {
+  unsigned min_bits = 1;
+  while ((std::size_t{1} << min_bits) < keys.size()) {
+    ++min_bits;
+  }
+  for (auto bits = min_bits; bits <= min_bits + 3 && bits < 32; ++bits) {
+    // Odd multipliers from a fixed sequence, so output is reproducible.
+    std::uint32_t state = 0x9e3779b9u;
+    for (int attempt = 0; attempt < 4096; ++attempt) {
+      state = state * 1664525u + 1013904223u;
+      PerfectHash hash{state | 1u, bits,
+                       std::vector<int>(std::size_t{1} << bits, -1)};
+      auto found = true;
+      for (std::size_t i = 0; i < keys.size() && found; ++i) {
+        auto& slot = hash.slots[hash.slot(keys[i])];
+        found = slot == -1;
+        slot = static_cast<int>(i);
+      }
+      if (found) {
+        return hash;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace toolman::generator
+
+#endif  // TOOLMAN_PERFECT_HASH_H_
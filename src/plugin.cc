@@ -0,0 +1,218 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "src/plugin.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+extern char** environ;
+
+namespace toolman::plugin {
+
+namespace {
+
+// Held from creating a plugin's pipes until it is spawned. pipe() and
+// fcntl() are two steps, and a plugin spawned in between by another thread
+// would inherit the pipes and keep them open.
+std::mutex spawn_mutex;
+
+class Pipe {
+ public:
+  Pipe() {
+    // pipe2() is not available on macOS.
+    if (pipe(fds_) != 0) {
+      fds_[0] = fds_[1] = -1;
+      return;
+    }
+    for (int fd : fds_) {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+  }
+  ~Pipe() {
+    close_read();
+    close_write();
+  }
+  Pipe(const Pipe&) = delete;
+  Pipe& operator=(const Pipe&) = delete;
+
+  [[nodiscard]] bool valid() const { return fds_[0] >= 0; }
+  [[nodiscard]] int read_fd() const { return fds_[0]; }
+  [[nodiscard]] int write_fd() const { return fds_[1]; }
+
+  void close_read() { close_fd(&fds_[0]); }
+  void close_write() { close_fd(&fds_[1]); }
+
+ private:
+  static void close_fd(int* fd) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+  int fds_[2];
+};
+
+// Feeds `request` to the plugin's stdin while draining its stdout, so a
+// plugin that starts writing before it has read everything cannot deadlock
+// against us.
+std::string exchange(Pipe* to_child, Pipe* from_child,
+                     const std::string& request) {
+  std::string output;
+  std::string::size_type written = 0;
+  fcntl(to_child->write_fd(), F_SETFL, O_NONBLOCK);
+  if (request.empty()) {
+    to_child->close_write();
+  }
+
+  char buffer[64 * 1024];
+  while (from_child->read_fd() >= 0) {
+    pollfd fds[2];
+    nfds_t nfds = 0;
+    fds[nfds++] = {from_child->read_fd(), POLLIN, 0};
+    if (to_child->write_fd() >= 0) {
+      fds[nfds++] = {to_child->write_fd(), POLLOUT, 0};
+    }
+    if (poll(fds, nfds, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    if (nfds == 2 && (fds[1].revents & (POLLOUT | POLLERR | POLLHUP))) {
+      auto n = write(to_child->write_fd(), request.data() + written,
+                     request.size() - written);
+      if (n > 0) {
+        written += n;
+      }
+      if (written == request.size() || (n < 0 && errno != EAGAIN)) {
+        // Either everything has been sent or the plugin closed its stdin,
+        // in both cases it gets EOF and we only keep reading.
+        to_child->close_write();
+      }
+    }
+
+    if (fds[0].revents & (POLLIN | POLLERR | POLLHUP)) {
+      auto n = read(from_child->read_fd(), buffer, sizeof(buffer));
+      if (n > 0) {
+        output.append(buffer, n);
+      } else if (n == 0 || errno != EINTR) {
+        from_child->close_read();
+      }
+    }
+  }
+  to_child->close_write();
+  return output;
+}
+
+PluginResult run_plugin(const std::string& name, const std::string& request) {
+  PluginResult result{name, {}, {}};
+  auto executable = kPluginExecutablePrefix + name;
+
+  std::unique_lock<std::mutex> spawn_lock(spawn_mutex);
+  Pipe to_child;
+  Pipe from_child;
+  if (!to_child.valid() || !from_child.valid()) {
+    result.failure = std::string("cannot create pipe: ") + strerror(errno);
+    return result;
+  }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, to_child.read_fd(), STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, from_child.write_fd(),
+                                   STDOUT_FILENO);
+  char* argv[] = {executable.data(), nullptr};
+  pid_t pid;
+  auto spawn_errno = posix_spawnp(&pid, executable.c_str(), &actions, nullptr,
+                                  argv, environ);
+  posix_spawn_file_actions_destroy(&actions);
+  spawn_lock.unlock();
+  if (spawn_errno != 0) {
+    result.failure =
+        "cannot run `" + executable + "`: " + strerror(spawn_errno);
+    return result;
+  }
+  to_child.close_read();
+  from_child.close_write();
+
+  auto output = exchange(&to_child, &from_child, request);
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    result.failure = "`" + executable + "` " +
+                     (WIFEXITED(status)
+                          ? "exited with status " +
+                                std::to_string(WEXITSTATUS(status))
+                          : std::string("was terminated by a signal"));
+    return result;
+  }
+
+  try {
+    result.response = descriptor::parse_response(output);
+  } catch (descriptor::DecodeError& e) {
+    result.failure = "`" + executable + "`: " + e.what();
+  }
+  return result;
+}
+
+}  // namespace
+
+std::vector<PluginResult> run_plugins(const std::vector<std::string>& names,
+                                      const Document& document) {
+  // A plugin that exits before reading all of its input must not kill us.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  const auto request = descriptor::serialize(document);
+  std::vector<PluginResult> results(names.size());
+  std::vector<std::thread> workers;
+  workers.reserve(names.size());
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    workers.emplace_back(
+        [&, i]() { results[i] = run_plugin(names[i], request); });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return results;
+}
+
+bool write_generated_files(const PluginResult& result,
+                           const std::filesystem::path& out_dir) {
+  for (const auto& file : result.response.files) {
+    auto relative = std::filesystem::path(file.name).lexically_normal();
+    if (relative.empty() || relative.is_absolute() ||
+        *relative.begin() == "..") {
+      return false;
+    }
+    auto target = out_dir / relative;
+    std::error_code error;
+    std::filesystem::create_directories(target.parent_path(), error);
+    if (error) {
+      return false;
+    }
+    std::ofstream ofs(target, std::ios_base::out | std::ios_base::binary |
+                                  std::ios_base::trunc);
+    ofs << file.content;
+    if (!ofs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace toolman::plugin
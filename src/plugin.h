@@ -0,0 +1,46 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_PLUGIN_H_
+#define TOOLMAN_PLUGIN_H_
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "src/descriptor.h"
+#include "src/document.h"
+
+namespace toolman::plugin {
+
+// Plugins are executables named `toolman-gen-<name>` that are looked up on
+// the PATH. Each one reads a descriptor request (see src/descriptor.h) from
+// stdin until EOF and writes a descriptor response to stdout.
+constexpr char kPluginExecutablePrefix[] = "toolman-gen-";
+
+struct PluginResult {
+  std::string name;
+  descriptor::Response response;
+  // Set when the plugin could not be run or its response is unusable.
+  std::string failure;
+
+  [[nodiscard]] bool ok() const {
+    return failure.empty() && response.errors.empty();
+  }
+};
+
+// Serializes `document` once and runs every named plugin concurrently on it.
+// The results are returned in the order of `names`.
+std::vector<PluginResult> run_plugins(const std::vector<std::string>& names,
+                                      const Document& document);
+
+// Writes the generated files of `result` below `out_dir`, creating
+// directories as needed. Returns false as soon as a file names a path outside
+// of `out_dir` or cannot be written.
+bool write_generated_files(const PluginResult& result,
+                           const std::filesystem::path& out_dir);
+
+}  // namespace toolman::plugin
+
+#endif  // TOOLMAN_PLUGIN_H_
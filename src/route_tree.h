@@ -0,0 +1,170 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_ROUTE_TREE_H_
+#define TOOLMAN_ROUTE_TREE_H_
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/api.h"
+#include "src/custom_type.h"
+#include "src/generator.h"
+#include "src/primitive_type.h"
+
+namespace toolman::generator {
+
+// A radix tree of the paths of an api group, built at code generation time
+// so that generated routers match a path with straight-line code. Every
+// path param makes up a whole segment, see ApiBuilder::check_path_params,
+// so a param node takes everything up to the next slash.
+struct RouteNode {
+  // The text matched on the way into the node, empty for param nodes.
+  std::string prefix;
+  // Static children, which start with distinct bytes.
+  std::vector<RouteNode> children;
+  std::unique_ptr<RouteNode> param;
+  // The indices of the apis whose path ends at this node.
+  std::vector<std::size_t> routes;
+};
+
+// A path split at its params: the static text before each param, then the
+// text after the last one.
+inline std::vector<std::string> route_parts(const Api& api) {
+  std::vector<std::string> parts;
+  std::string::size_type start = 0;
+  for (const auto& param : api.get_path_params()) {
+    parts.push_back(api.get_path().substr(start, param.pos_in_path - start));
+    start = param.pos_in_path;
+  }
+  parts.push_back(api.get_path().substr(start));
+  return parts;
+}
+
+// A bound on the text of a path param, used to presize the URLs built by
+// generated clients. Strings count as their length at run time, so 0.
+inline std::size_t path_param_size(const Type* type) {
+  if (type->is_enum()) {
+    std::size_t longest = 0;
+    for (const auto& field :
+         dynamic_cast<const EnumType*>(type)->get_fields()) {
+      longest = std::max(longest, field.get_name().size());
+    }
+    return longest;
+  }
+  auto primitive = dynamic_cast<const PrimitiveType*>(type);
+  if (primitive->is_string()) {
+    return 0;
+  } else if (primitive->is_bool()) {
+    return 5;
+  } else if (primitive->is_i32() || primitive->is_u32()) {
+    return 11;
+  } else if (primitive->is_i64() || primitive->is_u64()) {
+    return 20;
+  }
+  return 24;
+}
+
+// The name of an api in generated servers and clients: its HTTP method,
+// then the words of its path with each param spelled By<Param>.
+inline std::string api_method_name(const Api& api) {
+  std::string method = http_method_to_string(api.get_http_method());
+  std::transform(method.begin() + 1, method.end(), method.begin() + 1,
+                 [](unsigned char c) { return std::tolower(c); });
+  auto name = method;
+  auto parts = route_parts(api);
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    auto upper = true;
+    for (unsigned char c : parts[i]) {
+      if (!std::isalnum(c)) {
+        upper = true;
+      } else {
+        name.push_back(upper ? static_cast<char>(std::toupper(c))
+                             : static_cast<char>(c));
+        upper = false;
+      }
+    }
+    if (i + 1 < parts.size()) {
+      name += "By" + capitalize(camelcase(
+                         api.get_path_params()[i].field.get_name()));
+    }
+  }
+  return name;
+}
+
+// The names of the apis of a group, numbered where paths only differ in
+// punctuation.
+inline std::vector<std::string> api_method_names(const ApiGroup& api_group) {
+  std::vector<std::string> names;
+  for (const auto& api : api_group.get_apis()) {
+    auto name = api_method_name(api);
+    auto unique = name;
+    for (int n = 2;
+         std::find(names.begin(), names.end(), unique) != names.end(); ++n) {
+      unique = name + std::to_string(n);
+    }
+    names.push_back(unique);
+  }
+  return names;
+}
+
+// Adds the route to the tree under node, `text` is what is left of
+// parts[part].
+inline void insert_route(RouteNode* node,
+                         const std::vector<std::string>& parts,
+                         std::size_t part, std::string text,
+                         std::size_t route) {
+  while (!text.empty()) {
+    auto child = std::find_if(
+        node->children.begin(), node->children.end(),
+        [&](const RouteNode& c) { return c.prefix[0] == text[0]; });
+    if (child == node->children.end()) {
+      node->children.push_back(RouteNode{text, {}, nullptr, {}});
+      node = &node->children.back();
+      break;
+    }
+    std::size_t common = 1;
+    while (common < child->prefix.size() && common < text.size() &&
+           child->prefix[common] == text[common]) {
+      ++common;
+    }
+    if (common < child->prefix.size()) {
+      RouteNode rest{child->prefix.substr(common), std::move(child->children),
+                     std::move(child->param), std::move(child->routes)};
+      child->prefix.resize(common);
+      child->children.clear();
+      child->routes.clear();
+      child->children.push_back(std::move(rest));
+    }
+    node = &*child;
+    text.erase(0, common);
+  }
+  if (part + 1 == parts.size()) {
+    node->routes.push_back(route);
+    return;
+  }
+  if (!node->param) {
+    node->param = std::make_unique<RouteNode>();
+  }
+  insert_route(node->param.get(), parts, part + 1, parts[part + 1], route);
+}
+
+inline RouteNode build_route_tree(const ApiGroup& api_group) {
+  RouteNode root;
+  const auto& apis = api_group.get_apis();
+  for (std::size_t i = 0; i < apis.size(); ++i) {
+    auto parts = route_parts(apis[i]);
+    insert_route(&root, parts, 0, parts[0], i);
+  }
+  return root;
+}
+
+}  // namespace toolman::generator
+
+#endif  // TOOLMAN_ROUTE_TREE_H_
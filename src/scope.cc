@@ -15,5 +15,70 @@ void decl_buildin_option(OptionScope* option_scope) {
   option_scope->declare(
       std::make_shared<std::remove_const_t<decltype(option_java_package)>>(
           option_java_package));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_package)>>(
+          option_go_package));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_cpp_namespace)>>(
+          option_cpp_namespace));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_json_codec)>>(
+          option_go_json_codec));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_java_json_codec)>>(
+          option_java_json_codec));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_ts_decoders)>>(
+          option_ts_decoders));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_binary_codec)>>(
+          option_binary_codec));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_binary_views)>>(
+          option_binary_views));
+  option_scope->declare(
+      std::make_shared<
+          std::remove_const_t<decltype(option_java_primitive_lists)>>(
+          option_java_primitive_lists));
+  option_scope->declare(
+      std::make_shared<
+          std::remove_const_t<decltype(option_java_presence_bits)>>(
+          option_java_presence_bits));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_presence_bits)>>(
+          option_go_presence_bits));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_packed_layout)>>(
+          option_go_packed_layout));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_object_pool)>>(
+          option_go_object_pool));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_inline_oneof)>>(
+          option_go_inline_oneof));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_ts_classes)>>(
+          option_ts_classes));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_ts_typed_arrays)>>(
+          option_ts_typed_arrays));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_http_server)>>(
+          option_go_http_server));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_http_client)>>(
+          option_http_client));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_deep_copy)>>(
+          option_deep_copy));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_go_field_masks)>>(
+          option_go_field_masks));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_json_streams)>>(
+          option_json_streams));
+  option_scope->declare(
+      std::make_shared<std::remove_const_t<decltype(option_cpp_arena)>>(
+          option_cpp_arena));
 }
 }  // namespace toolman::buildin
@@ -5,10 +5,12 @@
 #ifndef TOOLMAN_SCOPE_H_
 #define TOOLMAN_SCOPE_H_
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "src/option.h"
 #include "src/type.h"
@@ -21,15 +23,53 @@ class Scope {
   typedef typename std::map<std::string, std::shared_ptr<T>>::const_iterator
       const_iterator;
 
-  // Lookup returns the `T` with the given name if it is
-  // found in this scope, otherwise it returns std::nullopt.
-  std::optional<std::shared_ptr<T>> lookup(const std::string& name) {
+  // Lookup returns the `T` with the given name if it is found in this
+  // scope or, failing that, in one of the chained scopes, otherwise it
+  // returns std::nullopt. Entries of this scope shadow chained ones and
+  // earlier chained scopes shadow later ones.
+  std::optional<std::shared_ptr<T>> lookup(const std::string& name) const {
+    std::vector<const Scope*> visited;
+    return lookup(name, &visited);
+  }
+
+  // Lookup only among the entries declared directly in this scope.
+  std::optional<std::shared_ptr<T>> lookup_local(
+      const std::string& name) const {
     if (const auto it = data_.find(name); data_.end() != it) {
       return {it->second};
     }
     return std::nullopt;
   }
 
+  // Returns every distinct `T` that the chained scopes provide for `name`.
+  // More than one result means the name is ambiguous unless this scope
+  // shadows it.
+  std::vector<std::shared_ptr<T>> lookup_chained(
+      const std::string& name) const {
+    std::vector<std::shared_ptr<T>> found_items;
+    std::vector<const Scope*> visited{this};
+    for (const auto& parent : parents_) {
+      if (auto found = parent->lookup(name, &visited);
+          found.has_value() &&
+          std::find(found_items.begin(), found_items.end(), found.value()) ==
+              found_items.end()) {
+        found_items.push_back(found.value());
+      }
+    }
+    return found_items;
+  }
+
+  // Chain `parent` behind this scope, its names become visible through
+  // `lookup` without being copied. Chaining is O(1) and resolution is
+  // deferred until a name is looked up.
+  void chain(std::shared_ptr<const Scope> parent) {
+    if (parent.get() != this &&
+        std::find(parents_.begin(), parents_.end(), parent) ==
+            parents_.end()) {
+      parents_.push_back(std::move(parent));
+    }
+  }
+
   // Declare a `T` into the scope.
   // If the scope did not have this scope present, `true` is returned.
   // If the map did have this key present, the value is updated,
@@ -51,8 +91,30 @@ class Scope {
   [[nodiscard]] const_iterator cend() const { return data_.cend(); }
 
  private:
+  // Modules may `import *` each other, so the chain can have cycles. Every
+  // scope is searched at most once per lookup, `visited` holds the ones
+  // already searched.
+  std::optional<std::shared_ptr<T>> lookup(
+      const std::string& name, std::vector<const Scope*>* visited) const {
+    if (std::find(visited->begin(), visited->end(), this) != visited->end()) {
+      return std::nullopt;
+    }
+    visited->push_back(this);
+    if (auto local = lookup_local(name); local.has_value()) {
+      return local;
+    }
+    for (const auto& parent : parents_) {
+      if (auto found = parent->lookup(name, visited); found.has_value()) {
+        return found;
+      }
+    }
+    return std::nullopt;
+  }
+
   // Map of names to `T`
   std::map<std::string, std::shared_ptr<T>> data_;
+  // Scopes imported with `import *`, in import order.
+  std::vector<std::shared_ptr<const Scope>> parents_;
 };
 
 class TypeScope final : public Scope<Type> {};
@@ -62,6 +124,47 @@ class OptionScope final : public Scope<Option> {};
 namespace buildin {
 const auto option_use_java8_optional = BoolOption("use_java8_optional");
 const auto option_java_package = StringOption("java_package");
+const auto option_go_package = StringOption("go_package");
+// Namespace of the generated C++ code, such as `acme::shapes`.
+const auto option_cpp_namespace = StringOption("cpp_namespace");
+// Generate reflection-free MarshalJSON/UnmarshalJSON methods for Go structs.
+const auto option_go_json_codec = BoolOption("go_json_codec");
+// Generate reflection-free writeTo/parseFrom JSON methods for Java classes.
+const auto option_java_json_codec = BoolOption("java_json_codec");
+// Generate decodeX/isX functions that check untrusted JSON against the types.
+const auto option_ts_decoders = BoolOption("ts_decoders");
+// Generate codecs for the binary wire format described in src/wire_format.h.
+const auto option_binary_codec = BoolOption("binary_codec");
+// Generate read-only views that read fields straight out of binary messages.
+const auto option_binary_views = BoolOption("binary_views");
+// Store Java lists of i32, u32, i64, u64 and float as int[], long[], float[].
+const auto option_java_primitive_lists = BoolOption("java_primitive_lists");
+// Store optional Java primitives unboxed, tracking presence in a bitmask.
+const auto option_java_presence_bits = BoolOption("java_presence_bits");
+// Store optional Go scalars as values, tracking presence in a bitmask.
+const auto option_go_presence_bits = BoolOption("go_presence_bits");
+// Order Go struct fields by alignment so that they need the least padding.
+const auto option_go_packed_layout = BoolOption("go_packed_layout");
+// Generate sync.Pool backed AcquireX/ReleaseX functions for Go structs.
+const auto option_go_object_pool = BoolOption("go_object_pool");
+// Store Go oneofs inline behind a discriminant instead of in an interface.
+const auto option_go_inline_oneof = BoolOption("go_inline_oneof");
+// Generate TypeScript classes that give every instance the same shape.
+const auto option_ts_classes = BoolOption("ts_classes");
+// Store TypeScript lists of numbers in Int32Array, Uint32Array, Float64Array.
+const auto option_ts_typed_arrays = BoolOption("ts_typed_arrays");
+// Generate net/http handler interfaces and routers for Go api groups.
+const auto option_go_http_server = BoolOption("go_http_server");
+// Generate HTTP clients for api groups, with bodies in the JSON codecs.
+const auto option_http_client = BoolOption("http_client");
+// Generate reflection-free deep copies: DeepCopy in Go, copyFrom in Java.
+const auto option_deep_copy = BoolOption("deep_copy");
+// Generate Go field masks and JSON encoders that only write what they select.
+const auto option_go_field_masks = BoolOption("go_field_masks");
+// Generate JSON decoders that read from a stream and pass list elements on.
+const auto option_json_streams = BoolOption("json_streams");
+// Generate C++ types that allocate from the std::pmr resource they are given.
+const auto option_cpp_arena = BoolOption("cpp_arena");
 
 void decl_buildin_option(OptionScope* option_scope);
 }  // namespace buildin
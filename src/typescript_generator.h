@@ -5,7 +5,10 @@
 #ifndef TOOLMAN_TYPESCRIPT_GENERATOR_H_
 #define TOOLMAN_TYPESCRIPT_GENERATOR_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -14,11 +17,107 @@
 #include "src/list_type.h"
 #include "src/map_type.h"
 #include "src/primitive_type.h"
+#include "src/route_tree.h"
+#include "src/scope.h"
 #include "src/type.h"
+#include "src/typescript_runtime.h"
+#include "src/validation.h"
+#include "src/wire_format.h"
 
 namespace toolman::generator {
 class TypescriptGenerator : public Generator {
  protected:
+  void before_generate_document(std::ostream& ostream,
+                                const Document* document) override {
+    for (const auto& opt : document->get_options()) {
+      if (opt->get_name() == buildin::option_ts_decoders.get_name()) {
+        decoders_ = std::dynamic_pointer_cast<decltype(
+                        buildin::option_ts_decoders)>(opt)
+                        ->get_value();
+      } else if (opt->get_name() == buildin::option_binary_codec.get_name()) {
+        binary_codec_ = std::dynamic_pointer_cast<decltype(
+                            buildin::option_binary_codec)>(opt)
+                            ->get_value();
+      } else if (opt->get_name() == buildin::option_binary_views.get_name()) {
+        binary_views_ = std::dynamic_pointer_cast<decltype(
+                            buildin::option_binary_views)>(opt)
+                            ->get_value();
+      } else if (opt->get_name() == buildin::option_ts_classes.get_name()) {
+        classes_ = std::dynamic_pointer_cast<decltype(
+                       buildin::option_ts_classes)>(opt)
+                       ->get_value();
+      } else if (opt->get_name() ==
+                 buildin::option_ts_typed_arrays.get_name()) {
+        typed_arrays_ = std::dynamic_pointer_cast<decltype(
+                            buildin::option_ts_typed_arrays)>(opt)
+                            ->get_value();
+      } else if (opt->get_name() == buildin::option_http_client.get_name()) {
+        http_client_ = std::dynamic_pointer_cast<decltype(
+                           buildin::option_http_client)>(opt)
+                           ->get_value();
+      } else if (opt->get_name() == buildin::option_json_streams.get_name()) {
+        streams_ = std::dynamic_pointer_cast<decltype(
+                       buildin::option_json_streams)>(opt)
+                       ->get_value();
+      }
+    }
+    http_client_ = http_client_ && !document->get_api_groups().empty();
+    decoders_ = decoders_ || http_client_ || streams_;
+    // Constraints are checked by the decoders, along with the types.
+    for (const auto& struct_type : document->get_struct_types()) {
+      validation_ =
+          validation_ || (decoders_ && needs_validation(struct_type.get()));
+    }
+  }
+
+  void after_generate_document(std::ostream& ostream,
+                               const Document* document) override {
+    if (http_client_) {
+      for (const auto& api_group : document->get_api_groups()) {
+        generate_http_client(ostream, api_group);
+      }
+    }
+    if (decoders_) {
+      ostream << typescript_runtime::kDecode;
+    }
+    if (streams_) {
+      ostream << typescript_runtime::kStream;
+    }
+    if (validation_) {
+      ostream << typescript_runtime::kValidation;
+    }
+    if (binary_codec_ || binary_views_) {
+      ostream << typescript_runtime::kBinary;
+    }
+    if (classes_) {
+      ostream << typescript_runtime::kClasses;
+    }
+    if (typed_arrays_) {
+      ostream << typescript_runtime::kTypedArrays;
+    }
+    if (http_client_) {
+      ostream << typescript_runtime::kHttpClient;
+    }
+  }
+
+  void after_generate_struct(std::ostream& ostream,
+                             const Document* document) override {
+    for (const auto& struct_type : document->get_struct_types()) {
+      if (decoders_) {
+        generate_decoder(ostream, struct_type.get());
+      }
+      if (streams_) {
+        generate_streams(ostream, struct_type.get());
+      }
+      if (binary_codec_) {
+        generate_binary_codec(ostream, struct_type.get());
+      }
+      if (binary_views_) {
+        generate_binary_view(ostream, struct_type.get());
+      }
+    }
+  }
+
   void after_generate_enum(std::ostream& ostream,
                            const Document* document) override {
     ostream << NL;
@@ -32,6 +131,10 @@ class TypescriptGenerator : public Generator {
   void generate_struct(
       std::ostream& ostream,
       const std::shared_ptr<StructType>& struct_type) override {
+    if (classes_) {
+      generate_class(ostream, struct_type.get());
+      return;
+    }
     ostream << "export interface " << struct_type->get_name() << " {" << NL;
     for (const auto& field : struct_type->get_fields()) {
       generate_doc_comment(ostream, field.get_comments(), INDENT_1);
@@ -50,6 +153,16 @@ class TypescriptGenerator : public Generator {
               << NL;
     }
     ostream << "}" << NL;
+    // Contiguous values are checked with a range test, see generate_check.
+    if (decoders_ && !enum_type->is_contiguous()) {
+      std::string values;
+      for (const auto& field : enum_type->get_fields()) {
+        values += (values.empty() ? "" : ", ") +
+                  std::to_string(field.get_value());
+      }
+      ostream << "const tm" << enum_type->get_name()
+              << "Values = new Set<unknown>([" << values << "]);" << NL;
+    }
   }
 
  private:
@@ -66,30 +179,1181 @@ class TypescriptGenerator : public Generator {
     ostream << indent << "*/" << NL;
   }
 
-  void generate_field(std::ostream& ostream, const Field* field) const {
+  // A class whose constructor assigns every field, optional ones included,
+  // in declaration order, so all instances share one hidden class in V8.
+  // XInit is the plain object shape the constructor and X.from() copy from,
+  // nested structs included; x.clone() is a deep copy.
+  void generate_class(std::ostream& ostream, const StructType* struct_type) {
+    const auto& name = struct_type->get_name();
+    auto fields = struct_type->get_fields();
+    ostream << "export interface " << name << "Init {" << NL;
+    for (const auto& field : fields) {
+      ostream << INDENT_1 << field.get_name()
+              << (field.is_optional() || field.get_type()->is_oneof() ? "?"
+                                                                      : "")
+              << ": ";
+      generate_field_type(ostream, &field, "Init");
+      ostream << ";" << NL;
+    }
+    ostream << "}" << NL2 << "export class " << name << " {" << NL;
+    for (const auto& field : fields) {
+      generate_doc_comment(ostream, field.get_comments(), INDENT_1);
+      ostream << INDENT_1 << field.get_name() << ": ";
+      generate_field_type(ostream, &field, "");
+      ostream << (field.is_optional() || field.get_type()->is_oneof()
+                      ? " | undefined"
+                      : "")
+              << ";" << NL;
+    }
+    ostream << NL << INDENT_1 << "constructor(init?: " << name << "Init) {"
+            << NL;
+    if (!fields.empty()) {
+      ostream << INDENT_2 << "if (init === undefined) {" << NL;
+      for (const auto& field : fields) {
+        ostream << INDENT_3 << "this." << field.get_name() << " = "
+                << class_zero_value(field) << ";" << NL;
+      }
+      ostream << INDENT_2 << "} else {" << NL;
+      for (const auto& field : fields) {
+        auto type = field.get_type().get();
+        auto expr = "init." + field.get_name();
+        auto copy = copy_value(type, expr, 1);
+        ostream << INDENT_3 << "this." << field.get_name() << " = ";
+        if (field.is_optional() || type->is_oneof()) {
+          ostream << expr << " === undefined || " << expr
+                  << " === null ? undefined : " << copy;
+        } else {
+          ostream << copy;
+        }
+        ostream << ";" << NL;
+      }
+      ostream << INDENT_2 << "}" << NL;
+    }
+    ostream << INDENT_1 << "}" << NL2 << INDENT_1 << "static from(init: "
+            << name << "Init): " << name << " {" << NL << INDENT_2
+            << "return new " << name << "(init);" << NL << INDENT_1 << "}"
+            << NL2 << INDENT_1 << "clone(): " << name << " {" << NL << INDENT_2
+            << "return new " << name << "(this);" << NL << INDENT_1 << "}"
+            << NL << "}" << NL;
+  }
+
+  // Returns what the constructor of a class starts `field` out as.
+  std::string class_zero_value(const Field& field) const {
+    auto type = field.get_type().get();
+    if (field.is_optional() || type->is_oneof()) {
+      return "undefined";
+    } else if (type->is_struct()) {
+      return "new " + type->get_name() + "()";
+    }
+    return binary_zero_value(field);
+  }
+
+  // Returns an expression for a deep copy of `expr`, with the structs in it
+  // turned into class instances. `depth` keeps parameter names unique.
+  std::string copy_value(const Type* type, const std::string& expr,
+                         int depth) const {
+    auto d = std::to_string(depth);
+    if (type->is_struct()) {
+      return type->get_name() + ".from(" + expr + ")";
+    } else if (!typed_array_of(type).empty()) {
+      return typed_array_of(type) + ".from(" + expr + ")";
+    } else if (type->is_list()) {
+      auto elem = dynamic_cast<const ListType*>(type)->get_elem_type().get();
+      if (elem->is_struct()) {
+        return "(" + expr + " as any[]).map(" + elem->get_name() + ".from)";
+      } else if (elem->is_primitive() || elem->is_enum()) {
+        return "(" + expr + " as any[]).slice()";
+      }
+      return "(" + expr + " as any[]).map((e" + d + ": any) => " +
+             copy_value(elem, "e" + d, depth + 1) + ")";
+    } else if (type->is_map()) {
+      auto value = dynamic_cast<const MapType*>(type)->get_value_type().get();
+      if (value->is_primitive() || value->is_enum()) {
+        return "Object.assign({}, " + expr + ")";
+      }
+      return "tmCopyMap(" + expr + ", (v" + d + ": any) => " +
+             copy_value(value, "v" + d, depth + 1) + ")";
+    } else if (type->is_oneof()) {
+      // The alternative that is set, copied into a new object.
+      auto o = "(" + expr + " as any)";
+      std::string copy;
+      for (const auto& oneof_field : dynamic_cast<const OneofType*>(type)
+                                         ->get_fields()) {
+        auto alt = o + "." + oneof_field.get_name();
+        copy += alt + " !== undefined ? { " + oneof_field.get_name() + ": " +
+                copy_value(oneof_field.get_type().get(), alt, depth) +
+                " } : ";
+      }
+      return copy + "undefined";
+    }
+    return expr;
+  }
+
+  // A client method builds its URL with one concatenation of the parts of
+  // the path, as split at code generation time, and the params between
+  // them. Response bodies go through the generated decoders.
+  void generate_http_client(std::ostream& ostream, const ApiGroup& api_group) {
+    auto group = capitalize(api_group.get_group_name());
+    const auto& apis = api_group.get_apis();
+    auto names = api_method_names(api_group);
+
+    for (const auto& api : apis) {
+      for (const auto& api_return : api.get_returns()) {
+        auto type = api_return.resp_.get();
+        if (type != nullptr && type->is_enum() &&
+            enum_decoders_.insert(type->get_name()).second) {
+          generate_enum_decoder(ostream, type);
+        }
+      }
+    }
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      ostream << NL << "export type " << group << names[i] << "Response ="
+              << NL;
+      for (const auto& api_return : apis[i].get_returns()) {
+        ostream << INDENT_1 << "| { status: " << api_return.http_status_code_;
+        if (api_return.resp_ != nullptr) {
+          ostream << "; body: " << type_to_ts_type(api_return.resp_.get());
+        }
+        ostream << " }" << NL;
+      }
+      ostream << INDENT_1 << ";" << NL;
+    }
+
+    ostream << NL << "export class " << group << "Client {" << NL << INDENT_1
+            << "private readonly baseUrl: string;" << NL2 << INDENT_1
+            << "constructor(" << NL << INDENT_2 << "baseUrl: string," << NL
+            << INDENT_2
+            << "private readonly fetchFn: (url: string, init: RequestInit) "
+               "=> Promise<Response> ="
+            << NL << INDENT_3 << "(url, init) => fetch(url, init)," << NL
+            << INDENT_1 << ") {" << NL << INDENT_2
+            << "this.baseUrl = baseUrl.endsWith(\"/\") ? "
+               "baseUrl.slice(0, -1) : baseUrl;"
+            << NL << INDENT_1 << "}" << NL;
+
+    for (std::size_t i = 0; i < apis.size(); ++i) {
+      const auto& api = apis[i];
+      const auto& params = api.get_path_params();
+      auto parts = route_parts(api);
+      auto body_type = api.get_body_param().get();
+
+      // fetch refuses to send a body with GET and HEAD requests.
+      auto has_body = api.get_http_method() != Api::HttpMethod::GET &&
+                      api.get_http_method() != Api::HttpMethod::HEAD;
+      std::string args;
+      for (const auto& param : params) {
+        args += (args.empty() ? "" : ", ") + http_param_name(param.field) +
+                ": " + type_to_ts_type(param.field.get_type().get());
+      }
+      if (has_body) {
+        args += (args.empty() ? "body?: " : ", body?: ") +
+                type_to_ts_type(body_type);
+      }
+      ostream << NL << INDENT_1 << "async " << decapitalize(names[i]) << "("
+              << args << "): Promise<" << group << names[i] << "Response> {"
+              << NL << INDENT_2 << "const url = this.baseUrl";
+      for (std::size_t j = 0; j < parts.size(); ++j) {
+        if (!parts[j].empty()) {
+          ostream << " + \"" << parts[j] << "\"";
+        }
+        if (j == params.size()) {
+          break;
+        }
+        auto name = http_param_name(params[j].field);
+        auto type = params[j].field.get_type().get();
+        if (type->is_enum()) {
+          ostream << " + " << type->get_name() << "[" << name << "]";
+        } else if (dynamic_cast<const PrimitiveType*>(type)->is_string()) {
+          ostream << " + encodeURIComponent(" << name << ")";
+        } else {
+          ostream << " + " << name;
+        }
+      }
+      ostream << ";" << NL;
+      if (has_body) {
+        ostream << INDENT_2
+                << "const json = body === undefined ? undefined : "
+                   "JSON.stringify(body"
+                << (typed_arrays_ ? ", toolmanJSONReplacer" : "") << ");"
+                << NL;
+      }
+      ostream << INDENT_2 << "const res = await this.fetchFn(url, tmRequest(\""
+              << http_method_to_string(api.get_http_method()) << "\", "
+              << (has_body ? "json" : "undefined") << "));" << NL << INDENT_2
+              << "switch (res.status) {" << NL;
+      for (const auto& api_return : api.get_returns()) {
+        auto status = std::to_string(api_return.http_status_code_);
+        ostream << INDENT_3 << "case " << status << ":" << NL << INDENT_4
+                << "return { status: " << status;
+        if (api_return.resp_ != nullptr) {
+          ostream << ", body: decode" << api_return.resp_->get_name()
+                  << "(await res.json())";
+        }
+        ostream << " };" << NL;
+      }
+      ostream << INDENT_3 << "default:" << NL << INDENT_4
+              << "throw new ToolmanHttpError(res.status, await res.text());"
+              << NL << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL;
+    }
+    ostream << "}" << NL;
+  }
+
+  // Enums returned by apis get a decoder like the one of structs.
+  void generate_enum_decoder(std::ostream& ostream, Type* type) {
+    const auto& name = type->get_name();
+    tmp_ = 0;
+    ostream << NL << "export function decode" << name
+            << "(json: unknown): " << name << " {" << NL << INDENT_1
+            << "const failure = check" << name << "(json);" << NL << INDENT_1
+            << "if (failure !== undefined) {" << NL << INDENT_2
+            << "tmThrow(failure);" << NL << INDENT_1 << "}" << NL << INDENT_1
+            << "return json as " << name << ";" << NL << "}" << NL2
+            << "function check" << name << "(v: any): TmFailure | undefined {"
+            << NL;
+    generate_check(ostream, type, "v", "\"\"", INDENT_1);
+    ostream << INDENT_1 << "return undefined;" << NL << "}" << NL;
+  }
+
+  // Parameter names of client methods, renamed where they would clash with
+  // the names the generated code uses.
+  static std::string http_param_name(const Field& field) {
+    static const std::set<std::string> taken = {"body", "json", "res", "url"};
+    auto name = field.get_name();
+    if (taken.count(name) != 0) {
+      name += "_";
+    }
+    return name;
+  }
+
+  // Decoders are straight-line checks generated per struct rather than a
+  // schema walked at runtime. decodeX() returns its argument typed as X
+  // once it has been checked and isX() is the matching type guard. Optional
+  // fields may be missing or null, like the other targets encode them.
+  void generate_decoder(std::ostream& ostream, const StructType* struct_type) {
+    const auto& name = struct_type->get_name();
+    // Classes copy the JSON into typed arrays themselves.
+    auto convert = !classes_ && has_typed_arrays(struct_type);
+    ostream << NL << "export function decode" << name
+            << "(json: unknown): " << name << " {" << NL << INDENT_1
+            << "const failure = check" << name << "(json);" << NL << INDENT_1
+            << "if (failure !== undefined) {" << NL << INDENT_2
+            << (needs_validation(struct_type) ? "tmReject" : "tmThrow")
+            << "(failure);" << NL << INDENT_1 << "}" << NL;
+    if (convert) {
+      ostream << INDENT_1 << "typed" << name << "(json);" << NL;
+    }
+    ostream << INDENT_1 << "return "
+            << (classes_ ? name + ".from(json as " + name + "Init)"
+                         : "json as " + name)
+            << ";" << NL << "}" << NL2 << "export function is" << name
+            << "(json: unknown): "
+            << (convert ? "boolean"
+                        : "json is " + name + (classes_ ? "Init" : ""))
+            << " {" << NL << INDENT_1 << "return check" << name
+            << "(json) === undefined;" << NL << "}" << NL2;
+
+    for (const auto& field : struct_type->get_fields()) {
+      if (const auto& pattern = field.get_constraints().pattern; pattern) {
+        ostream << "const " << pattern_name(struct_type, field)
+                << " = new RegExp(" << quote_literal(*pattern) << ", \"u\");"
+                << NL2;
+      }
+    }
+    tmp_ = 0;
+    ostream << "function check" << name
+            << "(v: any): TmFailure | undefined {" << NL << INDENT_1
+            << "if (!tmIsObject(v)) {" << NL << INDENT_2
+            << "return tmFail(\"\", \"" << name << "\", v);" << NL << INDENT_1
+            << "}" << NL;
+    for (const auto& field : struct_type->get_fields()) {
+      generate_field_check(ostream, struct_type, field, "v", "\"\"",
+                           INDENT_1);
+    }
+    ostream << INDENT_1 << "return undefined;" << NL << "}" << NL2;
+
+    if (convert) {
+      ostream << "// Replaces the number arrays of a checked " << name
+              << " with typed arrays, in place." << NL << "function typed"
+              << name << "(v: any): void {" << NL;
+      for (const auto& field : struct_type->get_fields()) {
+        auto type = field.get_type().get();
+        if (!has_typed_arrays(type)) {
+          continue;
+        }
+        auto expr = "v." + field.get_name();
+        if (field.is_optional()) {
+          ostream << INDENT_1 << "if (" << expr << " !== undefined && "
+                  << expr << " !== null) {" << NL;
+          generate_typed_conversion(ostream, type, expr, INDENT_2);
+          ostream << INDENT_1 << "}" << NL;
+        } else {
+          generate_typed_conversion(ostream, type, expr, INDENT_1);
+        }
+      }
+      ostream << "}" << NL2;
+    }
+  }
+
+  // A stream decoder is an async generator per list of a struct. It reads
+  // the struct from chunks of JSON text, checks and yields the elements of
+  // the list one at a time, then checks the rest of the struct and returns
+  // it with the list empty. Only one element is parsed at a time.
+  void generate_streams(std::ostream& ostream,
+                        const StructType* struct_type) {
+    const auto& name = struct_type->get_name();
+    auto fields = struct_type->get_fields();
+    for (const auto& list_field : fields) {
+      if (!list_field.get_type()->is_list()) {
+        continue;
+      }
+      auto elem_type =
+          dynamic_cast<const ListType*>(list_field.get_type().get())
+              ->get_elem_type()
+              .get();
+      auto stream_name = name + capitalize(list_field.get_name());
+      tmp_ = 0;
+      ostream << "function check" << stream_name
+              << "Element(e: any, i: number): TmFailure | undefined {" << NL;
+      generate_check(ostream, elem_type, "e",
+                     "\"." + list_field.get_name() + "[\" + i + \"]\"",
+                     INDENT_1);
+      ostream << INDENT_1 << "return undefined;" << NL << "}" << NL2;
+      tmp_ = 0;
+      ostream << "function check" << stream_name
+              << "Rest(v: any): TmFailure | undefined {" << NL;
+      for (const auto& field : fields) {
+        if (field.get_name() != list_field.get_name()) {
+          generate_field_check(ostream, struct_type, field, "v", "\"\"",
+                               INDENT_1);
+        }
+      }
+      ostream << INDENT_1 << "return undefined;" << NL << "}" << NL2;
+
+      auto elem_ts_type = type_to_ts_type(elem_type);
+      ostream << "// Yields the checked elements of " << name << "."
+              << list_field.get_name() << " as they are read from source,"
+              << NL << "// then returns the rest of the " << name
+              << ", with the list empty." << NL
+              << "export async function* stream" << stream_name
+              << "(source: AsyncIterable<Uint8Array | string>): "
+                 "AsyncGenerator<"
+              << elem_ts_type << ", " << name << ", undefined> {" << NL
+              << INDENT_1 << "const s = new TmJSONStream(source);" << NL
+              << INDENT_1 << "if (!await s.begin(\"{\")) {" << NL << INDENT_2
+              << "tmThrow(tmFail(\"\", \"" << name
+              << "\", JSON.parse(await s.value())));" << NL << INDENT_1 << "}"
+              << NL << INDENT_1 << "const rest: string[] = [];" << NL
+              << INDENT_1 << "for (let i = 0; await s.more(\"}\", i); i++) {"
+              << NL << INDENT_2 << "const key = await s.key();" << NL
+              << INDENT_2 << "if (key !== \"" << list_field.get_name()
+              << "\") {" << NL << INDENT_3
+              << "rest.push(JSON.stringify(key) + \":\" + await s.value());"
+              << NL << INDENT_2 << "} else if (await s.begin(\"[\")) {" << NL
+              << INDENT_3 << "for (let j = 0; await s.more(\"]\", j); j++) {"
+              << NL << INDENT_4
+              << (has_typed_arrays(elem_type) ? "let" : "const")
+              << " e = JSON.parse(await s.value());" << NL << INDENT_4
+              << "const failure = check" << stream_name
+              << "Element(e, j);" << NL << INDENT_4
+              << "if (failure !== undefined) {" << NL << INDENT_4 << INDENT_1
+              << (needs_validation(elem_type) ? "tmReject" : "tmThrow")
+              << "(failure);" << NL << INDENT_4 << "}" << NL;
+      if (classes_) {
+        ostream << INDENT_4 << "yield " << copy_value(elem_type, "e", 1)
+                << ";" << NL;
+      } else {
+        if (has_typed_arrays(elem_type)) {
+          generate_typed_conversion(ostream, elem_type, "e", INDENT_4);
+        }
+        ostream << INDENT_4 << "yield e;" << NL;
+      }
+      auto not_list = "tmThrow(tmFail(\"." + list_field.get_name() +
+                      "\", \"list\", e));";
+      ostream << INDENT_3 << "}" << NL << INDENT_2 << "} else {" << NL
+              << INDENT_3 << "const e = JSON.parse(await s.value());" << NL;
+      if (list_field.is_optional()) {
+        ostream << INDENT_3 << "if (e !== null) {" << NL << INDENT_4
+                << not_list << NL << INDENT_3 << "}" << NL;
+      } else {
+        ostream << INDENT_3 << not_list << NL;
+      }
+      ostream << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL << INDENT_1
+              << "await s.end();" << NL << INDENT_1
+              << "const v = JSON.parse(\"{\" + rest.join(\",\") + \"}\");"
+              << NL << INDENT_1 << "const failure = check" << stream_name
+              << "Rest(v);" << NL << INDENT_1 << "if (failure !== undefined) {"
+              << NL << INDENT_2
+              << (needs_validation(struct_type) ? "tmReject" : "tmThrow")
+              << "(failure);" << NL << INDENT_1 << "}" << NL;
+      if (!list_field.is_optional()) {
+        ostream << INDENT_1 << "v." << list_field.get_name() << " = [];"
+                << NL;
+      }
+      if (!classes_ && has_typed_arrays(struct_type)) {
+        ostream << INDENT_1 << "typed" << name << "(v);" << NL;
+      }
+      ostream << INDENT_1 << "return "
+              << (classes_ ? name + ".from(v as " + name + "Init)"
+                           : "v as " + name)
+              << ";" << NL << "}" << NL2;
+    }
+  }
+
+  // Whether values of `type` hold lists that ts_typed_arrays maps to typed
+  // arrays. `visiting` breaks cycles through recursive structs.
+  bool has_typed_arrays(const Type* type,
+                        std::set<std::string>* visiting = nullptr) const {
+    if (!typed_arrays_) {
+      return false;
+    }
+    if (!typed_array_of(type).empty()) {
+      return true;
+    } else if (type->is_list()) {
+      return has_typed_arrays(
+          dynamic_cast<const ListType*>(type)->get_elem_type().get(),
+          visiting);
+    } else if (type->is_map()) {
+      return has_typed_arrays(
+          dynamic_cast<const MapType*>(type)->get_value_type().get(),
+          visiting);
+    }
+    std::vector<Field> fields;
+    if (type->is_struct()) {
+      std::set<std::string> visited;
+      if (visiting == nullptr) {
+        visiting = &visited;
+      }
+      if (!visiting->insert(type->get_name()).second) {
+        return false;
+      }
+      fields = dynamic_cast<const StructType*>(type)->get_fields();
+    } else if (type->is_oneof()) {
+      fields = dynamic_cast<const OneofType*>(type)->get_fields();
+    }
+    for (const auto& field : fields) {
+      if (has_typed_arrays(field.get_type().get(), visiting)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Emits statements that turn the number arrays in the checked JSON value
+  // `target` of `type` into typed arrays.
+  void generate_typed_conversion(std::ostream& ostream, const Type* type,
+                                 const std::string& target,
+                                 const std::string& indent) {
+    auto n = std::to_string(++tmp_);
+    if (auto typed_array = typed_array_of(type); !typed_array.empty()) {
+      ostream << indent << target << " = " << typed_array << ".from("
+              << target << ");" << NL;
+    } else if (type->is_struct()) {
+      ostream << indent << "typed" << type->get_name() << "(" << target
+              << ");" << NL;
+    } else if (type->is_list()) {
+      ostream << indent << "for (let i" << n << " = 0; i" << n << " < "
+              << target << ".length; i" << n << "++) {" << NL;
+      generate_typed_conversion(
+          ostream, dynamic_cast<const ListType*>(type)->get_elem_type().get(),
+          target + "[i" + n + "]", indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      ostream << indent << "for (const k" << n << " in " << target << ") {"
+              << NL;
+      generate_typed_conversion(
+          ostream, dynamic_cast<const MapType*>(type)->get_value_type().get(),
+          target + "[k" + n + "]", indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      for (const auto& oneof_field :
+           dynamic_cast<const OneofType*>(type)->get_fields()) {
+        auto alt_type = oneof_field.get_type().get();
+        if (!has_typed_arrays(alt_type)) {
+          continue;
+        }
+        auto alt = target + "." + oneof_field.get_name();
+        ostream << indent << "if (" << alt << " !== undefined) {" << NL;
+        generate_typed_conversion(ostream, alt_type, alt, indent + INDENT_1);
+        ostream << indent << "}" << NL;
+      }
+    }
+  }
+
+  // Checks `field` of the object `object`, whose path is `path`, then the
+  // constraints declared on it.
+  void generate_field_check(std::ostream& ostream,
+                            const StructType* struct_type, const Field& field,
+                            const std::string& object,
+                            const std::string& path,
+                            const std::string& indent) {
+    auto type = field.get_type().get();
+    if (type->is_primitive() &&
+        dynamic_cast<const PrimitiveType*>(type)->is_any()) {
+      return;
+    }
+    auto expr = object + "." + field.get_name();
+    auto field_path = append_path(path, "." + field.get_name());
+    if (field.is_optional()) {
+      ostream << indent << "if (" << expr << " !== undefined && " << expr
+              << " !== null) {" << NL;
+      generate_check(ostream, type, expr, field_path, indent + INDENT_1);
+      generate_constraint_check(ostream, struct_type, field, expr, field_path,
+                                indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else {
+      generate_check(ostream, type, expr, field_path, indent);
+      generate_constraint_check(ostream, struct_type, field, expr, field_path,
+                                indent);
+    }
+  }
+
+  // Emits statements returning a TmInvalid when `expr`, already checked to
+  // be of the type of `field`, breaks a constraint declared on it.
+  void generate_constraint_check(std::ostream& ostream,
+                                 const StructType* struct_type,
+                                 const Field& field, const std::string& expr,
+                                 const std::string& path,
+                                 const std::string& indent) {
+    const auto& constraints = field.get_constraints();
+    auto fail = [&](const std::string& condition, const std::string& reason) {
+      ostream << indent << "if (" << condition << ") {" << NL << indent
+              << INDENT_1 << "return tmInvalid(" << path << ", "
+              << quote_literal(reason) << ", " << expr << ");" << NL << indent
+              << "}" << NL;
+    };
+    auto type = field.get_type().get();
+    if (constraints.min || constraints.max) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      // An unsigned value is never below 0, the type check saw to that.
+      auto min = (primitive->is_u32() || primitive->is_u64()) &&
+                         constraints.min == "0"
+                     ? std::nullopt
+                     : constraints.min;
+      const auto& max = constraints.max;
+      if (min || max) {
+        fail((min ? expr + " < " + *min : "") + (min && max ? " || " : "") +
+                 (max ? expr + " > " + *max : ""),
+             bounds_reason("", constraints.min, max));
+      }
+    }
+    if (!count_check("", constraints.min_len, constraints.max_len).empty()) {
+      auto length = "n" + std::to_string(++tmp_);
+      ostream << indent << "const " << length << " = tmCodePoints(" << expr
+              << ");" << NL;
+      fail(count_check(length, constraints.min_len, constraints.max_len,
+                       "!=="),
+           bounds_reason("length", constraints.min_len, constraints.max_len));
+    }
+    if (constraints.pattern) {
+      fail("!" + pattern_name(struct_type, field) + ".test(" + expr + ")",
+           "must match " + *constraints.pattern);
+    }
+    auto size = type->is_map() ? "Object.keys(" + expr + ").length"
+                               : expr + ".length";
+    if (auto check = count_check(size, constraints.min_items,
+                                 constraints.max_items, "!==");
+        !check.empty()) {
+      fail(check, bounds_reason("size", constraints.min_items,
+                                constraints.max_items));
+    }
+  }
+
+  static std::string pattern_name(const StructType* struct_type,
+                                  const Field& field) {
+    return "tm" + struct_type->get_name() +
+           capitalize(camelcase(field.get_name())) + "Pattern";
+  }
+
+  // Appends `text` to the TypeScript string expression `path`, folding it
+  // into a trailing string literal.
+  static std::string append_path(const std::string& path,
+                                 const std::string& text) {
+    if (!path.empty() && path.back() == '"') {
+      return path.substr(0, path.size() - 1) + text + "\"";
+    }
+    return path + " + \"" + text + "\"";
+  }
+
+  // Emits statements returning a TmFailure when `expr` is not a `type`.
+  // `path` is a TypeScript expression for the path of `expr`, it is only
+  // evaluated on failure.
+  void generate_check(std::ostream& ostream, const Type* type,
+                      const std::string& expr, const std::string& path,
+                      const std::string& indent) {
+    auto fail = [&](const std::string& condition,
+                    const std::string& expected) {
+      ostream << indent << "if (" << condition << ") {" << NL << indent
+              << INDENT_1 << "return tmFail(" << path << ", \"" << expected
+              << "\", " << expr << ");" << NL << indent << "}" << NL;
+    };
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      if (primitive->is_bool()) {
+        fail("typeof " + expr + " !== \"boolean\"", "boolean");
+      } else if (primitive->is_i32()) {
+        fail("typeof " + expr + " !== \"number\" || (" + expr + " | 0) !== " +
+                 expr,
+             "i32");
+      } else if (primitive->is_u32()) {
+        fail("typeof " + expr + " !== \"number\" || " + expr +
+                 " >>> 0 !== " + expr,
+             "u32");
+      } else if (primitive->is_i64()) {
+        fail("!Number.isInteger(" + expr + ")", "i64");
+      } else if (primitive->is_u64()) {
+        fail("!Number.isInteger(" + expr + ") || " + expr + " < 0", "u64");
+      } else if (primitive->is_float()) {
+        fail("typeof " + expr + " !== \"number\"", "float");
+      } else if (primitive->is_string()) {
+        fail("typeof " + expr + " !== \"string\"", "string");
+      }
+    } else if (type->is_enum()) {
+      auto enum_type = dynamic_cast<const EnumType*>(type);
+      if (enum_type->get_fields().empty()) {
+        fail("true", type->get_name());
+      } else if (enum_type->is_contiguous()) {
+        fail("typeof " + expr + " !== \"number\" || !Number.isInteger(" +
+                 expr + ") || " + expr + " < " +
+                 std::to_string(enum_type->get_min_value()) + " || " + expr +
+                 " > " + std::to_string(enum_type->get_max_value()),
+             type->get_name());
+      } else {
+        fail("!tm" + type->get_name() + "Values.has(" + expr + ")",
+             type->get_name());
+      }
+    } else if (type->is_struct()) {
+      auto failure = "f" + std::to_string(++tmp_);
+      ostream << indent << "const " << failure << " = check"
+              << type->get_name() << "(" << expr << ");" << NL << indent
+              << "if (" << failure << " !== undefined) {" << NL << indent
+              << INDENT_1 << "return tmPrefix(" << failure << ", " << path
+              << ");" << NL << indent << "}" << NL;
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      auto n = std::to_string(++tmp_);
+      fail("!Array.isArray(" + expr + ")", "list");
+      ostream << indent << "for (let i" << n << " = 0; i" << n << " < "
+              << expr << ".length; i" << n << "++) {" << NL << indent
+              << INDENT_1 << "const e" << n << " = " << expr << "[i" << n
+              << "];" << NL;
+      generate_check(ostream, list->get_elem_type().get(), "e" + n,
+                     append_path(append_path(path, "[") + " + i" + n, "]"),
+                     indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      auto key = map->get_key_type();
+      auto n = std::to_string(++tmp_);
+      auto elem_path = append_path(
+          append_path(path, "[") + " + JSON.stringify(k" + n + ")", "]");
+      fail("!tmIsObject(" + expr + ")", "map");
+      ostream << indent << "for (const k" << n << " in " << expr << ") {"
+              << NL;
+      std::string key_condition;
+      if (key->is_bool()) {
+        key_condition = "k" + n + " !== \"true\" && k" + n + " !== \"false\"";
+      } else if (key->is_i32()) {
+        key_condition = "!tmIsIntKey(k" + n + ", -2147483648, 2147483647)";
+      } else if (key->is_u32()) {
+        key_condition = "!tmIsIntKey(k" + n + ", 0, 4294967295)";
+      } else if (key->is_i64()) {
+        key_condition = "!tmIsIntKey(k" + n +
+                        ", -9223372036854775808, 9223372036854775807)";
+      } else if (key->is_u64()) {
+        key_condition = "!tmIsIntKey(k" + n + ", 0, 18446744073709551615)";
+      } else if (key->is_float()) {
+        key_condition = "k" + n + ".trim() === \"\" || !isFinite(Number(k" +
+                        n + "))";
+      }
+      if (!key_condition.empty()) {
+        ostream << indent << INDENT_1 << "if (" << key_condition << ") {"
+                << NL << indent << INDENT_2 << "return tmFail(" << elem_path
+                << ", \"" << key->get_name() << " key\", k" << n << ");" << NL
+                << indent << INDENT_1 << "}" << NL;
+      }
+      ostream << indent << INDENT_1 << "const e" << n << " = " << expr << "[k"
+              << n << "];" << NL;
+      generate_check(ostream, map->get_value_type().get(), "e" + n,
+                     elem_path, indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      // Exactly one alternative must be present, it discriminates the union.
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      auto n = std::to_string(++tmp_);
+      std::string alternatives;
+      fail("!tmIsObject(" + expr + ")", "oneof");
+      ostream << indent << "let n" << n << " = 0;" << NL;
+      for (const auto& oneof_field : oneof->get_fields()) {
+        auto alt = expr + "." + oneof_field.get_name();
+        alternatives +=
+            (alternatives.empty() ? "" : ", ") + oneof_field.get_name();
+        ostream << indent << "if (" << alt << " !== undefined) {" << NL
+                << indent << INDENT_1 << "n" << n << "++;" << NL;
+        generate_check(ostream, oneof_field.get_type().get(), alt,
+                       append_path(path, "." + oneof_field.get_name()),
+                       indent + INDENT_1);
+        ostream << indent << "}" << NL;
+      }
+      fail("n" + n + " !== 1", "exactly one of " + alternatives);
+    }
+  }
+
+  // The binary codec follows src/wire_format.h. readX() starts from the
+  // zero value of every field that is not optional, so a message missing
+  // them still decodes to a complete X.
+  void generate_binary_codec(std::ostream& ostream,
+                             const StructType* struct_type) {
+    const auto& name = struct_type->get_name();
+    auto fields = struct_type->get_fields();
+    auto input = classes_ ? name + "Init" : name;
+    ostream << NL << "export function encode" << name << "(m: " << input
+            << "): Uint8Array {" << NL << INDENT_1
+            << "const w = new TmBinaryWriter();" << NL << INDENT_1 << "write"
+            << name << "(w, m);" << NL << INDENT_1 << "return w.finish();" << NL
+            << "}" << NL2 << "export function decode" << name
+            << "Binary(data: Uint8Array): " << name << " {" << NL << INDENT_1
+            << "return read" << name
+            << "(new TmBinaryReader(data), data.length);" << NL << "}" << NL2;
+
+    // encode
+    tmp_ = 0;
+    ostream << "function write" << name << "(w: TmBinaryWriter, m: " << input
+            << "): void {" << NL;
+    for (const auto& field : fields) {
+      generate_binary_encode_field(ostream, field, "m", INDENT_1);
+    }
+    ostream << "}" << NL2;
+
+    // decode
+    tmp_ = 0;
+    ostream << "function read" << name << "(r: TmBinaryReader, end: number): "
+            << name << " {" << NL << INDENT_1 << "const m: any = ";
+    if (classes_) {
+      ostream << "new " << name << "()";
+    } else {
+      ostream << "{";
+      bool first = true;
+      for (const auto& field : fields) {
+        auto zero = binary_zero_value(field);
+        if (!zero.empty()) {
+          ostream << (first ? "" : ", ") << field.get_name() << ": " << zero;
+          first = false;
+        }
+      }
+      ostream << "}";
+    }
+    ostream << ";" << NL << INDENT_1 << "while (r.more(end)) {" << NL;
+    generate_number_switch(ostream, fields, "m", INDENT_2, false);
+    ostream << INDENT_1 << "}" << NL << INDENT_1 << "r.done(end);" << NL
+            << INDENT_1 << "return m;" << NL << "}" << NL;
+  }
+
+  // Emits a switch over the number of the next key that decodes the member
+  // it names into `object`, skipping unknown numbers. A oneof's `object`
+  // is replaced by a new one holding only the alternative.
+  void generate_number_switch(std::ostream& ostream,
+                              const std::vector<Field>& fields,
+                              const std::string& object,
+                              const std::string& indent, bool is_oneof) {
+    auto key = "k" + std::to_string(tmp_++);
+    ostream << indent << "const " << key << " = r.key();" << NL << indent
+            << "switch (" << key << " >>> 3) {" << NL;
+    for (const auto& field : fields) {
+      ostream << indent << INDENT_1 << "case " << field.get_number() << ": {"
+              << NL << indent << INDENT_2 << "r.expect(" << key << ", "
+              << static_cast<int>(
+                     wire_format::wire_type_of(field.get_type().get()))
+              << ");" << NL;
+      if (is_oneof) {
+        ostream << indent << INDENT_2 << object << " = {};" << NL;
+      }
+      generate_binary_decode(ostream, field.get_type().get(),
+                             object + "." + field.get_name(),
+                             indent + INDENT_2);
+      ostream << indent << INDENT_2 << "break;" << NL << indent << INDENT_1
+              << "}" << NL;
+    }
+    ostream << indent << INDENT_1 << "default:" << NL << indent << INDENT_2
+            << "r.skip(" << key << ");" << NL << indent << "}" << NL;
+  }
+
+  // Emits statements that write the key and value of `field` of `object`,
+  // unless it is an optional field that is not set.
+  void generate_binary_encode_field(std::ostream& ostream, const Field& field,
+                                    const std::string& object,
+                                    const std::string& indent) {
+    auto type = field.get_type().get();
+    auto expr = object + "." + field.get_name();
+    auto key = std::to_string(
+        static_cast<std::uint64_t>(field.get_number()) << 3 |
+        static_cast<std::uint64_t>(wire_format::wire_type_of(type)));
+    // Like on the other targets, a oneof with nothing set is left out.
+    if (field.is_optional() || type->is_oneof()) {
+      ostream << indent << "if (" << expr << " !== undefined && " << expr
+              << " !== null) {" << NL << indent << INDENT_1 << "w.varint("
+              << key << ");" << NL;
+      generate_binary_encode(ostream, type, expr, indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else {
+      ostream << indent << "w.varint(" << key << ");" << NL;
+      generate_binary_encode(ostream, type, expr, indent);
+    }
+  }
+
+  // Emits statements that write `expr` of `type` without a key.
+  void generate_binary_encode(std::ostream& ostream, const Type* type,
+                              const std::string& expr,
+                              const std::string& indent) {
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      ostream << indent << "w.";
+      if (primitive->is_bool()) {
+        ostream << "bool";
+      } else if (primitive->is_i32() || primitive->is_i64()) {
+        ostream << "zigzag";
+      } else if (primitive->is_u32() || primitive->is_u64()) {
+        ostream << "varint";
+      } else if (primitive->is_float()) {
+        ostream << "fixed64";
+      } else if (primitive->is_string()) {
+        ostream << "string";
+      } else {
+        ostream << "any";
+      }
+      ostream << "(" << expr << ");" << NL;
+      return;
+    }
+    if (type->is_enum()) {
+      ostream << indent << "w.zigzag(" << expr << ");" << NL;
+      return;
+    }
+    auto t = std::to_string(tmp_++);
+    ostream << indent << "const s" << t << " = w.begin();" << NL;
+    if (type->is_struct()) {
+      ostream << indent << "write" << type->get_name() << "(w, " << expr
+              << ");" << NL;
+    } else if (auto typed_array = typed_array_of(type);
+               !typed_array.empty()) {
+      auto elem = dynamic_cast<const ListType*>(type)->get_elem_type();
+      ostream << indent << "const a" << t << ": ArrayLike<number> = " << expr
+              << ";" << NL << indent << "w.varint(a" << t << ".length);" << NL;
+      if (dynamic_cast<const PrimitiveType*>(elem.get())->is_float()) {
+        ostream << indent << "w.float64s(a" << t << ");" << NL;
+      } else {
+        ostream << indent << "for (let i" << t << " = 0; i" << t << " < a"
+                << t << ".length; i" << t << "++) {" << NL;
+        generate_binary_encode(ostream, elem.get(), "a" + t + "[i" + t + "]",
+                               indent + INDENT_1);
+        ostream << indent << "}" << NL;
+      }
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      ostream << indent << "const a" << t << " = " << expr << " as any[];"
+              << NL << indent << "w.varint(a" << t << ".length);" << NL
+              << indent << "for (const e" << t << " of a" << t << ") {" << NL;
+      generate_binary_encode(ostream, list->get_elem_type().get(), "e" + t,
+                             indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      auto key = map->get_key_type();
+      // Object keys are strings, the others are parsed out of them.
+      auto key_expr = key->is_string() ? "k" + t
+                      : key->is_bool() ? "k" + t + " === \"true\""
+                                       : "Number(k" + t + ")";
+      ostream << indent << "const o" << t << ": any = " << expr << ";" << NL
+              << indent << "const keys" << t << " = Object.keys(o" << t
+              << ");" << NL << indent << "w.varint(keys" << t << ".length);"
+              << NL << indent << "for (const k" << t << " of keys" << t
+              << ") {" << NL;
+      generate_binary_encode(ostream, key.get(), key_expr, indent + INDENT_1);
+      generate_binary_encode(ostream, map->get_value_type().get(),
+                             "o" + t + "[k" + t + "]", indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      auto alternatives = oneof->get_fields();
+      ostream << indent << "const o" << t << ": any = " << expr << ";" << NL
+              << indent;
+      for (std::size_t i = 0; i < alternatives.size(); ++i) {
+        const auto& oneof_field = alternatives[i];
+        if (i > 0) {
+          ostream << " else ";
+        }
+        ostream << "if (o" << t << "." << oneof_field.get_name()
+                << " !== undefined) {" << NL;
+        generate_binary_encode_field(ostream, oneof_field, "o" + t,
+                                     indent + INDENT_1);
+        ostream << indent << "}";
+      }
+      ostream << NL;
+    }
+    ostream << indent << "w.end(s" << t << ");" << NL;
+  }
+
+  // Emits statements that decode the next binary value of `type`, which
+  // has no key, into `target`.
+  void generate_binary_decode(std::ostream& ostream, const Type* type,
+                              const std::string& target,
+                              const std::string& indent) {
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      ostream << indent << target << " = r.";
+      if (primitive->is_bool()) {
+        ostream << "bool";
+      } else if (primitive->is_i32() || primitive->is_i64()) {
+        ostream << "zigzag";
+      } else if (primitive->is_u32() || primitive->is_u64()) {
+        ostream << "varint";
+      } else if (primitive->is_float()) {
+        ostream << "fixed64";
+      } else if (primitive->is_string()) {
+        ostream << "string";
+      } else {
+        ostream << "any";
+      }
+      ostream << "();" << NL;
+      return;
+    }
+    if (type->is_enum()) {
+      ostream << indent << target << " = r.zigzag();" << NL;
+      return;
+    }
+    if (type->is_struct()) {
+      ostream << indent << target << " = read" << type->get_name()
+              << "(r, r.limit());" << NL;
+      return;
+    }
+    auto t = std::to_string(tmp_++);
+    ostream << indent << "const end" << t << " = r.limit();" << NL;
+    if (auto typed_array = typed_array_of(type); !typed_array.empty()) {
+      auto elem = dynamic_cast<const ListType*>(type)->get_elem_type();
+      if (dynamic_cast<const PrimitiveType*>(elem.get())->is_float()) {
+        ostream << indent << "const a" << t << " = r.float64s(r.count(end"
+                << t << "));" << NL;
+      } else {
+        ostream << indent << "const a" << t << " = new " << typed_array
+                << "(r.count(end" << t << "));" << NL << indent << "for (let i"
+                << t << " = 0; i" << t << " < a" << t << ".length; i" << t
+                << "++) {" << NL;
+        generate_binary_decode(ostream, elem.get(), "a" + t + "[i" + t + "]",
+                               indent + INDENT_1);
+        ostream << indent << "}" << NL;
+      }
+    } else if (type->is_list()) {
+      auto list = dynamic_cast<const ListType*>(type);
+      ostream << indent << "const a" << t << ": any[] = new Array(r.count(end"
+              << t << "));" << NL << indent << "for (let i" << t << " = 0; i"
+              << t << " < a" << t << ".length; i" << t << "++) {" << NL;
+      generate_binary_decode(ostream, list->get_elem_type().get(),
+                             "a" + t + "[i" + t + "]", indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_map()) {
+      auto map = dynamic_cast<const MapType*>(type);
+      ostream << indent << "const o" << t << ": any = {};" << NL << indent
+              << "for (let n" << t << " = r.count(end" << t << "); n" << t
+              << " > 0; n" << t << "--) {" << NL << indent << INDENT_1
+              << "let k" << t << ": any;" << NL;
+      generate_binary_decode(ostream, map->get_key_type().get(), "k" + t,
+                             indent + INDENT_1);
+      generate_binary_decode(ostream, map->get_value_type().get(),
+                             "o" + t + "[k" + t + "]", indent + INDENT_1);
+      ostream << indent << "}" << NL;
+    } else if (type->is_oneof()) {
+      auto oneof = dynamic_cast<const OneofType*>(type);
+      ostream << indent << "let o" << t << ": any = undefined;" << NL << indent
+              << "while (r.more(end" << t << ")) {" << NL;
+      generate_number_switch(ostream, oneof->get_fields(), "o" + t,
+                             indent + INDENT_1, true);
+      ostream << indent << "}" << NL;
+    }
+    ostream << indent << "r.done(end" << t << ");" << NL << indent << target
+            << " = " << (type->is_list() ? "a" : "o") << t << ";" << NL;
+  }
+
+  // A view checks the top level of a binary message once, recording where
+  // the value of each field it knows starts, and decodes a field only when
+  // it is read. Strings come back as subarrays of the message and structs
+  // as views of them. Lists, maps, oneofs and `any` values come back as
+  // their encoded bytes. Absent fields read as zero or undefined.
+  void generate_binary_view(std::ostream& ostream,
+                            const StructType* struct_type) {
+    auto view_name = struct_type->get_name() + "View";
+    auto fields = struct_type->get_fields();
+
+    ostream << NL << "export class " << view_name << " {" << NL << INDENT_1
+            << "private readonly bytes: Uint8Array;" << NL << INDENT_1
+            << "// Offset of each field's value plus one, 0 if it is absent."
+            << NL << INDENT_1 << "private readonly off = new Uint32Array("
+            << fields.size() << ");" << NL2 << INDENT_1
+            << "constructor(private readonly view: DataView) {" << NL
+            << INDENT_2
+            << "this.bytes = new Uint8Array(view.buffer, view.byteOffset, "
+               "view.byteLength);"
+            << NL << INDENT_2
+            << "const r = new TmBinaryReader(this.bytes, view);" << NL
+            << INDENT_2 << "while (r.more(this.bytes.length)) {" << NL
+            << INDENT_3 << "const k = r.key();" << NL << INDENT_3
+            << "const start = r.pos;" << NL << INDENT_3 << "switch (k >>> 3) {"
+            << NL;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      ostream << INDENT_4 << "case " << fields[i].get_number() << ":" << NL
+              << INDENT_4 << INDENT_1 << "r.expect(k, "
+              << static_cast<int>(
+                     wire_format::wire_type_of(fields[i].get_type().get()))
+              << ");" << NL << INDENT_4 << INDENT_1 << "this.off[" << i
+              << "] = start + 1;" << NL << INDENT_4 << INDENT_1 << "break;"
+              << NL;
+    }
+    ostream << INDENT_3 << "}" << NL << INDENT_3 << "r.skip(k);" << NL
+            << INDENT_2 << "}" << NL << INDENT_1 << "}" << NL2;
+
+    ostream << INDENT_1 << "private at(i: number): TmBinaryReader {" << NL
+            << INDENT_2
+            << "const r = new TmBinaryReader(this.bytes, this.view);" << NL
+            << INDENT_2 << "r.pos = this.off[i] - 1;" << NL << INDENT_2
+            << "return r;" << NL << INDENT_1 << "}" << NL;
+
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      const auto& field = fields[i];
+      auto type = field.get_type().get();
+      auto method = field.get_name();
+      auto slot = std::to_string(i);
+      auto reader = "this.at(" + slot + ")";
+      ostream << NL << INDENT_1 << "has_" << method << "(): boolean {" << NL
+              << INDENT_2 << "return this.off[" << slot << "] !== 0;" << NL
+              << INDENT_1 << "}" << NL2;
+
+      std::string result;
+      std::string zero = "undefined";
+      std::string read;
+      if (type->is_enum()) {
+        result = type->get_name();
+        zero = "0";
+        read = reader + ".zigzag()";
+      } else if (type->is_struct()) {
+        result = type->get_name() + "View | undefined";
+        read = "new " + type->get_name() + "View(tmDataView(" + reader +
+               ".bytes()))";
+      } else if (type->is_primitive() &&
+                 !dynamic_cast<const PrimitiveType*>(type)->is_any()) {
+        auto primitive = dynamic_cast<const PrimitiveType*>(type);
+        if (primitive->is_string()) {
+          result = "Uint8Array | undefined";
+          read = reader + ".bytes()";
+        } else if (primitive->is_bool()) {
+          result = "boolean";
+          zero = "false";
+          read = reader + ".bool()";
+        } else {
+          result = "number";
+          zero = "0";
+          read = reader + (primitive->is_float() ? ".fixed64()"
+                           : primitive->is_u32() || primitive->is_u64()
+                               ? ".varint()"
+                               : ".zigzag()");
+        }
+      } else {
+        method += "_bytes";
+        result = "Uint8Array | undefined";
+        read = reader + ".bytes()";
+      }
+      ostream << INDENT_1 << method << "(): " << result << " {" << NL
+              << INDENT_2 << "return this.off[" << slot << "] === 0 ? " << zero
+              << " : " << read << ";" << NL << INDENT_1 << "}" << NL;
+    }
+    ostream << "}" << NL;
+  }
+
+  // Returns what readX() starts `field` out as, empty if it is left out.
+  std::string binary_zero_value(const Field& field) const {
+    auto type = field.get_type().get();
+    if (field.is_optional() || type->is_oneof()) {
+      return "";
+    }
+    if (type->is_primitive()) {
+      auto primitive = dynamic_cast<const PrimitiveType*>(type);
+      if (primitive->is_bool()) {
+        return "false";
+      } else if (primitive->is_string()) {
+        return "\"\"";
+      } else if (primitive->is_any()) {
+        return "null";
+      }
+      return "0";
+    } else if (type->is_struct()) {
+      // Reads nothing, so every field of the struct gets its zero value.
+      return "read" + type->get_name() + "(r, r.pos)";
+    } else if (type->is_list()) {
+      auto typed_array = typed_array_of(type);
+      return typed_array.empty() ? "[]" : "new " + typed_array + "(0)";
+    } else if (type->is_map()) {
+      return "{}";
+    }
+    return "0";
+  }
+
+  // `suffix` is appended to the names of struct types.
+  void generate_field(std::ostream& ostream, const Field* field,
+                      const std::string& suffix = "") const {
     ostream << field->get_name();
     if (field->is_optional()) {
       ostream << "?";
     }
     ostream << ": ";
+    generate_field_type(ostream, field, suffix);
+    ostream << ";";
+  }
+
+  void generate_field_type(std::ostream& ostream, const Field* field,
+                           const std::string& suffix) const {
     if (field->get_type()->is_oneof()) {
       auto oneof = std::dynamic_pointer_cast<OneofType>(field->get_type());
       auto oneof_fields = oneof->get_fields();
       for (auto it = oneof_fields.begin(); it != oneof_fields.end(); ++it) {
         ostream << "{ ";
-        generate_field(ostream, &(*it));
+        generate_field(ostream, &(*it), suffix);
         ostream << " }";
         if (it != (oneof_fields.end() - 1)) {
           ostream << " | ";
         }
       }
     } else {
-      ostream << type_to_ts_type(field->get_type().get());
+      ostream << type_to_ts_type(field->get_type().get(), suffix);
     }
-    ostream << ";";
   }
 
-  [[nodiscard]] static std::string type_to_ts_type(Type* type) {
+  // Returns the typed array that holds a list of `type`, if ts_typed_arrays
+  // maps it to one. i64 and u64 are numbers everywhere in this target, so
+  // their lists are Float64Arrays, which hold the same values exactly.
+  std::string typed_array_of(const Type* type) const {
+    if (!typed_arrays_ || !type->is_list()) {
+      return "";
+    }
+    auto elem = dynamic_cast<const ListType*>(type)->get_elem_type().get();
+    if (!elem->is_primitive()) {
+      return "";
+    }
+    auto primitive = dynamic_cast<const PrimitiveType*>(elem);
+    if (primitive->is_i32()) {
+      return "Int32Array";
+    } else if (primitive->is_u32()) {
+      return "Uint32Array";
+    } else if (primitive->is_numeric()) {
+      return "Float64Array";
+    }
+    return "";
+  }
+
+  // A non-empty `suffix` asks for the input form, XInit, of struct types
+  // X, in which typed arrays may also be given as plain arrays.
+  [[nodiscard]] std::string type_to_ts_type(
+      Type* type, const std::string& suffix = "") const {
+    auto typed_array = typed_array_of(type);
+    if (!typed_array.empty()) {
+      return suffix.empty() ? typed_array : "ArrayLike<number>";
+    }
     if (type->is_primitive()) {
       auto primitive = dynamic_cast<PrimitiveType*>(type);
       if (primitive->is_bool()) {
@@ -101,19 +1365,35 @@ class TypescriptGenerator : public Generator {
       } else if (primitive->is_any()) {
         return "any";
       }
-    } else if (type->is_struct() || type->is_enum()) {
+    } else if (type->is_struct()) {
+      return type->get_name() + suffix;
+    } else if (type->is_enum()) {
       return type->get_name();
     } else if (type->is_map()) {
       auto map = dynamic_cast<MapType*>(type);
       return "{[key: " + type_to_ts_type(map->get_key_type().get()) +
-             "]: " + type_to_ts_type(map->get_value_type().get()) + ";}";
+             "]: " + type_to_ts_type(map->get_value_type().get(), suffix) +
+             ";}";
     } else if (type->is_list()) {
       auto list = dynamic_cast<ListType*>(type);
       return "{[index: number]: " +
-             type_to_ts_type(list->get_elem_type().get()) + ";}";
+             type_to_ts_type(list->get_elem_type().get(), suffix) + ";}";
     }
     return "";
   }
+
+  bool decoders_ = false;
+  bool binary_codec_ = false;
+  bool binary_views_ = false;
+  bool classes_ = false;
+  bool typed_arrays_ = false;
+  bool http_client_ = false;
+  bool streams_ = false;
+  bool validation_ = false;
+  // The enums that got a decoder for a client.
+  std::set<std::string> enum_decoders_;
+  // Numbers the temporaries of the function being generated.
+  int tmp_ = 0;
 };
 }  // namespace toolman::generator
 
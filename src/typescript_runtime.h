@@ -0,0 +1,617 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_TYPESCRIPT_RUNTIME_H_
+#define TOOLMAN_TYPESCRIPT_RUNTIME_H_
+
+namespace toolman::generator::typescript_runtime {
+
+// Support code emitted once into every TypeScript file that uses the
+// generated decoders. Check functions return undefined on success, so a
+// failure's path is only built on the way back up from the bad value.
+constexpr char kDecode[] = R"(
+export class ToolmanDecodeError extends Error {
+    readonly path: string;
+
+    constructor(path: string, message: string) {
+        super(path + ": " + message);
+        this.name = "ToolmanDecodeError";
+        this.path = path;
+    }
+}
+
+class TmFailure {
+    constructor(public path: string, readonly expected: string, readonly value: unknown) {}
+}
+
+function tmFail(path: string, expected: string, value: unknown): TmFailure {
+    return new TmFailure(path, expected, value);
+}
+
+function tmPrefix(failure: TmFailure, path: string): TmFailure {
+    failure.path = path + failure.path;
+    return failure;
+}
+
+function tmThrow(failure: TmFailure): never {
+    const value = failure.value;
+    const got = value === undefined ? "nothing" :
+        value === null ? "null" : Array.isArray(value) ? "array" : typeof value;
+    throw new ToolmanDecodeError("$" + failure.path, "expected " + failure.expected + ", got " + got);
+}
+
+function tmIsObject(value: unknown): value is { [key: string]: unknown } {
+    return typeof value === "object" && value !== null && !Array.isArray(value);
+}
+
+// Map keys are strings in JSON, integer keys must be spelled canonically.
+function tmIsIntKey(key: string, min: number, max: number): boolean {
+    if (!/^-?(0|[1-9][0-9]*)$/.test(key)) {
+        return false;
+    }
+    const n = Number(key);
+    return n >= min && n <= max;
+}
+)";
+
+// Support code for the generated streamX functions, emitted after `kDecode`.
+// Values are cut out of the text by counting brackets and handed whole to
+// JSON.parse, which reports what is wrong inside them.
+constexpr char kStream[] = R"(
+// TmJSONStream reads JSON text from a source of chunks one value at a time,
+// holding no more of it than the value being read and what was read ahead.
+class TmJSONStream {
+    private readonly chunks: AsyncIterator<Uint8Array | string>;
+    private readonly decoder = new TextDecoder();
+    private text = "";
+    private pos = 0;
+    // The offset of text in the input, in UTF-16 code units.
+    private offset = 0;
+    private eof = false;
+
+    constructor(source: AsyncIterable<Uint8Array | string>) {
+        this.chunks = source[Symbol.asyncIterator]();
+    }
+
+    // Drops the text before pos and appends the next chunk. Returns false at
+    // the end of the input.
+    private async read(): Promise<boolean> {
+        if (this.pos > 0) {
+            this.offset += this.pos;
+            this.text = this.text.slice(this.pos);
+            this.pos = 0;
+        }
+        while (!this.eof) {
+            const next = await this.chunks.next();
+            let chunk: string;
+            if (next.done) {
+                this.eof = true;
+                chunk = this.decoder.decode();
+            } else if (typeof next.value === "string") {
+                chunk = next.value;
+            } else {
+                chunk = this.decoder.decode(next.value, { stream: true });
+            }
+            if (chunk.length > 0) {
+                this.text += chunk;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    private fail(message: string): never {
+        throw new SyntaxError("toolman: " + message + " at offset " + (this.offset + this.pos));
+    }
+
+    // Skips whitespace and returns the next character, "" at the end of the
+    // input.
+    async peek(): Promise<string> {
+        for (;;) {
+            while (this.pos < this.text.length) {
+                const c = this.text.charCodeAt(this.pos);
+                if (c !== 0x20 && c !== 0x09 && c !== 0x0a && c !== 0x0d) {
+                    return this.text[this.pos];
+                }
+                this.pos++;
+            }
+            if (!await this.read()) {
+                return "";
+            }
+        }
+    }
+
+    // Returns the text of the next value, for JSON.parse.
+    async value(): Promise<string> {
+        if (await this.peek() === "") {
+            this.fail("unexpected end of JSON input");
+        }
+        let n = 0;
+        let depth = 0;
+        let str = false;
+        let esc = false;
+        scan: for (;;) {
+            if (this.pos + n === this.text.length && !await this.read()) {
+                break;
+            }
+            const c = this.text[this.pos + n];
+            if (str) {
+                n++;
+                if (esc) {
+                    esc = false;
+                } else if (c === "\\") {
+                    esc = true;
+                } else if (c === "\"") {
+                    str = false;
+                    if (depth === 0) {
+                        break;
+                    }
+                }
+                continue;
+            }
+            switch (c) {
+            case "\"":
+                str = true;
+                break;
+            case "{":
+            case "[":
+                depth++;
+                break;
+            case "}":
+            case "]":
+                if (depth === 0) {
+                    break scan;
+                }
+                if (--depth === 0) {
+                    n++;
+                    break scan;
+                }
+                break;
+            case ",":
+            case ":":
+            case " ":
+            case "\t":
+            case "\n":
+            case "\r":
+                if (depth === 0) {
+                    break scan;
+                }
+                break;
+            }
+            n++;
+        }
+        const value = this.text.slice(this.pos, this.pos + n);
+        this.pos += n;
+        return value;
+    }
+
+    // Consumes c if it is the next character.
+    async begin(c: string): Promise<boolean> {
+        if (await this.peek() !== c) {
+            return false;
+        }
+        this.pos++;
+        return true;
+    }
+
+    // Whether the object or array closed by c has another member, the i-th.
+    async more(c: string, i: number): Promise<boolean> {
+        const next = await this.peek();
+        if (next === c) {
+            this.pos++;
+            return false;
+        } else if (next === "," && i > 0) {
+            this.pos++;
+            return true;
+        } else if (next !== "" && next !== "," && i === 0) {
+            return true;
+        }
+        return this.fail(next === "" ? "unexpected end of JSON input" : "expected , or " + c);
+    }
+
+    // Reads an object key and the colon after it.
+    async key(): Promise<string> {
+        const key = JSON.parse(await this.value());
+        if (typeof key !== "string") {
+            this.fail("expected string");
+        }
+        if (!await this.begin(":")) {
+            this.fail("expected :");
+        }
+        return key;
+    }
+
+    async end(): Promise<void> {
+        if (await this.peek() !== "") {
+            this.fail("unexpected data after top-level value");
+        }
+    }
+}
+)";
+
+// Support code for the generated binary codec, see src/wire_format.h.
+// Integers are numbers, so 64-bit values are exact up to 2^53; varints are
+// built with arithmetic rather than 32-bit bitwise operators for that
+// reason.
+constexpr char kBinary[] = R"(
+export class ToolmanBinaryError extends Error {
+    readonly offset: number;
+
+    constructor(message: string, offset: number) {
+        super(message + " at offset " + offset);
+        this.name = "ToolmanBinaryError";
+        this.offset = offset;
+    }
+}
+
+const tmUtf8 = new TextDecoder();
+const tmLittleEndian = new Uint8Array(new Uint16Array([1]).buffer)[0] === 1;
+
+function tmDataView(b: Uint8Array): DataView {
+    return new DataView(b.buffer, b.byteOffset, b.byteLength);
+}
+
+class TmBinaryWriter {
+    private buf = new Uint8Array(256);
+    private view = new DataView(this.buf.buffer);
+    private len = 0;
+
+    private ensure(n: number): void {
+        if (this.len + n > this.buf.length) {
+            const buf = new Uint8Array(Math.max(this.buf.length * 2, this.len + n));
+            buf.set(this.buf.subarray(0, this.len));
+            this.buf = buf;
+            this.view = new DataView(buf.buffer);
+        }
+    }
+
+    varint(v: number): void {
+        this.ensure(10);
+        while (v >= 0x80) {
+            this.buf[this.len++] = (v % 0x80) | 0x80;
+            v = Math.floor(v / 0x80);
+        }
+        this.buf[this.len++] = v;
+    }
+
+    zigzag(v: number): void {
+        this.varint(v >= 0 ? v * 2 : -v * 2 - 1);
+    }
+
+    bool(v: boolean): void {
+        this.ensure(1);
+        this.buf[this.len++] = v ? 1 : 0;
+    }
+
+    fixed64(v: number): void {
+        this.ensure(8);
+        this.view.setFloat64(this.len, v, true);
+        this.len += 8;
+    }
+
+    // Writes floats back to back; a Float64Array is copied in one go on
+    // little-endian platforms, where its bytes are the wire format.
+    float64s(a: ArrayLike<number>): void {
+        this.ensure(a.length * 8);
+        if (tmLittleEndian && a instanceof Float64Array) {
+            this.buf.set(new Uint8Array(a.buffer, a.byteOffset, a.byteLength), this.len);
+            this.len += a.byteLength;
+            return;
+        }
+        for (let i = 0; i < a.length; i++) {
+            this.view.setFloat64(this.len, a[i], true);
+            this.len += 8;
+        }
+    }
+
+    string(s: string): void {
+        const start = this.begin();
+        this.ensure(s.length);
+        for (let i = 0; i < s.length; i++) {
+            let c = s.charCodeAt(i);
+            if (c < 0x80) {
+                this.ensure(1);
+                this.buf[this.len++] = c;
+                continue;
+            }
+            if (c >= 0xd800 && c < 0xdc00 && i + 1 < s.length) {
+                const low = s.charCodeAt(i + 1);
+                if (low >= 0xdc00 && low < 0xe000) {
+                    c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                    i++;
+                }
+            }
+            if (c >= 0xd800 && c < 0xe000) {
+                c = 0xfffd;
+            }
+            this.ensure(4);
+            if (c < 0x800) {
+                this.buf[this.len++] = 0xc0 | (c >> 6);
+            } else {
+                if (c < 0x10000) {
+                    this.buf[this.len++] = 0xe0 | (c >> 12);
+                } else {
+                    this.buf[this.len++] = 0xf0 | (c >> 18);
+                    this.buf[this.len++] = 0x80 | ((c >> 12) & 0x3f);
+                }
+                this.buf[this.len++] = 0x80 | ((c >> 6) & 0x3f);
+            }
+            this.buf[this.len++] = 0x80 | (c & 0x3f);
+        }
+        this.end(start);
+    }
+
+    any(v: unknown): void {
+        this.string(v === undefined ? "null" : JSON.stringify(v));
+    }
+
+    // Reserves a one byte length prefix, returns where the value starts.
+    begin(): number {
+        this.ensure(1);
+        this.buf[this.len++] = 0;
+        return this.len;
+    }
+
+    // Fills in the length prefix reserved by begin(), moving the value up
+    // when its length needs a longer varint.
+    end(start: number): void {
+        const n = this.len - start;
+        if (n < 0x80) {
+            this.buf[start - 1] = n;
+            return;
+        }
+        let extra = 1;
+        for (let v = n >>> 14; v !== 0; v >>>= 7) {
+            extra++;
+        }
+        this.ensure(extra);
+        this.buf.copyWithin(start + extra, start, this.len);
+        this.len += extra;
+        let p = start - 1;
+        let v = n;
+        for (; v >= 0x80; v >>>= 7) {
+            this.buf[p++] = (v & 0x7f) | 0x80;
+        }
+        this.buf[p] = v;
+    }
+
+    finish(): Uint8Array {
+        return this.buf.slice(0, this.len);
+    }
+}
+
+class TmBinaryReader {
+    private readonly view: DataView;
+    pos = 0;
+
+    constructor(private readonly buf: Uint8Array, view?: DataView) {
+        this.view = view ?? new DataView(buf.buffer, buf.byteOffset, buf.byteLength);
+    }
+
+    error(message: string): ToolmanBinaryError {
+        return new ToolmanBinaryError(message, this.pos);
+    }
+
+    more(end: number): boolean {
+        return this.pos < end;
+    }
+
+    varint(): number {
+        let v = 0;
+        let scale = 1;
+        for (let i = 0; i < 10; i++) {
+            if (this.pos >= this.buf.length) {
+                throw this.error("unexpected end of input");
+            }
+            const b = this.buf[this.pos++];
+            v += (b & 0x7f) * scale;
+            if (b < 0x80) {
+                return v;
+            }
+            scale *= 0x80;
+        }
+        throw this.error("malformed varint");
+    }
+
+    zigzag(): number {
+        const v = this.varint();
+        return v % 2 === 0 ? v / 2 : -(v + 1) / 2;
+    }
+
+    bool(): boolean {
+        return this.varint() !== 0;
+    }
+
+    fixed64(): number {
+        if (this.buf.length - this.pos < 8) {
+            throw this.error("unexpected end of input");
+        }
+        const v = this.view.getFloat64(this.pos, true);
+        this.pos += 8;
+        return v;
+    }
+
+    // Reads n floats written back to back, see TmBinaryWriter.float64s.
+    float64s(n: number): Float64Array {
+        if (this.buf.length - this.pos < n * 8) {
+            throw this.error("unexpected end of input");
+        }
+        const a = new Float64Array(n);
+        if (tmLittleEndian) {
+            new Uint8Array(a.buffer).set(this.buf.subarray(this.pos, this.pos + n * 8));
+            this.pos += n * 8;
+            return a;
+        }
+        for (let i = 0; i < n; i++) {
+            a[i] = this.view.getFloat64(this.pos, true);
+            this.pos += 8;
+        }
+        return a;
+    }
+
+    // Reads a length prefix, returns the offset the value ends at.
+    limit(): number {
+        const n = this.varint();
+        if (n > this.buf.length - this.pos) {
+            throw this.error("length exceeds input");
+        }
+        return this.pos + n;
+    }
+
+    // Reads an element count. Every element takes at least one byte, so a
+    // count larger than what is left before end is malformed.
+    count(end: number): number {
+        const n = this.varint();
+        if (n > end - this.pos) {
+            throw this.error("count exceeds input");
+        }
+        return n;
+    }
+
+    // Checks that a length-delimited value ended where its prefix said.
+    done(end: number): void {
+        if (this.pos !== end) {
+            throw this.error("length mismatch");
+        }
+    }
+
+    // Returns the next length-delimited value without copying it.
+    bytes(): Uint8Array {
+        const end = this.limit();
+        const b = this.buf.subarray(this.pos, end);
+        this.pos = end;
+        return b;
+    }
+
+    string(): string {
+        return tmUtf8.decode(this.bytes());
+    }
+
+    any(): any {
+        const start = this.pos;
+        const text = this.string();
+        try {
+            return JSON.parse(text);
+        } catch (e) {
+            this.pos = start;
+            throw this.error("malformed JSON in any value");
+        }
+    }
+
+    // Returns the whole key, the field number is key >>> 3.
+    key(): number {
+        const k = this.varint();
+        if (k > 0xffffffff) {
+            throw this.error("malformed key");
+        }
+        return k;
+    }
+
+    expect(key: number, wireType: number): void {
+        if ((key & 7) !== wireType) {
+            throw this.error("wrong wire type");
+        }
+    }
+
+    skip(key: number): void {
+        switch (key & 7) {
+            case 0:
+                this.varint();
+                break;
+            case 1:
+                if (this.buf.length - this.pos < 8) {
+                    throw this.error("unexpected end of input");
+                }
+                this.pos += 8;
+                break;
+            case 2:
+                this.pos = this.limit();
+                break;
+            default:
+                throw this.error("unknown wire type");
+        }
+    }
+}
+)";
+
+// Support code for the generated classes.
+constexpr char kClasses[] = R"(
+function tmCopyMap(o: any, copy: (v: any) => any): any {
+    const m: any = {};
+    for (const k of Object.keys(o)) {
+        m[k] = copy(o[k]);
+    }
+    return m;
+}
+)";
+
+// Support code for ts_typed_arrays. Typed arrays stringify as objects,
+// the replacer writes them as the arrays that the decoders read.
+constexpr char kTypedArrays[] = R"(
+export function toolmanJSONReplacer(key: string, value: unknown): unknown {
+    return ArrayBuffer.isView(value) ? Array.from(value as Float64Array) : value;
+}
+)";
+
+// Support code for the generated HTTP clients.
+constexpr char kHttpClient[] = R"(
+export class ToolmanHttpError extends Error {
+    readonly status: number;
+    readonly body: string;
+
+    constructor(status: number, body: string) {
+        super("unexpected HTTP status " + status);
+        this.name = "ToolmanHttpError";
+        this.status = status;
+        this.body = body;
+    }
+}
+
+function tmRequest(method: string, body: string | undefined): RequestInit {
+    return body === undefined ? { method } :
+        { method, headers: { "Content-Type": "application/json" }, body };
+}
+)";
+
+// Support code for the constraints checked by the generated decoders. A
+// TmInvalid is a failure whose value has the right type but breaks a
+// constraint, it is reported with its reason.
+constexpr char kValidation[] = R"(
+class TmInvalid extends TmFailure {
+    constructor(path: string, readonly reason: string, value: unknown) {
+        super(path, "", value);
+    }
+}
+
+function tmInvalid(path: string, reason: string, value: unknown): TmFailure {
+    return new TmInvalid(path, reason, value);
+}
+
+function tmReject(failure: TmFailure): never {
+    if (failure instanceof TmInvalid) {
+        throw new ToolmanDecodeError("$" + failure.path, failure.reason);
+    }
+    return tmThrow(failure);
+}
+
+// Lengths count code points, the way the other targets do.
+function tmCodePoints(s: string): number {
+    let n = s.length;
+    for (let i = 0; i + 1 < s.length; i++) {
+        const c = s.charCodeAt(i);
+        if (c >= 0xd800 && c < 0xdc00) {
+            const d = s.charCodeAt(i + 1);
+            if (d >= 0xdc00 && d < 0xe000) {
+                n--;
+                i++;
+            }
+        }
+    }
+    return n;
+}
+)";
+
+}  // namespace toolman::generator::typescript_runtime
+
+#endif  // TOOLMAN_TYPESCRIPT_RUNTIME_H_
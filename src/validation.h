@@ -0,0 +1,138 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_VALIDATION_H_
+#define TOOLMAN_VALIDATION_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+
+#include "src/custom_type.h"
+#include "src/field.h"
+#include "src/list_type.h"
+#include "src/map_type.h"
+#include "src/type.h"
+
+// Helpers shared by the validators of every target. A value is checked
+// against the constraints declared on the fields it is stored in, see
+// FieldConstraints, and every struct reachable from it through fields,
+// lists and maps is checked in turn. Validators stop at the first failure
+// and report it with a path such as `points[2].x` and a reason such as
+// `must be at most 100`.
+
+namespace toolman::generator {
+
+namespace validation_internal {
+inline bool needs_validation(const Type* type, std::set<const Type*>* seen) {
+  if (type->is_list()) {
+    return needs_validation(
+        dynamic_cast<const ListType*>(type)->get_elem_type().get(), seen);
+  } else if (type->is_map()) {
+    return needs_validation(
+        dynamic_cast<const MapType*>(type)->get_value_type().get(), seen);
+  } else if (!type->is_struct() || !seen->insert(type).second) {
+    return false;
+  }
+  for (const auto& field :
+       dynamic_cast<const StructType*>(type)->get_fields()) {
+    if (!field.get_constraints().empty() ||
+        needs_validation(field.get_type().get(), seen)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace validation_internal
+
+// Whether values of `type` have anything to check. Oneofs are not looked
+// into.
+inline bool needs_validation(const Type* type) {
+  std::set<const Type*> seen;
+  return validation_internal::needs_validation(type, &seen);
+}
+
+// Whether anything in the struct has to be checked by its validator
+// itself, rather than by the validators of the structs it holds.
+inline bool has_constraints(const StructType* struct_type) {
+  for (const auto& field : struct_type->get_fields()) {
+    if (!field.get_constraints().empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The reason a value is out of bounds, such as `length must be at least 1`.
+template <typename T>
+std::string bounds_reason(const std::string& what, const std::optional<T>& min,
+                          const std::optional<T>& max) {
+  auto text = [](const T& bound) {
+    if constexpr (std::is_same_v<T, std::string>) {
+      return bound;
+    } else {
+      return std::to_string(bound);
+    }
+  };
+  auto reason = what.empty() ? "must be " : what + " must be ";
+  if (min && max && *min == *max) {
+    return reason + text(*min);
+  } else if (min && max) {
+    return reason + "between " + text(*min) + " and " + text(*max);
+  } else if (min) {
+    return reason + "at least " + text(*min);
+  }
+  return reason + "at most " + text(*max);
+}
+
+// The condition under which the count `n` is out of bounds, empty if it
+// never is.
+inline std::string count_check(const std::string& n,
+                               const std::optional<std::uint64_t>& min,
+                               const std::optional<std::uint64_t>& max,
+                               const std::string& not_equal = "!=") {
+  if (min && max && *min == *max) {
+    return n + " " + not_equal + " " + std::to_string(*min);
+  }
+  std::string check;
+  if (min && *min > 0) {
+    check = n + " < " + std::to_string(*min);
+  }
+  if (max) {
+    check += (check.empty() ? "" : " || ") + n + " > " + std::to_string(*max);
+  }
+  return check;
+}
+
+// Spells `s` as a double quoted literal that Go, Java and TypeScript read
+// back the same.
+inline std::string quote_literal(const std::string& s) {
+  std::string quoted = "\"";
+  for (unsigned char c : s) {
+    if (c == '\\' || c == '"') {
+      quoted.push_back('\\');
+      quoted.push_back(static_cast<char>(c));
+    } else if (c == '\n') {
+      quoted += "\\n";
+    } else if (c == '\r') {
+      quoted += "\\r";
+    } else if (c == '\t') {
+      quoted += "\\t";
+    } else if (c < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      quoted += escaped;
+    } else {
+      quoted.push_back(static_cast<char>(c));
+    }
+  }
+  return quoted + "\"";
+}
+
+}  // namespace toolman::generator
+
+#endif  // TOOLMAN_VALIDATION_H_
@@ -19,9 +19,10 @@ void DeclPhaseWalker::enterImportStatement(
 void DeclPhaseWalker::exitImportStatement(
     ToolmanParser::ImportStatementContext *node) {
   import_builder_.end_import();
+  auto imports = import();
 
   // import regular imports.
-  for (auto const &[filename, import_names] : import().get_regular_imports()) {
+  for (auto const &[filename, import_names] : imports.get_regular_imports()) {
     std::shared_ptr<Module> module;
     try {
       module = compiler()->compile_module(filename);
@@ -47,7 +48,7 @@ void DeclPhaseWalker::exitImportStatement(
   }
 
   // import namespace.
-  for (auto const &filename : import().get_namespaces_imports()) {
+  for (auto const &filename : imports.get_namespaces_imports()) {
     std::shared_ptr<Module> module;
     try {
       module = compiler()->compile_module(filename);
@@ -55,13 +56,9 @@ void DeclPhaseWalker::exitImportStatement(
       push_error(UnresolvedImportError(filename));
       continue;
     }
-    for (auto it = module->type_scope()->cbegin();
-         it != module->type_scope()->cend(); it++) {
-      type_scope_->declare(it->second, it->first);
-    }
-    //    for (auto const&[name, type] : *module->type_scope()) {
-    //        type_scope_->declare(type, name);
-    //    }
+    // Chain instead of copying, names are resolved lazily on lookup so
+    // importing a module with n types costs O(1) here.
+    type_scope_->chain(module->type_scope());
   }
 }
 
@@ -6,10 +6,14 @@
 #define TOOLMAN_WALKER_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <stack>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -23,7 +27,9 @@
 #include "src/import.h"
 #include "src/list_type.h"
 #include "src/map_type.h"
+#include "src/primitive_type.h"
 #include "src/scope.h"
+#include "src/wire_format.h"
 
 namespace toolman {
 
@@ -38,6 +44,98 @@ StmtInfo get_stmt_info(NODE* node, SOURCE&& source) {
       std::forward<SOURCE>(source));
 }
 
+// Parses the text of an intgerLiteral, returns nullopt if it does not fit
+// in a uint64.
+inline std::optional<std::uint64_t> parse_unsigned_literal(
+    const std::string& text) {
+  int base = 10;
+  std::string::size_type start = 0;
+  if (text.size() > 2 && text[0] == '0') {
+    switch (text[1]) {
+      case 'x':
+      case 'X':
+        base = 16;
+        break;
+      case 'o':
+      case 'O':
+        base = 8;
+        break;
+      case 'b':
+      case 'B':
+        base = 2;
+        break;
+    }
+    start = base == 10 ? 0 : 2;
+  }
+  try {
+    return std::stoull(text.substr(start), nullptr, base);
+  } catch (std::out_of_range&) {
+    return std::nullopt;
+  }
+}
+
+// Parses the text of an intgerLiteral, returns -1 if it does not fit in an
+// int64.
+inline std::int64_t parse_integer_literal(const std::string& text) {
+  auto value = parse_unsigned_literal(text);
+  return value.has_value() && *value <= INT64_MAX
+             ? static_cast<std::int64_t>(*value)
+             : -1;
+}
+
+// A decimal integer bound of a constraint, as its sign and magnitude so that
+// bounds of every integer type compare exactly.
+struct IntegerBound {
+  bool negative;
+  std::uint64_t magnitude;
+};
+
+// Parses the decimal literal `bound`, returns nullopt if its magnitude does
+// not fit in a uint64.
+inline std::optional<IntegerBound> parse_integer_bound(
+    const std::string& bound) {
+  auto negative = bound[0] == '-';
+  auto magnitude = parse_unsigned_literal(bound.substr(negative ? 1 : 0));
+  if (!magnitude.has_value()) {
+    return std::nullopt;
+  }
+  return IntegerBound{negative && *magnitude != 0, *magnitude};
+}
+
+inline bool operator>(const IntegerBound& a, const IntegerBound& b) {
+  if (a.negative != b.negative) {
+    return b.negative;
+  }
+  return a.negative ? a.magnitude < b.magnitude : a.magnitude > b.magnitude;
+}
+
+// Whether the decimal literal `bound` of a constraint is a value of the
+// integer type `type`.
+inline bool integer_bound_fits(const std::string& bound,
+                               const PrimitiveType& type) {
+  auto parsed = parse_integer_bound(bound);
+  if (!parsed.has_value()) {
+    return false;
+  }
+  auto [negative, magnitude] = *parsed;
+  if (type.is_u32() || type.is_u64()) {
+    return negative ? magnitude == 0
+                    : type.is_u64() || magnitude <= UINT32_MAX;
+  }
+  auto max = type.is_i32() ? std::uint64_t{INT32_MAX} : INT64_MAX;
+  return magnitude <= (negative ? max + 1 : max);
+}
+
+// Whether the decimal literal `bound` of a constraint is a finite double.
+inline bool float_bound_fits(const std::string& bound) {
+  try {
+    std::stod(bound);
+    return true;
+  } catch (std::out_of_range&) {
+    return false;
+  }
+}
+
 class ImportBuilder {
  public:
   void start_import(std::string filename) {
@@ -54,6 +152,7 @@ class ImportBuilder {
       import_.add_import(current_filename_, std::move(current_import_names_));
     }
     current_import_names_.clear();
+    current_import_name_ = std::nullopt;
   }
 
   void start_import_name(std::string import_name) {
@@ -65,7 +164,7 @@ class ImportBuilder {
   }
 
   void start_import_name_alias(std::string alias_name) {
-    current_import_name_.value().original_name = std::move(alias_name);
+    current_import_name_.value().local_name = std::move(alias_name);
   }
 
   Import import() { return std::move(import_); }
@@ -180,6 +279,7 @@ class CustomTypeBuilder {
 
   void start_custom_type(std::shared_ptr<CustomType<FIELD>> custom_type) {
     current_custom_type_ = std::move(custom_type);
+    last_number_ = 0;
   }
 
   [[nodiscard]] std::shared_ptr<CustomType<FIELD>> end_custom_type() {
@@ -200,11 +300,17 @@ class CustomTypeBuilder {
       if (auto field_opt =
               current_custom_type_->get_field_by_name(current_field.get_name());
           field_opt.has_value()) {
+        clear_current_field();
         throw DuplicateFieldDeclError(field_opt.value(),
                                       current_field.get_stmt_info());
-      } else {
-        current_custom_type_->append_field(current_field);
       }
+      if constexpr (std::is_same_v<FIELD, Field>) {
+        number_field(&current_field);
+        check_constraints(current_field);
+      } else if constexpr (std::is_same_v<FIELD, EnumField>) {
+        check_enum_value(current_field);
+      }
+      current_custom_type_->append_field(current_field);
       clear_current_field();
     }
   }
@@ -223,8 +329,104 @@ class CustomTypeBuilder {
   }
 
  private:
+  // A field without a declared number gets the one after the previous
+  // field's.
+  void number_field(Field* field) {
+    if (field->get_number() == 0) {
+      field->set_number(last_number_ + 1);
+    }
+    last_number_ = field->get_number();
+    for (const auto& f : current_custom_type_->get_fields()) {
+      if (f.get_number() == field->get_number()) {
+        clear_current_field();
+        throw DuplicateFieldNumberError(f, field->get_stmt_info());
+      }
+    }
+  }
+
+  // Constraints must fit the type of their field, and bounds must be
+  // values of it, in order.
+  void check_constraints(const Field& field) {
+    const auto& constraints = field.get_constraints();
+    if (constraints.empty()) {
+      return;
+    }
+    auto fail = [&](const std::string& constraint, const std::string& problem) {
+      clear_current_field();
+      throw FieldConstraintError(constraint, problem, field.get_stmt_info());
+    };
+    // An unresolved type is already reported as not found.
+    auto type = field.get_type();
+    if (type == nullptr) {
+      return;
+    }
+    auto primitive = type->is_primitive()
+                         ? std::dynamic_pointer_cast<PrimitiveType>(type)
+                         : nullptr;
+    auto is_number = primitive != nullptr && primitive->is_numeric();
+    auto is_string = primitive != nullptr && primitive->is_string();
+
+    for (const auto& [name, bound] :
+         {std::pair{"min", constraints.min}, {"max", constraints.max}}) {
+      if (!bound.has_value()) {
+        continue;
+      }
+      if (!is_number) {
+        fail(name, "only applies to numbers");
+      }
+      auto fits = primitive->is_float()
+                      ? float_bound_fits(*bound)
+                      : bound->find_first_of(".eE") == std::string::npos &&
+                            integer_bound_fits(*bound, *primitive);
+      if (!fits) {
+        fail(name, "must be a value of " + primitive->get_name());
+      }
+    }
+    // Integer bounds are compared exactly, a double cannot tell apart the
+    // large values of an i64 or u64.
+    if (constraints.min && constraints.max &&
+        (primitive->is_float()
+             ? std::stod(*constraints.min) > std::stod(*constraints.max)
+             : *parse_integer_bound(*constraints.min) >
+                   *parse_integer_bound(*constraints.max))) {
+      fail("min", "is greater than max");
+    }
+    if ((constraints.min_len || constraints.max_len) && !is_string) {
+      fail(constraints.min_len ? "min_len" : "max_len",
+           "only applies to strings");
+    }
+    if (constraints.pattern && !is_string) {
+      fail("pattern", "only applies to strings");
+    }
+    if (constraints.min_len && constraints.max_len &&
+        *constraints.min_len > *constraints.max_len) {
+      fail("min_len", "is greater than max_len");
+    }
+    if ((constraints.min_items || constraints.max_items) &&
+        !type->is_list() && !type->is_map()) {
+      fail(constraints.min_items ? "min_items" : "max_items",
+           "only applies to lists and maps");
+    }
+    if (constraints.min_items && constraints.max_items &&
+        *constraints.min_items > *constraints.max_items) {
+      fail("min_items", "is greater than max_items");
+    }
+  }
+
+  // Values are unique within one enum only.
+  void check_enum_value(const EnumField& field) {
+    auto enum_type = std::static_pointer_cast<EnumType>(current_custom_type_);
+    if (auto first = enum_type->get_field_by_value(field.get_value());
+        first.has_value()) {
+      clear_current_field();
+      throw DuplicateEnumFieldValueError(first.value(),
+                                         field.get_stmt_info());
+    }
+  }
+
   std::optional<FIELD> current_field_;
   std::shared_ptr<CustomType<FIELD>> current_custom_type_;
+  std::uint32_t last_number_ = 0;
 };
 
 class ApiBuilder {
@@ -240,11 +442,35 @@ class ApiBuilder {
     api_ = std::make_optional(Api(http_method, std::move(body_param)));
   }
 
-  void end_api() {
-    if (api_group_.has_value() && api_.has_value()) {
-      api_group_.value().add_api(api_.value());
-      api_ = std::nullopt;
+  // Apis of a group that share a method must differ in their paths once
+  // params are ignored, or a router could not tell them apart.
+  template <typename SI>
+  void end_api(SI&& stmt_info) {
+    if (!api_group_.has_value() || !api_.has_value()) {
+      return;
+    }
+    auto api = std::move(api_.value());
+    api_ = std::nullopt;
+    for (const auto& other : api_group_->get_apis()) {
+      if (other.get_http_method() == api.get_http_method() &&
+          other.get_path() == api.get_path() &&
+          std::equal(other.get_path_params().begin(),
+                     other.get_path_params().end(),
+                     api.get_path_params().begin(),
+                     api.get_path_params().end(),
+                     [](const PathParam& a, const PathParam& b) {
+                       return a.pos_in_path == b.pos_in_path;
+                     })) {
+        auto path = api.get_path();
+        const auto& params = api.get_path_params();
+        for (auto param = params.rbegin(); param != params.rend(); ++param) {
+          path.insert(param->pos_in_path,
+                      "{" + param->field.get_name() + "}");
+        }
+        throw DuplicateRouteError(path, std::forward<SI>(stmt_info));
+      }
     }
+    api_group_->add_api(std::move(api));
   }
 
   void start_field(Field field) {
@@ -253,29 +479,46 @@ class ApiBuilder {
 
   void clear_current_field() { current_field_ = std::nullopt; }
 
+  void set_current_field_type(std::shared_ptr<Type> type) {
+    if (current_field_.has_value()) {
+      current_field_->set_type(std::move(type));
+    }
+  }
+
   void end_field() {
+    if (!current_field_.has_value() || param_positions_.empty()) {
+      return;
+    }
+    auto current_field = current_field_.value();
+    clear_current_field();
+    auto pos_in_path = param_positions_.front();
+    param_positions_.pop();
     if (!api_.has_value()) {
       return;
     }
-    auto api = api_.value();
-    if (current_field_.has_value()) {
-      auto current_field = current_field_.value();
-      if (auto param_opt = api.get_path_param_by_name(current_field.get_name());
-          param_opt.has_value()) {
-        throw DuplicatePathParamDeclError(current_field,
-                                          current_field.get_stmt_info());
-      } else {
-        api.add_path_param(
-            PathParam{current_field_.value(), current_path_.length()});
-      }
-      clear_current_field();
+    if (auto param_opt = api_->get_path_param_by_name(current_field.get_name());
+        param_opt.has_value()) {
+      throw DuplicatePathParamDeclError(current_field,
+                                        current_field.get_stmt_info());
+    }
+    // Params are parsed out of the URL, only scalars have a text form.
+    auto type = current_field.get_type();
+    if (type != nullptr && !type->is_enum() &&
+        !(type->is_primitive() &&
+          !std::dynamic_pointer_cast<PrimitiveType>(type)->is_any())) {
+      throw PathParamTypeError(current_field, current_field.get_stmt_info());
     }
+    api_->add_path_param(PathParam{current_field, pos_in_path});
   }
 
   void append_path(const std::string& partial_path) {
     current_path_.append(partial_path);
   }
 
+  // Params are left out of the path text, each is recorded by its offset
+  // into the text, which is known before the param's field is built.
+  void append_path_param() { param_positions_.push(current_path_.length()); }
+
   void end_path() {
     if (api_.has_value()) {
       api_->set_path(current_path_);
@@ -283,6 +526,25 @@ class ApiBuilder {
     current_path_.clear();
   }
 
+  // Each param must make up a whole path segment, so a router can take
+  // everything up to the next slash as its value.
+  void check_path_params() const {
+    if (!api_.has_value()) {
+      return;
+    }
+    const auto& path = api_->get_path();
+    auto last = std::string::npos;
+    for (const auto& param : api_->get_path_params()) {
+      auto pos = param.pos_in_path;
+      if ((pos != 0 && path[pos - 1] != '/') ||
+          (pos != path.size() && path[pos] != '/') || pos == last) {
+        throw PathParamSegmentError(param.field,
+                                    param.field.get_stmt_info());
+      }
+      last = pos;
+    }
+  }
+
   void insert_api_return(ApiReturn api_return) {
     if (api_.has_value()) {
       api_->insert_api_return(std::move(api_return));
@@ -292,6 +554,7 @@ class ApiBuilder {
  private:
   std::optional<Field> current_field_;
   std::string current_path_;
+  std::queue<std::string::size_type> param_positions_;
   std::optional<Api> api_;
   std::optional<ApiGroup> api_group_;
 };
@@ -313,7 +576,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
         option_scope_(std::move(option_scope)),
         source_(std::move(source)),
         enum_builder_(),
-        build_state_(BuildState::IN_STRUCT) {}
+        build_state_(BuildState::IN_STRUCT),
+        path_param_outer_state_(BuildState::IN_STRUCT) {}
   std::unique_ptr<Document> get_document() {
     return std::unique_ptr<Document>(document_.release());
   }
@@ -341,7 +605,9 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
       } else if (option_value_node->StringLiteral() != nullptr &&
                  search->is_string()) {
         auto string_option = std::dynamic_pointer_cast<StringOption>(search);
-        string_option->set_value(option_value_node->StringLiteral()->getText());
+        // Strip the surrounding quotes of the literal.
+        auto literal = option_value_node->StringLiteral()->getText();
+        string_option->set_value(literal.substr(1, literal.length() - 2));
         document_->insert_option(string_option);
       } else if (option_value_node->numericLiteral() != nullptr &&
                  search->is_numeric()) {
@@ -389,6 +655,26 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
     auto field = Field(node->identifierName()->getText(),
                        get_stmt_info(node, source_), comments);
     field.set_optional(node->QuestionMark() != nullptr);
+    if (auto field_number = node->fieldNumber(); field_number != nullptr) {
+      auto text = field_number->intgerLiteral()->getText();
+      auto number = parse_integer_literal(text);
+      if (number < 1 || number > wire_format::kMaxFieldNumber) {
+        push_error(FieldNumberOutOfRangeError(
+            text, get_stmt_info(field_number, source_)));
+      } else {
+        field.set_number(static_cast<std::uint32_t>(number));
+      }
+    }
+    if (auto constraints = node->fieldConstraints(); constraints != nullptr) {
+      if (build_state_ == BuildState::IN_STRUCT) {
+        field.set_constraints(read_constraints(constraints));
+      } else {
+        push_error(FieldConstraintError(
+            constraints->fieldConstraint(0)->identifierName()->getText(),
+            "only applies to struct fields",
+            get_stmt_info(constraints, source_)));
+      }
+    }
     if (build_state_ == BuildState::IN_STRUCT) {
       struct_builder_.start_field(field);
     } else if (build_state_ == BuildState::IN_ONEOF) {
@@ -398,6 +684,71 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
     }
   }
 
+  // Reads the constraints declared on a struct field. Whether they fit its
+  // type is checked once the type is known, see check_constraints.
+  FieldConstraints read_constraints(
+      ToolmanParser::FieldConstraintsContext* node) {
+    FieldConstraints constraints;
+    for (auto* constraint : node->fieldConstraint()) {
+      auto name = constraint->identifierName()->getText();
+      auto value = constraint->constraintValue();
+      auto stmt_info = get_stmt_info(constraint, source_);
+      // Integers are spelled in decimal, whatever base they were written in.
+      std::optional<std::string> number;
+      std::optional<std::uint64_t> count;
+      if (auto literal = value->numericLiteral(); literal != nullptr) {
+        auto sign = value->Minus() != nullptr ? "-" : "";
+        if (literal->DecimalLiteral() != nullptr) {
+          number = sign + literal->getText();
+        } else if (auto n = parse_unsigned_literal(literal->getText());
+                   n.has_value()) {
+          number = sign + std::to_string(*n);
+          count = value->Minus() == nullptr ? n : std::nullopt;
+        }
+      }
+      auto set = [&](auto* slot, const auto& parsed, const char* expected) {
+        if (slot->has_value()) {
+          push_error(FieldConstraintError(name, "is declared twice",
+                                          std::move(stmt_info)));
+        } else if (!parsed.has_value()) {
+          push_error(FieldConstraintError(name, std::string("must be ") +
+                                                    expected,
+                                          std::move(stmt_info)));
+        } else {
+          *slot = parsed;
+        }
+      };
+      if (name == "min") {
+        set(&constraints.min, number, "a number");
+      } else if (name == "max") {
+        set(&constraints.max, number, "a number");
+      } else if (name == "len") {
+        set(&constraints.min_len, count, "a non-negative integer");
+        constraints.max_len = constraints.min_len;
+      } else if (name == "min_len") {
+        set(&constraints.min_len, count, "a non-negative integer");
+      } else if (name == "max_len") {
+        set(&constraints.max_len, count, "a non-negative integer");
+      } else if (name == "min_items") {
+        set(&constraints.min_items, count, "a non-negative integer");
+      } else if (name == "max_items") {
+        set(&constraints.max_items, count, "a non-negative integer");
+      } else if (name == "pattern") {
+        std::optional<std::string> pattern;
+        if (auto literal = value->StringLiteral(); literal != nullptr) {
+          // The text between the quotes is the expression, backslashes and
+          // all.
+          pattern = literal->getText().substr(1, literal->getText().size() - 2);
+        }
+        set(&constraints.pattern, pattern, "a string");
+      } else {
+        push_error(
+            FieldConstraintError(name, "is unknown", std::move(stmt_info)));
+      }
+    }
+    return constraints;
+  }
+
   void exitStructField(ToolmanParser::StructFieldContext* node) override {
     try {
       if (build_state_ == BuildState::IN_STRUCT) {
@@ -409,6 +760,14 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
       }
     } catch (DuplicateFieldDeclError& e) {
       push_error(e);
+    } catch (DuplicateFieldNumberError& e) {
+      push_error(e);
+    } catch (DuplicatePathParamDeclError& e) {
+      push_error(e);
+    } catch (PathParamTypeError& e) {
+      push_error(e);
+    } catch (FieldConstraintError& e) {
+      push_error(e);
     }
   }
 
@@ -427,6 +786,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
         struct_builder_.set_current_field_type(type);
       } else if (build_state_ == BuildState::IN_ONEOF) {
         oneof_builder_.set_current_field_type(type);
+      } else if (build_state_ == BuildState::IN_API_PATH_PARAM) {
+        api_builder_.set_current_field_type(type);
       }
     }
   }
@@ -451,6 +812,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
         struct_builder_.set_current_field_type(type);
       } else if (build_state_ == BuildState::IN_ONEOF) {
         oneof_builder_.set_current_field_type(type);
+      } else if (build_state_ == BuildState::IN_API_PATH_PARAM) {
+        api_builder_.set_current_field_type(type);
       }
     }
   }
@@ -493,13 +856,16 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
         struct_builder_.set_current_field_type(type);
       } else if (build_state_ == BuildState::IN_ONEOF) {
         oneof_builder_.set_current_field_type(type);
+      } else if (build_state_ == BuildState::IN_API_PATH_PARAM) {
+        api_builder_.set_current_field_type(type);
       }
     }
   }
 
   void enterCustomTypeName(
       ToolmanParser::CustomTypeNameContext* node) override {
-    auto custom_type = type_scope_->lookup(node->identifierName()->getText());
+    auto custom_type = lookup_type(node->identifierName()->getText(),
+                                   get_stmt_info(node, source_));
     if (!custom_type.has_value()) {
       push_error(CustomTypeNotFoundError(node->identifierName()->getText(),
                                          get_stmt_info(node, source_)));
@@ -514,6 +880,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
         struct_builder_.set_current_field_type(type);
       } else if (build_state_ == BuildState::IN_ONEOF) {
         oneof_builder_.set_current_field_type(type);
+      } else if (build_state_ == BuildState::IN_API_PATH_PARAM) {
+        api_builder_.set_current_field_type(type);
       }
     }
   }
@@ -552,13 +920,7 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
     auto enum_field = EnumField(node->identifierName()->getText(),
                                 get_stmt_info(node, source_), comments);
 
-    auto value = std::stoi(node->intgerLiteral()->getText());
-    if (!enum_field.set_value(value)) {
-      push_error(
-          DuplicateEnumFieldValueError(EnumField::get_by_value(value).value(),
-                                       get_stmt_info(node, source_)));
-      return;
-    }
+    enum_field.set_value(std::stoi(node->intgerLiteral()->getText()));
     enum_builder_.start_field(enum_field);
   }
 
@@ -567,6 +929,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
       enum_builder_.end_field();
     } catch (DuplicateFieldDeclError& e) {
       push_error(e);
+    } catch (DuplicateEnumFieldValueError& e) {
+      push_error(e);
     }
   }
 
@@ -589,9 +953,14 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
   }
 
   void enterPathParam(ToolmanParser::PathParamContext*) override {
+    path_param_outer_state_ = build_state_;
     build_state_ = BuildState::IN_API_PATH_PARAM;
   }
 
+  void exitPathParam(ToolmanParser::PathParamContext*) override {
+    build_state_ = path_param_outer_state_;
+  }
+
   void enterApiDecl(ToolmanParser::ApiDeclContext* node) override {
     api_builder_.start_api_group(node->identifierName()->getText());
   }
@@ -634,7 +1003,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
 
     auto api_body_param_ident = node->identifierName();
     auto api_body_param_opt =
-        type_scope_->lookup(api_body_param_ident->getText());
+        lookup_type(api_body_param_ident->getText(),
+                    get_stmt_info(api_body_param_ident, source_));
     if (!api_body_param_opt.has_value()) {
       push_error(CustomTypeNotFoundError(
           api_body_param_ident->getText(),
@@ -644,36 +1014,45 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
     api_builder_.start_api(http_method, api_body_param_opt.value());
   }
 
-  void exitSingleApiDecl(ToolmanParser::SingleApiDeclContext*) override {
-    api_builder_.end_api();
+  void exitSingleApiDecl(ToolmanParser::SingleApiDeclContext* node) override {
+    try {
+      api_builder_.end_api(get_stmt_info(node, source_));
+    } catch (DuplicateRouteError& e) {
+      push_error(e);
+    }
   }
 
   void enterPath(ToolmanParser::PathContext* node) override {
     for (auto child : node->children) {
-      if (child == nullptr) {
-        continue;
-      }
-      if (typeid(child) == typeid(antlr4::tree::TerminalNode*)) {
-        auto slash = dynamic_cast<antlr4::tree::TerminalNode*>(child);
+      if (auto slash = dynamic_cast<antlr4::tree::TerminalNode*>(child);
+          slash != nullptr) {
         api_builder_.append_path(slash->getText());
-      } else if (typeid(child) == typeid(ToolmanParser::PathStringContext*)) {
-        auto path_string =
-            dynamic_cast<ToolmanParser::PathStringContext*>(child);
+      } else if (auto path_string =
+                     dynamic_cast<ToolmanParser::PathStringContext*>(child);
+                 path_string != nullptr) {
         api_builder_.append_path(path_string->getText());
+      } else if (dynamic_cast<ToolmanParser::PathParamContext*>(child) !=
+                 nullptr) {
+        api_builder_.append_path_param();
       }
     }
+    api_builder_.end_path();
   }
 
   void exitPath(ToolmanParser::PathContext*) override {
-    api_builder_.end_path();
+    try {
+      api_builder_.check_path_params();
+    } catch (PathParamSegmentError& e) {
+      push_error(e);
+    }
   }
 
   void enterReturnsItem(ToolmanParser::ReturnsItemContext* node) override {
     auto status_code = std::stoi(node->DecIntegerLiteral()->getText());
     std::shared_ptr<Type> return_type;
-    if (nullptr == node->identifierName()) {
-      auto return_type_opt =
-          type_scope_->lookup(node->identifierName()->getText());
+    if (nullptr != node->identifierName()) {
+      auto return_type_opt = lookup_type(node->identifierName()->getText(),
+                                         get_stmt_info(node, source_));
       if (!return_type_opt.has_value()) {
         push_error(CustomTypeNotFoundError(node->identifierName()->getText(),
                                            get_stmt_info(node, source_)));
@@ -685,6 +1064,24 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
   }
 
  private:
+  // Resolves a type reference. Types declared or explicitly imported in this
+  // file shadow the ones brought in by `import *`; a name provided by more
+  // than one `import *` and not shadowed is reported as ambiguous.
+  std::optional<std::shared_ptr<Type>> lookup_type(const std::string& name,
+                                                   const StmtInfo& stmt_info) {
+    if (auto local = type_scope_->lookup_local(name); local.has_value()) {
+      return local;
+    }
+    auto candidates = type_scope_->lookup_chained(name);
+    if (candidates.empty()) {
+      return std::nullopt;
+    }
+    if (candidates.size() > 1) {
+      push_error(AmbiguousTypeError(name, stmt_info));
+    }
+    return candidates.front();
+  }
+
   std::unique_ptr<Document> document_;
   CustomTypeBuilder<Field> struct_builder_;
   FieldTypeBuilder field_type_builder_;
@@ -694,6 +1091,8 @@ class RefPhaseWalker final : public ToolmanParserBaseListener,
   std::shared_ptr<OptionScope> option_scope_;
   std::shared_ptr<std::filesystem::path> source_;
   BuildState build_state_;
+  // What build_state_ was before the path param being walked.
+  BuildState path_param_outer_state_;
   ApiBuilder api_builder_;
 };
 
@@ -0,0 +1,116 @@
+// Copyright 2020 the Toolman project authors. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef TOOLMAN_WIRE_FORMAT_H_
+#define TOOLMAN_WIRE_FORMAT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "src/custom_type.h"
+#include "src/list_type.h"
+#include "src/map_type.h"
+#include "src/primitive_type.h"
+#include "src/type.h"
+
+// The toolman binary wire format, shared by the codecs of every target.
+//
+// A struct is encoded as a sequence of fields, each one a key followed by a
+// value. The key is the varint `number << 3 | wire_type`, where `number` is
+// the field number (declared as `name: type = 3`, otherwise one more than
+// the previous field's, starting at 1) and `wire_type` is one of:
+//
+//   0 varint            bool, i32, u32, i64, u64, enums
+//   1 fixed64           float
+//   2 length-delimited  string, any, structs, lists, maps, oneofs
+//
+// Values:
+//   - varint: unsigned LEB128, least significant group first.
+//   - bool: varint 0 or 1.
+//   - u32, u64: varint.
+//   - i32, i64, enums: zigzag then varint, (n << 1) ^ (n >> 63).
+//   - float: the IEEE 754 binary64 bits, little-endian.
+//   - string: varint byte length, then UTF-8.
+//   - any: like a string, holding the value's JSON text.
+//   - struct: varint byte length, then its fields.
+//   - list: varint byte length, then a varint element count followed by the
+//     elements' values without keys.
+//   - map: varint byte length, then a varint entry count followed by each
+//     entry's key value and value value without keys.
+//   - oneof: varint byte length, then the one alternative that is set,
+//     encoded like a field. Alternatives are numbered like the fields of a
+//     struct. Empty if none is set.
+//
+// Optional fields that are not set, and lists, maps, structs and oneofs
+// that are null, are left out; every other field is written in declaration
+// order. Decoders use the wire type to skip fields with numbers they do not
+// know, so fields can be added without breaking old readers. A field whose
+// wire type does not match its declaration is an error. Fields left out of
+// the input keep their zero value.
+//
+// Worked examples, bytes in hex, given
+//
+//   type Item struct {
+//     id: i64,
+//     name: string,
+//     tags: [u32],
+//     kind: (count: i32 | label: string) = 5,
+//   }
+//
+//   {id: -3, name: "hi", tags: [1, 300], kind: {label: "x"}}
+//     08 05                id = 1 varint, zigzag(-3) = 5
+//     12 02 68 69          name = 2 length-delimited, "hi"
+//     1a 04 02 01 ac 02    tags = 3, 4 bytes: count 2, 1, 300
+//     2a 03 12 01 78       kind = 5, 3 bytes: label = 2, "x"
+//
+//   type Point struct { x: float, y: float }
+//   {x: 1.5, y: -2}
+//     09 00 00 00 00 00 00 f8 3f
+//     11 00 00 00 00 00 00 00 c0
+//
+//   a {string: i32} value {"a": -1}
+//     04 01 01 61 01       4 bytes: count 1, "a", zigzag(-1) = 1
+
+namespace toolman::wire_format {
+
+enum class WireType : std::uint8_t {
+  Varint = 0,
+  Fixed64 = 1,
+  LengthDelimited = 2,
+};
+
+// Keys are 32-bit varints, which leaves 29 bits for the field number.
+constexpr std::uint32_t kMaxFieldNumber = (1u << 29) - 1;
+
+inline WireType wire_type_of(const Type* type) {
+  if (type->is_enum()) {
+    return WireType::Varint;
+  }
+  if (type->is_primitive()) {
+    auto primitive = dynamic_cast<const PrimitiveType*>(type);
+    if (primitive->is_float()) {
+      return WireType::Fixed64;
+    }
+    if (!primitive->is_string() && !primitive->is_any()) {
+      return WireType::Varint;
+    }
+  }
+  return WireType::LengthDelimited;
+}
+
+// Returns the bytes of the key for field `number` holding a `type`.
+inline std::string encode_key(std::uint32_t number, const Type* type) {
+  std::string key;
+  auto value = (number << 3) | static_cast<std::uint32_t>(wire_type_of(type));
+  while (value >= 0x80) {
+    key.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  key.push_back(static_cast<char>(value));
+  return key;
+}
+
+}  // namespace toolman::wire_format
+
+#endif  // TOOLMAN_WIRE_FORMAT_H_
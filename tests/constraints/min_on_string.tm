@@ -0,0 +1,6 @@
+// `min` bounds numbers, a string must be rejected.
+type (
+    Shape struct {
+        name: string [min: 1]
+    }
+)
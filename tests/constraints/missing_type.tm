@@ -0,0 +1,7 @@
+// A field of an unknown type reports the type, its constraints are not
+// checked.
+type (
+    Shape struct {
+        points: Missing [max_items: 3]
+    }
+)
@@ -0,0 +1,161 @@
+// Compares building, copying and destroying a request-sized Shape with the
+// default allocator and with cpp_arena over a per-request monotonic buffer.
+// Prints the time and the operator new calls per request, in the format of
+// Go benchmarks. The number of requests comes from the command line, which
+// ctest sets to 1 to keep the benchmark running.
+
+#include "arena/examples.h"
+#include "heap/examples.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <optional>
+
+namespace {
+
+long allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kText = "a value long enough to need its own allocation";
+char keys[32][96];
+
+// About 200 strings, lists and map nodes.
+template <typename Shape>
+void fill(Shape& shape) {
+  shape.id = 1;
+  shape.name = kText;
+  if constexpr (std::uses_allocator_v<Shape, toolman::Allocator>) {
+    toolman::emplace(shape.label, shape.get_allocator(), kText);
+  } else {
+    shape.label.emplace(kText);
+  }
+  for (int i = 0; i < 64; ++i) {
+    auto& point = shape.points.emplace_back();
+    point.x = i;
+    point.y = -i;
+    shape.ids.push_back(i);
+    shape.weights.push_back(i * 0.5);
+  }
+  for (const auto* key : keys) {
+    shape.tags.emplace(key, kText);
+  }
+  for (int i = 0; i < 16; ++i) {
+    shape.by_id[i].x = i;
+  }
+  for (int i = 0; i < 8; ++i) {
+    auto& row = shape.matrix.emplace_back();
+    for (int j = 0; j < 8; ++j) {
+      row.push_back(j);
+    }
+  }
+}
+
+// Accumulates the time and the allocations of one step of a request.
+class Step {
+ public:
+  template <typename F>
+  void run(F&& f) {
+    long before = allocations;
+    auto start = Clock::now();
+    f();
+    ns_ += std::chrono::duration<double, std::nano>(Clock::now() - start)
+               .count();
+    allocations_ += allocations - before;
+  }
+
+  void print(const char* name, int n) const {
+    std::printf("%s\t%d\t%.0f ns/op\t%.0f allocs/op\n", name, n, ns_ / n,
+                static_cast<double>(allocations_) / n);
+  }
+
+ private:
+  double ns_ = 0;
+  long allocations_ = 0;
+};
+
+std::size_t sink = 0;
+
+void bench_heap(int n) {
+  using bench::heap::Shape;
+  Step build, copy, destroy;
+  for (int i = 0; i < n; ++i) {
+    std::optional<Shape> shape;
+    std::optional<Shape> other;
+    build.run([&] { fill(shape.emplace()); });
+    copy.run([&] { other.emplace(*shape); });
+    sink += other->tags.size();
+    destroy.run([&] {
+      shape.reset();
+      other.reset();
+    });
+  }
+  build.print("BenchmarkBuild/default", n);
+  copy.print("BenchmarkCopy/default", n);
+  destroy.print("BenchmarkDestroy/default", n);
+}
+
+// With `destruct`, runs the destructors before releasing the arena, which
+// messages that hold nothing but arena memory can skip.
+void bench_arena(int n, bool destruct) {
+  using bench::arena::Shape;
+  alignas(std::max_align_t) static char buffer[256 << 10];
+  Step build, copy, destroy;
+  for (int i = 0; i < n; ++i) {
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof buffer);
+    Shape* shape = nullptr;
+    Shape* other = nullptr;
+    build.run([&] {
+      shape = toolman::arena_new<Shape>(arena);
+      fill(*shape);
+    });
+    copy.run([&] { other = toolman::arena_new<Shape>(arena, *shape); });
+    sink += other->tags.size();
+    destroy.run([&] {
+      if (destruct) {
+        shape->~Shape();
+        other->~Shape();
+      }
+      arena.release();
+    });
+  }
+  if (destruct) {
+    destroy.print("BenchmarkDestroy/arena_destructors", n);
+    return;
+  }
+  build.print("BenchmarkBuild/arena", n);
+  copy.print("BenchmarkCopy/arena", n);
+  destroy.print("BenchmarkDestroy/arena", n);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 20000;
+  for (int i = 0; i < 32; ++i) {
+    std::snprintf(keys[i], sizeof keys[i], "%s %d", kText, i);
+  }
+  bench_heap(n);
+  bench_arena(n, false);
+  bench_arena(n, true);
+  return sink == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
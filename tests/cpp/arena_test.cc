@@ -0,0 +1,224 @@
+// Checks that cpp_arena messages allocate everything they hold from their
+// allocator: when built, copied, moved and assigned, and as elements of
+// std::pmr containers.
+
+#include "examples.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+long allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using examples::Point;
+using examples::Shape;
+using examples::ShapeRadius;
+using examples::ShapeShapeKind;
+using examples::ShapeText;
+using Resource = std::pmr::memory_resource;
+
+int failures = 0;
+
+#define CHECK(condition)                                                \
+  do {                                                                  \
+    if (!(condition)) {                                                 \
+      std::fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, \
+                   #condition);                                         \
+      ++failures;                                                       \
+    }                                                                   \
+  } while (0)
+
+template <typename T>
+struct IsContainer : std::false_type {};
+template <typename T>
+struct IsContainer<std::pmr::vector<T>> : std::true_type {};
+template <typename K, typename V>
+struct IsContainer<std::pmr::map<K, V>> : std::true_type {};
+template <typename T>
+struct IsOptional : std::false_type {};
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+template <typename T>
+struct IsVariant : std::false_type {};
+template <typename... T>
+struct IsVariant<std::variant<T...>> : std::true_type {};
+template <typename T>
+struct IsPair : std::false_type {};
+template <typename K, typename V>
+struct IsPair<std::pair<K, V>> : std::true_type {};
+template <typename T, typename = void>
+struct IsMessage : std::false_type {};
+template <typename T>
+struct IsMessage<T, std::void_t<typename T::allocator_type>>
+    : std::true_type {};
+
+// Checks that everything `value` holds allocates from `resource`.
+template <typename T>
+void check_resource(const T& value, Resource* resource) {
+  if constexpr (std::is_same_v<T, std::pmr::string>) {
+    CHECK(value.get_allocator().resource() == resource);
+  } else if constexpr (IsOptional<T>::value) {
+    if (value) {
+      check_resource(*value, resource);
+    }
+  } else if constexpr (IsVariant<T>::value) {
+    std::visit(
+        [resource](const auto& alternative) {
+          using A = std::decay_t<decltype(alternative)>;
+          if constexpr (!std::is_same_v<A, std::monostate>) {
+            check_resource(alternative, resource);
+          }
+        },
+        value);
+  } else if constexpr (IsContainer<T>::value) {
+    CHECK(value.get_allocator().resource() == resource);
+    for (const auto& element : value) {
+      check_resource(element, resource);
+    }
+  } else if constexpr (IsPair<T>::value) {
+    check_resource(value.first, resource);
+    check_resource(value.second, resource);
+  } else if constexpr (IsMessage<T>::value) {
+    CHECK(value.get_allocator().resource() == resource);
+    toolman::for_each_field<T>([&value, resource](const auto& field) {
+      check_resource(value.*(field.member), resource);
+    });
+  }
+}
+
+// Too long for the small string buffer, so strings allocate.
+const char* const kLong =
+    "a string that is much too long for the small string buffer";
+
+void fill(Shape& shape) {
+  auto alloc = shape.get_allocator();
+  shape.id = 7;
+  shape.name = kLong;
+  toolman::emplace(shape.label, alloc, kLong);
+  toolman::emplace(shape.anchor, alloc).x = 2;
+  // std::optional::emplace allocates from the allocator it is given.
+  shape.extra.emplace(kLong, alloc);
+  for (int i = 0; i < 50; ++i) {
+    shape.points.emplace_back().x = i;
+    shape.ids.push_back(i);
+    shape.weights.push_back(i);
+  }
+  for (int i = 0; i < 10; ++i) {
+    char key[128];
+    std::snprintf(key, sizeof key, "%d %s", i, kLong);
+    shape.tags.emplace(key, kLong);
+    shape.by_id[i].y = i;
+    shape.matrix.emplace_back(10, i);
+  }
+  toolman::emplace<ShapeText>(shape.shape_kind, alloc).text = kLong;
+}
+
+bool same(const Shape& a, const Shape& b) {
+  return a.name == b.name && a.label == b.label &&
+         a.anchor->x == b.anchor->x && a.extra == b.extra &&
+         a.points.size() == b.points.size() &&
+         a.points.back().x == b.points.back().x && a.tags == b.tags &&
+         a.by_id.at(9).y == b.by_id.at(9).y && a.matrix == b.matrix &&
+         std::get<ShapeText>(a.shape_kind).text ==
+             std::get<ShapeText>(b.shape_kind).text;
+}
+
+static_assert(std::uses_allocator_v<Shape, toolman::Allocator>);
+static_assert(std::is_nothrow_move_constructible_v<Point>);
+
+}  // namespace
+
+int main() {
+  alignas(std::max_align_t) static char buffer[1 << 20];
+  std::pmr::monotonic_buffer_resource first(buffer, sizeof buffer,
+                                            std::pmr::null_memory_resource());
+  long before = allocations;
+  Shape* shape = toolman::arena_new<Shape>(first);
+  fill(*shape);
+  CHECK(allocations == before);
+  check_resource(*shape, &first);
+
+  // Copies with an allocator allocate from it. Plain copies use the default
+  // resource, like the std::pmr containers.
+  std::pmr::monotonic_buffer_resource second;
+  Shape copy(*shape, toolman::Allocator(&second));
+  check_resource(copy, &second);
+  Shape heap = *shape;
+  check_resource(heap, std::pmr::get_default_resource());
+  CHECK(same(*shape, copy));
+  CHECK(same(*shape, heap));
+  // Releasing the arena frees the message at once. Poison it, so that a copy
+  // still pointing into it fails.
+  first.release();
+  std::memset(buffer, 0xab, sizeof buffer);
+  CHECK(same(copy, heap));
+
+  // Assignment keeps the resource of the message assigned to, also for
+  // optional and oneof fields.
+  std::pmr::monotonic_buffer_resource third;
+  Shape target{toolman::Allocator(&third)};
+  target = heap;
+  check_resource(target, &third);
+  CHECK(same(target, heap));
+  target = std::move(copy);
+  check_resource(target, &third);
+  heap.shape_kind = ShapeRadius{};
+  target = heap;
+  CHECK(std::holds_alternative<ShapeRadius>(target.shape_kind));
+  ShapeText text{toolman::Allocator(&second)};
+  text.text = kLong;
+  toolman::assign(target.shape_kind, ShapeShapeKind(std::move(text)),
+                  target.get_allocator());
+  check_resource(target, &third);
+  target.label = std::nullopt;
+  toolman::assign(target.label, heap.label, target.get_allocator());
+  check_resource(target, &third);
+
+  // Moves with an allocator move into it, plain moves keep the source's.
+  Shape moved(std::move(target), toolman::Allocator(&second));
+  check_resource(moved, &second);
+  Shape moved_again(std::move(moved));
+  check_resource(moved_again, &second);
+
+  // Containers of messages pass their resource on, also when they grow.
+  std::pmr::vector<Shape> list(&third);
+  for (int i = 0; i < 20; ++i) {
+    list.push_back(heap);
+  }
+  check_resource(list, &third);
+  std::pmr::map<std::int64_t, Shape> map(&third);
+  map.emplace(1, heap);
+  map[2] = heap;
+  check_resource(map, &third);
+  std::pmr::vector<Shape> other(&second);
+  other = list;
+  check_resource(other, &second);
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,491 @@
+// Round-trips messages through a JSON writer and reader that know nothing
+// of examples.tm but what the generated descriptors tell them, the way
+// reflection-based libraries use them. Built with -Wall -Wextra -Werror, so
+// it also checks that the generated header compiles cleanly.
+
+#include "examples.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using examples::Color;
+using examples::Holes;
+using examples::Item;
+using examples::ItemLabel;
+using examples::Mixed;
+using examples::Point;
+using examples::Shape;
+using examples::ShapeOrigin;
+using examples::ShapeText;
+using examples::Status;
+using toolman::Descriptor;
+using toolman::FieldKind;
+
+template <typename T>
+struct IsVector : std::false_type {};
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+template <typename T>
+struct IsMap : std::false_type {};
+template <typename K, typename V>
+struct IsMap<std::map<K, V>> : std::true_type {};
+template <typename T>
+struct IsOptional : std::false_type {};
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+template <typename T>
+struct IsVariant : std::false_type {};
+template <typename... T>
+struct IsVariant<std::variant<T...>> : std::true_type {};
+template <typename T, typename = void>
+struct IsStruct : std::false_type {};
+template <typename T>
+struct IsStruct<T, std::void_t<decltype(Descriptor<T>::fields)>>
+    : std::true_type {};
+
+// The tables are usable at compile time.
+static_assert(Descriptor<Shape>::name == "Shape");
+static_assert(std::tuple_size_v<decltype(Descriptor<Shape>::fields)> == 19);
+static_assert(std::get<3>(Descriptor<Shape>::fields).name == "count");
+static_assert(std::get<3>(Descriptor<Shape>::fields).optional);
+static_assert(std::get<18>(Descriptor<Shape>::fields).number == 30);
+static_assert(std::get<18>(Descriptor<Shape>::fields).kind ==
+              FieldKind::kOneof);
+static_assert(std::get<0>(Descriptor<Point>::fields).member == &Point::x);
+static_assert(toolman::enum_name(Status::Teapot) == "Teapot");
+static_assert(toolman::enum_name(static_cast<Status>(1)).empty());
+static_assert(*toolman::parse_enum<Holes>("C") == Holes::C);
+static_assert(!toolman::parse_enum<Holes>("D"));
+
+constexpr int count_fields() {
+  int n = 0;
+  toolman::for_each_field<Mixed>([&n](const auto&) { ++n; });
+  return n;
+}
+static_assert(count_fields() == 7);
+
+void write_string(std::string& out, const std::string& s) {
+  out += '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  out += '"';
+}
+
+template <typename T>
+void write(std::string& out, const T& value);
+
+template <typename T>
+void write_struct(std::string& out, const T& value) {
+  out += '{';
+  bool first = true;
+  toolman::for_each_field<T>([&](const auto& field) {
+    const auto& member = value.*(field.member);
+    using M = std::decay_t<decltype(member)>;
+    if constexpr (IsOptional<M>::value) {
+      if (!member) {
+        return;
+      }
+    }
+    if constexpr (IsVariant<M>::value) {
+      if (member.index() == 0) {
+        return;
+      }
+    }
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    write_string(out, std::string(field.name));
+    out += ':';
+    if constexpr (std::is_same_v<M, std::optional<std::string>>) {
+      if (field.kind == FieldKind::kAny) {
+        out += *member;
+        return;
+      }
+    }
+    write(out, member);
+  });
+  out += '}';
+}
+
+template <typename T>
+void write(std::string& out, const T& value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    out += value ? "true" : "false";
+  } else if constexpr (std::is_enum_v<T>) {
+    write_string(out, std::string(toolman::enum_name(value)));
+  } else if constexpr (std::is_floating_point_v<T>) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.17g", value);
+    out += buf;
+  } else if constexpr (std::is_integral_v<T>) {
+    out += std::to_string(value);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    write_string(out, value);
+  } else if constexpr (IsOptional<T>::value) {
+    write(out, *value);
+  } else if constexpr (IsVector<T>::value) {
+    out += '[';
+    for (std::size_t i = 0; i < value.size(); ++i) {
+      if (i > 0) {
+        out += ',';
+      }
+      write(out, value[i]);
+    }
+    out += ']';
+  } else if constexpr (IsMap<T>::value) {
+    out += '{';
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      if (it != value.begin()) {
+        out += ',';
+      }
+      if constexpr (std::is_same_v<typename T::key_type, std::string>) {
+        write_string(out, it->first);
+      } else {
+        write_string(out, std::to_string(it->first));
+      }
+      out += ':';
+      write(out, it->second);
+    }
+    out += '}';
+  } else if constexpr (IsVariant<T>::value) {
+    std::visit(
+        [&out](const auto& alternative) {
+          using A = std::decay_t<decltype(alternative)>;
+          if constexpr (!std::is_same_v<A, std::monostate>) {
+            write_struct(out, alternative);
+          }
+        },
+        value);
+  } else {
+    write_struct(out, value);
+  }
+}
+
+// Reads what write writes, and aborts on anything else.
+class Reader {
+ public:
+  explicit Reader(const std::string& text) : text_(text) {}
+
+  template <typename T>
+  void read(T& value);
+
+ private:
+  char peek() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+    if (pos_ >= text_.size()) {
+      fail("unexpected end of input");
+    }
+    return text_[pos_];
+  }
+
+  void expect(char c) {
+    if (peek() != c) {
+      fail(std::string("expected ") + c);
+    }
+    ++pos_;
+  }
+
+  // Consumes `c` if it comes next.
+  bool consume(char c) {
+    if (peek() != c) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  [[noreturn]] void fail(const std::string& message) {
+    std::cerr << message << " at offset " << pos_ << "\n";
+    std::abort();
+  }
+
+  std::string read_string() {
+    expect('"');
+    std::string s;
+    while (text_[pos_] != '"') {
+      if (text_[pos_] == '\\') {
+        ++pos_;
+      }
+      s += text_[pos_++];
+    }
+    ++pos_;
+    return s;
+  }
+
+  // Returns the text of the next value.
+  std::string read_raw() {
+    peek();
+    std::size_t begin = pos_;
+    int depth = 0;
+    for (bool quoted = false; pos_ < text_.size(); ++pos_) {
+      char c = text_[pos_];
+      if (quoted) {
+        if (c == '\\') {
+          ++pos_;
+        } else if (c == '"') {
+          quoted = false;
+        }
+      } else if (c == '"') {
+        quoted = true;
+      } else if (c == '{' || c == '[') {
+        ++depth;
+      } else if (c == '}' || c == ']' || c == ',') {
+        if (depth == 0) {
+          break;
+        }
+        if (c != ',') {
+          --depth;
+        }
+      }
+    }
+    return text_.substr(begin, pos_ - begin);
+  }
+
+  template <typename T>
+  void read_number(T& value) {
+    peek();
+    const char* begin = text_.c_str() + pos_;
+    char* end;
+    if constexpr (std::is_floating_point_v<T>) {
+      value = std::strtod(begin, &end);
+    } else if constexpr (std::is_signed_v<T>) {
+      value = static_cast<T>(std::strtoll(begin, &end, 10));
+    } else {
+      value = static_cast<T>(std::strtoull(begin, &end, 10));
+    }
+    pos_ += end - begin;
+  }
+
+  template <typename T>
+  void read_struct(T& value) {
+    expect('{');
+    if (consume('}')) {
+      return;
+    }
+    do {
+      auto name = read_string();
+      expect(':');
+      bool found = false;
+      toolman::for_each_field<T>([&](const auto& field) {
+        if (found || field.name != name) {
+          return;
+        }
+        found = true;
+        auto& member = value.*(field.member);
+        if constexpr (std::is_same_v<std::decay_t<decltype(member)>,
+                                     std::optional<std::string>>) {
+          if (field.kind == FieldKind::kAny) {
+            member = read_raw();
+            return;
+          }
+        }
+        read(member);
+      });
+      if (!found) {
+        fail("unknown field " + name);
+      }
+    } while (consume(','));
+    expect('}');
+  }
+
+  // Oneof alternatives are structs of a single field, named like it.
+  template <typename V, std::size_t I = 1>
+  void read_alternative(V& value, const std::string& name) {
+    if constexpr (I < std::variant_size_v<V>) {
+      using A = std::variant_alternative_t<I, V>;
+      const auto& field = std::get<0>(Descriptor<A>::fields);
+      if (field.name == name) {
+        A alternative;
+        read(alternative.*(field.member));
+        value = std::move(alternative);
+        return;
+      }
+      read_alternative<V, I + 1>(value, name);
+    } else {
+      fail("unknown alternative " + name);
+    }
+  }
+
+  const std::string& text_;
+  std::size_t pos_ = 0;
+};
+
+template <typename T>
+void Reader::read(T& value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    value = read_raw() == "true";
+  } else if constexpr (std::is_enum_v<T>) {
+    auto name = read_string();
+    auto parsed = toolman::parse_enum<T>(name);
+    if (!parsed) {
+      fail("unknown enum value " + name);
+    }
+    value = *parsed;
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    read_number(value);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    value = read_string();
+  } else if constexpr (IsOptional<T>::value) {
+    read(value.emplace());
+  } else if constexpr (IsVector<T>::value) {
+    expect('[');
+    if (consume(']')) {
+      return;
+    }
+    do {
+      read(value.emplace_back());
+    } while (consume(','));
+    expect(']');
+  } else if constexpr (IsMap<T>::value) {
+    expect('{');
+    if (consume('}')) {
+      return;
+    }
+    do {
+      auto name = read_string();
+      expect(':');
+      typename T::key_type key;
+      if constexpr (std::is_same_v<typename T::key_type, std::string>) {
+        key = name;
+      } else {
+        key = static_cast<typename T::key_type>(std::stoll(name));
+      }
+      read(value[key]);
+    } while (consume(','));
+    expect('}');
+  } else if constexpr (IsVariant<T>::value) {
+    expect('{');
+    auto name = read_string();
+    expect(':');
+    read_alternative(value, name);
+    expect('}');
+  } else {
+    read_struct(value);
+  }
+}
+
+template <typename T>
+bool equal(const T& a, const T& b) {
+  if constexpr (IsStruct<T>::value) {
+    bool result = true;
+    toolman::for_each_field<T>([&](const auto& field) {
+      result = result && equal(a.*(field.member), b.*(field.member));
+    });
+    return result;
+  } else if constexpr (IsOptional<T>::value) {
+    return a.has_value() == b.has_value() && (!a || equal(*a, *b));
+  } else if constexpr (IsVector<T>::value) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!equal(a[i], b[i])) {
+        return false;
+      }
+    }
+    return true;
+  } else if constexpr (IsMap<T>::value) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (const auto& entry : a) {
+      auto it = b.find(entry.first);
+      if (it == b.end() || !equal(entry.second, it->second)) {
+        return false;
+      }
+    }
+    return true;
+  } else if constexpr (IsVariant<T>::value) {
+    return a.index() == b.index() &&
+           std::visit(
+               [&b](const auto& x) {
+                 using X = std::decay_t<decltype(x)>;
+                 if constexpr (std::is_same_v<X, std::monostate>) {
+                   return true;
+                 } else {
+                   return equal(x, std::get<X>(b));
+                 }
+               },
+               a);
+  } else {
+    return a == b;
+  }
+}
+
+int failures = 0;
+
+// Writes `value`, reads it back and checks that nothing changed.
+template <typename T>
+T round_trip(const T& value) {
+  std::string json;
+  write(json, value);
+  T back{};
+  Reader(json).read(back);
+  std::string again;
+  write(again, back);
+  if (!equal(value, back) || json != again) {
+    std::cerr << Descriptor<T>::name << " did not round-trip:\n"
+              << json << "\n" << again << "\n";
+    ++failures;
+  }
+  return back;
+}
+
+Shape sample() {
+  Shape s;
+  s.id = -42;
+  s.name = "sh\"ape";
+  s.visible = true;
+  s.count = 3;
+  s.size = 7;
+  s.big = 18446744073709551615ull;
+  s.color = Color::Blue;
+  s.alt_color = Color::Red;
+  s.center = {1.5, -2.25};
+  s.anchor = Point{3, 4};
+  s.points = {{1, 2}, {0.1, 1e-300}};
+  s.weights = {0.5};
+  s.ids = {1, -2};
+  s.tags = {{"a", "b"}, {"c", ""}};
+  s.by_id = {{-1, {5, 6}}};
+  s.matrix = {{1, 2}, {}, {3}};
+  s.extra = R"({"k":[1,"x,}"]})";
+  s.shape_kind = ShapeOrigin{{7, 8}};
+  return s;
+}
+
+}  // namespace
+
+int main() {
+  auto shape = round_trip(sample());
+  shape.shape_kind = ShapeText{"t"};
+  if (equal(shape, sample())) {
+    std::cerr << "a different oneof alternative compared equal\n";
+    ++failures;
+  }
+
+  Item item;
+  item.kind = ItemLabel{"q"};
+  item.tags = {1, 4000000000u};
+  round_trip(item);
+  round_trip(Mixed{});
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,7 @@
+// A value declared twice in one enum is still an error.
+type (
+    Small enum {
+        One = 1,
+        Uno = 1
+    }
+)
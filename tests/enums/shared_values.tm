@@ -0,0 +1,12 @@
+// Values are unique within an enum, unrelated enums may share them.
+type (
+    Small enum {
+        One = 1,
+        Two = 2
+    },
+
+    Other enum {
+        Uno = 1,
+        Dos = 2
+    }
+)
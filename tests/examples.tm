@@ -0,0 +1,83 @@
+// The schema the generated-code tests and benchmarks are built from, see
+// tests/CMakeLists.txt. Each test prepends the options it needs.
+
+type (
+    Color enum {
+        Red = 1,
+        Green = 2,
+        Blue = 3
+    },
+
+    Status enum {
+        Ok = 0,
+        NotFound = 404,
+        Internal = 500,
+        Teapot = 418
+    },
+
+    // Values with gaps, so that lookups cannot index by value.
+    Holes enum {
+        A = 2,
+        B = 3,
+        C = 6
+    },
+
+    Point struct {
+        x: float [min: -1000, max: 1e3],
+        y: float
+    },
+
+    // Every kind of field, with constraints the samples in the tests meet.
+    Shape struct {
+        id: i64 [min: -9223372036854775808],
+        name: string [min_len: 1, max_len: 16, pattern: "^[a-z][a-z0-9_]*$"],
+        visible: bool,
+        count: i32? [min: -5, max: 5],
+        size: u32 [min: 0, max: 100],
+        big: u64? [min: 1, max: 18446744073709551615],
+        label: string? [len: 3],
+        color: Color,
+        alt_color: Color?,
+        center: Point,
+        anchor: Point?,
+        points: [Point] [max_items: 4],
+        weights: [float],
+        ids: [i32],
+        tags: {string: string} [max_items: 3],
+        by_id: {i64: Point},
+        matrix: [[i64]],
+        extra: any?,
+        shape_kind: (radius: float | text: string | origin: Point) = 30
+    },
+
+    Item struct {
+        id: i64,
+        name: string,
+        tags: [u32],
+        kind: (count: i32 | label: string) = 5
+    },
+
+    // Bools and optionals between wider fields, for the packed layouts.
+    Mixed struct {
+        a: bool,
+        b: i64,
+        c: bool?,
+        d: i32,
+        e: string,
+        f: bool,
+        g: Point
+    }
+)
+
+// Routes with static segments, params of every kind a path can hold and a
+// static segment that overlaps a param, for the HTTP servers and clients.
+api shapes (
+    get /shapes (Point) returns {200 -> Shape},
+    get /shapes/{id: i64} (Point) returns {200 -> Shape, 404 -> Status},
+    delete /shapes/{id: i64} (Point) returns {200 -> Status},
+    get /shapes/{id: i64}/points/{idx: u32} (Point) returns {200 -> Point},
+    get /shapes/search (Point) returns {200 -> Shape},
+    post /shapes/by-color/{color: Color} (Shape) returns {200 -> Shape},
+    get /settings/{name: string}/{on: bool} (Point) returns {200 -> Point},
+    get / (Point) returns {200 -> Point}
+)
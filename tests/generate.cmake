@@ -0,0 +1,40 @@
+# Compiles SCHEMA into OUTPUT with `toolman TARGET`, run as
+#
+#   cmake -DTOOLMAN=... -DTARGET=go -DSCHEMA=examples.tm -DOUTPUT=...
+#         -DOPTIONS="go_package=codec;go_json_codec" -P generate.cmake
+#
+# Every NAME=VALUE in OPTIONS, or NAME alone for `true`, becomes an option
+# statement ahead of the schema. The schema is copied next to OUTPUT under
+# its own name, which generated code mentions.
+
+file(READ ${SCHEMA} schema)
+set(options "")
+foreach(option IN LISTS OPTIONS)
+  string(FIND "${option}" "=" eq)
+  if(eq EQUAL -1)
+    set(name ${option})
+    set(value true)
+  else()
+    string(SUBSTRING "${option}" 0 ${eq} name)
+    math(EXPR eq "${eq} + 1")
+    string(SUBSTRING "${option}" ${eq} -1 value)
+    if(NOT value MATCHES "^(true|false|-?[0-9.]+)$")
+      set(value "\"${value}\"")
+    endif()
+  endif()
+  string(APPEND options "option ${name} = ${value};\n")
+endforeach()
+
+get_filename_component(dir ${OUTPUT} DIRECTORY)
+get_filename_component(schema_name ${SCHEMA} NAME)
+file(MAKE_DIRECTORY ${dir})
+file(WRITE ${dir}/${schema_name} "${options}${schema}")
+
+execute_process(
+  COMMAND ${TOOLMAN} ${TARGET} ${schema_name}
+  WORKING_DIRECTORY ${dir}
+  OUTPUT_FILE ${OUTPUT}
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "toolman ${TARGET} ${SCHEMA} failed")
+endif()
@@ -0,0 +1,133 @@
+package codec
+
+import (
+	"testing"
+
+	shared "toolman.test/sample"
+)
+
+// sampleBinary returns the Shape that the other packages decode, binary
+// encoded.
+func sampleBinary(tb testing.TB) []byte {
+	var s Shape
+	if err := s.UnmarshalJSON(shared.Shape); err != nil {
+		tb.Fatal(err)
+	}
+	return s.AppendBinary(nil)
+}
+
+// The benchmarks below have namesakes in the packages generated with other
+// layouts, which compare against these.
+
+func BenchmarkUnmarshalBinary(b *testing.B) {
+	data := sampleBinary(b)
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		var s Shape
+		if err := s.UnmarshalBinary(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+var shapes = make([]Shape, 1024)
+
+func BenchmarkSetOptionals(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s := &shapes[i%len(shapes)]
+		count, big, label, color := int32(i%5), uint64(i), "abc", Color_Red
+		s.Count, s.Big, s.Label, s.Alt_color = &count, &big, &label, &color
+	}
+}
+
+func BenchmarkSetOneof(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s := &shapes[i%len(shapes)]
+		if i%2 == 0 {
+			s.Shape_kind = &ShapeRadius{Radius: float64(i)}
+		} else {
+			s.Shape_kind = &ShapeOrigin{Origin: Point{X: 1, Y: 2}}
+		}
+	}
+}
+
+var sinkFloat float64
+
+func BenchmarkSumOneof1024(b *testing.B) {
+	for i := range shapes {
+		if i%2 == 0 {
+			shapes[i].Shape_kind = &ShapeRadius{Radius: float64(i)}
+		} else {
+			shapes[i].Shape_kind = &ShapeOrigin{Origin: Point{X: 1, Y: 2}}
+		}
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		total := 0.0
+		for j := range shapes {
+			switch kind := shapes[j].Shape_kind.(type) {
+			case *ShapeRadius:
+				total += kind.Radius
+			case *ShapeOrigin:
+				total += kind.Origin.X
+			}
+		}
+		sinkFloat = total
+	}
+}
+
+func TestDecodeBinaryReusesStorage(t *testing.T) {
+	data := sampleBinary(t)
+	var want Shape
+	if err := want.UnmarshalBinary(data); err != nil {
+		t.Fatal(err)
+	}
+	s := AcquireShape()
+	defer ReleaseShape(s)
+	for i := 0; i < 3; i++ {
+		if err := s.DecodeBinary(data); err != nil {
+			t.Fatal(err)
+		}
+		if got := string(s.AppendJSON(nil)); got != string(want.AppendJSON(nil)) {
+			t.Fatalf("decode %d into the same Shape gave\n%s", i, got)
+		}
+	}
+	points := &s.Points[:1][0]
+	s.Reset()
+	if s.Id != 0 || len(s.Points) != 0 || len(s.Tags) != 0 ||
+		cap(s.Points) == 0 || &s.Points[:1][0] != points {
+		t.Fatalf("Reset did not keep the storage of Points: %+v", s)
+	}
+	// Optional fields become nil, which is how they are absent.
+	if s.Anchor != nil || s.Count != nil || s.Extra != nil {
+		t.Fatalf("Reset kept optional fields: %+v", s)
+	}
+}
+
+// Steady-state decoding, in which the decoded Shapes are reused instead of
+// left to the garbage collector. Compare with BenchmarkUnmarshalBinary.
+
+func BenchmarkDecodeBinary(b *testing.B) {
+	data := sampleBinary(b)
+	var s Shape
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		if err := s.DecodeBinary(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkDecodeBinaryPooled(b *testing.B) {
+	data := sampleBinary(b)
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s := AcquireShape()
+		if err := s.DecodeBinary(data); err != nil {
+			b.Fatal(err)
+		}
+		ReleaseShape(s)
+	}
+}
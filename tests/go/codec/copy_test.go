@@ -0,0 +1,144 @@
+package codec
+
+import (
+	"encoding/json"
+	"reflect"
+	"testing"
+
+	"toolman.test/plain"
+)
+
+// reflectCopy deeply copies v the way reflection-based cloning helpers do.
+func reflectCopy(v reflect.Value) reflect.Value {
+	switch v.Kind() {
+	case reflect.Ptr:
+		if v.IsNil() {
+			return v
+		}
+		c := reflect.New(v.Type().Elem())
+		c.Elem().Set(reflectCopy(v.Elem()))
+		return c
+	case reflect.Interface:
+		if v.IsNil() {
+			return v
+		}
+		c := reflect.New(v.Type()).Elem()
+		c.Set(reflectCopy(v.Elem()))
+		return c
+	case reflect.Struct:
+		c := reflect.New(v.Type()).Elem()
+		for i := 0; i < v.NumField(); i++ {
+			c.Field(i).Set(reflectCopy(v.Field(i)))
+		}
+		return c
+	case reflect.Slice:
+		if v.IsNil() {
+			return v
+		}
+		c := reflect.MakeSlice(v.Type(), v.Len(), v.Len())
+		for i := 0; i < v.Len(); i++ {
+			c.Index(i).Set(reflectCopy(v.Index(i)))
+		}
+		return c
+	case reflect.Map:
+		if v.IsNil() {
+			return v
+		}
+		c := reflect.MakeMapWithSize(v.Type(), v.Len())
+		for it := v.MapRange(); it.Next(); {
+			c.SetMapIndex(it.Key(), reflectCopy(it.Value()))
+		}
+		return c
+	}
+	return v
+}
+
+func copySample(t testing.TB) Shape {
+	var s Shape
+	if err := s.UnmarshalBinary(sampleBinary(t)); err != nil {
+		t.Fatal(err)
+	}
+	return s
+}
+
+func TestDeepCopy(t *testing.T) {
+	s := copySample(t)
+	want := string(s.AppendJSON(nil))
+	c := s.DeepCopy()
+	if got := string(c.AppendJSON(nil)); got != want {
+		t.Fatalf("DeepCopy gave\n%s\nwant\n%s", got, want)
+	}
+	if cap(c.Points) != len(s.Points) || cap(c.Matrix) != len(s.Matrix) {
+		t.Errorf("lists copied with capacity %d and %d, want %d and %d",
+			cap(c.Points), cap(c.Matrix), len(s.Points), len(s.Matrix))
+	}
+	// Changing anything the copy holds leaves the original as it was.
+	*c.Count = 1
+	*c.Label = "xyz"
+	c.Anchor.X = 100
+	c.Points[0].X = 100
+	c.Tags["a"] = "changed"
+	c.By_id[-5] = Point{}
+	c.Matrix[0][0] = 100
+	(*c.Extra).(map[string]interface{})["k"].([]interface{})[0] = "changed"
+	c.Shape_kind.(*ShapeText).Text = "changed"
+	if got := string(s.AppendJSON(nil)); got != want {
+		t.Fatalf("changing the copy changed the original to\n%s", got)
+	}
+	r := reflectCopy(reflect.ValueOf(s)).Interface().(Shape)
+	if got := string(r.AppendJSON(nil)); got != want {
+		t.Fatalf("reflectCopy gave\n%s", got)
+	}
+}
+
+var (
+	sinkShape      *Shape
+	sinkPlainShape *plain.Shape
+)
+
+// plainSample is s in the package generated without codecs, whose structs
+// only have tags, so that encoding/json works on them by reflection alone.
+// encoding/json cannot decode a oneof into its interface, the copy goes
+// without it.
+func plainSample(b *testing.B, s Shape) plain.Shape {
+	s.Shape_kind = nil
+	var p plain.Shape
+	if err := json.Unmarshal(s.AppendJSON(nil), &p); err != nil {
+		b.Fatal(err)
+	}
+	return p
+}
+
+// BenchmarkDeepCopy compares the generated DeepCopy with the ways of
+// cloning a message without one: reflection and a JSON round trip.
+func BenchmarkDeepCopy(b *testing.B) {
+	s := copySample(b)
+	b.Run("generated", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			sinkShape = s.DeepCopy()
+		}
+	})
+	b.Run("reflect", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			sinkShape = reflectCopy(reflect.ValueOf(&s)).Interface().(*Shape)
+		}
+	})
+	b.Run("json", func(b *testing.B) {
+		p := plainSample(b, s)
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			data, err := json.Marshal(&p)
+			if err != nil {
+				b.Fatal(err)
+			}
+			c := new(plain.Shape)
+			if err := json.Unmarshal(data, c); err != nil {
+				b.Fatal(err)
+			}
+			sinkPlainShape = c
+		}
+	})
+}
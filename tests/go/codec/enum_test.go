@@ -0,0 +1,118 @@
+package codec
+
+import (
+	"strconv"
+	"testing"
+)
+
+// Color and Holes are dense, their names are indexed by value. Status is
+// sparse, its names are found through a perfect hash of the value.
+func TestEnumString(t *testing.T) {
+	for _, c := range []struct {
+		got  string
+		want string
+	}{
+		{Color_Red.String(), "Red"},
+		{Color_Green.String(), "Green"},
+		{Color_Blue.String(), "Blue"},
+		{Status_Ok.String(), "Ok"},
+		{Status_NotFound.String(), "NotFound"},
+		{Status_Internal.String(), "Internal"},
+		{Status_Teapot.String(), "Teapot"},
+		{Holes_A.String(), "A"},
+		{Holes_B.String(), "B"},
+		{Holes_C.String(), "C"},
+	} {
+		if c.got != c.want {
+			t.Errorf("got %q, want %q", c.got, c.want)
+		}
+	}
+	// Every slot of the Status table is taken, so each undeclared value
+	// lands on a declared one and is told apart by comparing it.
+	for _, s := range tmStatusByNumber {
+		if s.name == "" {
+			t.Fatalf("tmStatusByNumber has an empty slot")
+		}
+	}
+	for _, v := range []int32{1, 403, 405, 419, 501, -404, -1, 1 << 30,
+		-1 << 31} {
+		if got, want := Status(v).String(), strconv.Itoa(int(v)); got != want {
+			t.Errorf("Status(%d): got %q, want %q", v, got, want)
+		}
+	}
+	for _, v := range []int32{0, 4, -1, -1 << 31} {
+		if got, want := Color(v).String(), strconv.Itoa(int(v)); got != want {
+			t.Errorf("Color(%d): got %q, want %q", v, got, want)
+		}
+	}
+	for _, v := range []int32{0, 1, 4, 5, 7} {
+		if got, want := Holes(v).String(), strconv.Itoa(int(v)); got != want {
+			t.Errorf("Holes(%d): got %q, want %q", v, got, want)
+		}
+	}
+}
+
+func TestEnumParse(t *testing.T) {
+	for _, v := range []Color{Color_Red, Color_Green, Color_Blue} {
+		if got, ok := ParseColor(v.String()); !ok || got != v {
+			t.Errorf("ParseColor(%q): got %v, %v", v.String(), got, ok)
+		}
+	}
+	for _, v := range []Status{Status_Ok, Status_NotFound, Status_Internal,
+		Status_Teapot} {
+		if got, ok := ParseStatus(v.String()); !ok || got != v {
+			t.Errorf("ParseStatus(%q): got %v, %v", v.String(), got, ok)
+		}
+	}
+	for _, v := range []Holes{Holes_A, Holes_B, Holes_C} {
+		if got, ok := ParseHoles(v.String()); !ok || got != v {
+			t.Errorf("ParseHoles(%q): got %v, %v", v.String(), got, ok)
+		}
+	}
+
+	// The four Status names fill the four slots of their table, so every
+	// other name hashes into a slot holding a different name. The empty
+	// slots of the other tables hold the empty name, which no name
+	// matches, not even the empty one.
+	for _, s := range tmStatusByName {
+		if s.name == "" {
+			t.Fatalf("tmStatusByName has an empty slot")
+		}
+	}
+	empty := 0
+	for _, s := range tmColorByName {
+		if s.name == "" {
+			empty++
+		}
+	}
+	if empty == 0 {
+		t.Fatalf("tmColorByName has no empty slot")
+	}
+	for _, name := range []string{"", "ok", "OK", "Ok ", "Ok\x00", "O",
+		"NotFoun", "NotFoundd", "Red", "A", "Teapots", "404", "0"} {
+		if got, ok := ParseStatus(name); ok {
+			t.Errorf("ParseStatus(%q): got %v", name, got)
+		}
+	}
+	for _, name := range []string{"", "red", "RED", "Redd", "Gree", "Ok",
+		"\x00", "Blue\n"} {
+		if got, ok := ParseColor(name); ok {
+			t.Errorf("ParseColor(%q): got %v", name, got)
+		}
+	}
+	for _, name := range []string{"", "a", "D", "AB", "1"} {
+		if got, ok := ParseHoles(name); ok {
+			t.Errorf("ParseHoles(%q): got %v", name, got)
+		}
+	}
+	// Nor is any other name of one or two bytes.
+	for c := 0; c < 1<<16; c++ {
+		name := string([]byte{byte(c >> 8), byte(c)})
+		if v, ok := ParseStatus(name); ok && v.String() != name {
+			t.Errorf("ParseStatus(%q): got %v", name, v)
+		}
+		if v, ok := ParseHoles(name[1:]); ok && v.String() != name[1:] {
+			t.Errorf("ParseHoles(%q): got %v", name[1:], v)
+		}
+	}
+}
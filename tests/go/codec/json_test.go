@@ -0,0 +1,114 @@
+package codec
+
+import (
+	"encoding/json"
+	"reflect"
+	"strings"
+	"testing"
+)
+
+// sample matches the one in plain/json_test.go, so that the benchmarks of
+// both packages encode the same message.
+func sample() Shape {
+	count := int32(-3)
+	big := uint64(1<<63 + 5)
+	label := "abc"
+	altColor := Color_Blue
+	return Shape{
+		Id:        -1 << 62,
+		Name:      "hello_world",
+		Visible:   true,
+		Count:     &count,
+		Size:      42,
+		Big:       &big,
+		Label:     &label,
+		Color:     Color_Green,
+		Alt_color: &altColor,
+		Center:    Point{X: 1.5, Y: -2e-9},
+		Anchor:    &Point{X: 3, Y: 1e22},
+		Points:    []Point{{X: 1, Y: 2}, {X: 0.1, Y: 123456789.125}},
+		Weights:   []float64{0, -0.5, 1e21},
+		Ids:       []int32{1, -2, 3},
+		Tags:      map[string]string{"b": "2", "a": "1", "c\"<>": "3"},
+		By_id: map[int64]Point{
+			-5: {X: 7, Y: 8}, 10: {X: 1}, 9: {Y: 2}, 100: {X: 3, Y: 3},
+		},
+		Matrix: [][]int64{{1, 2}, nil, {}},
+	}
+}
+
+// reflected has the fields of Shape but not its methods, so encoding/json
+// encodes it by reflection.
+type reflected Shape
+
+func TestAppendJSONMatchesEncodingJSON(t *testing.T) {
+	// Enough keys that they are not sorted by insertion.
+	many := sample()
+	for i := int64(-20); i < 20; i++ {
+		many.By_id[i*7] = Point{X: float64(i)}
+	}
+	for _, s := range []Shape{sample(), many} {
+		want, err := json.Marshal(reflected(s))
+		if err != nil {
+			t.Fatal(err)
+		}
+		// Map iteration order changes from run to run, so a few runs would
+		// catch keys written in that order.
+		for i := 0; i < 16; i++ {
+			if got := s.AppendJSON(nil); string(got) != string(want) {
+				t.Fatalf("AppendJSON\n got %s\nwant %s", got, want)
+			}
+		}
+	}
+	s := sample()
+	want := string(s.AppendJSON(nil))
+	if !strings.Contains(want, `"by_id":{"-5":`) ||
+		!strings.Contains(want, `"100":{"x":3,"y":3},"9":`) {
+		t.Fatalf("map keys are not sorted as strings: %s", want)
+	}
+}
+
+func TestJSONRoundTrip(t *testing.T) {
+	for _, kind := range []isShape_Shape_kind{
+		nil, &ShapeRadius{Radius: 2.5}, &ShapeText{Text: "x"},
+		&ShapeOrigin{Origin: Point{X: 1, Y: 2}},
+	} {
+		s := sample()
+		s.Shape_kind = kind
+		data := s.AppendJSON(nil)
+		var out Shape
+		if err := out.UnmarshalJSON(data); err != nil {
+			t.Fatalf("%v: %s", err, data)
+		}
+		if !reflect.DeepEqual(out, s) {
+			t.Fatalf("round trip of %s\n got %#v\nwant %#v", data, out, s)
+		}
+	}
+}
+
+// BenchmarkMarshalJSON and BenchmarkUnmarshalJSON compare with the
+// encoding/json baseline of the same names in plain.
+
+func BenchmarkMarshalJSON(b *testing.B) {
+	s := sample()
+	buf := s.AppendJSON(nil)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		buf = s.AppendJSON(buf[:0])
+	}
+}
+
+func BenchmarkUnmarshalJSON(b *testing.B) {
+	s := sample()
+	data := s.AppendJSON(nil)
+	b.SetBytes(int64(len(data)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		var out Shape
+		if err := out.UnmarshalJSON(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
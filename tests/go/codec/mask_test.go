@@ -0,0 +1,203 @@
+package codec
+
+import (
+	"encoding/json"
+	"errors"
+	"reflect"
+	"strings"
+	"sync"
+	"testing"
+)
+
+// mapFields are the fields of Shape whose objects are maps, not structs.
+var mapFields = map[string]bool{"tags": true, "by_id": true}
+
+// project keeps what paths select of v, a struct as encoding/json decodes
+// it. A path through a list or a map applies to every element, and a field
+// selected whole stays whole.
+func project(v interface{}, paths []string) interface{} {
+	obj, ok := v.(map[string]interface{})
+	if !ok {
+		return v
+	}
+	nested := map[string][]string{}
+	whole := map[string]bool{}
+	for _, path := range paths {
+		if name, rest, ok := strings.Cut(path, "."); ok {
+			nested[name] = append(nested[name], rest)
+		} else {
+			whole[name] = true
+		}
+	}
+	out := map[string]interface{}{}
+	for name := range whole {
+		out[name] = obj[name]
+	}
+	for name, rest := range nested {
+		if whole[name] {
+			continue
+		}
+		switch field := obj[name].(type) {
+		case []interface{}:
+			list := make([]interface{}, len(field))
+			for i, e := range field {
+				list[i] = project(e, rest)
+			}
+			out[name] = list
+		case map[string]interface{}:
+			if !mapFields[name] {
+				out[name] = project(field, rest)
+				break
+			}
+			m := make(map[string]interface{}, len(field))
+			for k, e := range field {
+				m[k] = project(e, rest)
+			}
+			out[name] = m
+		default:
+			out[name] = field
+		}
+	}
+	return out
+}
+
+func decodeAny(t *testing.T, b []byte) interface{} {
+	t.Helper()
+	var v interface{}
+	if err := json.Unmarshal(b, &v); err != nil {
+		t.Fatalf("%v: %s", err, b)
+	}
+	return v
+}
+
+func TestFieldMask(t *testing.T) {
+	s := sample()
+	full := decodeAny(t, s.AppendJSON(nil))
+	for _, paths := range []string{
+		"",
+		"id",
+		"shape_kind,extra,id",
+		// Nested structs, alone or through an optional.
+		"center.x",
+		"center.x,anchor.y,center.y",
+		// Every element of lists and map values.
+		"points.y",
+		"by_id.x",
+		"points.x,by_id.y,points.y",
+		// A field selected whole stays whole, in either order.
+		"center,center.x",
+		"center.y,center",
+		// Lists and maps of scalars can only be selected whole.
+		"weights,ids,tags,matrix",
+	} {
+		k, err := ParseShapeMask(paths)
+		if err != nil {
+			t.Fatalf("%q: %v", paths, err)
+		}
+		got := s.AppendJSONMask(nil, k)
+		var split []string
+		if paths != "" {
+			split = strings.Split(paths, ",")
+		}
+		if want := project(full, split); !reflect.DeepEqual(
+			decodeAny(t, got), want) {
+			t.Errorf("%q: got %s, want %v", paths, got, want)
+		}
+	}
+}
+
+// Fields are written in declaration order, whatever the order of the
+// paths, exactly as AppendJSON writes them.
+func TestFieldMaskEncoding(t *testing.T) {
+	s := sample()
+	s.Anchor = nil
+	for _, c := range []struct{ paths, want string }{
+		{"", `{}`},
+		{"name,id", `{"id":-4611686018427387904,"name":"hello_world"}`},
+		{"anchor.x,center.y", `{"center":{"y":-2e-9},"anchor":null}`},
+		{"points.y,count", `{"count":-3,"points":[{"y":2},{"y":123456789.125}]}`},
+		// Map keys are sorted as encoding/json sorts them.
+		{"by_id.x", `{"by_id":{"-5":{"x":7},"10":{"x":1},"100":{"x":3},` +
+			`"9":{"x":0}}}`},
+		{"center.x,center.y", `{"center":{"x":1.5,"y":-2e-9}}`},
+	} {
+		k, err := ParseShapeMask(c.paths)
+		if err != nil {
+			t.Fatalf("%q: %v", c.paths, err)
+		}
+		if got := string(s.AppendJSONMask(nil, k)); got != c.want {
+			t.Errorf("%q: got %s, want %s", c.paths, got, c.want)
+		}
+	}
+	every := strings.Join([]string{"id", "name", "visible", "count", "size",
+		"big", "label", "color", "alt_color", "center", "anchor", "points",
+		"weights", "ids", "tags", "by_id", "matrix", "extra", "shape_kind"},
+		",")
+	k, err := ParseShapeMask(every)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if got, want := s.AppendJSONMask(nil, k), s.AppendJSON(nil); string(got) != string(want) {
+		t.Errorf("every field: got %s, want %s", got, want)
+	}
+	// A nil mask selects everything.
+	if got, want := s.AppendJSONMask(nil, nil), s.AppendJSON(nil); string(got) != string(want) {
+		t.Errorf("nil mask: got %s, want %s", got, want)
+	}
+}
+
+func TestFieldMaskRejects(t *testing.T) {
+	for _, c := range []struct{ paths, bad string }{
+		{"nope", "nope"},
+		{"id,Id", "Id"},
+		{"id.x", "id.x"},
+		{"center.z", "center.z"},
+		{"center.x.y", "center.x.y"},
+		// Selected whole already, the path still has to exist.
+		{"center,center.z", "center.z"},
+		{"points.", "points."},
+		{"tags.a", "tags.a"},
+		{"id,,name", ""},
+		{"id,", ""},
+		{".id", ".id"},
+	} {
+		k, err := ParseShapeMask(c.paths)
+		var maskErr *ToolmanMaskError
+		if !errors.As(err, &maskErr) || maskErr.Path != c.bad {
+			t.Errorf("%q: got %v, %v, want the path %q rejected", c.paths, k,
+				err, c.bad)
+		}
+	}
+}
+
+// A parsed mask is not changed by encoding, so it is reused, also by
+// goroutines at once.
+func TestFieldMaskReuse(t *testing.T) {
+	k, err := ParseShapeMask("id,points.x")
+	if err != nil {
+		t.Fatal(err)
+	}
+	var wg sync.WaitGroup
+	for g := 0; g < 8; g++ {
+		wg.Add(1)
+		go func(g int) {
+			defer wg.Done()
+			var b []byte
+			for i := 0; i < 100; i++ {
+				s := Shape{Id: int64(g*1000 + i), Points: []Point{{X: float64(i), Y: 1}}}
+				b = s.AppendJSONMask(b[:0], k)
+				var got Shape
+				if err := json.Unmarshal(b, (*reflected)(&got)); err != nil {
+					t.Error(err)
+					return
+				}
+				if got.Id != s.Id || len(got.Points) != 1 ||
+					got.Points[0] != (Point{X: float64(i)}) {
+					t.Errorf("got %s", b)
+					return
+				}
+			}
+		}(g)
+	}
+	wg.Wait()
+}
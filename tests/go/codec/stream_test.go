@@ -0,0 +1,194 @@
+package codec
+
+import (
+	"bytes"
+	"errors"
+	"io"
+	"strconv"
+	"strings"
+	"testing"
+	"testing/iotest"
+)
+
+// largeShape is a Shape whose points and matrix hold n elements, far more
+// than the stream reads ahead.
+func largeShape(n int) []byte {
+	b := []byte(`{"name":"hello_world","points":[`)
+	for i := 0; i < n; i++ {
+		if i > 0 {
+			b = append(b, ',')
+		}
+		b = append(b, `{"x":`...)
+		b = strconv.AppendInt(b, int64(i%1000), 10)
+		b = append(b, `,"y":`...)
+		b = strconv.AppendInt(b, int64(i), 10)
+		b = append(b, '}')
+	}
+	b = append(b, `],"weights":[1,2],"matrix":[`...)
+	for i := 0; i < n; i++ {
+		if i > 0 {
+			b = append(b, ',')
+		}
+		b = append(b, '[')
+		b = strconv.AppendInt(b, int64(i), 10)
+		b = append(b, ']')
+	}
+	return append(b, `],"size":7}`...)
+}
+
+// The handlers see every element in order, the lists they take are left
+// empty and the other fields are decoded, whatever the reads return.
+func TestDecodeJSONStream(t *testing.T) {
+	const n = 100000
+	data := largeShape(n)
+	for name, r := range map[string]func() io.Reader{
+		"whole":    func() io.Reader { return bytes.NewReader(data) },
+		"one byte": func() io.Reader { return iotest.OneByteReader(bytes.NewReader(data)) },
+		"half":     func() io.Reader { return iotest.HalfReader(bytes.NewReader(data)) },
+	} {
+		points, rows := 0, 0
+		h := &ShapeStream{
+			Points: func(i int, v *Point) error {
+				if i != points || v.X != float64(i%1000) || v.Y != float64(i) {
+					t.Fatalf("%s: point %d is %d %+v", name, points, i, *v)
+				}
+				points++
+				return nil
+			},
+			Matrix: func(i int, v []int64) error {
+				if i != rows || len(v) != 1 || v[0] != int64(i) {
+					t.Fatalf("%s: row %d is %d %v", name, rows, i, v)
+				}
+				rows++
+				return nil
+			},
+		}
+		// Storage left over from an earlier decode is emptied, not kept.
+		m := Shape{Points: make([]Point, 3), Matrix: [][]int64{{1}}}
+		if err := m.DecodeJSONStream(r(), h); err != nil {
+			t.Fatalf("%s: %v", name, err)
+		}
+		if points != n || rows != n {
+			t.Fatalf("%s: %d points, %d rows", name, points, rows)
+		}
+		if len(m.Points) != 0 || len(m.Matrix) != 0 {
+			t.Fatalf("%s: lists hold %d points, %d rows", name,
+				len(m.Points), len(m.Matrix))
+		}
+		if m.Name != "hello_world" || m.Size != 7 || len(m.Weights) != 2 {
+			t.Fatalf("%s: decoded %q %d %v", name, m.Name, m.Size, m.Weights)
+		}
+	}
+}
+
+func TestDecodeJSONStreamHandlerError(t *testing.T) {
+	stop := errors.New("stop")
+	calls := 0
+	h := &ShapeStream{Points: func(i int, v *Point) error {
+		calls++
+		if i == 10 {
+			return stop
+		}
+		return nil
+	}}
+	var m Shape
+	err := m.DecodeJSONStream(bytes.NewReader(largeShape(1000)), h)
+	if !errors.Is(err, stop) || calls != 11 {
+		t.Fatalf("got %v after %d calls", err, calls)
+	}
+	// Reading errors are returned as they are.
+	r := io.MultiReader(strings.NewReader(`{"points":[{"x":1,"y":2},`),
+		iotest.ErrReader(io.ErrUnexpectedEOF))
+	calls = 0
+	h.Points = func(i int, v *Point) error { calls++; return nil }
+	if err := m.DecodeJSONStream(r, h); !errors.Is(err, io.ErrUnexpectedEOF) ||
+		calls != 1 {
+		t.Fatalf("got %v after %d calls", err, calls)
+	}
+}
+
+func TestDecodeJSONStreamEmpty(t *testing.T) {
+	calls := 0
+	h := &ShapeStream{
+		Points:  func(i int, v *Point) error { calls++; return nil },
+		Weights: func(i int, v float64) error { calls++; return nil },
+	}
+	for _, data := range []string{
+		`{"points":null,"weights":[]}`,
+		` { "points" : [ ] , "weights" : null } `,
+		`{}`,
+		`null`,
+	} {
+		m := Shape{Name: "x", Points: []Point{{X: 1}}}
+		if err := m.DecodeJSONStream(strings.NewReader(data), h); err != nil {
+			t.Fatalf("%s: %v", data, err)
+		}
+		if calls != 0 || len(m.Points) != 0 || len(m.Weights) != 0 ||
+			m.Name != "" {
+			t.Fatalf("%s: %d calls, decoded %+v", data, calls, m)
+		}
+	}
+}
+
+func TestDecodeJSONStreamRejects(t *testing.T) {
+	h := &ShapeStream{Points: func(i int, v *Point) error { return nil }}
+	for _, data := range []string{
+		``,
+		`[]`,
+		`{"points":[{"x":1,"y":2}`,
+		`{"points":[{"x":1,"y":2}}`,
+		`{"points":[{"x":1,"y":2},]}`,
+		`{"points":{}}`,
+		`{"points":[{"x":"1","y":2}]}`,
+		// Elements are checked against the constraints of their type.
+		`{"points":[{"x":1001,"y":2}]}`,
+		`{"name":"x"} {}`,
+	} {
+		var m Shape
+		if err := m.DecodeJSONStream(strings.NewReader(data), h); err == nil {
+			t.Errorf("%s: decoded %+v", data, m)
+		}
+	}
+}
+
+// Compared with reading the whole message and decoding it, without the
+// validation of the message that the stream skips too. UnmarshalJSON would
+// reject the points over max_items.
+func BenchmarkDecodeJSONStream(b *testing.B) {
+	data := largeShape(10000)
+	b.Run("stream", func(b *testing.B) {
+		sum := 0.0
+		h := &ShapeStream{Points: func(i int, v *Point) error {
+			sum += v.Y
+			return nil
+		}}
+		b.ReportAllocs()
+		var m Shape
+		for i := 0; i < b.N; i++ {
+			if err := m.DecodeJSONStream(bytes.NewReader(data), h); err != nil {
+				b.Fatal(err)
+			}
+		}
+		sinkFloat = sum
+	})
+	b.Run("whole", func(b *testing.B) {
+		sum := 0.0
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			all, err := io.ReadAll(bytes.NewReader(data))
+			if err != nil {
+				b.Fatal(err)
+			}
+			var m Shape
+			d := tmJSONDecoder{data: all}
+			m.decodeJSON(&d)
+			if err := d.end(); err != nil {
+				b.Fatal(err)
+			}
+			for j := range m.Points {
+				sum += m.Points[j].Y
+			}
+		}
+		sinkFloat = sum
+	})
+}
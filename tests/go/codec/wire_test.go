@@ -0,0 +1,74 @@
+package codec
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/hex"
+	"os"
+	"strings"
+	"testing"
+)
+
+type wireMessage interface {
+	AppendJSON(b []byte) []byte
+	UnmarshalJSON(data []byte) error
+	AppendBinary(b []byte) []byte
+	UnmarshalBinary(data []byte) error
+}
+
+func newWireMessage(name string) wireMessage {
+	switch name {
+	case "Item":
+		return &Item{}
+	case "Point":
+		return &Point{}
+	case "Mixed":
+		return &Mixed{}
+	case "Shape":
+		return &Shape{}
+	}
+	return nil
+}
+
+// TestWireGolden checks the binary codec against the vectors that the
+// tests of every target share. Values are compared as the JSON the codec
+// writes for them.
+func TestWireGolden(t *testing.T) {
+	file, err := os.Open("../../wire_golden.txt")
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer file.Close()
+	scanner := bufio.NewScanner(file)
+	for line := 1; scanner.Scan(); line++ {
+		if scanner.Text() == "" || strings.HasPrefix(scanner.Text(), "#") {
+			continue
+		}
+		fields := strings.Split(scanner.Text(), "\t")
+		data, err := hex.DecodeString(fields[2])
+		if err != nil {
+			t.Fatalf("line %d: %v", line, err)
+		}
+		want := newWireMessage(fields[0])
+		if err := want.UnmarshalJSON([]byte(fields[1])); err != nil {
+			t.Fatalf("line %d: %v", line, err)
+		}
+		if len(fields) < 4 {
+			if got := want.AppendBinary(nil); !bytes.Equal(got, data) {
+				t.Errorf("line %d: encoded to\n%x\nwant\n%x", line, got, data)
+			}
+		}
+		got := newWireMessage(fields[0])
+		if err := got.UnmarshalBinary(data); err != nil {
+			t.Errorf("line %d: %v", line, err)
+			continue
+		}
+		if !bytes.Equal(got.AppendJSON(nil), want.AppendJSON(nil)) {
+			t.Errorf("line %d: decoded to\n%s\nwant\n%s", line,
+				got.AppendJSON(nil), want.AppendJSON(nil))
+		}
+	}
+	if err := scanner.Err(); err != nil {
+		t.Fatal(err)
+	}
+}
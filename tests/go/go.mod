@@ -0,0 +1,3 @@
+module toolman.test
+
+go 1.18
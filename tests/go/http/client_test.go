@@ -0,0 +1,156 @@
+package http
+
+import (
+	"context"
+	"errors"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+
+	"toolman.test/sample"
+)
+
+// recorder answers every request with a canned response and keeps the
+// request line and body it got.
+type recorder struct {
+	status int
+	body   string
+	got    []string
+}
+
+func (rec *recorder) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	body, err := io.ReadAll(r.Body)
+	if err != nil {
+		panic(err)
+	}
+	rec.got = append(rec.got, r.Method+" "+r.RequestURI+" "+string(body))
+	w.WriteHeader(rec.status)
+	w.Write([]byte(rec.body))
+}
+
+func TestClientURLs(t *testing.T) {
+	rec := &recorder{status: 599}
+	srv := httptest.NewServer(rec)
+	defer srv.Close()
+	// A trailing slash on the base is dropped.
+	c := NewShapesClient(srv.URL+"/", srv.Client())
+	ctx := context.Background()
+	c.Get(ctx, nil)
+	c.GetShapes(ctx, &Point{X: 1})
+	c.GetShapesById(ctx, -9223372036854775808, nil)
+	c.DeleteShapesById(ctx, 7, nil)
+	c.GetShapesByIdPointsByIdx(ctx, 7, 4294967295, nil)
+	c.GetShapesSearch(ctx, nil)
+	c.PostShapesByColorByColor(ctx, Color_Green, &Shape{Name: "a"})
+	// Everything but unreserved characters is escaped, in UTF-8.
+	c.GetSettingsByNameByOn(ctx, "a/b c?d%€", true, nil)
+	c.GetSettingsByNameByOn(ctx, "", false, nil)
+	want := []string{
+		"GET / ",
+		`GET /shapes {"x":1,"y":0}`,
+		"GET /shapes/-9223372036854775808 ",
+		"DELETE /shapes/7 ",
+		"GET /shapes/7/points/4294967295 ",
+		"GET /shapes/search ",
+		"POST /shapes/by-color/Green ",
+		"GET /settings/a%2Fb%20c%3Fd%25%E2%82%AC/true ",
+		"GET /settings//false ",
+	}
+	if len(rec.got) != len(want) {
+		t.Fatalf("got %d requests, want %d: %q", len(rec.got), len(want), rec.got)
+	}
+	for i := range want {
+		if !strings.HasPrefix(rec.got[i], want[i]) {
+			t.Errorf("request %d is %q, want %q", i, rec.got[i], want[i])
+		}
+	}
+	if !strings.Contains(rec.got[6], `"name":"a"`) {
+		t.Errorf("POST body %q", rec.got[6])
+	}
+}
+
+func TestClientDecodesByStatus(t *testing.T) {
+	rec := &recorder{}
+	srv := httptest.NewServer(rec)
+	defer srv.Close()
+	c := NewShapesClient(srv.URL, srv.Client())
+	ctx := context.Background()
+
+	rec.status, rec.body = 200, string(sample.Shape)
+	resp, err := c.GetShapesById(ctx, 1, nil)
+	if err != nil || resp.Status() != 200 || resp.Body200().Name != "hello_world" ||
+		resp.Body404() != 0 {
+		t.Fatalf("200: %+v, %v", resp, err)
+	}
+	rec.status, rec.body = 404, "404"
+	resp, err = c.GetShapesById(ctx, 1, nil)
+	if err != nil || resp.Status() != 404 || resp.Body404() != Status_NotFound ||
+		resp.Body200() != nil {
+		t.Fatalf("404: %+v, %v", resp, err)
+	}
+	// A 200 response body may be null.
+	rec.status, rec.body = 200, "null"
+	if resp, err := c.Get(ctx, nil); err != nil || resp.Status() != 200 {
+		t.Fatalf("null: %+v, %v", resp, err)
+	}
+
+	// A status the api does not declare keeps its body in the error.
+	rec.status, rec.body = 503, "busy"
+	_, err = c.GetShapesById(ctx, 1, nil)
+	var httpErr *ToolmanHTTPError
+	if !errors.As(err, &httpErr) || httpErr.Status != 503 ||
+		string(httpErr.Body) != "busy" {
+		t.Fatalf("503: %v", err)
+	}
+	// So does a declared status with the body of another.
+	rec.status, rec.body = 404, "busy"
+	if resp, err := c.GetShapesById(ctx, 1, nil); err == nil {
+		t.Fatalf("malformed 404 decoded as %+v", resp)
+	}
+	rec.status, rec.body = 200, `{"x":1}{`
+	if resp, err := c.Get(ctx, nil); err == nil {
+		t.Fatalf("trailing data decoded as %+v", resp)
+	}
+}
+
+// The client against the generated server, both ways through the codecs.
+func TestClientServerRoundTrip(t *testing.T) {
+	h := &handler{}
+	srv := httptest.NewServer(NewShapesServer(h))
+	defer srv.Close()
+	c := NewShapesClient(srv.URL, srv.Client())
+	ctx := context.Background()
+
+	var shape Shape
+	if err := shape.UnmarshalJSON(sample.Shape); err != nil {
+		t.Fatal(err)
+	}
+	resp, err := c.PostShapesByColorByColor(ctx, Color_Blue, &shape)
+	if err != nil || h.call != "PostShapesByColorByColor Blue hello_world" ||
+		resp.Body200().Color != Color_Blue ||
+		resp.Body200().Points[1] != shape.Points[1] {
+		t.Fatalf("called %q, got %+v, %v", h.call, resp, err)
+	}
+	settings, err := c.GetSettingsByNameByOn(ctx, "a/b c?€", true, nil)
+	if err != nil || h.call != `GetSettingsByNameByOn "a/b c?€" true` ||
+		settings.Body200().X != 9 {
+		t.Fatalf("called %q, got %+v, %v", h.call, settings, err)
+	}
+	point, err := c.GetShapesByIdPointsByIdx(ctx, -3, 8, nil)
+	if err != nil || *point.Body200() != (Point{X: -3, Y: 8}) {
+		t.Fatalf("got %+v, %v", point, err)
+	}
+	missing, err := c.GetShapesById(ctx, 404, nil)
+	if err != nil || missing.Status() != 404 ||
+		missing.Body404() != Status_NotFound {
+		t.Fatalf("got %+v, %v", missing, err)
+	}
+	// An enum value without a name does not make a route.
+	_, err = c.PostShapesByColorByColor(ctx, Color(9), &shape)
+	var httpErr *ToolmanHTTPError
+	if !errors.As(err, &httpErr) || httpErr.Status != 400 {
+		t.Fatalf("unknown color: %v", err)
+	}
+}
@@ -0,0 +1,290 @@
+package http
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strconv"
+	"strings"
+	"testing"
+
+	"toolman.test/sample"
+)
+
+// handler records the call it gets as text and answers from the params.
+type handler struct {
+	call string
+}
+
+func (h *handler) GetShapes(r *http.Request, body *Point) (ShapesGetShapesResponse, error) {
+	h.call = "GetShapes"
+	return ShapesGetShapes200(&Shape{Name: "all"}), nil
+}
+
+func (h *handler) GetShapesById(r *http.Request, id int64, body *Point) (ShapesGetShapesByIdResponse, error) {
+	h.call = fmt.Sprint("GetShapesById ", id)
+	if id == 404 {
+		return ShapesGetShapesById404(Status_NotFound), nil
+	}
+	if id == 500 {
+		return ShapesGetShapesByIdResponse{}, errors.New("boom")
+	}
+	return ShapesGetShapesById200(&Shape{Id: id}), nil
+}
+
+func (h *handler) DeleteShapesById(r *http.Request, id int64, body *Point) (ShapesDeleteShapesByIdResponse, error) {
+	h.call = fmt.Sprint("DeleteShapesById ", id)
+	return ShapesDeleteShapesById200(Status_Teapot), nil
+}
+
+func (h *handler) GetShapesByIdPointsByIdx(r *http.Request, id int64, idx uint32, body *Point) (ShapesGetShapesByIdPointsByIdxResponse, error) {
+	h.call = fmt.Sprint("GetShapesByIdPointsByIdx ", id, " ", idx)
+	return ShapesGetShapesByIdPointsByIdx200(&Point{X: float64(id), Y: float64(idx)}), nil
+}
+
+func (h *handler) GetShapesSearch(r *http.Request, body *Point) (ShapesGetShapesSearchResponse, error) {
+	h.call = fmt.Sprint("GetShapesSearch ", body.X)
+	return ShapesGetShapesSearch200(&Shape{Name: "found"}), nil
+}
+
+func (h *handler) PostShapesByColorByColor(r *http.Request, color Color, body *Shape) (ShapesPostShapesByColorByColorResponse, error) {
+	h.call = fmt.Sprint("PostShapesByColorByColor ", color, " ", body.Name)
+	body.Color = color
+	return ShapesPostShapesByColorByColor200(body), nil
+}
+
+func (h *handler) GetSettingsByNameByOn(r *http.Request, name string, on bool, body *Point) (ShapesGetSettingsByNameByOnResponse, error) {
+	h.call = fmt.Sprintf("GetSettingsByNameByOn %q %v", name, on)
+	return ShapesGetSettingsByNameByOn200(&Point{X: float64(len(name))}), nil
+}
+
+func (h *handler) Get(r *http.Request, body *Point) (ShapesGetResponse, error) {
+	h.call = "Get"
+	return ShapesGet200(nil), nil
+}
+
+func serve(t *testing.T, s http.Handler, method, target, body string) *httptest.ResponseRecorder {
+	t.Helper()
+	w := httptest.NewRecorder()
+	s.ServeHTTP(w, httptest.NewRequest(method, target, strings.NewReader(body)))
+	return w
+}
+
+func TestServerDispatch(t *testing.T) {
+	for _, c := range []struct {
+		method, target, body string
+		call                 string
+		status               int
+		response             string
+	}{
+		{"GET", "/", "", "Get", 200, "null"},
+		{"GET", "/shapes", "", "GetShapes", 200, `"name":"all"`},
+		{"GET", "/shapes/7", "", "GetShapesById 7", 200, `"id":7`},
+		{"GET", "/shapes/-9223372036854775808", "",
+			"GetShapesById -9223372036854775808", 200,
+			`"id":-9223372036854775808`},
+		{"GET", "/shapes/404", "", "GetShapesById 404", 404, "404"},
+		{"DELETE", "/shapes/7", "", "DeleteShapesById 7", 200, "418"},
+		{"GET", "/shapes/7/points/3", "", "GetShapesByIdPointsByIdx 7 3",
+			200, `{"x":7,"y":3}`},
+		// The static segment wins over the param next to it.
+		{"GET", "/shapes/search", `{"x":2,"y":0}`, "GetShapesSearch 2", 200,
+			`"name":"found"`},
+		{"POST", "/shapes/by-color/Blue", string(sample.Shape),
+			"PostShapesByColorByColor Blue hello_world", 200, `"color":3`},
+		// String params are unescaped, the others parse the text as is.
+		{"GET", "/settings/a%2Fb%20c/true", "",
+			`GetSettingsByNameByOn "a/b c" true`, 200, `{"x":5,`},
+		{"GET", "/settings/%E2%82%AC/false", "",
+			`GetSettingsByNameByOn "€" false`, 200, `{"x":3,`},
+	} {
+		h := &handler{}
+		w := serve(t, NewShapesServer(h), c.method, c.target, c.body)
+		if h.call != c.call || w.Code != c.status ||
+			!strings.Contains(w.Body.String(), c.response) {
+			t.Errorf("%s %s: called %q, got %d %s, want %q, %d %s",
+				c.method, c.target, h.call, w.Code, w.Body, c.call,
+				c.status, c.response)
+		}
+		if got := w.Header().Get("Content-Type"); got != "application/json" {
+			t.Errorf("%s %s: Content-Type %q", c.method, c.target, got)
+		}
+	}
+}
+
+func TestServerRejects(t *testing.T) {
+	for _, c := range []struct {
+		method, target, body string
+		status               int
+		allow                string
+	}{
+		// Paths no route matches, also by a prefix or with more segments.
+		{"GET", "/nope", "", 404, ""},
+		{"GET", "/shape", "", 404, ""},
+		{"GET", "/shapes/", "", 404, ""},
+		{"GET", "/shapes/7/", "", 404, ""},
+		{"GET", "/shapes/7/points", "", 404, ""},
+		{"GET", "/shapes/7/points/3/4", "", 404, ""},
+		{"GET", "/shapes/by-color/", "", 404, ""},
+		{"GET", "/settings/a", "", 404, ""},
+		{"GET", "//", "", 404, ""},
+		// Routes without the method list the methods they have.
+		{"POST", "/", "", 405, "GET"},
+		{"PUT", "/shapes/7", "", 405, "GET, DELETE"},
+		{"GET", "/shapes/by-color/Red", "", 405, "POST"},
+		// Params that do not parse as their type, and malformed bodies.
+		{"GET", "/shapes/x", "", 400, ""},
+		{"GET", "/shapes/9223372036854775808", "", 400, ""},
+		{"GET", "/shapes/7/points/-1", "", 400, ""},
+		{"GET", "/shapes/7/points/4294967296", "", 400, ""},
+		{"POST", "/shapes/by-color/Purple", "{}", 400, ""},
+		{"GET", "/settings/a/maybe", "", 400, ""},
+		{"GET", "/shapes/search", `{"x":`, 400, ""},
+		// A handler error is an internal error.
+		{"GET", "/shapes/500", "", 500, ""},
+	} {
+		h := &handler{}
+		w := serve(t, NewShapesServer(h), c.method, c.target, c.body)
+		if w.Code != c.status || w.Header().Get("Allow") != c.allow {
+			t.Errorf("%s %s: got %d, Allow %q, want %d, Allow %q",
+				c.method, c.target, w.Code, w.Header().Get("Allow"),
+				c.status, c.allow)
+		}
+		if c.status != 500 && h.call != "" {
+			t.Errorf("%s %s: called %s", c.method, c.target, h.call)
+		}
+	}
+}
+
+// A zero response, one no <Status> function made, is an internal error.
+type zeroHandler struct{ handler }
+
+func (zeroHandler) Get(r *http.Request, body *Point) (ShapesGetResponse, error) {
+	return ShapesGetResponse{}, nil
+}
+
+func TestServerZeroResponse(t *testing.T) {
+	if w := serve(t, NewShapesServer(&zeroHandler{}), "GET", "/", ""); w.Code != 500 {
+		t.Fatalf("got %d %s", w.Code, w.Body)
+	}
+}
+
+// The same routes on http.ServeMux, which matches prefixes only, so the
+// params are split out by hand as a server without generated routing
+// would. The handler and the JSON codec are shared.
+func newServeMux(h ShapesHandler) *http.ServeMux {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/shapes/", func(w http.ResponseWriter, r *http.Request) {
+		parts := strings.Split(strings.TrimPrefix(r.URL.Path, "/shapes/"), "/")
+		if len(parts) != 3 || parts[1] != "points" {
+			http.NotFound(w, r)
+			return
+		}
+		if r.Method != "GET" {
+			w.Header().Set("Allow", "GET")
+			http.Error(w, "", http.StatusMethodNotAllowed)
+			return
+		}
+		id, err := strconv.ParseInt(parts[0], 10, 64)
+		if err != nil {
+			http.Error(w, "malformed path param id", http.StatusBadRequest)
+			return
+		}
+		idx, err := strconv.ParseUint(parts[2], 10, 32)
+		if err != nil {
+			http.Error(w, "malformed path param idx", http.StatusBadRequest)
+			return
+		}
+		var body Point
+		if data, err := io.ReadAll(r.Body); err != nil {
+			http.Error(w, err.Error(), http.StatusBadRequest)
+			return
+		} else if len(data) != 0 {
+			if err := body.UnmarshalJSON(data); err != nil {
+				http.Error(w, err.Error(), http.StatusBadRequest)
+				return
+			}
+		}
+		resp, err := h.GetShapesByIdPointsByIdx(r, id, uint32(idx), &body)
+		if err != nil {
+			http.Error(w, err.Error(), http.StatusInternalServerError)
+			return
+		}
+		w.Header().Set("Content-Type", "application/json")
+		w.WriteHeader(resp.Status())
+		w.Write(resp.Body200().AppendJSON(nil))
+	})
+	return mux
+}
+
+func TestServeMuxBaseline(t *testing.T) {
+	h := &handler{}
+	w := serve(t, newServeMux(h), "GET", "/shapes/7/points/3", "")
+	if w.Code != 200 || w.Body.String() != `{"x":7,"y":3}` {
+		t.Fatalf("got %d %s", w.Code, w.Body)
+	}
+}
+
+// discard is a ResponseWriter that keeps nothing, so that the route
+// benchmarks measure the server.
+type discard struct {
+	header http.Header
+}
+
+func (w *discard) Header() http.Header         { return w.header }
+func (w *discard) Write(b []byte) (int, error) { return len(b), nil }
+func (w *discard) WriteHeader(int)             {}
+
+func servers() []struct {
+	name string
+	h    http.Handler
+} {
+	return []struct {
+		name string
+		h    http.Handler
+	}{
+		{"generated", NewShapesServer(&handler{})},
+		{"servemux", newServeMux(&handler{})},
+	}
+}
+
+// Routes a request with two params and answers it, in process.
+func BenchmarkRoute(b *testing.B) {
+	for _, s := range servers() {
+		b.Run(s.name, func(b *testing.B) {
+			r := httptest.NewRequest("GET", "/shapes/7/points/3", nil)
+			w := &discard{header: http.Header{}}
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				r.Body = http.NoBody
+				s.h.ServeHTTP(w, r)
+			}
+		})
+	}
+}
+
+// The same request over a loopback connection that is kept alive.
+func BenchmarkLoopback(b *testing.B) {
+	for _, s := range servers() {
+		b.Run(s.name, func(b *testing.B) {
+			srv := httptest.NewServer(s.h)
+			defer srv.Close()
+			c := srv.Client()
+			url := srv.URL + "/shapes/7/points/3"
+			b.ReportAllocs()
+			for i := 0; i < b.N; i++ {
+				res, err := c.Get(url)
+				if err != nil {
+					b.Fatal(err)
+				}
+				io.Copy(io.Discard, res.Body)
+				res.Body.Close()
+				if res.StatusCode != 200 {
+					b.Fatal(res.Status)
+				}
+			}
+		})
+	}
+}
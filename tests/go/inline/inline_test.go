@@ -0,0 +1,102 @@
+package inline
+
+import (
+	"strings"
+	"testing"
+
+	"toolman.test/sample"
+)
+
+func sampleBinary(tb testing.TB) []byte {
+	var s Shape
+	if err := s.UnmarshalJSON(sample.Shape); err != nil {
+		tb.Fatal(err)
+	}
+	return s.AppendBinary(nil)
+}
+
+func TestInlineOneof(t *testing.T) {
+	var s Shape
+	if err := s.UnmarshalBinary(sampleBinary(t)); err != nil {
+		t.Fatal(err)
+	}
+	if s.Shape_kind.Kind() != Shape_Shape_kind_Text ||
+		s.Shape_kind.Text() != "hello" || s.Shape_kind.Radius() != 0 {
+		t.Fatalf("decoded oneof %+v", s.Shape_kind)
+	}
+	s.Shape_kind.SetOrigin(Point{X: 1, Y: 2})
+	if s.Shape_kind.Kind() != Shape_Shape_kind_Origin ||
+		s.Shape_kind.Text() != "" {
+		t.Fatalf("SetOrigin left %+v", s.Shape_kind)
+	}
+	json := string(s.AppendJSON(nil))
+	if !strings.Contains(json, `"shape_kind":{"origin":{"x":1,"y":2}}`) {
+		t.Fatalf("oneof missing from %s", json)
+	}
+	var out Shape
+	if err := out.UnmarshalBinary(s.AppendBinary(nil)); err != nil {
+		t.Fatal(err)
+	}
+	if out.Shape_kind != s.Shape_kind {
+		t.Fatalf("binary round trip gave %+v", out.Shape_kind)
+	}
+	s.Shape_kind.Clear()
+	if s.Shape_kind.Kind() != Shape_Shape_kind_None ||
+		!strings.Contains(string(s.AppendJSON(nil)), `"shape_kind":null`) {
+		t.Fatalf("Clear left %+v", s.Shape_kind)
+	}
+}
+
+// Compare with the namesakes in the codec package, which holds oneofs in
+// interfaces.
+
+func BenchmarkUnmarshalBinary(b *testing.B) {
+	data := sampleBinary(b)
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		var s Shape
+		if err := s.UnmarshalBinary(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+var shapes = make([]Shape, 1024)
+
+func BenchmarkSetOneof(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s := &shapes[i%len(shapes)]
+		if i%2 == 0 {
+			s.Shape_kind.SetRadius(float64(i))
+		} else {
+			s.Shape_kind.SetOrigin(Point{X: 1, Y: 2})
+		}
+	}
+}
+
+var sinkFloat float64
+
+func BenchmarkSumOneof1024(b *testing.B) {
+	for i := range shapes {
+		if i%2 == 0 {
+			shapes[i].Shape_kind.SetRadius(float64(i))
+		} else {
+			shapes[i].Shape_kind.SetOrigin(Point{X: 1, Y: 2})
+		}
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		total := 0.0
+		for j := range shapes {
+			kind := &shapes[j].Shape_kind
+			switch kind.Kind() {
+			case Shape_Shape_kind_Radius:
+				total += kind.Radius()
+			case Shape_Shape_kind_Origin:
+				total += kind.Origin().X
+			}
+		}
+		sinkFloat = total
+	}
+}
@@ -0,0 +1,125 @@
+package packed
+
+import (
+	"bytes"
+	"encoding/json"
+	"os"
+	"reflect"
+	"regexp"
+	"strconv"
+	"testing"
+	"unsafe"
+
+	"toolman.test/plain"
+	"toolman.test/sample"
+)
+
+// The sizes the comments above the structs report, in this layout and in
+// declaration order, against what the compiler lays out.
+func TestPackedSizes(t *testing.T) {
+	src, err := os.ReadFile("examples.go")
+	if err != nil {
+		t.Fatal(err)
+	}
+	sizes := map[string][2]uintptr{
+		"Shape": {unsafe.Sizeof(Shape{}), unsafe.Sizeof(plain.Shape{})},
+		"Item":  {unsafe.Sizeof(Item{}), unsafe.Sizeof(plain.Item{})},
+		"Point": {unsafe.Sizeof(Point{}), unsafe.Sizeof(plain.Point{})},
+		"Mixed": {unsafe.Sizeof(Mixed{}), unsafe.Sizeof(plain.Mixed{})},
+	}
+	comments := regexp.MustCompile(`// Fields (ordered by alignment|in `+
+		`declaration order): (\d+) bytes(?:, (\d+) in declaration `+
+		`order)?\.\n(\w+) struct`).FindAllSubmatch(src, -1)
+	if len(comments) != len(sizes) {
+		t.Fatalf("%d commented structs, want %d", len(comments), len(sizes))
+	}
+	packed := 0
+	for _, c := range comments {
+		name := string(c[4])
+		size, _ := strconv.Atoi(string(c[2]))
+		declared := size
+		if len(c[3]) > 0 {
+			declared, _ = strconv.Atoi(string(c[3]))
+			packed++
+		}
+		want := sizes[name]
+		if uintptr(size) != want[0] || uintptr(declared) != want[1] {
+			t.Errorf("%s: commented %d and %d bytes, laid out in %d and %d",
+				name, size, declared, want[0], want[1])
+		}
+		if declared <= size && len(c[3]) > 0 {
+			t.Errorf("%s: reordered without saving space", name)
+		}
+	}
+	// Shape and Mixed are the ones whose fields move.
+	if packed != 2 {
+		t.Errorf("%d structs reordered, want 2", packed)
+	}
+}
+
+// The keys of the JSON object b, in the order they are written.
+func keys(t *testing.T, b []byte) []string {
+	t.Helper()
+	d := json.NewDecoder(bytes.NewReader(b))
+	if _, err := d.Token(); err != nil {
+		t.Fatal(err)
+	}
+	var keys []string
+	for d.More() {
+		key, err := d.Token()
+		if err != nil {
+			t.Fatal(err)
+		}
+		keys = append(keys, key.(string))
+		var value json.RawMessage
+		if err := d.Decode(&value); err != nil {
+			t.Fatal(err)
+		}
+	}
+	return keys
+}
+
+// However the fields are laid out, json.Marshal writes them in the order
+// examples.tm declares them, and the values come back.
+func TestPackedJSONOrder(t *testing.T) {
+	var s Shape
+	if err := json.Unmarshal(sample.Shape, &s); err != nil {
+		t.Fatal(err)
+	}
+	b, err := json.Marshal(s)
+	if err != nil {
+		t.Fatal(err)
+	}
+	want := []string{"id", "name", "visible", "count", "size", "big",
+		"label", "color", "alt_color", "center", "anchor", "points",
+		"weights", "ids", "tags", "by_id", "matrix", "extra", "shape_kind"}
+	if got := keys(t, b); !reflect.DeepEqual(got, want) {
+		t.Errorf("Shape keys: got %v, want %v", got, want)
+	}
+	var back Shape
+	if err := json.Unmarshal(b, &back); err != nil {
+		t.Fatal(err)
+	}
+	if !reflect.DeepEqual(back, s) {
+		t.Errorf("got %+v, want %+v", back, s)
+	}
+
+	c := true
+	m := Mixed{A: true, B: -1, C: &c, D: 2, E: "e", F: true,
+		G: Point{X: 1, Y: 2}}
+	b, err = json.Marshal(&m)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if got, want := keys(t, b), []string{"a", "b", "c", "d", "e", "f",
+		"g"}; !reflect.DeepEqual(got, want) {
+		t.Errorf("Mixed keys: got %v, want %v", got, want)
+	}
+	var mixed Mixed
+	if err := json.Unmarshal(b, &mixed); err != nil {
+		t.Fatal(err)
+	}
+	if !reflect.DeepEqual(mixed, m) {
+		t.Errorf("got %+v, want %+v", mixed, m)
+	}
+}
@@ -0,0 +1,65 @@
+package plain
+
+import (
+	"encoding/json"
+	"testing"
+)
+
+// sample matches the one in codec/json_test.go, so that the benchmarks of
+// both packages encode the same message.
+func sample() Shape {
+	count := int32(-3)
+	big := uint64(1<<63 + 5)
+	label := "abc"
+	altColor := Color_Blue
+	return Shape{
+		Id:        -1 << 62,
+		Name:      "hello_world",
+		Visible:   true,
+		Count:     &count,
+		Size:      42,
+		Big:       &big,
+		Label:     &label,
+		Color:     Color_Green,
+		Alt_color: &altColor,
+		Center:    Point{X: 1.5, Y: -2e-9},
+		Anchor:    &Point{X: 3, Y: 1e22},
+		Points:    []Point{{X: 1, Y: 2}, {X: 0.1, Y: 123456789.125}},
+		Weights:   []float64{0, -0.5, 1e21},
+		Ids:       []int32{1, -2, 3},
+		Tags:      map[string]string{"b": "2", "a": "1", "c\"<>": "3"},
+		By_id: map[int64]Point{
+			-5: {X: 7, Y: 8}, 10: {X: 1}, 9: {Y: 2}, 100: {X: 3, Y: 3},
+		},
+		Matrix: [][]int64{{1, 2}, nil, {}},
+	}
+}
+
+// The encoding/json baseline of the benchmarks in codec.
+
+func BenchmarkMarshalJSON(b *testing.B) {
+	s := sample()
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		if _, err := json.Marshal(&s); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkUnmarshalJSON(b *testing.B) {
+	s := sample()
+	data, err := json.Marshal(&s)
+	if err != nil {
+		b.Fatal(err)
+	}
+	b.SetBytes(int64(len(data)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		var out Shape
+		if err := json.Unmarshal(data, &out); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
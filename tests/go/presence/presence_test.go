@@ -0,0 +1,73 @@
+package presence
+
+import (
+	"strings"
+	"testing"
+
+	"toolman.test/sample"
+)
+
+func sampleBinary(tb testing.TB) []byte {
+	var s Shape
+	if err := s.UnmarshalJSON(sample.Shape); err != nil {
+		tb.Fatal(err)
+	}
+	return s.AppendBinary(nil)
+}
+
+func TestPresenceBits(t *testing.T) {
+	var s Shape
+	// Absent fields are null, as encoding/json writes nil pointers.
+	if json := string(s.AppendJSON(nil)); s.HasCount() ||
+		!strings.Contains(json, `"count":null`) {
+		t.Fatalf("zero Shape has a count: %s", json)
+	}
+	// A zero value that is set is still present, in both codecs.
+	s.Name, s.Color = "a", Color_Red
+	s.SetCount(0)
+	s.SetLabel("abc")
+	if !s.HasCount() || !s.HasLabel() || s.HasBig() {
+		t.Fatal("SetCount or SetLabel did not mark their field present")
+	}
+	if json := string(s.AppendJSON(nil)); !strings.Contains(json, `"count":0`) {
+		t.Fatalf("set count missing from %s", json)
+	}
+	var out Shape
+	if err := out.UnmarshalBinary(s.AppendBinary(nil)); err != nil {
+		t.Fatal(err)
+	}
+	if !out.HasCount() || !out.HasLabel() || out.HasBig() {
+		t.Fatalf("presence lost in the binary codec: %+v", out)
+	}
+	s.ClearCount()
+	if s.HasCount() || !s.HasLabel() {
+		t.Fatal("ClearCount cleared the wrong field")
+	}
+}
+
+// Compare with the namesakes in the codec package, which holds optional
+// fields behind pointers.
+
+func BenchmarkUnmarshalBinary(b *testing.B) {
+	data := sampleBinary(b)
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		var s Shape
+		if err := s.UnmarshalBinary(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+var shapes = make([]Shape, 1024)
+
+func BenchmarkSetOptionals(b *testing.B) {
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		s := &shapes[i%len(shapes)]
+		s.SetCount(int32(i % 5))
+		s.SetBig(uint64(i))
+		s.SetLabel("abc")
+		s.SetAlt_color(Color_Red)
+	}
+}
@@ -0,0 +1,15 @@
+// Package sample holds the message that the benchmarks of the generated
+// packages decode, so that their numbers compare.
+package sample
+
+// Shape is a Shape of examples.tm with every field set, as JSON.
+var Shape = []byte(`{"id":-4611686018427387904,"name":"hello_world",` +
+	`"visible":true,"count":-3,"size":42,"big":9223372036854775813,` +
+	`"label":"abc","color":2,"alt_color":3,"center":{"x":1.5,"y":-2e-9},` +
+	`"anchor":{"x":3,"y":1e+22},` +
+	`"points":[{"x":1,"y":2},{"x":0.1,"y":123456789.125}],` +
+	`"weights":[0,-0.5,1e+21],"ids":[1,-2,3],` +
+	`"tags":{"a":"1","b":"2","c\"<>":"3"},` +
+	`"by_id":{"-5":{"x":7,"y":8},"10":{"x":1,"y":0},"100":{"x":3,"y":3},` +
+	`"9":{"x":0,"y":2}},"matrix":[[1,2],[3],[]],"extra":{"k":[1,"x"]},` +
+	`"shape_kind":{"text":"hello"}}`)
@@ -0,0 +1,71 @@
+package views
+
+import (
+	"testing"
+
+	"toolman.test/sample"
+)
+
+func sampleBinary(tb testing.TB) []byte {
+	var s Shape
+	if err := s.UnmarshalJSON(sample.Shape); err != nil {
+		tb.Fatal(err)
+	}
+	return s.AppendBinary(nil)
+}
+
+func TestViewMatchesDecode(t *testing.T) {
+	data := sampleBinary(t)
+	var s Shape
+	if err := s.UnmarshalBinary(data); err != nil {
+		t.Fatal(err)
+	}
+	v, err := NewShapeView(data)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if v.Id() != s.Id || string(v.Name()) != s.Name ||
+		v.Count() != *s.Count || v.Big() != *s.Big ||
+		string(v.Label()) != *s.Label || v.Color() != s.Color ||
+		v.Center().X() != s.Center.X || v.Anchor().Y() != s.Anchor.Y {
+		t.Errorf("view %+v does not match %+v", v, s)
+	}
+	if !v.HasPoints() || v.HasShape_kind() != (s.Shape_kind != nil) {
+		t.Errorf("view %+v does not match %+v", v, s)
+	}
+	if v, err := NewShapeView(data[:len(data)-1]); err == nil {
+		t.Errorf("truncated message read as %+v", v)
+	}
+	if v, _ := NewShapeView(nil); v.HasId() || len(v.Name()) != 0 {
+		t.Errorf("empty message read as %+v", v)
+	}
+}
+
+var sinkID int64
+var sinkLen int
+
+// BenchmarkReadTwoFields reads the id and the name of a Shape, which a view
+// finds in place while a decode builds the whole message first.
+func BenchmarkReadTwoFields(b *testing.B) {
+	data := sampleBinary(b)
+	b.Run("view", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			v, err := NewShapeView(data)
+			if err != nil {
+				b.Fatal(err)
+			}
+			sinkID, sinkLen = v.Id(), len(v.Name())
+		}
+	})
+	b.Run("decode", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			var s Shape
+			if err := s.UnmarshalBinary(data); err != nil {
+				b.Fatal(err)
+			}
+			sinkID, sinkLen = s.Id, len(s.Name)
+		}
+	})
+}
@@ -0,0 +1,9 @@
+// Refers to a name that two `import *` provide.
+from 'ambiguous_x.tm' import *;
+from 'ambiguous_y.tm' import *;
+
+type (
+    Root struct {
+        dup: Dup
+    }
+)
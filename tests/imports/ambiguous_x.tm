@@ -0,0 +1,5 @@
+type (
+    Dup struct {
+        x: bool
+    }
+)
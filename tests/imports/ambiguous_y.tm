@@ -0,0 +1,5 @@
+type (
+    Dup struct {
+        y: bool
+    }
+)
@@ -0,0 +1,9 @@
+// Imports a module that is part of a cycle this file is not in.
+from 'cycle_a.tm' import *;
+
+type (
+    Root struct {
+        a: A,
+        b: B
+    }
+)
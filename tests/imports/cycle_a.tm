@@ -0,0 +1,7 @@
+from 'cycle_b.tm' import *;
+
+type (
+    A struct {
+        id: i64
+    }
+)
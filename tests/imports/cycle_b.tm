@@ -0,0 +1,7 @@
+from 'cycle_a.tm' import *;
+
+type (
+    B struct {
+        id: i64
+    }
+)
@@ -0,0 +1,8 @@
+// Looks up a name that no module of the cycle declares.
+from 'cycle_a.tm' import *;
+
+type (
+    Root struct {
+        missing: Missing
+    }
+)
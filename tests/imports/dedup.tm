@@ -0,0 +1,11 @@
+// Imports the same file under three paths, it is compiled once and its
+// types are not ambiguous.
+from 'dedup_shared.tm' import *;
+from 'search/../dedup_shared.tm' import *;
+from 'dedup_link.tm' import *;
+
+type (
+    Root struct {
+        shared: Shared
+    }
+)
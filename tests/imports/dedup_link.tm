@@ -0,0 +1 @@
+dedup_shared.tm
\ No newline at end of file
@@ -0,0 +1,5 @@
+type (
+    Shared struct {
+        id: i64
+    }
+)
@@ -0,0 +1,8 @@
+// Imports a module that imports this file back.
+from 'mutual_back.tm' import *;
+
+type (
+    Root struct {
+        back: Back
+    }
+)
@@ -0,0 +1,7 @@
+from 'mutual.tm' import *;
+
+type (
+    Back struct {
+        id: i64
+    }
+)
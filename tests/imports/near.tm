@@ -0,0 +1,5 @@
+type (
+    Near struct {
+        id: i64
+    }
+)
@@ -0,0 +1,8 @@
+// Imports a file that is next to it and in an -I directory.
+from 'near.tm' import *;
+
+type (
+    Root struct {
+        near: Near
+    }
+)
@@ -0,0 +1,8 @@
+// Imports a file that is in both -I directories of the search tests.
+from 'searched.tm' import *;
+
+type (
+    Root struct {
+        first: First
+    }
+)
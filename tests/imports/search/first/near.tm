@@ -0,0 +1,5 @@
+type (
+    Far struct {
+        id: i64
+    }
+)
@@ -0,0 +1,5 @@
+type (
+    First struct {
+        id: i64
+    }
+)
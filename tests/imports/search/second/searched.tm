@@ -0,0 +1,5 @@
+type (
+    Second struct {
+        id: i64
+    }
+)
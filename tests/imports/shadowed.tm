@@ -0,0 +1,13 @@
+// Declares a name that two `import *` provide, which shadows both.
+from 'ambiguous_x.tm' import *;
+from 'ambiguous_y.tm' import *;
+
+type (
+    Dup struct {
+        local: bool
+    },
+
+    Root struct {
+        dup: Dup
+    }
+)
@@ -0,0 +1,178 @@
+import java.nio.charset.StandardCharsets;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Checks the copies that deep_copy generates: copyFrom overwrites every
+ * field, absent ones included, and the copy shares no list, map, nested
+ * object or oneof with the original, so changing one leaves the other as
+ * it was.
+ */
+public final class DeepCopy {
+    private DeepCopy() {}
+
+    // Every field set, with something to change at every level.
+    private static final String FULL = "{\"id\":-9223372036854775808,"
+        + "\"name\":\"hello_world\",\"visible\":true,\"count\":-5,"
+        + "\"size\":100,\"big\":18446744073709551615,"
+        + "\"label\":\"abc\",\"color\":2,\"alt_color\":3,"
+        + "\"center\":{\"x\":1.5,\"y\":-2},\"anchor\":{\"x\":0,\"y\":0.25},"
+        + "\"points\":[{\"x\":1,\"y\":2}],\"weights\":[0.5,-3,2.75],"
+        + "\"ids\":[-2147483648,0,2147483647],"
+        + "\"tags\":{\"b\":\"2\",\"a\":\"1\"},"
+        + "\"by_id\":{\"-5\":{\"x\":7,\"y\":0},\"10\":{\"x\":1,\"y\":2}},"
+        + "\"matrix\":[[1,-2],[],[9223372036854775807]],"
+        + "\"extra\":{\"k\":[\"s\",true,null]},"
+        + "\"shape_kind\":{\"origin\":{\"x\":3,\"y\":4}}}";
+
+    // Every optional field absent.
+    private static final String EMPTY = "{\"id\":0,\"name\":\"a\","
+        + "\"visible\":false,\"count\":null,\"size\":0,\"big\":null,"
+        + "\"label\":null,\"color\":1,\"alt_color\":null,"
+        + "\"center\":{\"x\":0,\"y\":0},\"anchor\":null,\"points\":null,"
+        + "\"weights\":null,\"ids\":null,\"tags\":null,\"by_id\":null,"
+        + "\"matrix\":null,\"extra\":null,\"shape_kind\":null}";
+
+    public static void main(String[] args) throws Exception {
+        copies();
+        independent();
+        overwrites();
+        oneofs();
+    }
+
+    private static void copies() throws Exception {
+        for (String text : new String[] {FULL, EMPTY}) {
+            Examples.Shape m = shape(text);
+            Examples.Shape c = m.deepCopy();
+            check(c != m && json(c).equals(text), "deepCopy of " + text,
+                json(c));
+            Examples.Shape into = new Examples.Shape();
+            check(into.copyFrom(m) == into && json(into).equals(text),
+                "copyFrom of " + text, json(into));
+            // Copying a message into itself leaves it as it was.
+            check(m.copyFrom(m) == m && json(m).equals(text),
+                "copyFrom itself of " + text, json(m));
+        }
+    }
+
+    @SuppressWarnings("unchecked")
+    private static void independent() throws Exception {
+        Examples.Shape m = shape(FULL);
+        Examples.Shape c = m.deepCopy();
+        check(c.getCenter() != m.getCenter()
+            && c.getAnchor() != m.getAnchor()
+            && c.getPoints() != m.getPoints()
+            && c.getPoints().get(0) != m.getPoints().get(0)
+            && c.getWeights() != m.getWeights() && c.getIds() != m.getIds()
+            && c.getTags() != m.getTags() && c.getById() != m.getById()
+            && c.getById().get(-5L) != m.getById().get(-5L)
+            && c.getMatrix() != m.getMatrix()
+            && c.getMatrix().get(0) != m.getMatrix().get(0)
+            && c.getExtra() != m.getExtra()
+            && c.getShapeKind() != m.getShapeKind(), "shared storage",
+            json(c));
+
+        c.getCenter().setX(100);
+        c.getAnchor().setY(100);
+        c.getPoints().get(0).setX(100);
+        c.getPoints().add(new Examples.Point());
+        c.getWeights().set(0, 100.0);
+        c.getIds().add(100);
+        c.getTags().put("a", "changed");
+        c.getById().get(-5L).setX(100);
+        c.getById().remove(10L);
+        c.getMatrix().get(0).set(0, 100L);
+        c.getMatrix().get(1).add(100L);
+        c.getMatrix().add(null);
+        Map<String, Object> extra = (Map<String, Object>) c.getExtra();
+        ((List<Object>) extra.get("k")).set(0, "changed");
+        extra.put("added", 1.0);
+        ((Examples.ShapeOrigin) c.getShapeKind()).getOrigin().setX(100);
+        check(json(m).equals(FULL), "changing the copy changed the original",
+            json(m));
+
+        // Nor does changing the original change the copy.
+        String copied = json(c);
+        m.getPoints().clear();
+        m.getTags().clear();
+        m.getMatrix().get(2).set(0, 0L);
+        ((Examples.ShapeOrigin) m.getShapeKind()).setOrigin(null);
+        check(json(c).equals(copied), "changing the original changed the copy",
+            json(c));
+    }
+
+    // copyFrom leaves nothing of what the message held before.
+    private static void overwrites() throws Exception {
+        Examples.Shape m = shape(FULL);
+        m.copyFrom(shape(EMPTY));
+        check(json(m).equals(EMPTY), "copyFrom an empty Shape", json(m));
+        m.copyFrom(shape(FULL));
+        check(json(m).equals(FULL), "copyFrom a full Shape", json(m));
+
+        Examples.Mixed mixed = Examples.Mixed.parseFrom(utf8("{\"a\":true,"
+            + "\"b\":-1,\"c\":false,\"d\":2,\"e\":\"e\",\"f\":true,"
+            + "\"g\":{\"x\":1,\"y\":2}}"));
+        Examples.Mixed into = Examples.Mixed.parseFrom(utf8("{\"a\":false,"
+            + "\"b\":0,\"c\":null,\"d\":0,\"e\":\"\",\"f\":false,"
+            + "\"g\":{\"x\":0,\"y\":0}}"));
+        into.copyFrom(mixed);
+        check(json(into).equals(json(mixed)) && into.getG() != mixed.getG(),
+            "copyFrom a Mixed", json(into));
+    }
+
+    // Each alternative of a oneof is copied as itself.
+    private static void oneofs() throws Exception {
+        for (String kind : new String[] {"{\"radius\":1.5}",
+                "{\"text\":\"hello\"}", "{\"origin\":{\"x\":3,\"y\":4}}",
+                "{\"origin\":null}"}) {
+            String text = EMPTY.replace("\"shape_kind\":null",
+                "\"shape_kind\":" + kind);
+            Examples.Shape m = shape(text);
+            Examples.Shape c = m.deepCopy();
+            check(c.getShapeKind().getClass() == m.getShapeKind().getClass()
+                && c.getShapeKind() != m.getShapeKind()
+                && json(c).equals(text), "oneof " + kind, json(c));
+        }
+        for (String kind : new String[] {"{\"count\":-1}",
+                "{\"label\":\"l\"}"}) {
+            String text = "{\"id\":1,\"name\":\"n\",\"tags\":[0,4294967295],"
+                + "\"kind\":" + kind + "}";
+            Examples.Item m = Examples.Item.parseFrom(utf8(text));
+            Examples.Item c = m.deepCopy();
+            check(c.getKind() != m.getKind() && c.getTags() != m.getTags()
+                && json(c).equals(text), "oneof " + kind, json(c));
+        }
+    }
+
+    private static Examples.Shape shape(String text) {
+        return Examples.Shape.parseFrom(utf8(text));
+    }
+
+    private static byte[] utf8(String text) {
+        return text.getBytes(StandardCharsets.UTF_8);
+    }
+
+    private static String json(Examples.Shape m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Mixed m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Item m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static void check(boolean ok, String what, String got) {
+        if (!ok) {
+            throw new AssertionError(what + ": got " + got);
+        }
+    }
+}
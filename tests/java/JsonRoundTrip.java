@@ -0,0 +1,233 @@
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Checks the JSON codec on its own: texts in the form the codec writes
+ * them come back unchanged, optional fields and oneofs decode to what
+ * their accessors promise, and enums are looked up by number and by name.
+ */
+public final class JsonRoundTrip {
+    private JsonRoundTrip() {}
+
+    // Every field set, with values at the edges of their types where the
+    // constraints allow.
+    private static final String FULL = "{\"id\":-9223372036854775808,"
+        + "\"name\":\"hello_world\",\"visible\":true,\"count\":-5,"
+        + "\"size\":100,\"big\":18446744073709551615,"
+        + "\"label\":\"abc\",\"color\":2,\"alt_color\":3,"
+        + "\"center\":{\"x\":1.5,\"y\":-2},\"anchor\":{\"x\":0,\"y\":0.25},"
+        + "\"points\":[{\"x\":1,\"y\":2}],\"weights\":[0.5,-3,2.75],"
+        + "\"ids\":[-2147483648,0,2147483647],"
+        + "\"tags\":{\"b\":\"line\\n\",\"a\":\"caf\u00e9\"},"
+        + "\"by_id\":{\"-5\":{\"x\":7,\"y\":0},\"10\":{\"x\":1,\"y\":2}},"
+        + "\"matrix\":[[1,-2],[],[9223372036854775807]],"
+        + "\"extra\":{\"k\":[\"s\",true,null]},"
+        + "\"shape_kind\":{\"origin\":{\"x\":3,\"y\":4}}}";
+
+    // Every optional field absent.
+    private static final String EMPTY = "{\"id\":0,\"name\":\"a\","
+        + "\"visible\":false,\"count\":null,\"size\":0,\"big\":null,"
+        + "\"label\":null,\"color\":1,\"alt_color\":null,"
+        + "\"center\":{\"x\":0,\"y\":0},\"anchor\":null,\"points\":[],"
+        + "\"weights\":[],\"ids\":[],\"tags\":{},\"by_id\":{},\"matrix\":[],"
+        + "\"extra\":null,\"shape_kind\":{\"radius\":1.5}}";
+
+    public static void main(String[] args) throws Exception {
+        roundTrip();
+        optionals();
+        oneofs();
+        enums();
+        rejects();
+    }
+
+    private static void roundTrip() throws Exception {
+        for (String text : new String[] {FULL, EMPTY,
+                EMPTY.replace("{\"radius\":1.5}", "{\"text\":\"\"}"),
+                EMPTY.replace("{\"radius\":1.5}", "null")}) {
+            check(json(shape(text)).equals(text), "round trip of " + text,
+                json(shape(text)));
+        }
+        for (String text : new String[] {
+                "{\"id\":1,\"name\":\"n\",\"tags\":[0,4294967295],"
+                    + "\"kind\":{\"count\":-1}}",
+                "{\"id\":1,\"name\":\"n\",\"tags\":null,"
+                    + "\"kind\":{\"label\":\"\\\"\"}}"}) {
+            Examples.Item m = Examples.Item.parseFrom(utf8(text));
+            check(json(m).equals(text), "round trip of " + text, json(m));
+        }
+        String mixed = "{\"a\":true,\"b\":-1,\"c\":null,\"d\":2,\"e\":\"\","
+            + "\"f\":false,\"g\":{\"x\":0,\"y\":0}}";
+        Examples.Mixed m = Examples.Mixed.parseFrom(utf8(mixed));
+        check(json(m).equals(mixed), "round trip of " + mixed, json(m));
+
+        // Whitespace, key order and unknown keys do not matter.
+        Examples.Shape reordered = shape(" {\"shape_kind\" : {\"radius\":1.5},"
+            + " \"unknown\": [1, {\"a\": null}], \"name\": \"a\", \"color\": 1,"
+            + " \"center\": {\"y\": 0, \"x\": 0}, \"points\": [], "
+            + "\"weights\": [], \"ids\": [], \"tags\": {}, \"by_id\": {},"
+            + " \"matrix\": []} ");
+        check(json(reordered).equals(EMPTY), "reordered", json(reordered));
+    }
+
+    private static void optionals() throws Exception {
+        Examples.Shape full = shape(FULL);
+        check(full.getCount() == -5 && full.getBig() == -1L
+            && "abc".equals(full.getLabel())
+            && full.getAltColor() == Examples.Color.Blue
+            && full.getAnchor().getY() == 0.25
+            && full.getExtra() instanceof java.util.Map, "full optionals",
+            json(full));
+        // Unsigned values keep their bits in the signed Java types.
+        check(full.getBig() == -1L, "unsigned", json(full));
+        Examples.Item item = Examples.Item.parseFrom(
+            utf8("{\"tags\":[4294967295]}"));
+        check(item.getTags().get(0) == -1, "unsigned", json(item));
+
+        // Absent and null are the same, and written back as null.
+        for (String text : new String[] {EMPTY, "{\"name\":\"a\"}"}) {
+            Examples.Shape m = shape(text);
+            check(m.getCount() == null && m.getBig() == null
+                && m.getLabel() == null && m.getAltColor() == null
+                && m.getAnchor() == null && m.getExtra() == null,
+                "absent optionals of " + text, json(m));
+        }
+
+        // Setting and clearing an optional field.
+        Examples.Shape m = shape(EMPTY);
+        m.setCount(0);
+        m.setBig(1L);
+        m.setAnchor(new Examples.Point());
+        String set = json(m);
+        check(set.contains("\"count\":0,") && set.contains("\"big\":1,")
+            && set.contains("\"anchor\":{\"x\":0,\"y\":0}"), "set", set);
+        check(shape(set).getCount() == 0, "decoded set", set);
+        m.setCount(null);
+        m.setBig(null);
+        m.setAnchor(null);
+        check(json(m).equals(EMPTY), "cleared", json(m));
+    }
+
+    private static void oneofs() throws Exception {
+        Examples.IsShapeShapeKind kind = shape(FULL).getShapeKind();
+        check(kind instanceof Examples.ShapeOrigin
+            && ((Examples.ShapeOrigin) kind).getOrigin().getX() == 3,
+            "origin", String.valueOf(kind));
+        kind = shape(EMPTY).getShapeKind();
+        check(kind instanceof Examples.ShapeRadius
+            && ((Examples.ShapeRadius) kind).getRadius() == 1.5, "radius",
+            String.valueOf(kind));
+        // No member, or none that is known, is no value.
+        for (String value : new String[] {"null", "{}", "{\"nope\":1}"}) {
+            Examples.Shape m = shape(EMPTY.replace("{\"radius\":1.5}", value));
+            check(m.getShapeKind() == null, "shape_kind " + value, json(m));
+        }
+
+        // A value set through the interface is written as its member.
+        Examples.Shape m = shape(EMPTY);
+        Examples.ShapeText text = new Examples.ShapeText();
+        text.setText("t");
+        m.setShapeKind(text);
+        check(json(m).endsWith("\"shape_kind\":{\"text\":\"t\"}}"), "text",
+            json(m));
+        Examples.Item item = new Examples.Item();
+        Examples.ItemLabel label = new Examples.ItemLabel();
+        label.setLabel("l");
+        item.setKind(label);
+        Examples.Item decoded = Examples.Item.parseFrom(utf8(json(item)));
+        check(decoded.getKind() instanceof Examples.ItemLabel
+            && ((Examples.ItemLabel) decoded.getKind()).getLabel().equals("l"),
+            "item label", json(decoded));
+    }
+
+    private static void enums() throws Exception {
+        // Dense values, sparse values and values with gaps.
+        for (Examples.Color c : Examples.Color.values()) {
+            check(Examples.Color.forNumber(c.getNumber()) == c
+                && Examples.Color.forName(c.name()) == c, "Color", c.name());
+        }
+        for (Examples.Status s : Examples.Status.values()) {
+            check(Examples.Status.forNumber(s.getNumber()) == s
+                && Examples.Status.forName(s.name()) == s, "Status", s.name());
+        }
+        for (Examples.Holes h : Examples.Holes.values()) {
+            check(Examples.Holes.forNumber(h.getNumber()) == h
+                && Examples.Holes.forName(h.name()) == h, "Holes", h.name());
+        }
+        for (int value : new int[] {0, 4, -1, Integer.MIN_VALUE}) {
+            check(Examples.Color.forNumber(value) == null, "Color",
+                String.valueOf(value));
+        }
+        for (int value : new int[] {1, 403, 419, 501, -404,
+                Integer.MAX_VALUE}) {
+            check(Examples.Status.forNumber(value) == null, "Status",
+                String.valueOf(value));
+        }
+        for (int value : new int[] {0, 1, 4, 5, 7, Integer.MIN_VALUE}) {
+            check(Examples.Holes.forNumber(value) == null, "Holes",
+                String.valueOf(value));
+        }
+        for (String name : new String[] {"", "red", "RED", "Purple", "Ok "}) {
+            check(Examples.Color.forName(name) == null
+                && Examples.Status.forName(name) == null, "name", name);
+        }
+
+        // JSON holds enums as their numbers.
+        Examples.Shape m = shape(EMPTY);
+        m.setColor(Examples.Color.Green);
+        m.setAltColor(Examples.Color.Red);
+        String text = json(m);
+        check(text.contains("\"color\":2,\"alt_color\":1,"), "enum numbers",
+            text);
+        check(shape(text).getColor() == Examples.Color.Green
+            && shape(text).getAltColor() == Examples.Color.Red,
+            "decoded enums", text);
+    }
+
+    private static void rejects() {
+        for (String text : new String[] {"", "{", "[]", "{\"id\":1} {}",
+                "{\"id\":\"1\"}", "{\"name\":1}", "{\"visible\":\"true\"}",
+                "{\"points\":[{\"x\":1,\"y\":2}", "{\"points\":{}}",
+                "{\"tags\":{\"a\":1}}", "{\"by_id\":{\"x\":{}}}",
+                "{\"id\":1,}", "{\"id\"1}"}) {
+            try {
+                Examples.Shape m = shape(text);
+                throw new AssertionError("decoded " + text + " to " + json(m));
+            } catch (Examples.ToolmanJsonException e) {
+                // Expected.
+            } catch (java.io.IOException e) {
+                throw new AssertionError(e);
+            }
+        }
+    }
+
+    private static Examples.Shape shape(String text) {
+        return Examples.Shape.parseFrom(utf8(text));
+    }
+
+    private static byte[] utf8(String text) {
+        return text.getBytes(StandardCharsets.UTF_8);
+    }
+
+    private static String json(Examples.Shape m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Item m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Mixed m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static void check(boolean ok, String what, String got) {
+        if (!ok) {
+            throw new AssertionError(what + ": got " + got);
+        }
+    }
+}
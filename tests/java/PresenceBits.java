@@ -0,0 +1,151 @@
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Checks the optional primitives that java_presence_bits stores unboxed:
+ * setting, clearing and decoding each tracks its presence apart from its
+ * value, so a zero that is set is not mistaken for an absent field.
+ */
+public final class PresenceBits {
+    private PresenceBits() {}
+
+    public static void main(String[] args) throws Exception {
+        setAndClear();
+        decode();
+        references();
+    }
+
+    private static void setAndClear() throws Exception {
+        Examples.Shape m = shape();
+        check(!m.hasCount() && !m.hasBig() && m.getCount() == 0
+            && m.getBig() == 0, "new", json(m));
+        check(json(m).contains("\"count\":null,")
+            && json(m).contains("\"big\":null,"), "new", json(m));
+
+        // A zero that is set is present, and each field has its own bit.
+        m.setCount(0);
+        check(m.hasCount() && !m.hasBig(), "count set", json(m));
+        check(json(m).contains("\"count\":0,")
+            && json(m).contains("\"big\":null,"), "count set", json(m));
+        m.setBig(-1L);
+        check(m.hasCount() && m.hasBig(), "both set", json(m));
+        check(json(m).contains("\"big\":18446744073709551615,"), "big set",
+            json(m));
+
+        // Clearing drops the value with the bit.
+        m.setCount(4);
+        m.clearCount();
+        check(!m.hasCount() && m.getCount() == 0 && m.hasBig(), "cleared",
+            json(m));
+        check(json(m).contains("\"count\":null,"), "cleared", json(m));
+        m.clearBig();
+        check(!m.hasBig() && m.getBig() == 0, "big cleared", json(m));
+
+        Examples.Mixed mixed = new Examples.Mixed();
+        check(!mixed.hasC(), "new Mixed", json(mixed));
+        mixed.setC(false);
+        check(mixed.hasC() && json(mixed).contains("\"c\":false,"), "c set",
+            json(mixed));
+        mixed.clearC();
+        check(!mixed.hasC() && json(mixed).contains("\"c\":null,"),
+            "c cleared", json(mixed));
+    }
+
+    private static void decode() throws Exception {
+        Examples.Shape m = shape();
+        m.setCount(0);
+        Examples.Shape absentBig = m;
+        m = shape();
+        m.setBig(-1L);
+        Examples.Shape absentCount = m;
+
+        for (Examples.Shape got : new Examples.Shape[] {
+                Examples.Shape.parseFrom(utf8(json(absentBig))),
+                Examples.Shape.parseBinary(absentBig.toBinary())}) {
+            check(got.hasCount() && got.getCount() == 0 && !got.hasBig(),
+                "count 0 decoded", json(got));
+        }
+        for (Examples.Shape got : new Examples.Shape[] {
+                Examples.Shape.parseFrom(utf8(json(absentCount))),
+                Examples.Shape.parseBinary(absentCount.toBinary())}) {
+            check(!got.hasCount() && got.hasBig() && got.getBig() == -1L,
+                "big decoded", json(got));
+        }
+
+        // Absent and null clear the bit, the last value of a key wins.
+        for (String text : new String[] {"{\"name\":\"a\"}",
+                "{\"name\":\"a\",\"count\":null}",
+                "{\"name\":\"a\",\"count\":3,\"count\":null}"}) {
+            Examples.Shape got = Examples.Shape.parseFrom(utf8(text));
+            check(!got.hasCount() && got.getCount() == 0, text, json(got));
+        }
+        Examples.Shape got = Examples.Shape.parseFrom(
+            utf8("{\"name\":\"a\",\"big\":null,\"big\":5}"));
+        check(got.hasBig() && got.getBig() == 5, "big null then 5",
+            json(got));
+
+        Examples.Mixed mixed = new Examples.Mixed();
+        mixed.setC(false);
+        for (Examples.Mixed c : new Examples.Mixed[] {
+                Examples.Mixed.parseFrom(utf8(json(mixed))),
+                Examples.Mixed.parseBinary(mixed.toBinary())}) {
+            check(c.hasC() && !c.getC(), "c false decoded", json(c));
+        }
+        mixed.clearC();
+        for (Examples.Mixed c : new Examples.Mixed[] {
+                Examples.Mixed.parseFrom(utf8(json(mixed))),
+                Examples.Mixed.parseBinary(mixed.toBinary())}) {
+            check(!c.hasC(), "c absent decoded", json(c));
+        }
+    }
+
+    // Optional fields of reference types report their presence too.
+    private static void references() throws Exception {
+        Examples.Shape m = shape();
+        check(!m.hasLabel() && !m.hasAltColor() && !m.hasAnchor()
+            && !m.hasExtra(), "new references", json(m));
+        m.setLabel("abc");
+        m.setAltColor(Examples.Color.Red);
+        m.setAnchor(new Examples.Point());
+        m.setExtra("x");
+        for (Examples.Shape got : new Examples.Shape[] {
+                Examples.Shape.parseFrom(utf8(json(m))),
+                Examples.Shape.parseBinary(m.toBinary())}) {
+            check(got.hasLabel() && got.hasAltColor() && got.hasAnchor()
+                && got.hasExtra() && !got.hasCount(), "references decoded",
+                json(got));
+        }
+        m.clearLabel();
+        m.clearAnchor();
+        check(!m.hasLabel() && m.getLabel() == null && !m.hasAnchor()
+            && m.hasAltColor(), "references cleared", json(m));
+    }
+
+    // A Shape that meets the constraints, with no optional field set.
+    private static Examples.Shape shape() {
+        Examples.Shape m = new Examples.Shape();
+        m.setName("a");
+        return m;
+    }
+
+    private static byte[] utf8(String text) {
+        return text.getBytes(StandardCharsets.UTF_8);
+    }
+
+    private static String json(Examples.Shape m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Mixed m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static void check(boolean ok, String what, String got) {
+        if (!ok) {
+            throw new AssertionError(what + ": got " + got);
+        }
+    }
+}
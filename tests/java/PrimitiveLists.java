@@ -0,0 +1,120 @@
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Checks the numeric lists that java_primitive_lists stores as arrays: they
+ * come back element for element through JSON and through the binary codec,
+ * at the edges of their types, empty, absent, and longer than the capacity
+ * the JSON decoder starts with.
+ */
+public final class PrimitiveLists {
+    private PrimitiveLists() {}
+
+    public static void main(String[] args) throws Exception {
+        check(new double[] {0.5, -3, 0.1, 123456789.125, 1e300,
+                Double.MIN_VALUE, -Double.MAX_VALUE},
+            new int[] {Integer.MIN_VALUE, -1, 0, 1, Integer.MAX_VALUE},
+            new long[][] {{Long.MIN_VALUE, Long.MAX_VALUE}, {}, {5}},
+            // -1 is the largest u32.
+            new int[] {0, -1, 7});
+        check(new double[0], new int[0], new long[0][], new int[0]);
+        check(null, null, null, null);
+
+        double[] weights = new double[1000];
+        int[] ids = new int[weights.length];
+        long[][] matrix = new long[weights.length][];
+        for (int i = 0; i < weights.length; i++) {
+            weights[i] = i / 8.0;
+            ids[i] = i * 7 - 3500;
+            matrix[i] = new long[i % 20];
+            Arrays.fill(matrix[i], (long) i << 40);
+        }
+        check(weights, ids, matrix, ids);
+
+        // The JSON arrays hold the values as the boxed lists did.
+        Examples.Shape m = shape(new double[] {0.5, -3}, new int[] {-1, 2},
+            new long[][] {{Long.MIN_VALUE}, {}});
+        String text = json(m);
+        check(text.contains("\"weights\":[0.5,-3],\"ids\":[-1,2],")
+            && text.contains("\"matrix\":[[-9223372036854775808],[]]"),
+            "JSON arrays", text);
+        Examples.Item item = new Examples.Item();
+        item.setTags(new int[] {-1});
+        check(json(item).contains("\"tags\":[4294967295]"), "JSON u32",
+            json(item));
+    }
+
+    private static void check(double[] weights, int[] ids, long[][] matrix,
+            int[] tags) throws Exception {
+        Examples.Shape m = shape(weights, ids, matrix);
+        Examples.Item item = new Examples.Item();
+        item.setTags(tags);
+        String json = json(m);
+        Examples.Shape[] decoded = {
+            Examples.Shape.parseFrom(utf8(json)),
+            Examples.Shape.parseBinary(m.toBinary())};
+        Examples.Item[] items = {
+            Examples.Item.parseFrom(utf8(json(item))),
+            Examples.Item.parseBinary(item.toBinary())};
+        String[] codecs = {"JSON", "binary"};
+        for (int i = 0; i < codecs.length; i++) {
+            Examples.Shape got = decoded[i];
+            check(Arrays.equals(got.getWeights(), weights), codecs[i]
+                + " weights", Arrays.toString(got.getWeights()));
+            check(Arrays.equals(got.getIds(), ids), codecs[i] + " ids",
+                Arrays.toString(got.getIds()));
+            check(sameMatrix(got.getMatrix(), matrix), codecs[i] + " matrix",
+                json(got));
+            check(Arrays.equals(items[i].getTags(), tags), codecs[i] + " tags",
+                Arrays.toString(items[i].getTags()));
+        }
+    }
+
+    private static Examples.Shape shape(double[] weights, int[] ids,
+            long[][] matrix) {
+        Examples.Shape m = new Examples.Shape();
+        m.setName("a");
+        m.setWeights(weights);
+        m.setIds(ids);
+        m.setMatrix(matrix == null ? null : Arrays.asList(matrix));
+        return m;
+    }
+
+    private static boolean sameMatrix(List<long[]> got, long[][] want) {
+        if (got == null || want == null) {
+            return got == null && want == null;
+        }
+        if (got.size() != want.length) {
+            return false;
+        }
+        for (int i = 0; i < want.length; i++) {
+            if (!Arrays.equals(got.get(i), want[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private static byte[] utf8(String text) {
+        return text.getBytes(StandardCharsets.UTF_8);
+    }
+
+    private static String json(Examples.Shape m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static String json(Examples.Item m) throws java.io.IOException {
+        StringBuilder out = new StringBuilder();
+        m.writeTo(out);
+        return out.toString();
+    }
+
+    private static void check(boolean ok, String what, String got) {
+        if (!ok) {
+            throw new AssertionError(what + ": got " + got);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Checks the binary codec against the vectors that the tests of every
+ * target share. Values are compared as the JSON the codec writes for them.
+ */
+public final class WireGolden {
+    private WireGolden() {}
+
+    public static void main(String[] args) throws Exception {
+        List<String> lines = Files.readAllLines(
+            Paths.get("..", "wire_golden.txt"), StandardCharsets.UTF_8);
+        int failures = 0;
+        int vectors = 0;
+        for (int i = 0; i < lines.size(); i++) {
+            String row = lines.get(i);
+            if (row.isEmpty() || row.startsWith("#")) {
+                continue;
+            }
+            vectors++;
+            try {
+                check(row.split("\t"));
+            } catch (InvocationTargetException e) {
+                failures++;
+                System.err.println("line " + (i + 1) + ": " + e.getCause());
+            } catch (AssertionError e) {
+                failures++;
+                System.err.println("line " + (i + 1) + ": " + e.getMessage());
+            }
+        }
+        if (vectors == 0 || failures > 0) {
+            System.exit(1);
+        }
+    }
+
+    private static void check(String[] fields) throws Exception {
+        Class<?> type = Class.forName("Examples$" + fields[0]);
+        Method parseFrom = type.getMethod("parseFrom", byte[].class);
+        Method parseBinary = type.getMethod("parseBinary", byte[].class);
+        Method toBinary = type.getMethod("toBinary");
+        byte[] data = unhex(fields[2]);
+
+        Object want = parseFrom.invoke(
+            null, (Object) fields[1].getBytes(StandardCharsets.UTF_8));
+        if (fields.length < 4) {
+            byte[] got = (byte[]) toBinary.invoke(want);
+            if (!Arrays.equals(got, data)) {
+                throw new AssertionError(
+                    "encoded to\n" + hex(got) + "\nwant\n" + fields[2]);
+            }
+        }
+        Object got = parseBinary.invoke(null, (Object) data);
+        String gotJson = json(type, got);
+        String wantJson = json(type, want);
+        if (!gotJson.equals(wantJson)) {
+            throw new AssertionError(
+                "decoded to\n" + gotJson + "\nwant\n" + wantJson);
+        }
+    }
+
+    private static String json(Class<?> type, Object value) throws Exception {
+        StringBuilder out = new StringBuilder();
+        type.getMethod("writeTo", Appendable.class).invoke(value, out);
+        return out.toString();
+    }
+
+    private static byte[] unhex(String s) {
+        byte[] b = new byte[s.length() / 2];
+        for (int i = 0; i < b.length; i++) {
+            b[i] = (byte) Integer.parseInt(s.substring(2 * i, 2 * i + 2), 16);
+        }
+        return b;
+    }
+
+    private static String hex(byte[] b) {
+        StringBuilder out = new StringBuilder();
+        for (byte x : b) {
+            out.append(String.format("%02x", x & 0xff));
+        }
+        return out.toString();
+    }
+}
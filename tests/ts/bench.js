@@ -0,0 +1,22 @@
+"use strict";
+
+// Runs fn after a warm-up and prints the time per call, in the format of Go
+// benchmarks. The number of calls comes from the command line, which ctest
+// sets to 1 to keep the benchmarks running.
+const calls = Number(process.argv[2] || 200000);
+let sink;
+
+function bench(name, fn) {
+  for (let i = 0; i < Math.min(calls, 1000); i++) {
+    sink = fn();
+  }
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < calls; i++) {
+    sink = fn();
+  }
+  const ns = Number(process.hrtime.bigint() - start) / calls;
+  console.log(`${name}\t${calls}\t${ns.toFixed(1)} ns/op`);
+  return sink;
+}
+
+module.exports = { bench };
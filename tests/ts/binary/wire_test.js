@@ -0,0 +1,20 @@
+"use strict";
+
+const assert = require("assert");
+const examples = require("./examples");
+const { wireGolden } = require("../wire_golden");
+
+const vectors = wireGolden();
+assert.ok(vectors.length > 0);
+for (const { line, struct, json, bytes, decodeOnly } of vectors) {
+  const value = JSON.parse(json);
+  if (!decodeOnly) {
+    const encoded = examples[`encode${struct}`](value);
+    assert.strictEqual(Buffer.from(encoded).toString("hex"),
+                       Buffer.from(bytes).toString("hex"), `line ${line}`);
+  }
+  // Through JSON, so that optional fields left undefined count as missing.
+  const decoded = examples[`decode${struct}Binary`](bytes);
+  assert.deepStrictEqual(JSON.parse(JSON.stringify(decoded)), value,
+                         `line ${line}`);
+}
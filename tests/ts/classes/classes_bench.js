@@ -0,0 +1,74 @@
+"use strict";
+
+// Compares Shapes built as object literals, whose keys depend on the
+// optional fields they set, with ts_classes instances, which all have the
+// same keys. Reading a field of literals of 8 different shapes goes through
+// a megamorphic inline cache; reading it of instances does not.
+
+const { bench } = require("../bench");
+const { Point, Shape } = require("./examples");
+
+// Sets the optional fields in 8 different combinations, as code filling in
+// what a request happened to contain does.
+function literal(i) {
+  const s = { id: i, name: "shape", visible: true, size: i & 0xff, color: 1,
+              center: { x: i, y: -i }, points: [], weights: [], ids: [],
+              tags: {}, by_id: {}, matrix: [] };
+  if (i & 1) {
+    s.count = 3;
+  }
+  if (i & 2) {
+    s.label = "abc";
+  }
+  if (i & 4) {
+    s.anchor = { x: 1, y: 2 };
+  }
+  return s;
+}
+
+function instance(i) {
+  const s = new Shape();
+  s.id = i;
+  s.name = "shape";
+  s.visible = true;
+  s.size = i & 0xff;
+  s.color = 1;
+  s.center.x = i;
+  s.center.y = -i;
+  if (i & 1) {
+    s.count = 3;
+  }
+  if (i & 2) {
+    s.label = "abc";
+  }
+  if (i & 4) {
+    s.anchor = new Point({ x: 1, y: 2 });
+  }
+  return s;
+}
+
+// One function per kind of Shape, since a shared one would see both.
+function sumLiterals(shapes) {
+  let total = 0;
+  for (let i = 0; i < shapes.length; i++) {
+    total += shapes[i].size + (shapes[i].count ?? 0);
+  }
+  return total;
+}
+
+function sumInstances(shapes) {
+  let total = 0;
+  for (let i = 0; i < shapes.length; i++) {
+    total += shapes[i].size + (shapes[i].count ?? 0);
+  }
+  return total;
+}
+
+let i = 0;
+bench("BenchmarkConstruct/literal", () => literal(i++));
+bench("BenchmarkConstruct/class", () => instance(i++));
+
+const literals = Array.from({ length: 1024 }, (_, i) => literal(i));
+const instances = Array.from({ length: 1024 }, (_, i) => instance(i));
+bench("BenchmarkSum1024/literal", () => sumLiterals(literals));
+bench("BenchmarkSum1024/class", () => sumInstances(instances));
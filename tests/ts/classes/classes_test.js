@@ -0,0 +1,29 @@
+"use strict";
+
+const assert = require("assert");
+const { Shape } = require("./examples");
+const { sample } = require("../sample");
+
+// Every Shape has the same keys in the same order, whichever optional
+// fields are set, so V8 gives them all one hidden class.
+const empty = new Shape();
+const keys = Object.keys(empty);
+assert.strictEqual(keys.length, 19);
+assert.strictEqual(empty.count, undefined);
+assert.deepStrictEqual(Object.keys(Shape.from(sample())), keys);
+const partial = sample();
+delete partial.count;
+delete partial.anchor;
+delete partial.shape_kind;
+assert.deepStrictEqual(Object.keys(Shape.from(partial)), keys);
+
+// clone copies nested messages, lists and maps.
+const original = Shape.from(sample());
+const copy = original.clone();
+assert.deepStrictEqual(copy, original);
+copy.center.x = 100;
+copy.points[0].y = 100;
+copy.tags.a = "changed";
+copy.by_id[-5].x = 100;
+copy.matrix[0][0] = 100;
+assert.deepStrictEqual(original, Shape.from(sample()));
@@ -0,0 +1,117 @@
+"use strict";
+
+const assert = require("assert");
+const http = require("http");
+const {
+  Color, Status, ShapesClient, ToolmanDecodeError, ToolmanHttpError,
+} = require("./examples");
+const { sample } = require("../sample");
+
+// Answers every request with the next canned response and keeps the
+// request line and body it got.
+function listen() {
+  const server = http.createServer((req, res) => {
+    let body = "";
+    req.on("data", (chunk) => (body += chunk));
+    req.on("end", () => {
+      server.got.push(`${req.method} ${req.url} ${body}`);
+      const [status, text] = server.responses.shift() || [599, ""];
+      res.writeHead(status, { "Content-Type": "application/json" });
+      res.end(text);
+    });
+  });
+  server.got = [];
+  server.responses = [];
+  return new Promise((resolve) =>
+    server.listen(0, "127.0.0.1", () => resolve(server)));
+}
+
+async function rejects(promise) {
+  try {
+    await promise;
+  } catch (e) {
+    return e;
+  }
+  assert.fail("did not reject");
+}
+
+async function testURLs(server, client) {
+  const calls = [
+    () => client.get(),
+    () => client.getShapes(),
+    () => client.getShapesById(-9007199254740991),
+    () => client.deleteShapesById(7, { x: 1, y: 0 }),
+    () => client.getShapesByIdPointsByIdx(7, 4294967295),
+    () => client.getShapesSearch(),
+    () => client.postShapesByColorByColor(Color.Green, sample()),
+    // Everything but unreserved characters is escaped, in UTF-8.
+    () => client.getSettingsByNameByOn("a/b c?d%€", true),
+    () => client.getSettingsByNameByOn("", false),
+  ];
+  for (const call of calls) {
+    const e = await rejects(call());
+    assert.ok(e instanceof ToolmanHttpError && e.status === 599, String(e));
+  }
+  assert.deepStrictEqual(server.got.map((got) => got.split(" ", 2).join(" ")), [
+    "GET /",
+    "GET /shapes",
+    "GET /shapes/-9007199254740991",
+    "DELETE /shapes/7",
+    "GET /shapes/7/points/4294967295",
+    "GET /shapes/search",
+    "POST /shapes/by-color/Green",
+    "GET /settings/a%2Fb%20c%3Fd%25%E2%82%AC/true",
+    "GET /settings//false",
+  ]);
+  assert.ok(server.got[3].endsWith(' {"x":1,"y":0}'));
+  assert.deepStrictEqual(
+    JSON.parse(server.got[6].slice("POST /shapes/by-color/Green ".length)),
+    sample());
+}
+
+async function testStatuses(server, client) {
+  server.responses.push([200, JSON.stringify(sample())]);
+  let res = await client.getShapesById(1);
+  assert.strictEqual(res.status, 200);
+  assert.deepStrictEqual(res.body, sample());
+
+  server.responses.push([404, "404"]);
+  res = await client.getShapesById(1);
+  assert.deepStrictEqual(res, { status: 404, body: Status.NotFound });
+
+  // A status the api does not declare keeps its body in the error.
+  server.responses.push([503, "busy"]);
+  let e = await rejects(client.getShapesById(1));
+  assert.ok(e instanceof ToolmanHttpError);
+  assert.strictEqual(e.status, 503);
+  assert.strictEqual(e.body, "busy");
+
+  // Bodies are decoded as the type of their status, not another's.
+  server.responses.push([404, JSON.stringify(sample())]);
+  e = await rejects(client.getShapesById(1));
+  assert.ok(e instanceof ToolmanDecodeError, String(e));
+  server.responses.push([200, "404"]);
+  e = await rejects(client.getShapesById(1));
+  assert.ok(e instanceof ToolmanDecodeError, String(e));
+  server.responses.push([200, '{"x":1}']);
+  e = await rejects(client.get());
+  assert.ok(e instanceof ToolmanDecodeError, String(e));
+}
+
+async function main() {
+  const server = await listen();
+  try {
+    const base = `http://127.0.0.1:${server.address().port}`;
+    // A trailing slash on the base is dropped.
+    await testURLs(server, new ShapesClient(base + "/"));
+    await testStatuses(server, new ShapesClient(base));
+  } finally {
+    server.close();
+    server.closeAllConnections();
+  }
+}
+
+main().catch((e) => {
+  console.error(e);
+  process.exit(1);
+});
@@ -0,0 +1,148 @@
+"use strict";
+
+// Compares the generated decodeShape with a generic validator that
+// interprets a description of the same type on every call, the way
+// schema-driven validators do.
+
+const assert = require("assert");
+const { bench } = require("../bench");
+const { decodeShape } = require("./examples");
+const { sample } = require("../sample");
+
+const point = {
+  kind: "object",
+  fields: {
+    x: { kind: "number", min: -1000, max: 1e3 },
+    y: { kind: "number" },
+  },
+};
+const i64 = { kind: "integer", min: -(2 ** 63), max: 2 ** 63 };
+const shape = {
+  kind: "object",
+  fields: {
+    id: i64,
+    name: { kind: "string", minLength: 1, maxLength: 16,
+            pattern: /^[a-z][a-z0-9_]*$/u },
+    visible: { kind: "boolean" },
+    count: { kind: "integer", min: -5, max: 5, optional: true },
+    size: { kind: "integer", min: 0, max: 100 },
+    big: { kind: "integer", min: 1, max: 2 ** 64, optional: true },
+    label: { kind: "string", minLength: 3, maxLength: 3, optional: true },
+    color: { kind: "enum", values: [1, 2, 3] },
+    alt_color: { kind: "enum", values: [1, 2, 3], optional: true },
+    center: point,
+    anchor: { ...point, optional: true },
+    points: { kind: "list", items: point, maxItems: 4 },
+    weights: { kind: "list", items: { kind: "number" } },
+    ids: { kind: "list", items: { kind: "integer", min: -(2 ** 31),
+                                  max: 2 ** 31 - 1 } },
+    tags: { kind: "map", key: /^/, values: { kind: "string" }, maxItems: 3 },
+    by_id: { kind: "map", key: /^-?(0|[1-9][0-9]*)$/, values: point },
+    matrix: { kind: "list", items: { kind: "list", items: i64 } },
+    extra: { kind: "any", optional: true },
+    shape_kind: {
+      kind: "oneof",
+      fields: { radius: { kind: "number" }, text: { kind: "string" },
+                origin: point },
+    },
+  },
+};
+
+// Returns the path of the first value that does not match `type`.
+function validate(type, value, path) {
+  if (value === undefined || value === null) {
+    return type.optional ? undefined : path;
+  }
+  switch (type.kind) {
+    case "boolean":
+    case "number":
+    case "string":
+      if (typeof value !== type.kind) {
+        return path;
+      }
+      if (type.kind === "string") {
+        const length = [...value].length;
+        if (length < (type.minLength ?? 0) ||
+            length > (type.maxLength ?? Infinity) ||
+            (type.pattern && !type.pattern.test(value))) {
+          return path;
+        }
+      } else if (value < (type.min ?? -Infinity) ||
+                 value > (type.max ?? Infinity)) {
+        return path;
+      }
+      return undefined;
+    case "integer":
+      return Number.isInteger(value) && value >= type.min &&
+          value <= type.max ? undefined : path;
+    case "enum":
+      return type.values.includes(value) ? undefined : path;
+    case "any":
+      return undefined;
+    case "list":
+      if (!Array.isArray(value) || value.length > (type.maxItems ?? Infinity)) {
+        return path;
+      }
+      for (let i = 0; i < value.length; i++) {
+        const failure = validate(type.items, value[i], `${path}[${i}]`);
+        if (failure !== undefined) {
+          return failure;
+        }
+      }
+      return undefined;
+    case "map":
+    case "object":
+    case "oneof": {
+      if (typeof value !== "object" || Array.isArray(value)) {
+        return path;
+      }
+      if (type.kind === "map") {
+        const keys = Object.keys(value);
+        if (keys.length > (type.maxItems ?? Infinity)) {
+          return path;
+        }
+        for (const key of keys) {
+          const at = `${path}[${JSON.stringify(key)}]`;
+          if (!type.key.test(key)) {
+            return at;
+          }
+          const failure = validate(type.values, value[key], at);
+          if (failure !== undefined) {
+            return failure;
+          }
+        }
+        return undefined;
+      }
+      let present = 0;
+      for (const [name, field] of Object.entries(type.fields)) {
+        if (type.kind === "oneof") {
+          if (value[name] === undefined) {
+            continue;
+          }
+          present++;
+        }
+        const failure = validate(field, value[name], `${path}.${name}`);
+        if (failure !== undefined) {
+          return failure;
+        }
+      }
+      return type.kind === "oneof" && present !== 1 ? path : undefined;
+    }
+  }
+  return path;
+}
+
+const value = sample();
+assert.strictEqual(validate(shape, value, "$"), undefined);
+value.points[1].y = "x";
+assert.strictEqual(validate(shape, value, "$"), "$.points[1].y");
+
+// Both validate a message parsed from the same text.
+const json = JSON.stringify(sample());
+const parsed = JSON.parse(json);
+bench("BenchmarkDecodeShape/generated", () => decodeShape(parsed));
+bench("BenchmarkDecodeShape/generic", () => validate(shape, parsed, "$"));
+bench("BenchmarkParseAndDecodeShape/generated",
+      () => decodeShape(JSON.parse(json)));
+bench("BenchmarkParseAndDecodeShape/generic",
+      () => validate(shape, JSON.parse(json), "$"));
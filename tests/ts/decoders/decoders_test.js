@@ -0,0 +1,47 @@
+"use strict";
+
+const assert = require("assert");
+const { decodeShape, isShape, ToolmanDecodeError } = require("./examples");
+const { sample } = require("../sample");
+
+const valid = sample();
+assert.strictEqual(decodeShape(valid), valid);
+assert.ok(isShape(valid));
+
+// Optional fields may be missing or null.
+const optional = sample();
+delete optional.count;
+optional.label = null;
+optional.extra = undefined;
+assert.ok(isShape(optional));
+
+// Each case breaks one check of sample() and expects the error it reports.
+const cases = [
+  [(s) => (s.points[1].y = "x"), "$.points[1].y: expected float, got string"],
+  [(s) => (s.ids[0] = 1.5), "$.ids[0]: expected i32, got number"],
+  [(s) => (s.size = -1), "$.size: expected u32, got number"],
+  [(s) => (s.color = 4), "$.color: expected Color, got number"],
+  [(s) => (s.by_id["01"] = { x: 0, y: 0 }),
+   '$.by_id["01"]: expected i64 key, got string'],
+  [(s) => (s.matrix[2] = {}), "$.matrix[2]: expected list, got object"],
+  [(s) => (s.shape_kind = {}),
+   "$.shape_kind: expected exactly one of radius, text, origin, got object"],
+  [(s) => (s.shape_kind.text = "x"),
+   "$.shape_kind: expected exactly one of radius, text, origin, got object"],
+  [(s) => delete s.center, "$.center: expected Point, got nothing"],
+  [(s) => (s.count = 6), "$.count: must be between -5 and 5"],
+  [(s) => (s.name = "Hello"), "$.name: must match ^[a-z][a-z0-9_]*$"],
+  [(s) => (s.tags.d = "4"), "$.tags: size must be at most 3"],
+];
+for (const [breakIt, message] of cases) {
+  const s = sample();
+  breakIt(s);
+  assert.ok(!isShape(s), message);
+  assert.throws(() => decodeShape(s), (e) => {
+    assert.ok(e instanceof ToolmanDecodeError);
+    assert.strictEqual(e.message, message);
+    assert.strictEqual(e.path, message.slice(0, message.indexOf(":")));
+    return true;
+  });
+}
+assert.throws(() => decodeShape([]), /^ToolmanDecodeError: \$: expected Shape, got array$/);
@@ -0,0 +1,28 @@
+"use strict";
+
+// A Shape as JSON.parse returns it, valid for every check of examples.tm.
+function sample() {
+  return {
+    id: -4611686018427387904,
+    name: "hello_world",
+    visible: true,
+    count: -3,
+    size: 42,
+    big: 12345,
+    label: "abc",
+    color: 2,
+    alt_color: 3,
+    center: { x: 1.5, y: -2e-9 },
+    anchor: { x: 3, y: 1e22 },
+    points: [{ x: 1, y: 2 }, { x: 0.1, y: 123456789.125 }],
+    weights: [0, -0.5, 1e21],
+    ids: [1, -2, 3],
+    tags: { b: "2", a: "1", "c\"<>": "3" },
+    by_id: { "-5": { x: 7, y: 8 }, 10: { x: 1, y: 0 }, 9: { x: 0, y: 2 } },
+    matrix: [[1, 2], [], [3]],
+    extra: { any: ["thing"] },
+    shape_kind: { radius: 2.5 },
+  };
+}
+
+module.exports = { sample };
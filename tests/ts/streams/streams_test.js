@@ -0,0 +1,152 @@
+"use strict";
+
+const assert = require("assert");
+const {
+  streamShapePoints, streamShapeWeights, ToolmanDecodeError,
+} = require("./examples");
+const { sample } = require("../sample");
+
+// Yields text in chunks of size characters, or as UTF-8 bytes in chunks of
+// size bytes, which may split a character.
+async function* chunks(text, size, bytes) {
+  const all = bytes ? Buffer.from(text, "utf8") : text;
+  for (let i = 0; i < all.length; i += size) {
+    yield bytes ? new Uint8Array(all.subarray(i, i + size))
+      : all.slice(i, i + size);
+  }
+}
+
+// Runs the generator to its end, returning what it yields and returns.
+async function drain(generator) {
+  const yielded = [];
+  for (;;) {
+    const { value, done } = await generator.next();
+    if (done) {
+      return { yielded, returned: value };
+    }
+    yielded.push(value);
+  }
+}
+
+async function rejects(promise, check) {
+  try {
+    await promise;
+  } catch (e) {
+    assert.ok(check(e), String(e));
+    return;
+  }
+  assert.fail("did not reject");
+}
+
+// A Shape with n points, far more than one chunk holds, and a name and
+// an any value that are not ASCII.
+function large(n) {
+  const s = sample();
+  s.points = [];
+  for (let i = 0; i < n; i++) {
+    s.points.push({ x: i % 1000, y: i });
+  }
+  s.extra = { text: "a € and a 😀" };
+  return s;
+}
+
+async function testElements() {
+  const s = large(20000);
+  const text = JSON.stringify(s, null, 1);
+  for (const [size, bytes] of [[text.length, false], [7, false], [1, true],
+    [4093, true]]) {
+    const { yielded, returned } =
+      await drain(streamShapePoints(chunks(text, size, bytes)));
+    assert.deepStrictEqual(yielded, s.points, `chunks of ${size}`);
+    // The rest of the Shape is returned whole, with the list left empty.
+    assert.deepStrictEqual(returned, { ...s, points: [] });
+  }
+}
+
+async function testEmptyAndNull() {
+  const s = sample();
+  s.points = [];
+  let { yielded, returned } =
+    await drain(streamShapePoints(chunks(JSON.stringify(s), 3)));
+  assert.deepStrictEqual(yielded, []);
+  assert.deepStrictEqual(returned, s);
+
+  // The streamed list does not have to come first, or at all.
+  s.weights = [1, 2];
+  const { weights, ...rest } = s;
+  const text = JSON.stringify(rest).slice(0, -1) + ',"weights":[1,2]}';
+  ({ yielded, returned } = await drain(streamShapeWeights(chunks(text, 5))));
+  assert.deepStrictEqual(yielded, weights);
+  assert.deepStrictEqual(returned.weights, []);
+  ({ yielded, returned } = await drain(streamShapeWeights(
+    chunks(JSON.stringify(rest), 5))));
+  assert.deepStrictEqual(yielded, []);
+  assert.deepStrictEqual(returned.weights, []);
+
+  // A list is not optional, null is not one.
+  s.points = null;
+  await rejects(drain(streamShapePoints(chunks(JSON.stringify(s), 3))),
+    (e) => e instanceof ToolmanDecodeError && e.path === "$.points");
+  await rejects(drain(streamShapePoints(chunks("null", 1))),
+    (e) => e instanceof ToolmanDecodeError && e.path === "$");
+}
+
+async function testErrors() {
+  // Elements are checked as they are read, after the ones before them are
+  // yielded.
+  const s = large(10);
+  s.points[5].x = "5";
+  const generator = streamShapePoints(chunks(JSON.stringify(s), 16));
+  const seen = [];
+  await rejects((async () => {
+    for await (const point of generator) {
+      seen.push(point);
+    }
+  })(), (e) => e instanceof ToolmanDecodeError && e.path === "$.points[5].x");
+  assert.strictEqual(seen.length, 5);
+
+  // The rest is checked once the stream ends.
+  const t = large(3);
+  t.name = "Hello";
+  await rejects(drain(streamShapePoints(chunks(JSON.stringify(t), 16))),
+    (e) => e instanceof ToolmanDecodeError && e.path === "$.name");
+
+  // Malformed or truncated text, and text after the object.
+  const valid = JSON.stringify(large(3));
+  for (const text of [valid.slice(0, -1), valid.slice(0, 40),
+    valid.replace('"points":[{', '"points":[{,'), valid + "{}", ""]) {
+    await rejects(drain(streamShapePoints(chunks(text, 8))),
+      (e) => e instanceof SyntaxError || e instanceof ToolmanDecodeError);
+  }
+}
+
+// A consumer may stop early, the source is not read further.
+async function testEarlyStop() {
+  let read = 0;
+  async function* counted() {
+    for await (const chunk of chunks(JSON.stringify(large(10000)), 64)) {
+      read++;
+      yield chunk;
+    }
+  }
+  let n = 0;
+  for await (const point of streamShapePoints(counted())) {
+    assert.strictEqual(point.y, n);
+    if (++n === 100) {
+      break;
+    }
+  }
+  assert.ok(read < 100, `read ${read} chunks`);
+}
+
+async function main() {
+  await testElements();
+  await testEmptyAndNull();
+  await testErrors();
+  await testEarlyStop();
+}
+
+main().catch((e) => {
+  console.error(e);
+  process.exit(1);
+});
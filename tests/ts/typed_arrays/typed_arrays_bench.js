@@ -0,0 +1,62 @@
+"use strict";
+
+// Compares Shapes whose weights and ids are typed arrays with the plain
+// arrays of the binary suite: decoding and encoding them, summing them, and
+// the memory the decoded messages hold.
+
+const assert = require("assert");
+const v8 = require("v8");
+const vm = require("vm");
+const { bench } = require("../bench");
+const typed = require("./examples");
+const plain = require("../binary/examples");
+const { sample } = require("../sample");
+
+const n = 1000;
+const s = sample();
+s.weights = Array.from({ length: n }, (_, i) => i / 7);
+s.ids = Array.from({ length: n }, (_, i) => i - n / 2);
+const data = typed.encodeShape(s);
+assert.deepStrictEqual(plain.encodeShape(s), data);
+
+const t = typed.decodeShapeBinary(data);
+const p = plain.decodeShapeBinary(data);
+assert.ok(t.weights instanceof Float64Array && Array.isArray(p.weights));
+
+function sum(m) {
+  let total = 0;
+  for (let i = 0; i < m.weights.length; i++) {
+    total += m.weights[i] + m.ids[i];
+  }
+  return total;
+}
+assert.strictEqual(sum(t), sum(p));
+
+for (const [name, codec, m] of [["typed", typed, t], ["plain", plain, p]]) {
+  bench(`BenchmarkDecodeBinary/${name}`, () => codec.decodeShapeBinary(data));
+  bench(`BenchmarkEncodeBinary/${name}`, () => codec.encodeShape(m));
+  bench(`BenchmarkSum/${name}`, () => sum(m));
+}
+
+// The bytes the decoded messages hold, on the heap and in array buffers,
+// with the garbage collected before each measurement.
+v8.setFlagsFromString("--expose-gc");
+const gc = vm.runInNewContext("gc");
+
+function used() {
+  gc();
+  const { heapUsed, arrayBuffers } = process.memoryUsage();
+  return heapUsed + arrayBuffers;
+}
+
+for (const [name, codec] of [["typed", typed], ["plain", plain]]) {
+  const count = 1000;
+  const held = [];
+  const before = used();
+  for (let i = 0; i < count; i++) {
+    held.push(codec.decodeShapeBinary(data));
+  }
+  const bytes = (used() - before) / count;
+  assert.strictEqual(held.length, count);
+  console.log(`BenchmarkMemory/${name}\t${count}\t${bytes.toFixed(0)} B/op`);
+}
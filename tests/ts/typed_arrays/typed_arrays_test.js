@@ -0,0 +1,107 @@
+"use strict";
+
+const assert = require("assert");
+const examples = require("./examples");
+const { decodeItem, decodeShape, decodeShapeBinary, encodeShape, isShape,
+        toolmanJSONReplacer } = examples;
+const { sample } = require("../sample");
+const { wireGolden } = require("../wire_golden");
+
+function toJSON(value) {
+  return JSON.parse(JSON.stringify(value, toolmanJSONReplacer));
+}
+
+function hex(bytes) {
+  return Buffer.from(bytes).toString("hex");
+}
+
+function checkTyped(shape) {
+  assert.ok(shape.weights instanceof Float64Array);
+  assert.ok(shape.ids instanceof Int32Array);
+  for (const row of shape.matrix) {
+    assert.ok(row instanceof Float64Array);
+  }
+}
+
+// The golden vectors hold in both directions with typed arrays, and encode
+// the same from plain arrays, which the encoders also take.
+const vectors = wireGolden();
+assert.ok(vectors.length > 0);
+for (const { line, struct, json, bytes, decodeOnly } of vectors) {
+  const value = JSON.parse(json);
+  const decoded = examples[`decode${struct}Binary`](bytes);
+  assert.deepStrictEqual(toJSON(decoded), value, `line ${line}`);
+  if (struct === "Shape") {
+    checkTyped(decoded);
+  } else if (struct === "Item") {
+    assert.ok(decoded.tags instanceof Uint32Array);
+  }
+  if (!decodeOnly) {
+    const encode = examples[`encode${struct}`];
+    assert.strictEqual(hex(encode(decoded)), hex(bytes), `line ${line}`);
+    assert.strictEqual(hex(encode(value)), hex(bytes), `line ${line}`);
+  }
+}
+
+// Float lists are copied out of the input in one go: the decoded array
+// owns its memory, whatever the alignment of the input.
+{
+  const s = sample();
+  s.weights = [0.5, -1e300, 3, Number.MIN_VALUE];
+  const bytes = encodeShape(s);
+  for (let offset = 0; offset < 8; offset++) {
+    const input = new Uint8Array(bytes.length + offset);
+    input.set(bytes, offset);
+    const decoded = decodeShapeBinary(input.subarray(offset));
+    input.fill(0xff);
+    assert.deepStrictEqual(Array.from(decoded.weights), s.weights);
+    assert.strictEqual(decoded.weights.buffer.byteLength, 4 * 8);
+  }
+  // And written back the same way, also from a view into a larger buffer.
+  const decoded = decodeShapeBinary(bytes);
+  const backing = new Float64Array(6);
+  backing.set(decoded.weights, 1);
+  decoded.weights = backing.subarray(1, 5);
+  assert.strictEqual(hex(encodeShape(decoded)), hex(bytes));
+}
+
+// At the JSON boundary, decodeX checks the plain arrays and then converts
+// them. i64 and u64 are numbers in this target, so their lists are
+// Float64Arrays, which hold every value JSON.parse gives exactly: integers
+// up to 2^53 stay exact, and larger ones keep the double JSON.parse
+// rounded them to, rather than being truncated to 32 bits.
+{
+  const text = JSON.stringify({
+    ...sample(),
+    ids: [-2147483648, 0, 2147483647],
+    matrix: [[2 ** 53, -(2 ** 53), 2 ** 53 - 1], [], [2 ** 62]],
+  }).replace(String(2 ** 62), "4611686018427387905");
+  const value = JSON.parse(text);
+  const expected = toJSON(value);
+  const shape = decodeShape(value);
+  checkTyped(shape);
+  assert.deepStrictEqual(Array.from(shape.ids), [-2147483648, 0, 2147483647]);
+  assert.deepStrictEqual(Array.from(shape.matrix[0]),
+                         [2 ** 53, -(2 ** 53), 2 ** 53 - 1]);
+  assert.strictEqual(shape.matrix[2][0], 4611686018427387905);
+  assert.strictEqual(shape.matrix[2][0], 2 ** 62);
+  // The replacer writes typed arrays back as the JSON arrays they came from.
+  assert.deepStrictEqual(toJSON(shape), expected);
+  assert.strictEqual(JSON.stringify(shape, toolmanJSONReplacer),
+                     JSON.stringify(expected));
+  // And u32 lists keep their full range.
+  const item = decodeItem({ id: 1, name: "x", tags: [0, 4294967295],
+                            kind: { count: 1 } });
+  assert.ok(item.tags instanceof Uint32Array);
+  assert.deepStrictEqual(Array.from(item.tags), [0, 4294967295]);
+
+  // Values a typed array would silently change are rejected before the
+  // conversion.
+  for (const [field, bad] of [["ids", [2 ** 31]], ["ids", [1.5]],
+                              ["matrix", [[0.5]]], ["weights", ["1"]]]) {
+    const s = sample();
+    s[field] = bad;
+    assert.ok(!isShape(s), field);
+    assert.throws(() => decodeShape(s), field);
+  }
+}
@@ -0,0 +1,27 @@
+"use strict";
+
+// Reads the id and the name of a binary encoded Shape, which a ShapeView
+// finds in place while decodeShapeBinary builds the whole message first.
+
+const assert = require("assert");
+const { bench } = require("../bench");
+const { ShapeView, decodeShapeBinary, encodeShape } = require("./examples");
+const { sample } = require("../sample");
+
+const data = encodeShape(sample());
+const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+const decoded = decodeShapeBinary(data);
+const v = new ShapeView(view);
+assert.strictEqual(v.id(), decoded.id);
+assert.strictEqual(Buffer.from(v.name()).toString(), decoded.name);
+assert.strictEqual(v.center().x(), decoded.center.x);
+assert.strictEqual(v.anchor().y(), decoded.anchor.y);
+
+bench("BenchmarkReadTwoFields/view", () => {
+  const v = new ShapeView(view);
+  return v.id() + v.name().length;
+});
+bench("BenchmarkReadTwoFields/decode", () => {
+  const m = decodeShapeBinary(data);
+  return m.id + m.name.length;
+});
@@ -0,0 +1,28 @@
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+
+// The vectors of tests/wire_golden.txt as {line, struct, json, bytes,
+// decodeOnly}.
+function wireGolden() {
+  const text = fs.readFileSync(
+      path.join(__dirname, "..", "wire_golden.txt"), "utf8");
+  const vectors = [];
+  text.split("\n").forEach((row, i) => {
+    if (row === "" || row.startsWith("#")) {
+      return;
+    }
+    const [struct, json, hex, decode] = row.split("\t");
+    vectors.push({
+      line: i + 1,
+      struct,
+      json,
+      bytes: Uint8Array.from(Buffer.from(hex, "hex")),
+      decodeOnly: decode === "decode",
+    });
+  });
+  return vectors;
+}
+
+module.exports = { wireGolden };
@@ -0,0 +1,106 @@
+// Checks that FileCache identifies a file however its path is spelled,
+// through a symlink or a `..` segment, and that it remembers what it found,
+// misses included.
+
+#include "src/file_cache.h"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using toolman::FileCache;
+using toolman::FileId;
+
+int failures = 0;
+
+void fail(const std::string& what, const std::string& message) {
+  std::cerr << what << ": " << message << "\n";
+  ++failures;
+}
+
+bool same_file(const std::optional<FileId>& a,
+               const std::optional<FileId>& b) {
+  return a.has_value() && b.has_value() && a.value() == b.value();
+}
+
+void touch(const std::filesystem::path& path) {
+  std::ofstream(path) << "type ()\n";
+}
+
+void check(const std::filesystem::path& dir) {
+  namespace fs = std::filesystem;
+  fs::create_directories(dir / "a");
+  fs::create_directories(dir / "b");
+  touch(dir / "a" / "x.tm");
+  touch(dir / "a" / "y.tm");
+  fs::create_symlink(dir / "a" / "x.tm", dir / "b" / "link.tm");
+  fs::create_directory_symlink(dir / "a", dir / "c");
+
+  FileCache cache;
+  auto x = cache.stat(dir / "a" / "x.tm");
+  if (!x.has_value()) {
+    fail("stat", "no identity for a/x.tm");
+    return;
+  }
+  for (const auto& path :
+       {dir / "b" / ".." / "a" / "x.tm", dir / "b" / "link.tm",
+        dir / "c" / "x.tm", dir / "c" / ".." / "b" / "link.tm"}) {
+    if (!same_file(cache.stat(path), x)) {
+      fail("same file", path.string() + " is another file");
+    }
+  }
+  if (same_file(cache.stat(dir / "a" / "y.tm"), x)) {
+    fail("other file", "a/y.tm is a/x.tm");
+  }
+  // Only regular files have an identity.
+  for (const auto& path : {dir / "a", dir / "c", dir / "a" / "missing.tm"}) {
+    if (cache.stat(path).has_value()) {
+      fail("not a file", path.string() + " has an identity");
+    }
+  }
+
+  auto canonical = fs::canonical(dir / "a" / "x.tm");
+  for (const auto& path : {dir / "b" / "link.tm", dir / "c" / "x.tm"}) {
+    if (cache.canonical(path) != canonical) {
+      fail("canonical", cache.canonical(path).string());
+    }
+  }
+  if (cache.canonical(dir / "b" / ".." / "missing.tm") !=
+      dir / "missing.tm") {
+    fail("canonical missing", "not the lexically normal path");
+  }
+
+  // Once looked up, a path keeps the answer it got: the cache lives for one
+  // compilation, during which the files are taken not to change.
+  fs::remove(dir / "a" / "x.tm");
+  touch(dir / "a" / "missing.tm");
+  if (!same_file(cache.stat(dir / "b" / "link.tm"), x) ||
+      cache.stat(dir / "a" / "missing.tm").has_value()) {
+    fail("cached", "looked at the filesystem again");
+  }
+  if (!FileCache().stat(dir / "a" / "missing.tm").has_value() ||
+      FileCache().stat(dir / "b" / "link.tm").has_value()) {
+    fail("uncached", "a new cache did not see the changes");
+  }
+}
+
+}  // namespace
+
+int main() {
+  namespace fs = std::filesystem;
+  auto dir = fs::temp_directory_path() /
+             ("toolman_file_cache_test." + std::to_string(getpid()));
+  fs::remove_all(dir);
+  try {
+    check(dir);
+  } catch (fs::filesystem_error& e) {
+    fail("filesystem", e.what());
+  }
+  fs::remove_all(dir);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+// Checks that find_perfect_hash gives every key a slot of its own, for the
+// sparse enum values and the name hashes the generators look up through
+// it, within the table sizes it promises.
+
+#include "src/perfect_hash.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using toolman::generator::find_perfect_hash;
+using toolman::generator::PerfectHash;
+
+int failures = 0;
+
+void fail(const std::string& what, const std::string& message) {
+  std::cerr << what << ": " << message << "\n";
+  ++failures;
+}
+
+// The FNV-1a hash the generated ParseX functions take of names.
+std::uint32_t fnv1a(const std::string& str) {
+  std::uint32_t hash = 2166136261u;
+  for (auto c : str) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return hash;
+}
+
+// Checks that each key is in a slot of its own that points back at it, and
+// that no other slot is used.
+void check(const std::string& what, const std::vector<std::uint32_t>& keys) {
+  auto hash = find_perfect_hash(keys);
+  if (!hash.has_value()) {
+    fail(what, "no perfect hash found");
+    return;
+  }
+  unsigned min_bits = 1;
+  while ((std::size_t{1} << min_bits) < keys.size()) {
+    ++min_bits;
+  }
+  if (hash->bits < min_bits || hash->bits > min_bits + 3 ||
+      hash->slots.size() != std::size_t{1} << hash->bits ||
+      hash->multiplier % 2 == 0) {
+    fail(what, std::to_string(hash->slots.size()) + " slots for " +
+                   std::to_string(keys.size()) + " keys");
+    return;
+  }
+  std::size_t used = 0;
+  for (auto slot : hash->slots) {
+    used += slot >= 0;
+  }
+  if (used != keys.size()) {
+    fail(what, std::to_string(used) + " slots used for " +
+                   std::to_string(keys.size()) + " keys");
+  }
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    auto slot = hash->slot(keys[i]);
+    if (slot >= hash->slots.size() ||
+        hash->slots[slot] != static_cast<int>(i)) {
+      fail(what, "key " + std::to_string(keys[i]) + " is not in its slot");
+    }
+  }
+  // The search is reproducible, so is the generated code.
+  auto again = find_perfect_hash(keys);
+  if (!again.has_value() || again->multiplier != hash->multiplier ||
+      again->bits != hash->bits) {
+    fail(what, "a second search found another hash");
+  }
+}
+
+std::vector<std::uint32_t> values(const std::vector<std::int32_t>& values) {
+  return {values.begin(), values.end()};
+}
+
+std::vector<std::uint32_t> names(const std::vector<std::string>& names) {
+  std::vector<std::uint32_t> keys;
+  for (const auto& name : names) {
+    keys.push_back(fnv1a(name));
+  }
+  return keys;
+}
+
+}  // namespace
+
+int main() {
+  // The sparse enums of tests/examples.tm and others whose values are far
+  // apart, negative or share their low bits.
+  check("Status", values({0, 404, 500, 418}));
+  check("one value", values({7}));
+  check("negative", values({-1, -2, -100000, 0, 1, INT32_MIN, INT32_MAX}));
+  check("powers of two", values({1 << 8, 1 << 16, 1 << 24, 1 << 30, 0}));
+  check("shared low bits",
+        values({0x10000, 0x20000, 0x30000, 0x40000, 0x50000, 0x60000}));
+  check("http statuses", values({100, 200, 201, 204, 301, 302, 304, 400, 401,
+                                 403, 404, 409, 418, 429, 500, 502, 503}));
+  check("Status names", names({"Ok", "NotFound", "Internal", "Teapot"}));
+  check("Color names", names({"Red", "Green", "Blue"}));
+
+  // Sets of random sparse values of every size up to 64, from a fixed
+  // sequence.
+  std::uint32_t state = 1;
+  for (std::size_t n = 1; n <= 64; ++n) {
+    std::vector<std::uint32_t> keys;
+    while (keys.size() < n) {
+      state = state * 1103515245u + 12345u;
+      auto key = state ^ (state >> 13);
+      auto seen = false;
+      for (auto k : keys) {
+        seen = seen || k == key;
+      }
+      if (!seen) {
+        keys.push_back(key);
+      }
+    }
+    check(std::to_string(n) + " random values", keys);
+  }
+
+  // Keys that are not distinct have no perfect hash, the generators fall
+  // back to a switch.
+  if (find_perfect_hash(values({1, 2, 1})).has_value()) {
+    fail("duplicates", "found a perfect hash");
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+// A generator plugin for plugin_test.cc, built as toolman-gen-echo: it
+// answers with one file holding the request it read and one error saying
+// how long the request was.
+
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "src/descriptor.h"
+
+namespace {
+
+void write_string(const std::string& str) {
+  auto size = str.size();
+  while (size >= 0x80) {
+    std::cout.put(static_cast<char>((size & 0x7f) | 0x80));
+    size >>= 7;
+  }
+  std::cout.put(static_cast<char>(size));
+  std::cout << str;
+}
+
+}  // namespace
+
+int main() {
+  using toolman::descriptor::RecordKind;
+  std::string request(std::istreambuf_iterator<char>(std::cin), {});
+
+  std::cout.write(toolman::descriptor::kResponseMagic,
+                  sizeof(toolman::descriptor::kResponseMagic));
+  std::cout.put(static_cast<char>(RecordKind::File));
+  write_string("echo/request.bin");
+  write_string(request);
+  std::cout.put(static_cast<char>(RecordKind::Error));
+  write_string("read " + std::to_string(request.size()) + " bytes");
+  return std::cout.flush() ? 0 : 1;
+}
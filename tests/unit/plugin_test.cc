@@ -0,0 +1,209 @@
+// Checks the plugin protocol: the request toolman serializes, including the
+// types it pulls in from imported files, reaches a plugin byte for byte,
+// the files and errors the plugin answers with come back, and a response
+// that is cut short or holds an unknown record is rejected.
+//
+// toolman-gen-echo, built from plugin_echo.cc, must be on the PATH.
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/descriptor.h"
+#include "src/document.h"
+#include "src/list_type.h"
+#include "src/plugin.h"
+
+namespace {
+
+using toolman::Document;
+using toolman::EnumField;
+using toolman::EnumType;
+using toolman::Field;
+using toolman::ListType;
+using toolman::StmtInfo;
+using toolman::StructType;
+namespace descriptor = toolman::descriptor;
+
+int failures = 0;
+
+void fail(const std::string& what, const std::string& message) {
+  std::cerr << what << ": " << message << "\n";
+  ++failures;
+}
+
+std::string byte(int value) { return std::string(1, static_cast<char>(value)); }
+
+// A string as the descriptor writes it, for strings shorter than 128 bytes.
+std::string str(const std::string& value) {
+  return byte(static_cast<int>(value.size())) + value;
+}
+
+std::string magic(const char (&magic)[4]) { return std::string(magic, 4); }
+
+// a.tm declares A, whose fields refer to B, declared in another file, and
+// B to the enum C, declared in a third one. Neither is declared in a.tm,
+// so the descriptor carries both in its imported types, once each.
+struct Schema {
+  Schema() {
+    auto source = std::make_shared<std::filesystem::path>("a.tm");
+    auto imported = std::make_shared<std::filesystem::path>("b.tm");
+    StmtInfo at(1, 1, source);
+    StmtInfo there(1, 1, imported);
+
+    auto c = std::make_shared<EnumType>("C", there);
+    EnumField x("X", there);
+    x.set_value(-1);
+    c->append_field(x);
+
+    auto b = std::make_shared<StructType>("B", there);
+    Field b_c("c", there);
+    b_c.set_type(c);
+    b_c.set_optional(true);
+    b_c.set_number(1);
+    b->append_field(b_c);
+
+    auto a = std::make_shared<StructType>("A", at);
+    Field a_b("b", at, {"doc"});
+    a_b.set_type(b);
+    a_b.set_number(1);
+    a->append_field(a_b);
+    auto bs = std::make_shared<ListType>(at);
+    bs->set_elem_type(b);
+    Field a_bs("bs", at);
+    a_bs.set_type(bs);
+    a_bs.set_number(2);
+    a->append_field(a_bs);
+
+    document.set_source(source);
+    document.insert_struct_type(a);
+  }
+
+  // The request for `document`, written out by hand from the grammar in
+  // src/descriptor.h.
+  static std::string request() {
+    auto struct_kind = byte(static_cast<int>(descriptor::TypeKind::Struct));
+    auto enum_kind = byte(static_cast<int>(descriptor::TypeKind::Enum));
+    auto list_kind = byte(static_cast<int>(descriptor::TypeKind::List));
+    return magic(descriptor::kRequestMagic) + str("a.tm") +
+           // options, enums
+           byte(0) + byte(0) +
+           // structs: A { b: B = 1 with a comment, bs: list<B> = 2 }
+           byte(1) + str("A") + byte(2) +
+           str("b") + byte(0) + byte(1) + str("doc") + struct_kind +
+           str("B") + byte(1) +
+           str("bs") + byte(0) + byte(0) + list_kind + struct_kind +
+           str("B") + byte(2) +
+           // api groups
+           byte(0) +
+           // imported enums: C { X = -1 }
+           byte(1) + str("C") + byte(1) + str("X") + byte(1) + byte(0) +
+           // imported structs: B { c?: C = 1 }
+           byte(1) + str("B") + byte(1) + str("c") + byte(1) + byte(0) +
+           enum_kind + str("C") + byte(1);
+  }
+
+  Document document;
+};
+
+void check_serialize() {
+  Schema schema;
+  auto request = descriptor::serialize(schema.document);
+  if (request != Schema::request()) {
+    fail("serialize", "got " + std::to_string(request.size()) +
+                          " bytes that differ from the " +
+                          std::to_string(Schema::request().size()) +
+                          " expected");
+  }
+}
+
+void check_echo() {
+  Schema schema;
+  auto results = toolman::plugin::run_plugins({"echo", "missing", "echo"},
+                                              schema.document);
+  if (results.size() != 3) {
+    fail("run_plugins", std::to_string(results.size()) + " results");
+    return;
+  }
+  for (auto i : {0, 2}) {
+    // The error it reports fails the plugin, the files still come back.
+    const auto& result = results[i];
+    if (!result.failure.empty() || result.ok()) {
+      fail("echo", "failure `" + result.failure + "`");
+      continue;
+    }
+    const auto& files = result.response.files;
+    if (files.size() != 1 || files[0].name != "echo/request.bin" ||
+        files[0].content != Schema::request()) {
+      fail("echo", "the request did not come back as the file");
+    }
+    const auto& errors = result.response.errors;
+    auto want = "read " + std::to_string(Schema::request().size()) + " bytes";
+    if (errors.size() != 1 || errors[0] != want) {
+      fail("echo", "the error record did not come back");
+    }
+  }
+  // A plugin that cannot be run fails alone.
+  if (results[1].ok() || results[1].name != "missing" ||
+      results[1].failure.find("cannot run `toolman-gen-missing`") != 0) {
+    fail("missing", "got `" + results[1].failure + "`");
+  }
+}
+
+void check_response() {
+  auto header = magic(descriptor::kResponseMagic);
+  auto file = byte(static_cast<int>(descriptor::RecordKind::File));
+  auto error = byte(static_cast<int>(descriptor::RecordKind::Error));
+
+  auto empty = descriptor::parse_response(header);
+  if (!empty.files.empty() || !empty.errors.empty()) {
+    fail("no records", "got records");
+  }
+  auto records = descriptor::parse_response(
+      header + file + str("x") + str("") + error + str("e") + file +
+      str("y") + str("why"));
+  if (records.files.size() != 2 || records.files[0].name != "x" ||
+      !records.files[0].content.empty() || records.files[1].name != "y" ||
+      records.files[1].content != "why" || records.errors.size() != 1 ||
+      records.errors[0] != "e") {
+    fail("records", "not read back in order");
+  }
+
+  struct Malformed {
+    const char* what;
+    std::string data;
+  };
+  std::vector<Malformed> malformed = {
+      {"no magic", ""},
+      {"short magic", header.substr(0, 3)},
+      {"request magic", magic(descriptor::kRequestMagic)},
+      {"other version", header.substr(0, 3) + byte(2)},
+      {"no file name", header + file},
+      {"no content", header + file + str("x")},
+      {"short content", header + file + str("x") + byte(5) + "abcd"},
+      {"short error", header + error + byte(2) + "e"},
+      {"cut varint", header + error + byte(0x80)},
+      {"long varint", header + error + std::string(10, '\xff') + byte(0)},
+      {"record 0", header + byte(0)},
+      {"record 3", header + byte(3) + str("x")},
+      {"unknown after files", header + file + str("x") + str("") + byte(0x81)},
+  };
+  for (const auto& c : malformed) {
+    try {
+      descriptor::parse_response(c.data);
+      fail(c.what, "accepted");
+    } catch (descriptor::DecodeError&) {
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  check_serialize();
+  check_echo();
+  check_response();
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+// Checks how chained scopes resolve names: declarations shadow what
+// `import *` brings in, earlier imports shadow later ones, a name that two
+// imports provide is reported by lookup_chained, and cycles end.
+
+#include "src/scope.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/custom_type.h"
+
+namespace {
+
+using toolman::StmtInfo;
+using toolman::StructType;
+using toolman::Type;
+using toolman::TypeScope;
+
+int failures = 0;
+
+void fail(const std::string& what, const std::string& message) {
+  std::cerr << what << ": " << message << "\n";
+  ++failures;
+}
+
+// A scope declaring one struct for each name, from the file `source`.
+std::shared_ptr<TypeScope> module(const std::string& source,
+                                  const std::vector<std::string>& names) {
+  auto scope = std::make_shared<TypeScope>();
+  auto path = std::make_shared<std::filesystem::path>(source);
+  for (const auto& name : names) {
+    scope->declare(std::make_shared<StructType>(name, StmtInfo(1, 1, path)));
+  }
+  return scope;
+}
+
+std::string source_of(const std::shared_ptr<Type>& type) {
+  return type->get_stmt_info().get_source()->string();
+}
+
+// Checks that `name` resolves to the type declared in `want`, or to
+// nothing if `want` is empty.
+void check_lookup(const std::string& what, const TypeScope& scope,
+                  const std::string& name, const std::string& want) {
+  auto got = scope.lookup(name);
+  auto got_source = got.has_value() ? source_of(got.value()) : "";
+  if (got_source != want) {
+    fail(what, "`" + name + "` from `" + got_source + "`, want `" + want +
+                   "`");
+  }
+}
+
+void check_chained(const std::string& what, const TypeScope& scope,
+                   const std::string& name,
+                   const std::vector<std::string>& want) {
+  std::vector<std::string> got;
+  for (const auto& type : scope.lookup_chained(name)) {
+    got.push_back(source_of(type));
+  }
+  if (got != want) {
+    fail(what, std::to_string(got.size()) + " types for `" + name + "`");
+  }
+}
+
+void check_shadowing() {
+  auto root = module("root.tm", {"Dup", "Root"});
+  auto x = module("x.tm", {"Dup", "Both", "X"});
+  auto y = module("y.tm", {"Dup", "Both", "Y"});
+  // y.tm imports z.tm, whose names come after y.tm's own.
+  auto z = module("z.tm", {"Y", "Z"});
+  y->chain(z);
+  root->chain(x);
+  root->chain(y);
+
+  check_lookup("declared", *root, "Dup", "root.tm");
+  check_lookup("first import", *root, "Both", "x.tm");
+  check_lookup("second import", *root, "Y", "y.tm");
+  check_lookup("transitive import", *root, "Z", "z.tm");
+  check_lookup("missing", *root, "Missing", "");
+  if (root->lookup_local("X").has_value() ||
+      !root->lookup_local("Root").has_value()) {
+    fail("lookup_local", "saw through the chain");
+  }
+
+  // lookup_chained leaves out the scope itself, so Dup is ambiguous among
+  // the imports even though root.tm shadows it.
+  check_chained("ambiguous", *root, "Dup", {"x.tm", "y.tm"});
+  check_chained("ambiguous", *root, "Both", {"x.tm", "y.tm"});
+  check_chained("not ambiguous", *root, "Y", {"y.tm"});
+  check_chained("not imported", *root, "Root", {});
+
+  // The same module imported twice, or reached through two imports,
+  // provides its types once.
+  auto shared = module("shared.tm", {"Shared"});
+  auto a = module("a.tm", {});
+  auto b = module("b.tm", {});
+  a->chain(shared);
+  b->chain(shared);
+  auto twice = module("twice.tm", {});
+  twice->chain(shared);
+  twice->chain(shared);
+  twice->chain(a);
+  twice->chain(b);
+  check_chained("imported twice", *twice, "Shared", {"shared.tm"});
+}
+
+void check_cycles() {
+  auto a = module("a.tm", {"A"});
+  auto b = module("b.tm", {"B"});
+  a->chain(b);
+  b->chain(a);
+  a->chain(a);
+  check_lookup("cycle", *a, "B", "b.tm");
+  check_lookup("cycle", *b, "A", "a.tm");
+  check_lookup("cycle", *a, "Missing", "");
+  check_chained("cycle", *a, "A", {});
+  check_chained("cycle", *a, "B", {"b.tm"});
+  check_chained("cycle", *a, "Missing", {});
+}
+
+}  // namespace
+
+int main() {
+  check_shadowing();
+  check_cycles();
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}